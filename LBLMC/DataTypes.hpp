@@ -99,6 +99,20 @@ typedef double AddSubType;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+	//qualifier of the time step dependent constants of components (dt, hol2, hoc2, HOL, ...); they are
+	//only mutable when setTimestep() is enabled, so they stay constant for synthesis otherwise
+#ifdef LMC_RUNTIME_TIMESTEP
+#define LMC_TIMESTEP_CONST
+#else
+#define LMC_TIMESTEP_CONST const
+#endif
+
+	//companion conductance of the DC-side capacitors of the half-bridge converter components; shared by
+	//the components and the code generators that emit their updates
+#define LMC_HB_CAP_CONDUCT 10000.0
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
 } //namespace LBLMC
 
 #endif // LBLMCDATATYPES_HPP
@@ -36,11 +36,13 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #define LMC_TIMESTEP 100.0e-9 ///< time step period for testbench and engine
 #define LMC_SIM_TIME 600.0e-3 ///< total simulation time to run for testbenches
 
+	//compile-time selection of the model time step; codegen/TimestepBank selects among stamped time steps at runtime
 //#define LMC_DT_40NS ///< used to select conductance matrix and elements based on time step
 //#define LMC_DT_45NS ///< used to select conductance matrix and elements based on time step
 //#define LMC_DT_50NS ///< used to select conductance matrix and elements based on time step
 //#define LMC_DT_55NS ///< used to select conductance matrix and elements based on time step
 //#define LMC_DT_60NS ///< used to select conductance matrix and elements based on time step
+//#define LMC_RUNTIME_TIMESTEP ///< enables setTimestep() of the components; leave undefined so synthesis folds their time step constants
 
 //==================================================================================================
 //	Data Logging and Sampling
@@ -74,6 +76,9 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 //#define LMC_USE_SINGLE_FLOAT_POINT_TYPES	//Use 32-bit single-precision floating point type
 //#define LMC_USE_HALF_FLOAT_POINT_TYPES	//Use 16-bit half-precision floating point type
 
+	//uncomment to record signal ranges with SignalRangeTracker in offline runs for fixed-point word-length exploration
+//#define LMC_RANGE_TRACKING_MODE
+
 //==================================================================================================
 //	Code Operation Parameters
 //==================================================================================================
@@ -82,7 +87,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 //#define LMC_OFFLINE_SIMULATION_MODE	//use the codebase for offline simulation
 //#define LMC_OFFLINE_COSIMULATION_MODE //use the codebase for offline C++/RTL co-simulation
 //#define LMC_CODE_GENERATION_MODE    //use the codebase to generate sim engine source files for FPGA synthesis
-//#define LMC_MODEL_DECOMPOSITION_MODE    //use the codebase to decompose a model into subnetworks under LB-LMC
+//#define LMC_MODEL_DECOMPOSITION_MODE    //use the codebase to decompose a model into subnetworks under LB-LMC (see SystemDecomposer)
 #define LMC_FPGA_SYNTHESIS_MODE     //use the codebase for FPGA synthesis
 
 //==================================================================================================
@@ -0,0 +1,274 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "BackgroundSystemRebuilder.hpp"
+#include "SparseSystemConductance.hpp"
+#include "SystemSourceVector.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <ctime>
+
+#if __cplusplus >= 201103L
+#define LMC_BACKGROUND_REBUILD_THREADS ///< rebuilds run on a std::thread; otherwise they run in requestRebuild()
+#include <thread>
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace LBLMC
+{
+
+struct BackgroundSystemRebuilder::SharedState
+{
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+	std::atomic<int> active; ///< index of the active solver buffer; written by the simulation thread
+	std::atomic<int> status; ///< Status of the rebuild
+	std::atomic<unsigned long> num_steps; ///< number of solve() calls; written by the simulation thread
+	std::thread worker;
+#else
+	int active;
+	int status;
+	unsigned long num_steps;
+#endif
+
+	SharedState() : active(0), status(IDLE), num_steps(0) {}
+};
+
+BackgroundSystemRebuilder::BackgroundSystemRebuilder(const SystemSolver& solver) :
+	netlist(solver.getDimension()), dt(0.0), error_message(), shared(new SharedState()),
+	request_time(0.0), request_step(0), num_switches(0),
+	build_time(0.0), last_build_time(0.0), last_switch_latency(0.0), last_switch_steps(0)
+{
+	solvers[0] = new SystemSolver(solver);
+	solvers[1] = new SystemSolver(solver);
+}
+
+BackgroundSystemRebuilder::~BackgroundSystemRebuilder()
+{
+	waitForWorker();
+
+	delete solvers[0];
+	delete solvers[1];
+	delete shared;
+}
+
+int BackgroundSystemRebuilder::requestRebuild(const SystemNetlist& netlist, NumType dt)
+{
+	const int state = shared->status;
+	if(state == BUILDING || state == READY) return -1;
+
+	waitForWorker(); //previous worker has finished; joins it
+
+	this->netlist.reset(netlist);
+	this->dt = dt;
+
+	request_time = now();
+	request_step = getNumSteps();
+	shared->status = BUILDING;
+
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+	shared->worker = std::thread(&BackgroundSystemRebuilder::build, this);
+#else
+	build();
+#endif
+
+	return 0;
+}
+
+bool BackgroundSystemRebuilder::swapIfReady()
+{
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+	if(shared->status.load(std::memory_order_acquire) != READY) return false;
+#else
+	if(shared->status != READY) return false;
+#endif
+
+	shared->active = 1 - shared->active;
+
+		//the acquire of READY makes the worker's build_time visible; the statistics read by the
+		//simulation thread are only written here, so they never race with a running rebuild
+
+	last_build_time = build_time;
+	last_switch_latency = now() - request_time;
+	last_switch_steps = getNumSteps() - request_step;
+	num_switches++;
+
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+	shared->status.store(IDLE, std::memory_order_release);
+#else
+	shared->status = IDLE;
+#endif
+
+	return true;
+}
+
+void BackgroundSystemRebuilder::solve(const NumType* b_components, NumType* x)
+{
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+		//only this thread writes the count, so a relaxed load and store is enough and avoids a locked add
+	shared->num_steps.store(shared->num_steps.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	solvers[shared->active.load(std::memory_order_relaxed)]->solve(b_components, x);
+#else
+	shared->num_steps++;
+	solvers[shared->active]->solve(b_components, x);
+#endif
+}
+
+const SystemSolver& BackgroundSystemRebuilder::getActiveSolver() const
+{
+	return *solvers[int(shared->active)];
+}
+
+BackgroundSystemRebuilder::Status BackgroundSystemRebuilder::getStatus() const
+{
+	return Status(int(shared->status));
+}
+
+const char* BackgroundSystemRebuilder::getErrorMessage() const
+{
+	return error_message.c_str();
+}
+
+unsigned long BackgroundSystemRebuilder::getNumSteps() const
+{
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+	return shared->num_steps.load(std::memory_order_relaxed);
+#else
+	return shared->num_steps;
+#endif
+}
+
+unsigned long BackgroundSystemRebuilder::getNumSwitches() const
+{
+	return num_switches;
+}
+
+double BackgroundSystemRebuilder::getLastBuildTime() const
+{
+	return last_build_time;
+}
+
+double BackgroundSystemRebuilder::getLastSwitchLatency() const
+{
+	return last_switch_latency;
+}
+
+unsigned long BackgroundSystemRebuilder::getLastSwitchSteps() const
+{
+	return last_switch_steps;
+}
+
+const char* BackgroundSystemRebuilder::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	sstrm << "Background System Rebuilder Statistics\n\n";
+	sstrm << "dimension:            " << getActiveSolver().getDimension() << "\n";
+	sstrm << "steps:                " << getNumSteps() << "\n";
+	sstrm << "switches:             " << num_switches << "\n";
+	sstrm << "last build time (s):  " << last_build_time << "\n";
+	sstrm << "last switch latency:  " << last_switch_latency << " s, " << last_switch_steps << " steps\n";
+
+	if(getStatus() == FAILED)
+	{
+		sstrm << "last rebuild failed:  " << error_message << "\n";
+	}
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+bool BackgroundSystemRebuilder::hasBackgroundThreads()
+{
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void BackgroundSystemRebuilder::build()
+{
+	const double start = now();
+
+	try
+	{
+		const unsigned int dim = netlist.getDimension();
+
+		SparseSystemConductance conductance(dim);
+		SystemSourceVector sources(dim);
+
+		if(netlist.stampSystem(dt, conductance, sources))
+		{
+			throw std::runtime_error("BackgroundSystemRebuilder: cannot stamp netlist due to matrix dimension size");
+		}
+
+		const int active = shared->active;
+		const SystemSolver& present = *solvers[active];
+		SystemSolver& target = *solvers[1 - active];
+
+		target.reset(conductance, sources);
+
+		if(target.getDimension() != present.getDimension() ||
+			target.getNumSources() != present.getNumSources() ||
+			target.getVariableSources() != present.getVariableSources())
+		{
+			throw std::runtime_error("BackgroundSystemRebuilder: rebuilt netlist changed the source layout");
+		}
+	}
+	catch(std::exception& e)
+	{
+		error_message = e.what();
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+		shared->status.store(FAILED, std::memory_order_release);
+#else
+		shared->status = FAILED;
+#endif
+		return;
+	}
+
+	build_time = now() - start;
+
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+	shared->status.store(READY, std::memory_order_release);
+#else
+	shared->status = READY;
+#endif
+}
+
+void BackgroundSystemRebuilder::waitForWorker()
+{
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+	if(shared->worker.joinable()) shared->worker.join();
+#endif
+}
+
+double BackgroundSystemRebuilder::now()
+{
+#ifdef LMC_BACKGROUND_REBUILD_THREADS
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+	return double(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+} //namespace LBLMC
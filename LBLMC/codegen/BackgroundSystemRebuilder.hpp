@@ -0,0 +1,166 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BACKGROUNDSYSTEMREBUILDER_HPP
+#define BACKGROUNDSYSTEMREBUILDER_HPP
+
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "SystemNetlist.hpp"
+#include "SystemSolver.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief rebuilds the solver of a running simulation on a background thread and switches to it at a step boundary
+ *
+ * The simulation thread solves each step with the active one of two SystemSolver buffers.  When the
+ * model changes (e.g. an operator changes a parameter), requestRebuild() copies the changed netlist
+ * and stamps and factors it on a background thread into the inactive buffer, using the sparse path
+ * of SystemSolver so no dense inverse is formed.  The simulation keeps stepping on the old solver;
+ * at a step boundary, swapIfReady() switches to the new solver with a single atomic index change if
+ * the rebuild finished.  The simulation thread never waits on the rebuild.
+ *
+ * The changed netlist must keep the source layout (the same components in the same order), so the
+ * b_components of the running simulation stay valid; only parameters and nodes may change.
+ *
+ * Background threads need C++11 (std::thread, std::atomic).  When the library is compiled as C++03,
+ * requestRebuild() rebuilds synchronously before returning, and the switch still happens at the next
+ * swapIfReady().  The mode is chosen when BackgroundSystemRebuilder.cpp is compiled; the thread state
+ * is kept out of the class layout, so code including this header may use either language standard.
+ *
+ * solve(), swapIfReady(), and the statistics are to be called from the simulation thread;
+ * requestRebuild() from a single control thread.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class BackgroundSystemRebuilder
+{
+public:
+
+	/**
+	 * state of the background rebuild
+	 */
+	enum Status
+	{
+		IDLE, ///< no rebuild in progress
+		BUILDING, ///< rebuild running on the background thread
+		READY, ///< rebuilt solver waiting for the switch at swapIfReady()
+		FAILED ///< last rebuild failed; see getErrorMessage()
+	};
+
+private:
+	SystemSolver* solvers[2]; ///< double-buffered solvers; the active one is used by the simulation thread
+	SystemNetlist netlist; ///< copy of the netlist being rebuilt
+	NumType dt; ///< time step of the netlist being rebuilt
+	std::string error_message; ///< reason of the last failed rebuild
+
+	struct SharedState; ///< active buffer index, rebuild status, step count and worker thread; defined by the library
+	SharedState* shared; ///< state shared between the simulation, control and worker threads
+
+	double request_time; ///< time of the last requestRebuild(), in seconds
+	unsigned long request_step; ///< step count at the last requestRebuild()
+	unsigned long num_switches; ///< number of switches to a rebuilt solver
+	double build_time; ///< duration of the finished rebuild, in seconds; written by the worker before it sets READY
+	double last_build_time; ///< duration of the rebuild last switched to, in seconds; copied from build_time at the switch
+	double last_switch_latency; ///< time from request to switch of the last rebuild, in seconds
+	unsigned long last_switch_steps; ///< steps solved with the old solver between request and switch of the last rebuild
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param solver solver of the running simulation to start with
+	 */
+	BackgroundSystemRebuilder(const SystemSolver& solver);
+
+	/**
+	 * destructor; waits for a running rebuild to finish
+	 */
+	~BackgroundSystemRebuilder();
+
+	/**
+	 * starts rebuilding the solver for a changed netlist
+	 *
+	 * Does not wait for the rebuild, except when compiled without C++11 threads.
+	 *
+	 * @param netlist changed netlist of the system, with the same source layout; copied
+	 * @param dt simulation time step of the discretized components
+	 * @return 0 if the rebuild was started, -1 if a rebuild is running or waiting to be switched to
+	 */
+	int requestRebuild(const SystemNetlist& netlist, NumType dt);
+
+	/**
+	 * switches to the rebuilt solver if the rebuild finished; call at a step boundary
+	 *
+	 * Never blocks.
+	 *
+	 * @return true if switched to a rebuilt solver
+	 */
+	bool swapIfReady();
+
+	/**
+	 * solves the system for the present source contributions with the active solver
+	 * @param b_components source contributions of the components; b_components[index-1] for source index
+	 * @param x array to store the solution to, of the system dimension
+	 */
+	void solve(const NumType* b_components, NumType* x);
+
+	/**
+	 * @return the active solver
+	 */
+	const SystemSolver& getActiveSolver() const;
+
+	Status getStatus() const; ///< @return state of the background rebuild
+	const char* getErrorMessage() const; ///< @return reason of the last failed rebuild
+
+	unsigned long getNumSteps() const; ///< @return number of solve() calls
+	unsigned long getNumSwitches() const; ///< @return number of switches to a rebuilt solver
+	double getLastBuildTime() const; ///< @return duration of the rebuild last switched to, in seconds
+	double getLastSwitchLatency() const; ///< @return time from request to switch of the last rebuild, in seconds
+	unsigned long getLastSwitchSteps() const; ///< @return steps solved between request and switch of the last rebuild
+
+	/**
+	 * creates a report, as a string, of the rebuild and switch statistics
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+	/**
+	 * @return true if the library was compiled with background threads, false if rebuilds run in requestRebuild()
+	 */
+	static bool hasBackgroundThreads();
+
+private:
+
+	BackgroundSystemRebuilder(const BackgroundSystemRebuilder& base); ///< not copyable; owns a thread
+	BackgroundSystemRebuilder& operator=(const BackgroundSystemRebuilder& base);
+
+	void build();
+	void waitForWorker();
+	static double now();
+};
+
+} //namespace LBLMC
+
+#endif //BACKGROUNDSYSTEMREBUILDER_HPP
@@ -0,0 +1,705 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "CSDSolverGenerator.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+
+namespace LBLMC
+{
+
+CSDSolverGenerator::CSDSolverGenerator(const NumType* A, unsigned int dimension, unsigned int num_components,
+		unsigned int coef_frac_bits, unsigned int input_frac_bits, NumType zero_bound) :
+	A(A), dimension(dimension), num_components(num_components), coef_frac_bits(coef_frac_bits),
+	input_frac_bits(input_frac_bits), zero_bound(zero_bound), quantized(), columns(), rows()
+{
+	buildPlan();
+}
+
+CSDSolverGenerator::CSDSolverGenerator(const CSDSolverGenerator& base) :
+	A(base.A), dimension(base.dimension), num_components(base.num_components), coef_frac_bits(base.coef_frac_bits),
+	input_frac_bits(base.input_frac_bits), zero_bound(base.zero_bound), quantized(base.quantized),
+	columns(base.columns), rows(base.rows)
+{
+	//do nothing else
+}
+
+void CSDSolverGenerator::reset(const NumType* A, unsigned int dimension, unsigned int num_components,
+		unsigned int coef_frac_bits, unsigned int input_frac_bits, NumType zero_bound)
+{
+	this->A = A;
+	this->dimension = dimension;
+	this->num_components = num_components;
+	this->coef_frac_bits = coef_frac_bits;
+	this->input_frac_bits = input_frac_bits;
+	this->zero_bound = zero_bound;
+
+	buildPlan();
+}
+
+void CSDSolverGenerator::reset(const CSDSolverGenerator& base)
+{
+	A = base.A;
+	dimension = base.dimension;
+	num_components = base.num_components;
+	coef_frac_bits = base.coef_frac_bits;
+	input_frac_bits = base.input_frac_bits;
+	zero_bound = base.zero_bound;
+	quantized = base.quantized;
+	columns = base.columns;
+	rows = base.rows;
+}
+
+void CSDSolverGenerator::buildPlan()
+{
+	quantized.assign(dimension*dimension, 0);
+	columns.assign(dimension, CSDColumn());
+	rows.assign(dimension, std::vector<CSDRowTerm>());
+
+	const double scale = std::ldexp(1.0, coef_frac_bits);
+
+	for(unsigned int i = 0; i < dimension*dimension; i++)
+	{
+		if( A[i] < zero_bound && A[i] > -zero_bound ) continue; // A[r,c] is close to zero, so ignore the term.
+
+		quantized[i] = (long long)std::floor(double(A[i])*scale + 0.5);
+	}
+
+	for(unsigned int c = 0; c < dimension; c++)
+	{
+		CSDColumn& col = columns[c];
+		std::map<long long, unsigned int> product_index;
+
+			//equal coefficient magnitudes in a column share one product across rows
+		for(unsigned int r = 0; r < dimension; r++)
+		{
+			long long q = quantized[dimension*r+c];
+			if(q == 0) continue;
+
+			long long m = (q < 0) ? -q : q;
+
+			std::map<long long, unsigned int>::iterator iter = product_index.find(m);
+			unsigned int p;
+			if(iter == product_index.end())
+			{
+				p = col.products.size();
+				product_index[m] = p;
+
+				CSDProduct prod;
+				prod.magnitude = m;
+
+					//canonical signed digit recoding
+				unsigned int k = 0;
+				while(m != 0)
+				{
+					if(m & 1)
+					{
+						CSDTerm term;
+						term.operand = -1;
+						term.shift = k;
+						term.sign = ((m & 3) == 3) ? -1 : +1;
+						m -= term.sign;
+						prod.terms.push_back(term);
+					}
+					m >>= 1;
+					++k;
+				}
+
+				col.products.push_back(prod);
+			}
+			else
+			{
+				p = iter->second;
+			}
+
+			CSDRowTerm rterm;
+			rterm.column = c;
+			rterm.product = p;
+			rterm.sign = (q < 0) ? -1 : +1;
+			rows[r].push_back(rterm);
+		}
+
+			//extract digit pairs b +/- (b << d) recurring in several products as shared subterms
+		while(true)
+		{
+			std::map<std::pair<unsigned int,int>, unsigned int> counts;
+
+			for(unsigned int p = 0; p < col.products.size(); p++)
+			{
+				std::map<std::pair<unsigned int,int>, bool> seen;
+				const std::vector<CSDTerm>& terms = col.products[p].terms;
+
+				for(unsigned int i = 0; i < terms.size(); i++)
+				{
+					if(terms[i].operand != -1) continue;
+					for(unsigned int j = i+1; j < terms.size(); j++)
+					{
+						if(terms[j].operand != -1) continue;
+						std::pair<unsigned int,int> key(terms[j].shift - terms[i].shift, terms[i].sign*terms[j].sign);
+						if(!seen[key])
+						{
+							seen[key] = true;
+							++counts[key];
+						}
+					}
+				}
+			}
+
+			std::pair<unsigned int,int> best(0,0);
+			unsigned int best_count = 1;
+			std::map<std::pair<unsigned int,int>, unsigned int>::iterator iter = counts.begin();
+			for( ; iter != counts.end(); iter++)
+			{
+				if(iter->second > best_count)
+				{
+					best = iter->first;
+					best_count = iter->second;
+				}
+			}
+
+			if(best_count < 2) break;
+
+			CSDSubterm sub;
+			sub.shift = best.first;
+			sub.sign = best.second;
+			int sub_index = col.subterms.size();
+			col.subterms.push_back(sub);
+
+				//replace non-overlapping digit pairs matching the subterm
+			for(unsigned int p = 0; p < col.products.size(); p++)
+			{
+				std::vector<CSDTerm>& terms = col.products[p].terms;
+				std::vector<bool> used(terms.size(), false);
+				std::vector<CSDTerm> replaced;
+
+				for(unsigned int i = 0; i < terms.size(); i++)
+				{
+					if(used[i] || terms[i].operand != -1) continue;
+					for(unsigned int j = i+1; j < terms.size(); j++)
+					{
+						if(used[j] || terms[j].operand != -1) continue;
+						if( (terms[j].shift - terms[i].shift) == sub.shift && terms[i].sign*terms[j].sign == sub.sign )
+						{
+							used[i] = true;
+							used[j] = true;
+
+							CSDTerm term;
+							term.operand = sub_index;
+							term.shift = terms[i].shift;
+							term.sign = terms[i].sign;
+							replaced.push_back(term);
+							break;
+						}
+					}
+				}
+
+				for(unsigned int i = 0; i < terms.size(); i++)
+				{
+					if(!used[i]) replaced.push_back(terms[i]);
+				}
+
+				terms = replaced;
+			}
+		}
+	}
+}
+
+long long CSDSolverGenerator::evaluateProduct(unsigned int c, unsigned int p, long long raw) const
+{
+	const CSDColumn& col = columns[c];
+	const std::vector<CSDTerm>& terms = col.products[p].terms;
+
+	long long sum = 0;
+
+	for(unsigned int i = 0; i < terms.size(); i++)
+	{
+		long long v = raw;
+		if(terms[i].operand >= 0)
+		{
+			const CSDSubterm& sub = col.subterms[terms[i].operand];
+			v = raw + sub.sign*(raw*(1LL << sub.shift));
+		}
+
+		sum += terms[i].sign*(v*(1LL << terms[i].shift));
+	}
+
+	return sum;
+}
+
+/**
+ * @return v >> n rounded toward negative infinity, as the arithmetic right shift of the generated code
+ */
+static long long shiftRight(long long v, unsigned int n)
+{
+	return (v >= 0) ? (v >> n) : -((-(v+1)) >> n) - 1;
+}
+
+#if defined LMC_USE_FIXED_POINT_TYPES
+/**
+ * @return bits of a fixed-point NumType, wrapped to its width as ap_fixed does on overflow
+ */
+static long long wrapToNumType(long long bits)
+{
+	const unsigned int unused = 64 - NUM_FIXED_POINT_SIZE;
+	if(unused == 0) return bits;
+	return (long long)((unsigned long long)bits << unused) >> unused;
+}
+#endif
+
+long long CSDSolverGenerator::toRaw(double value, double& represented) const
+{
+#if defined LMC_USE_FIXED_POINT_TYPES
+		//NumType rounds to NUM_FIXED_POINT_FRAC fractional bits, then its bits are shifted to input_frac_bits
+	const long long bits = wrapToNumType((long long)std::floor(std::ldexp(value, NUM_FIXED_POINT_FRAC) + 0.5));
+	represented = std::ldexp(double(bits), -int(NUM_FIXED_POINT_FRAC));
+
+	if(int(NUM_FIXED_POINT_FRAC) <= int(input_frac_bits)) return bits*(1LL << (input_frac_bits - NUM_FIXED_POINT_FRAC));
+	return shiftRight(bits, NUM_FIXED_POINT_FRAC - input_frac_bits);
+#else
+	represented = double(NumType(value));
+	return (long long)(represented*std::ldexp(1.0, input_frac_bits));
+#endif
+}
+
+double CSDSolverGenerator::fromRaw(long long sum) const
+{
+#if defined LMC_USE_FIXED_POINT_TYPES
+	long long bits;
+	if(int(NUM_FIXED_POINT_FRAC) >= int(input_frac_bits)) bits = shiftRight(sum, coef_frac_bits)*(1LL << (NUM_FIXED_POINT_FRAC - input_frac_bits));
+	else bits = shiftRight(sum, coef_frac_bits + input_frac_bits - NUM_FIXED_POINT_FRAC);
+
+	return std::ldexp(double(wrapToNumType(bits)), -int(NUM_FIXED_POINT_FRAC));
+#else
+	return double(NumType(double(shiftRight(sum, coef_frac_bits))*std::ldexp(1.0, -int(input_frac_bits))));
+#endif
+}
+
+long long CSDSolverGenerator::getQuantizedCoefficient(unsigned int r, unsigned int c) const
+{
+	return quantized[dimension*r+c];
+}
+
+void CSDSolverGenerator::getOperationCounts(unsigned int& adders, unsigned int& subterms, unsigned int& multipliers) const
+{
+	adders = 0;
+	subterms = 0;
+	multipliers = 0;
+
+	for(unsigned int c = 0; c < dimension; c++)
+	{
+		subterms += columns[c].subterms.size();
+		adders += columns[c].subterms.size();
+
+		for(unsigned int p = 0; p < columns[c].products.size(); p++)
+		{
+			adders += columns[c].products[p].terms.size() - 1;
+		}
+	}
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		multipliers += rows[r].size();
+		if(!rows[r].empty()) adders += rows[r].size() - 1;
+	}
+}
+
+const char* CSDSolverGenerator::asString(std::string& buffer) const
+{
+	std::stringstream sstrm;
+
+	unsigned int adders, subterms, multipliers;
+	getOperationCounts(adders, subterms, multipliers);
+
+	unsigned int csd_digits = 0;
+	unsigned int products = 0;
+	for(unsigned int c = 0; c < dimension; c++)
+	{
+		products += columns[c].products.size();
+		for(unsigned int p = 0; p < columns[c].products.size(); p++)
+		{
+			long long m = columns[c].products[p].magnitude;
+			while(m != 0)
+			{
+				if(m & 1)
+				{
+					++csd_digits;
+					m -= ((m & 3) == 3) ? -1 : +1;
+				}
+				m >>= 1;
+			}
+		}
+	}
+
+	sstrm << "coefficient fractional bits: " << coef_frac_bits << "\n";
+	sstrm << "input fractional bits: " << input_frac_bits << "\n";
+	sstrm << "constant multipliers replaced: " << multipliers << "\n";
+	sstrm << "distinct column products: " << products << " (" << csd_digits << " CSD digits)\n";
+	sstrm << "shared subterms: " << subterms << "\n";
+	sstrm << "adders/subtractors: " << adders << "\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+const char* CSDSolverGenerator::generateSystemSolver(std::string& buffer, const char* solver_name, const char* b_func_name) const
+{
+	std::stringstream sstrm;
+
+	sstrm << std::setprecision(17);
+
+	const double in_scale = std::ldexp(1.0, input_frac_bits);
+	const double out_scale = std::ldexp(1.0, -int(input_frac_bits));
+
+	std::vector<bool> used(dimension, false);
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(unsigned int i = 0; i < rows[r].size(); i++) used[rows[r][i].column] = true;
+	}
+
+	//// conversions between NumType and the raw integers
+
+		//a fixed-point NumType cannot hold 2^input_frac_bits or the unshifted sums, so its bits are
+		//moved to and from the raw integers with shifts; floating-point types are scaled in double
+
+	sstrm <<
+	"#if defined LMC_USE_FIXED_POINT_TYPES\n\n"
+	"static CSDRawType " << solver_name << "ToRaw(LBLMC::NumType value)\n"
+	"{\n\t"
+		"ap_int<NUM_FIXED_POINT_SIZE> bits;\n\t"
+		"bits.range(NUM_FIXED_POINT_SIZE-1, 0) = value.range(NUM_FIXED_POINT_SIZE-1, 0);\n"
+	"#if NUM_FIXED_POINT_FRAC <= " << input_frac_bits << "\n\t"
+		"return CSDRawType(bits)*CSDRawType(1LL << (" << input_frac_bits << " - NUM_FIXED_POINT_FRAC));\n"
+	"#else\n\t"
+		"return CSDRawType(bits >> (NUM_FIXED_POINT_FRAC - " << input_frac_bits << "));\n"
+	"#endif\n"
+	"}\n\n"
+	"static LBLMC::NumType " << solver_name << "FromRaw(CSDRawType sum)\n"
+	"{\n"
+	"#if NUM_FIXED_POINT_FRAC >= " << input_frac_bits << "\n\t"
+		"ap_int<NUM_FIXED_POINT_SIZE> bits = (sum >> " << coef_frac_bits << ")*CSDRawType(1LL << (NUM_FIXED_POINT_FRAC - " << input_frac_bits << "));\n"
+	"#else\n\t"
+		"ap_int<NUM_FIXED_POINT_SIZE> bits = sum >> (" << (coef_frac_bits + input_frac_bits) << " - NUM_FIXED_POINT_FRAC);\n"
+	"#endif\n\t"
+		"LBLMC::NumType value;\n\t"
+		"value.range(NUM_FIXED_POINT_SIZE-1, 0) = bits.range(NUM_FIXED_POINT_SIZE-1, 0);\n\t"
+		"return value;\n"
+	"}\n\n"
+	"#else\n\n"
+	"static CSDRawType " << solver_name << "ToRaw(LBLMC::NumType value)\n"
+	"{\n\t"
+		"return CSDRawType(double(value)*" << in_scale << ");\n"
+	"}\n\n"
+	"static LBLMC::NumType " << solver_name << "FromRaw(CSDRawType sum)\n"
+	"{\n\t"
+		"return LBLMC::NumType(double(sum >> " << coef_frac_bits << ")*" << out_scale << ");\n"
+	"}\n\n"
+	"#endif\n\n";
+
+	//// shift-add solver
+
+	sstrm <<
+	"void " << solver_name << "(LBLMC::NumType x["<<dimension<<"], LBLMC::NumType b_components["<<num_components<<"])\n"
+	"{\n\t"
+		"LBLMC::NumType b[" << dimension << "];\n\n\t";
+
+	sstrm << b_func_name <<
+	"(b, b_components);\n\n\t";
+
+	for(unsigned int c = 0; c < dimension; c++)
+	{
+		if(!used[c]) continue;
+		sstrm << "CSDRawType r" << c << " = " << solver_name << "ToRaw(b[" << c << "]);\n\t";
+	}
+	sstrm << "\n\t";
+
+		//operands can be negative, so shifts are emitted as products with a power of two rather than
+		//a left shift of a signed value, which is undefined; HLS maps the constant product to wiring
+
+	for(unsigned int c = 0; c < dimension; c++)
+	{
+		const CSDColumn& col = columns[c];
+
+		for(unsigned int s = 0; s < col.subterms.size(); s++)
+		{
+			sstrm << "CSDRawType s" << c << "_" << s << " = r" << c
+				  << ((col.subterms[s].sign > 0) ? " + " : " - ") << "r" << c << "*CSDRawType(1LL << " << col.subterms[s].shift << ");\n\t";
+		}
+
+		for(unsigned int p = 0; p < col.products.size(); p++)
+		{
+			sstrm << "CSDRawType p" << c << "_" << p << " =";
+
+			const std::vector<CSDTerm>& terms = col.products[p].terms;
+			for(unsigned int i = 0; i < terms.size(); i++)
+			{
+				sstrm << ((terms[i].sign > 0) ? ((i == 0) ? " " : " + ") : ((i == 0) ? " -" : " - "));
+
+				std::stringstream operand;
+				if(terms[i].operand < 0) operand << "r" << c;
+				else operand << "s" << c << "_" << terms[i].operand;
+
+				if(terms[i].shift == 0) sstrm << operand.str();
+				else sstrm << operand.str() << "*CSDRawType(1LL << " << terms[i].shift << ")";
+			}
+
+			sstrm << ";\t// " << col.products[p].magnitude << "\n\t";
+		}
+	}
+	sstrm << "\n\t";
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		sstrm << "x[" << r << "] = ";
+
+		if(rows[r].empty())
+		{
+			sstrm << "LBLMC::NumType(0.0);\n\t";
+			continue;
+		}
+
+		sstrm << solver_name << "FromRaw(";
+		for(unsigned int i = 0; i < rows[r].size(); i++)
+		{
+			const CSDRowTerm& t = rows[r][i];
+			sstrm << ((t.sign > 0) ? ((i == 0) ? "" : " + ") : ((i == 0) ? "-" : " - "))
+				  << "p" << t.column << "_" << t.product;
+		}
+		sstrm << ");\n\t";
+	}
+
+	sstrm << "\n}\n\n";
+
+	//// multiplier reference and check, excluded from synthesis
+
+	sstrm << "#ifndef __SYNTHESIS__\n\n";
+
+	sstrm <<
+	"void " << solver_name << "Reference(LBLMC::NumType x["<<dimension<<"], LBLMC::NumType b_components["<<num_components<<"])\n"
+	"{\n\t"
+		"LBLMC::NumType b[" << dimension << "];\n\n\t";
+
+	sstrm << b_func_name <<
+	"(b, b_components);\n\n\t";
+
+	for(unsigned int c = 0; c < dimension; c++)
+	{
+		if(!used[c]) continue;
+		sstrm << "CSDRawType r" << c << " = " << solver_name << "ToRaw(b[" << c << "]);\n\t";
+	}
+	sstrm << "\n\t";
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		sstrm << "x[" << r << "] = ";
+
+		if(rows[r].empty())
+		{
+			sstrm << "LBLMC::NumType(0.0);\n\t";
+			continue;
+		}
+
+		sstrm << solver_name << "FromRaw(";
+		for(unsigned int i = 0; i < rows[r].size(); i++)
+		{
+			unsigned int c = rows[r][i].column;
+			sstrm << ((i == 0) ? "" : " + ") << "CSDRawType(" << quantized[dimension*r+c] << "LL)*r" << c;
+		}
+		sstrm << ");\n\t";
+	}
+
+	sstrm << "\n}\n\n";
+
+	sstrm <<
+	"int " << solver_name << "Check(LBLMC::NumType b_components["<<num_components<<"])\n"
+	"{\n\t"
+		"LBLMC::NumType x_csd[" << dimension << "];\n\t"
+		"LBLMC::NumType x_ref[" << dimension << "];\n\t"
+		"int mismatches = 0;\n\n\t" <<
+		solver_name << "(x_csd, b_components);\n\t" <<
+		solver_name << "Reference(x_ref, b_components);\n\n\t"
+		"for(int i = 0; i < " << dimension << "; i++)\n\t"
+		"{\n\t\t"
+			"if(x_csd[i] != x_ref[i]) ++mismatches;\n\t"
+		"}\n\n\t"
+		"return mismatches;\n"
+	"}\n\n";
+
+	sstrm << "#endif // __SYNTHESIS__\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+int CSDSolverGenerator::generateSystemSolverAndExportC(const char* dir, const char* filename, const char* solver_name,
+		const char* b_func_name, unsigned int raw_type_bits) const
+{
+	std::fstream header;
+	std::fstream source;
+
+	std::string hname = dir; hname +=filename; hname += ".hpp";
+	std::string sname = dir; sname +=filename; sname += ".cpp";
+
+	try
+	{
+		header.open((hname).c_str(), std::fstream::out | std::fstream::trunc);
+		source.open((sname).c_str(), std::fstream::out | std::fstream::trunc);
+	}
+	catch(...)
+	{
+		header.close();
+		source.close();
+		return -1;
+	}
+
+	if(header.fail() || source.fail())
+	{
+		header.close();
+		source.close();
+		return -1;
+	}
+
+	header <<
+			"/**\n"
+			" *\n"
+			" * LBLMC Vivado HLS Simulation Engine for FPGA Designs\n"
+			" *\n"
+			" * Auto-generated by CSDSolverGenerator Object\n"
+			" *\n"
+			" */\n\n";
+
+	header << "#ifndef " << solver_name << "_HPP\n";
+	header << "#define " << solver_name << "_HPP\n\n";
+	header << "\n#include \"LBLMC/DataTypes.hpp\"\n";
+	header << "#include \""<< b_func_name << ".hpp\"\n\n";
+	header << "#ifndef LBLMC_CSD_RAW_TYPE\n";
+	header << "#define LBLMC_CSD_RAW_TYPE\n";
+	header << "#ifdef LBLMC_XILINX_VIVADO_HLS\n";
+	header << "typedef ap_int<" << raw_type_bits << "> CSDRawType;\n";
+	header << "#else\n";
+	header << "typedef long long CSDRawType;\n";
+	header << "#endif\n";
+	header << "#endif\n\n";
+	header << "void " << solver_name << "(LBLMC::NumType x["<<dimension<<"], LBLMC::NumType b_components["<<num_components<<"]);\n\n";
+	header << "#ifndef __SYNTHESIS__\n";
+	header << "void " << solver_name << "Reference(LBLMC::NumType x["<<dimension<<"], LBLMC::NumType b_components["<<num_components<<"]);\n";
+	header << "int " << solver_name << "Check(LBLMC::NumType b_components["<<num_components<<"]);\n";
+	header << "#endif\n\n";
+	header << "#endif";
+	header.close();
+
+	source << "#include \"" << filename << ".hpp" << "\"\n\n";
+
+	std::string buf;
+	source << generateSystemSolver(buf,solver_name,b_func_name);
+	source.close();
+
+	return 0;
+}
+
+int CSDSolverGenerator::verifyBitExact(unsigned int num_trials, double b_magnitude, std::string* report) const
+{
+	const double in_scale = std::ldexp(1.0, input_frac_bits);
+
+#if defined LMC_USE_FIXED_POINT_TYPES
+		//inputs and solutions must be within the range of the fixed-point NumType, which wraps
+	const double max_value = std::ldexp(1.0, NUM_FIXED_POINT_INT-1);
+	if( b_magnitude >= max_value ) return -1;
+#endif
+
+		//guard against overflow of the 64-bit raw type, including subterm intermediates
+	const double max_raw = b_magnitude*in_scale;
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		double bound = 0.0;
+		for(unsigned int c = 0; c < dimension; c++)
+		{
+			bound += std::fabs(double(quantized[dimension*r+c]));
+		}
+		if( 2.0*bound*max_raw >= std::ldexp(1.0, 62) ) return -1;
+#if defined LMC_USE_FIXED_POINT_TYPES
+		if( bound*std::ldexp(b_magnitude, -int(coef_frac_bits)) >= max_value ) return -1;
+#endif
+	}
+
+	std::vector<long long> raw(dimension, 0);
+	std::vector<double> b(dimension, 0.0);
+
+	int mismatches = 0;
+	double max_error = 0.0;
+
+	std::srand(1);
+
+	for(unsigned int t = 0; t < num_trials; t++)
+	{
+		for(unsigned int c = 0; c < dimension; c++)
+		{
+			double v = b_magnitude*(2.0*double(std::rand())/double(RAND_MAX) - 1.0);
+			raw[c] = toRaw(v, b[c]);
+		}
+
+		for(unsigned int r = 0; r < dimension; r++)
+		{
+			long long acc_csd = 0;
+			long long acc_mul = 0;
+
+			for(unsigned int i = 0; i < rows[r].size(); i++)
+			{
+				const CSDRowTerm& term = rows[r][i];
+				acc_csd += term.sign*evaluateProduct(term.column, term.product, raw[term.column]);
+				acc_mul += quantized[dimension*r+term.column]*raw[term.column];
+			}
+
+			if(acc_csd != acc_mul) ++mismatches;
+
+			double x_fixed = fromRaw(acc_mul);
+
+			double x_exact = 0.0;
+			for(unsigned int c = 0; c < dimension; c++)
+			{
+				x_exact += double(A[dimension*r+c])*b[c];
+			}
+
+			double err = std::fabs(x_fixed - x_exact);
+			if(err > max_error) max_error = err;
+		}
+	}
+
+	if(report != 0)
+	{
+		std::stringstream sstrm;
+		sstrm << "trials: " << num_trials << "\n";
+		sstrm << "NumType conversions: " << LMC_NUM_TYPE_STRING << "\n";
+		sstrm << "mismatches between shift-add and multiplier solvers: " << mismatches << "\n";
+		sstrm << std::scientific << std::setprecision(6);
+		sstrm << "max quantization error versus A: " << max_error << "\n";
+		*report = sstrm.str();
+	}
+
+	return mismatches;
+}
+
+} // namespace LBLMC
@@ -0,0 +1,221 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CSDSOLVERGENERATOR_HPP
+#define CSDSOLVERGENERATOR_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief generates multiplierless (shift-add) system solvers for fixed-point LB-LMC engines
+ *
+ * This generator is an alternative backend to SystemSolverGenerator.  Since every coefficient of
+ * the inverted conductance matrix A is a constant, the products A[r][c]*b[c] of x = A*b can be
+ * realized without multipliers:
+ *
+ * 	1. each coefficient is quantized to an integer q = round(A[r][c] * 2^coef_frac_bits)
+ * 	2. each quantized coefficient is recoded in canonical signed digit (CSD) form, which has the
+ * 	   fewest non-zero digits of any signed binary form
+ * 	3. digit pairs that recur across the coefficients of a column are extracted as shared
+ * 	   subterms t = b[c] +/- (b[c] << d), and equal coefficients of a column share one product
+ * 	4. each row of x is then a sum of shifted subterms and products
+ *
+ * Inputs b are converted to integers raw = b * 2^input_frac_bits, and outputs are computed as
+ * x = (sum >> coef_frac_bits) * 2^-input_frac_bits.  With a fixed-point NumType, which can hold
+ * neither 2^input_frac_bits nor the unshifted sums, the conversions move the bits of NumType with
+ * shifts; they are exact when input_frac_bits = NUM_FIXED_POINT_FRAC.  With a floating-point
+ * NumType they are scaled in double.  Either way the generated shift-add solver is bit-exact with
+ * the multiplier form of the same quantized coefficients.  The generated source includes that
+ * multiplier form and a check function (excluded from synthesis) to compare them, and
+ * verifyBitExact() performs the same comparison offline, modelling the conversions of NumType.
+ *
+ * The accumulation is done in a raw integer type (CSDRawType) which is long long for software
+ * and ap_int<raw_type_bits> for HLS; the fractional bits must be chosen such that sums do not
+ * overflow this type.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class CSDSolverGenerator
+{
+private:
+
+	/**
+	 * a signed, shifted operand of a shift-add expression
+	 */
+	struct CSDTerm
+	{
+		int operand; ///< -1 for the column input b[c]; otherwise index of the shared subterm of the column
+		unsigned int shift; ///< left shift applied to the operand
+		int sign; ///< +1 or -1
+	};
+
+	/**
+	 * shared subterm t = b[c] + sign*(b[c] << shift) of a column
+	 */
+	struct CSDSubterm
+	{
+		unsigned int shift;
+		int sign;
+	};
+
+	/**
+	 * shift-add product of a column input with a coefficient magnitude
+	 */
+	struct CSDProduct
+	{
+		long long magnitude; ///< quantized coefficient magnitude
+		std::vector<CSDTerm> terms; ///< terms that sum to magnitude*b[c]
+	};
+
+	/**
+	 * shared subterms and products of one column of A
+	 */
+	struct CSDColumn
+	{
+		std::vector<CSDSubterm> subterms;
+		std::vector<CSDProduct> products;
+	};
+
+	/**
+	 * reference from a row of x to a signed product of a column
+	 */
+	struct CSDRowTerm
+	{
+		unsigned int column;
+		unsigned int product;
+		int sign;
+	};
+
+	const NumType* A; ///< the inverted conductance matrix ( A = G^-1 of Gx=b )
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	unsigned int num_components; ///< number of components in system to contribute to vector b of Gx=b
+	unsigned int coef_frac_bits; ///< number of fractional bits of the quantized coefficients
+	unsigned int input_frac_bits; ///< number of fractional bits of the raw integer inputs
+	NumType zero_bound; ///< range from zero when determining whether Aij is close to zero to be ignored
+
+	std::vector<long long> quantized; ///< quantized coefficients of A, row-major
+	std::vector<CSDColumn> columns; ///< shift-add plan per column of A
+	std::vector<std::vector<CSDRowTerm> > rows; ///< shift-add plan per row of x
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param A the inverted conductance matrix ( A = G^-1 of Gx=b )
+	 * @param dimension number of solutions in the system Gx=b
+	 * @param num_components number of components in system to contribute to vector b of Gx=b
+	 * @param coef_frac_bits number of fractional bits of quantized coefficients; defaults to 20
+	 * @param input_frac_bits number of fractional bits of the raw integer inputs; defaults to 20
+	 * @param zero_bound range from zero when determining whether Aij is close to zero to be ignored; defaults to 1e-12.
+	 */
+	CSDSolverGenerator(const NumType* A, unsigned int dimension, unsigned int num_components,
+			unsigned int coef_frac_bits = 20, unsigned int input_frac_bits = 20, NumType zero_bound = 1.0e-12);
+	CSDSolverGenerator(const CSDSolverGenerator& base);
+
+	void reset(const NumType* A, unsigned int dimension, unsigned int num_components,
+			unsigned int coef_frac_bits = 20, unsigned int input_frac_bits = 20, NumType zero_bound = 1.0e-12);
+	void reset(const CSDSolverGenerator& base);
+
+	/**
+	 * @param r row of A
+	 * @param c column of A
+	 * @return quantized coefficient of A[r][c]; zero if ignored
+	 */
+	long long getQuantizedCoefficient(unsigned int r, unsigned int c) const;
+
+	/**
+	 * counts the operations of the generated shift-add solver
+	 * @param adders stores number of adders/subtractors of the shift-add solver
+	 * @param subterms stores number of shared subterms extracted across rows
+	 * @param multipliers stores number of constant multipliers the shift-add solver replaces
+	 */
+	void getOperationCounts(unsigned int& adders, unsigned int& subterms, unsigned int& multipliers) const;
+
+	/**
+	 * creates a report, as a string, of the quantization and operation counts of the shift-add solver
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer) const;
+
+	/**
+	 * generates the C/C++ source of the shift-add system solver and its multiplier reference
+	 * @param buffer string that will store the source code
+	 * @param solver_name name of the generated solver function
+	 * @param b_func_name name of the function that aggregates the source vector b
+	 * @return buffer string as a const char* string
+	 */
+	const char* generateSystemSolver(std::string& buffer, const char* solver_name = "solveSystem",
+			const char* b_func_name = "aggregateSources") const;
+
+	/**
+	 * generates the shift-add system solver and exports it as C/C++ header and source files
+	 * @param dir existing directory to store source files in, written as "/dir/loc/"; input "" for local directory
+	 * @param filename filename of the source code files, without extension
+	 * @param solver_name name of the generated solver function
+	 * @param b_func_name name of the function that aggregates the source vector b
+	 * @param raw_type_bits width of the ap_int raw integer type used under HLS; defaults to 64
+	 * @return 0 if successful, -1 if fails
+	 */
+	int generateSystemSolverAndExportC(const char* dir, const char* filename, const char* solver_name = "solveSystem",
+			const char* b_func_name = "aggregateSources", unsigned int raw_type_bits = 64) const;
+
+	/**
+	 * verifies offline that the shift-add solver is bit-exact with the multiplier form of the
+	 * quantized coefficients, using random source vectors
+	 *
+	 * @param num_trials number of random source vectors to test
+	 * @param b_magnitude maximum magnitude of the random source vector elements
+	 * @param report optional string to store a report of the check and quantization error versus A
+	 * @return number of mismatching solution elements (0 if bit-exact), -1 if the raw type or a
+	 * fixed-point NumType may overflow
+	 */
+	int verifyBitExact(unsigned int num_trials, double b_magnitude, std::string* report = 0) const;
+
+private:
+
+	void buildPlan();
+
+	long long evaluateProduct(unsigned int c, unsigned int p, long long raw) const;
+
+	/**
+	 * models the conversion of the generated code from NumType to a raw integer input
+	 * @param value input value
+	 * @param represented stores the input value as represented by NumType
+	 * @return raw integer input
+	 */
+	long long toRaw(double value, double& represented) const;
+
+	/**
+	 * models the conversion of the generated code from a raw integer sum to NumType
+	 * @return solution value as represented by NumType
+	 */
+	double fromRaw(long long sum) const;
+};
+
+} //namespace LBLMC
+
+#endif //CSDSOLVERGENERATOR_HPP
@@ -26,5 +26,27 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #include "LBLMC/codegen/SystemConductance.hpp"
 #include "LBLMC/codegen/SystemSourceVector.hpp"
 #include "LBLMC/codegen/SystemSolverGenerator.hpp"
+#include "LBLMC/codegen/SignalRangeTracker.hpp"
+#include "LBLMC/codegen/CSDSolverGenerator.hpp"
+#include "LBLMC/codegen/SolverResourceEstimator.hpp"
+#include "LBLMC/codegen/SystemNetlist.hpp"
+#include "LBLMC/codegen/SystemStepGenerator.hpp"
+#include "LBLMC/codegen/SystemSolver.hpp"
+#include "LBLMC/codegen/IncrementalSystemSolver.hpp"
+#include "LBLMC/codegen/SparseSystemConductance.hpp"
+#include "LBLMC/codegen/WoodburyInverseUpdater.hpp"
+#include "LBLMC/codegen/BackgroundSystemRebuilder.hpp"
+#include "LBLMC/codegen/MatrixFile.hpp"
+#include "LBLMC/codegen/ModelBuildCache.hpp"
+#include "LBLMC/codegen/SystemDecomposer.hpp"
+#include "LBLMC/codegen/LatencyPlacementOptimizer.hpp"
+#include "LBLMC/codegen/NodeReordering.hpp"
+#include "LBLMC/codegen/HierarchicalInverse.hpp"
+#include "LBLMC/codegen/ConjugateGradientSolver.hpp"
+#include "LBLMC/codegen/SparseDirectSolver.hpp"
+#include "LBLMC/codegen/ReducedPrecisionSolver.hpp"
+#include "LBLMC/codegen/SymmetricPackedMatrix.hpp"
+#include "LBLMC/codegen/SwitchedSystemSolverBank.hpp"
+#include "LBLMC/codegen/TimestepBank.hpp"
 
 #endif // LBLMCCODEGEN_HPP
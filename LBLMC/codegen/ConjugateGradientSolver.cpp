@@ -0,0 +1,619 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "ConjugateGradientSolver.hpp"
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cmath>
+#include <Eigen/Dense>
+
+namespace LBLMC
+{
+
+ConjugateGradientSolver::ConjugateGradientSolver
+(
+	SparseSystemConductance& conductance,
+	Preconditioner preconditioner,
+	double tolerance,
+	unsigned int max_iterations,
+	unsigned int block_size
+) :
+	dimension(0), G(), preconditioner(preconditioner), block_size(block_size),
+	ic_row_start(), ic_cols(), ic_values(), ic_shift(0.0), bj_inverse(),
+	tolerance(tolerance), max_iterations(max_iterations), adaptive(false), iteration_cap(max_iterations),
+	average_iterations(0.0), x(), bv(), r(), z(), p(), q(),
+	last_iterations(0), last_residual(0.0), num_steps(0), num_iterations(0), most_iterations(0),
+	largest_residual(0.0), num_unconverged(0), record_history(false), iteration_history(), residual_history()
+{
+	reset(conductance, preconditioner, tolerance, max_iterations, block_size);
+}
+
+ConjugateGradientSolver::ConjugateGradientSolver(const ConjugateGradientSolver& base) :
+	dimension(base.dimension), G(base.G), preconditioner(base.preconditioner), block_size(base.block_size),
+	ic_row_start(base.ic_row_start), ic_cols(base.ic_cols), ic_values(base.ic_values), ic_shift(base.ic_shift),
+	bj_inverse(base.bj_inverse), tolerance(base.tolerance), max_iterations(base.max_iterations),
+	adaptive(base.adaptive), iteration_cap(base.iteration_cap), average_iterations(base.average_iterations),
+	x(base.x), bv(base.bv), r(base.r), z(base.z), p(base.p), q(base.q),
+	last_iterations(base.last_iterations), last_residual(base.last_residual), num_steps(base.num_steps),
+	num_iterations(base.num_iterations), most_iterations(base.most_iterations),
+	largest_residual(base.largest_residual), num_unconverged(base.num_unconverged),
+	record_history(base.record_history), iteration_history(base.iteration_history),
+	residual_history(base.residual_history)
+{
+	//do nothing else
+}
+
+void ConjugateGradientSolver::reset
+(
+	SparseSystemConductance& conductance,
+	Preconditioner preconditioner,
+	double tolerance,
+	unsigned int max_iterations,
+	unsigned int block_size
+)
+{
+	dimension = conductance.getDimension();
+	G = conductance.asEigen3SparseMatrix();
+	G.makeCompressed();
+
+	double largest = 0.0;
+	for(unsigned int i = 0; i < dimension; i++)
+	{
+		bool has_diagonal = false;
+		for(SparseMatrixRMXd::InnerIterator it(G, i); it; ++it)
+		{
+			largest = std::max(largest, std::fabs(it.value()));
+			if((unsigned int)it.col() == i) has_diagonal = (it.value() > 0.0);
+		}
+
+		if(!has_diagonal)
+		{
+			throw std::runtime_error("ConjugateGradientSolver: conductance matrix is not positive definite");
+		}
+	}
+
+	if(!conductance.isSymmetric(1e-14*largest))
+	{
+		throw std::runtime_error("ConjugateGradientSolver: conductance matrix is not symmetric");
+	}
+
+	this->preconditioner = preconditioner;
+	this->block_size = (block_size == 0) ? 1 : block_size;
+
+	ic_row_start.clear();
+	ic_cols.clear();
+	ic_values.clear();
+	ic_shift = 0.0;
+	bj_inverse.clear();
+
+	if(preconditioner == INCOMPLETE_CHOLESKY) factorIncompleteCholesky();
+	else factorBlockJacobi();
+
+	this->tolerance = tolerance;
+	this->max_iterations = (max_iterations == 0) ? 1 : max_iterations;
+	adaptive = false;
+	iteration_cap = this->max_iterations;
+
+	x = Eigen::VectorXd::Zero(dimension);
+	bv = Eigen::VectorXd::Zero(dimension);
+	r = Eigen::VectorXd::Zero(dimension);
+	z = Eigen::VectorXd::Zero(dimension);
+	p = Eigen::VectorXd::Zero(dimension);
+	q = Eigen::VectorXd::Zero(dimension);
+
+	record_history = false;
+	clearStatistics();
+}
+
+void ConjugateGradientSolver::reset(const ConjugateGradientSolver& base)
+{
+	dimension = base.dimension;
+	G = base.G;
+	preconditioner = base.preconditioner;
+	block_size = base.block_size;
+	ic_row_start = base.ic_row_start;
+	ic_cols = base.ic_cols;
+	ic_values = base.ic_values;
+	ic_shift = base.ic_shift;
+	bj_inverse = base.bj_inverse;
+	tolerance = base.tolerance;
+	max_iterations = base.max_iterations;
+	adaptive = base.adaptive;
+	iteration_cap = base.iteration_cap;
+	average_iterations = base.average_iterations;
+	x = base.x;
+	bv = base.bv;
+	r = base.r;
+	z = base.z;
+	p = base.p;
+	q = base.q;
+	last_iterations = base.last_iterations;
+	last_residual = base.last_residual;
+	num_steps = base.num_steps;
+	num_iterations = base.num_iterations;
+	most_iterations = base.most_iterations;
+	largest_residual = base.largest_residual;
+	num_unconverged = base.num_unconverged;
+	record_history = base.record_history;
+	iteration_history = base.iteration_history;
+	residual_history = base.residual_history;
+}
+
+void ConjugateGradientSolver::setTolerance(double tolerance)
+{
+	this->tolerance = tolerance;
+}
+
+void ConjugateGradientSolver::setIterationCap(unsigned int max_iterations, bool adaptive)
+{
+	this->max_iterations = (max_iterations == 0) ? 1 : max_iterations;
+	this->adaptive = adaptive;
+	iteration_cap = this->max_iterations;
+}
+
+void ConjugateGradientSolver::setInitialSolution(const NumType* x0)
+{
+	for(unsigned int i = 0; i < dimension; i++)
+	{
+		x(i) = double(x0[i]);
+	}
+}
+
+void ConjugateGradientSolver::clearSolution()
+{
+	x.setZero();
+}
+
+bool ConjugateGradientSolver::solve(const NumType* b, NumType* x_out)
+{
+	for(unsigned int i = 0; i < dimension; i++)
+	{
+		bv(i) = double(b[i]);
+	}
+
+	const double b_norm = bv.norm();
+
+	unsigned int iterations = 0;
+	double r_norm = 0.0;
+
+	if(b_norm == 0.0)
+	{
+		x.setZero();
+	}
+	else
+	{
+		const double target = tolerance*b_norm;
+
+			//warm start from the solution of the last step
+
+		r = bv;
+		r.noalias() -= G*x;
+		r_norm = r.norm();
+
+		if(r_norm > target)
+		{
+			precondition();
+			p = z;
+			double rz = r.dot(z);
+
+			while(iterations < iteration_cap)
+			{
+				q.noalias() = G*p;
+
+				const double pq = p.dot(q);
+				if(!(pq > 0.0)) break; //breakdown; G not positive definite in direction p
+
+				const double alpha = rz/pq;
+				x.noalias() += alpha*p;
+				r.noalias() -= alpha*q;
+				iterations++;
+
+				r_norm = r.norm();
+				if(r_norm <= target) break;
+
+				precondition();
+				const double rz_next = r.dot(z);
+				p = z + (rz_next/rz)*p;
+				rz = rz_next;
+			}
+		}
+
+		r_norm /= b_norm;
+	}
+
+	for(unsigned int i = 0; i < dimension; i++)
+	{
+		x_out[i] = NumType(x(i));
+	}
+
+	const bool converged = (r_norm <= tolerance);
+
+		//statistics
+
+	last_iterations = iterations;
+	last_residual = r_norm;
+	num_iterations += iterations;
+	most_iterations = std::max(most_iterations, iterations);
+	largest_residual = std::max(largest_residual, r_norm);
+	if(!converged) num_unconverged++;
+
+	if(record_history)
+	{
+		iteration_history.push_back(iterations);
+		residual_history.push_back(r_norm);
+	}
+
+		//adaptive cap: twice the moving average of recent steps, doubled after a step that did not converge
+
+	if(num_steps == 0) average_iterations = iterations;
+	else average_iterations += (double(iterations) - average_iterations)/16.0;
+	num_steps++;
+
+	if(adaptive)
+	{
+		if(!converged) iteration_cap = 2*iteration_cap;
+		else iteration_cap = (unsigned int)(std::ceil(2.0*average_iterations)) + 1;
+
+		if(iteration_cap > max_iterations) iteration_cap = max_iterations;
+	}
+
+	return converged;
+}
+
+bool ConjugateGradientSolver::solve(const SystemSourceVector& sources, const NumType* b_components, NumType* x_out)
+{
+	std::vector<NumType> b(dimension, NumType(0.0));
+
+	const std::map<long, std::vector<long> >& nodes = sources.asMap();
+	for(std::map<long, std::vector<long> >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
+	{
+		if(it->second[0] != 0) b[it->second[0]-1] += b_components[it->first-1];
+		if(it->second[1] != 0) b[it->second[1]-1] -= b_components[it->first-1];
+	}
+
+	return solve(&b[0], x_out);
+}
+
+unsigned int ConjugateGradientSolver::getDimension() const
+{
+	return dimension;
+}
+
+ConjugateGradientSolver::Preconditioner ConjugateGradientSolver::getPreconditioner() const
+{
+	return preconditioner;
+}
+
+double ConjugateGradientSolver::getTolerance() const
+{
+	return tolerance;
+}
+
+unsigned int ConjugateGradientSolver::getIterationCap() const
+{
+	return iteration_cap;
+}
+
+double ConjugateGradientSolver::getPreconditionerShift() const
+{
+	return ic_shift;
+}
+
+unsigned int ConjugateGradientSolver::getLastIterations() const
+{
+	return last_iterations;
+}
+
+double ConjugateGradientSolver::getLastResidual() const
+{
+	return last_residual;
+}
+
+unsigned long ConjugateGradientSolver::getNumSteps() const
+{
+	return num_steps;
+}
+
+unsigned long ConjugateGradientSolver::getNumIterations() const
+{
+	return num_iterations;
+}
+
+unsigned int ConjugateGradientSolver::getMostIterations() const
+{
+	return most_iterations;
+}
+
+double ConjugateGradientSolver::getLargestResidual() const
+{
+	return largest_residual;
+}
+
+unsigned long ConjugateGradientSolver::getNumUnconverged() const
+{
+	return num_unconverged;
+}
+
+void ConjugateGradientSolver::setRecordHistory(bool record)
+{
+	record_history = record;
+}
+
+const std::vector<unsigned int>& ConjugateGradientSolver::getIterationHistory() const
+{
+	return iteration_history;
+}
+
+const std::vector<double>& ConjugateGradientSolver::getResidualHistory() const
+{
+	return residual_history;
+}
+
+int ConjugateGradientSolver::exportHistory(const char* filename) const
+{
+	std::fstream file;
+
+	try
+	{
+		file.open(filename, std::fstream::out | std::fstream::trunc);
+	}
+	catch(...)
+	{
+		return -1;
+	}
+
+	if(!file.is_open()) return -1;
+
+	file.precision(17);
+
+	file << "step,iterations,residual\n";
+	for(unsigned int s = 0; s < iteration_history.size(); s++)
+	{
+		file << s << "," << iteration_history[s] << "," << residual_history[s] << "\n";
+	}
+
+	if(!file.good())
+	{
+		file.close();
+		return -1;
+	}
+
+	file.close();
+
+	return 0;
+}
+
+void ConjugateGradientSolver::clearStatistics()
+{
+	last_iterations = 0;
+	last_residual = 0.0;
+	num_steps = 0;
+	num_iterations = 0;
+	most_iterations = 0;
+	largest_residual = 0.0;
+	num_unconverged = 0;
+	average_iterations = 0.0;
+	iteration_history.clear();
+	residual_history.clear();
+}
+
+const char* ConjugateGradientSolver::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	sstrm << "Conjugate Gradient Solver Statistics\n\n";
+	sstrm << "dimension:          " << dimension << "\n";
+	sstrm << "non-zeros of G:     " << G.nonZeros() << "\n";
+	if(preconditioner == INCOMPLETE_CHOLESKY)
+	{
+		sstrm << "preconditioner:     incomplete Cholesky\n";
+		sstrm << "diagonal shift:     " << ic_shift << "\n";
+	}
+	else
+	{
+		sstrm << "preconditioner:     block Jacobi\n";
+		sstrm << "block size:         " << block_size << "\n";
+	}
+	sstrm << "tolerance:          " << tolerance << "\n";
+	sstrm << "iteration cap:      " << iteration_cap << " of " << max_iterations << (adaptive ? " (adaptive)" : "") << "\n\n";
+	sstrm << "steps:              " << num_steps << "\n";
+	sstrm << "iterations:         " << num_iterations << "\n";
+	sstrm << "average iterations: " << (num_steps == 0 ? 0.0 : double(num_iterations)/double(num_steps)) << "\n";
+	sstrm << "most iterations:    " << most_iterations << "\n";
+	sstrm << "last residual:      " << last_residual << "\n";
+	sstrm << "largest residual:   " << largest_residual << "\n";
+	sstrm << "unconverged steps:  " << num_unconverged << "\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+void ConjugateGradientSolver::factorIncompleteCholesky()
+{
+		//lower triangle of G in CSR, diagonal last in each row
+
+	ic_row_start.assign(dimension+1, 0);
+	ic_cols.clear();
+	std::vector<double> lower;
+
+	for(unsigned int i = 0; i < dimension; i++)
+	{
+		for(SparseMatrixRMXd::InnerIterator it(G, i); it; ++it)
+		{
+			if((unsigned int)it.col() > i) break;
+			ic_cols.push_back(it.col());
+			lower.push_back(it.value());
+		}
+		ic_row_start[i+1] = ic_cols.size();
+	}
+
+		//IC(0), retried with a growing relative diagonal shift if a pivot breaks down
+
+	ic_shift = 0.0;
+
+	for(unsigned int attempt = 0; attempt < 32; attempt++)
+	{
+		ic_values = lower;
+
+		bool breakdown = false;
+
+		for(unsigned int i = 0; i < dimension && !breakdown; i++)
+		{
+			const unsigned int diag_i = ic_row_start[i+1]-1;
+
+			for(unsigned int pi = ic_row_start[i]; pi < diag_i; pi++)
+			{
+				const unsigned int k = ic_cols[pi];
+				const unsigned int diag_k = ic_row_start[k+1]-1;
+
+					//L(i,k) = (G(i,k) - sum_j<k L(i,j)*L(k,j)) / L(k,k), over the common pattern
+
+				double sum = ic_values[pi];
+				unsigned int a = ic_row_start[i];
+				unsigned int b = ic_row_start[k];
+				while(a < pi && b < diag_k)
+				{
+					if(ic_cols[a] < ic_cols[b]) a++;
+					else if(ic_cols[b] < ic_cols[a]) b++;
+					else sum -= ic_values[a++]*ic_values[b++];
+				}
+
+				ic_values[pi] = sum/ic_values[diag_k];
+			}
+
+			double d = ic_values[diag_i]*(1.0 + ic_shift);
+			for(unsigned int pi = ic_row_start[i]; pi < diag_i; pi++)
+			{
+				d -= ic_values[pi]*ic_values[pi];
+			}
+
+			if(!(d > 0.0)) breakdown = true;
+			else ic_values[diag_i] = std::sqrt(d);
+		}
+
+		if(!breakdown) return;
+
+		ic_shift = (ic_shift == 0.0) ? 1e-3 : 2.0*ic_shift;
+	}
+
+	throw std::runtime_error("ConjugateGradientSolver: incomplete Cholesky factorization failed; conductance matrix is not positive definite");
+}
+
+void ConjugateGradientSolver::factorBlockJacobi()
+{
+	const unsigned int num_blocks = (dimension + block_size - 1)/block_size;
+
+	bj_inverse.assign((unsigned long)num_blocks*block_size*block_size, 0.0);
+
+	for(unsigned int k = 0; k < num_blocks; k++)
+	{
+		const unsigned int row0 = k*block_size;
+		const unsigned int n = std::min(block_size, dimension - row0);
+
+		Eigen::MatrixXd block = Eigen::MatrixXd::Zero(n, n);
+		for(unsigned int i = 0; i < n; i++)
+		{
+			for(SparseMatrixRMXd::InnerIterator it(G, row0+i); it; ++it)
+			{
+				const unsigned int c = it.col();
+				if(c >= row0 && c < row0+n) block(i, c-row0) = it.value();
+			}
+		}
+
+		Eigen::LLT<Eigen::MatrixXd> llt(block);
+		if(llt.info() != Eigen::Success)
+		{
+			std::stringstream sstrm;
+			sstrm << "ConjugateGradientSolver: diagonal block " << k << " of conductance matrix is not positive definite";
+			throw std::runtime_error(sstrm.str());
+		}
+
+		const Eigen::MatrixXd inverse = llt.solve(Eigen::MatrixXd::Identity(n, n));
+
+		double* dst = &bj_inverse[(unsigned long)k*block_size*block_size];
+		for(unsigned int i = 0; i < n; i++)
+		{
+			for(unsigned int j = 0; j < n; j++)
+			{
+				dst[i*n+j] = inverse(i,j);
+			}
+		}
+	}
+}
+
+void ConjugateGradientSolver::precondition()
+{
+	if(preconditioner == INCOMPLETE_CHOLESKY)
+	{
+			//L y = r, forward
+
+		for(unsigned int i = 0; i < dimension; i++)
+		{
+			const unsigned int diag_i = ic_row_start[i+1]-1;
+
+			double sum = r(i);
+			for(unsigned int pi = ic_row_start[i]; pi < diag_i; pi++)
+			{
+				sum -= ic_values[pi]*z(ic_cols[pi]);
+			}
+			z(i) = sum/ic_values[diag_i];
+		}
+
+			//L^T z = y, backward by rows of L
+
+		for(unsigned int i = dimension; i-- > 0;)
+		{
+			const unsigned int diag_i = ic_row_start[i+1]-1;
+
+			z(i) /= ic_values[diag_i];
+
+			const double zi = z(i);
+			for(unsigned int pi = ic_row_start[i]; pi < diag_i; pi++)
+			{
+				z(ic_cols[pi]) -= ic_values[pi]*zi;
+			}
+		}
+	}
+	else
+	{
+		for(unsigned int row0 = 0; row0 < dimension; row0 += block_size)
+		{
+			const unsigned int n = std::min(block_size, dimension - row0);
+			const double* inverse = &bj_inverse[(unsigned long)(row0/block_size)*block_size*block_size];
+
+			for(unsigned int i = 0; i < n; i++)
+			{
+				double sum = 0.0;
+				for(unsigned int j = 0; j < n; j++)
+				{
+					sum += inverse[i*n+j]*r(row0+j);
+				}
+				z(row0+i) = sum;
+			}
+		}
+	}
+}
+
+} //namespace LBLMC
@@ -0,0 +1,242 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef CONJUGATEGRADIENTSOLVER_HPP
+#define CONJUGATEGRADIENTSOLVER_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SparseSystemConductance.hpp"
+#include "SystemSourceVector.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief solves a LB-LMC system model at runtime with preconditioned conjugate gradients on the sparse G
+ *
+ * For networks too large to invert, G x = b is solved each step iteratively, without A = G^-1.  G
+ * of a LB-LMC model is symmetric positive definite when the network has no controlled sources, which
+ * is what conjugate gradients require.  Between steps the solution changes little, so each solve is
+ * started from the solution of the previous step (warm start), and a few iterations reach the
+ * tolerance.
+ *
+ * Two preconditioners are available:
+ *
+ * 	INCOMPLETE_CHOLESKY: zero fill-in incomplete Cholesky factor L L^T ~= G on the pattern of G.
+ * 	If a pivot breaks down, the factorization is retried with a growing diagonal shift.
+ *
+ * 	BLOCK_JACOBI: inverses of the diagonal blocks of G of a given size, in node order; a block size
+ * 	of 1 is the plain Jacobi (diagonal) preconditioner.
+ *
+ * Both depend on the node order; ordering the nodes first with NodeReordering keeps neighbours in
+ * the same Jacobi block and reduces what the incomplete factor drops.
+ *
+ * The iterations of a step are capped, for bounded work per step.  With an adaptive cap, the cap
+ * follows twice the average iterations of recent steps, up to the fixed maximum, and doubles after a
+ * step that does not converge; the residual left is carried to the next step by the warm start.
+ *
+ * The iterations and final relative residual ||b - G x|| / ||b|| of each step are tracked, and can be
+ * recorded per step.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class ConjugateGradientSolver
+{
+public:
+
+	/**
+	 * preconditioner of the conjugate gradient iterations
+	 */
+	enum Preconditioner
+	{
+		BLOCK_JACOBI,
+		INCOMPLETE_CHOLESKY
+	};
+
+private:
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	SparseMatrixRMXd G; ///< conductance matrix
+
+	Preconditioner preconditioner;
+	unsigned int block_size; ///< BLOCK_JACOBI: dimension of the diagonal blocks
+
+	std::vector<unsigned int> ic_row_start; ///< INCOMPLETE_CHOLESKY: CSR row offsets of L, diagonal last in each row
+	std::vector<unsigned int> ic_cols; ///< INCOMPLETE_CHOLESKY: CSR column indices of L
+	std::vector<double> ic_values; ///< INCOMPLETE_CHOLESKY: CSR values of L
+	double ic_shift; ///< INCOMPLETE_CHOLESKY: relative diagonal shift the factor was computed with
+
+	std::vector<double> bj_inverse; ///< BLOCK_JACOBI: row-major inverses of the diagonal blocks, concatenated
+
+	double tolerance; ///< relative residual ||b - G x|| / ||b|| to iterate to
+	unsigned int max_iterations; ///< largest number of iterations per step
+	bool adaptive; ///< true if the iteration cap adapts to the recent iterations
+	unsigned int iteration_cap; ///< iteration cap of the next step
+	double average_iterations; ///< moving average of the iterations of recent steps
+
+	Eigen::VectorXd x; ///< solution of the last step, start of the next
+	Eigen::VectorXd bv, r, z, p, q; ///< iteration vectors
+
+	unsigned int last_iterations; ///< statistics: iterations of the last step
+	double last_residual; ///< statistics: relative residual of the last step
+	unsigned long num_steps; ///< statistics: number of solve() calls
+	unsigned long num_iterations; ///< statistics: total iterations
+	unsigned int most_iterations; ///< statistics: most iterations of a step
+	double largest_residual; ///< statistics: largest relative residual of a step
+	unsigned long num_unconverged; ///< statistics: steps that reached the iteration cap above tolerance
+
+	bool record_history; ///< true to record the iterations and residual of each step
+	std::vector<unsigned int> iteration_history;
+	std::vector<double> residual_history;
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param conductance the (not inverted) conductance matrix G of Gx=b; must be symmetric positive definite
+	 * @param preconditioner preconditioner of the iterations
+	 * @param tolerance relative residual ||b - G x|| / ||b|| to iterate to
+	 * @param max_iterations largest number of iterations per step
+	 * @param block_size dimension of the diagonal blocks of BLOCK_JACOBI; ignored by INCOMPLETE_CHOLESKY
+	 * @throws std::runtime_error if the conductance matrix is not symmetric or not positive definite
+	 */
+	ConjugateGradientSolver
+	(
+		SparseSystemConductance& conductance,
+		Preconditioner preconditioner = INCOMPLETE_CHOLESKY,
+		double tolerance = 1e-9,
+		unsigned int max_iterations = 100,
+		unsigned int block_size = 16
+	);
+
+	ConjugateGradientSolver(const ConjugateGradientSolver& base);
+
+	void reset
+	(
+		SparseSystemConductance& conductance,
+		Preconditioner preconditioner = INCOMPLETE_CHOLESKY,
+		double tolerance = 1e-9,
+		unsigned int max_iterations = 100,
+		unsigned int block_size = 16
+	);
+
+	void reset(const ConjugateGradientSolver& base);
+
+	/**
+	 * @param tolerance relative residual ||b - G x|| / ||b|| to iterate to
+	 */
+	void setTolerance(double tolerance);
+
+	/**
+	 * sets the cap of the iterations per step
+	 * @param max_iterations largest number of iterations per step
+	 * @param adaptive true to adapt the cap to twice the average iterations of recent steps, up to max_iterations
+	 */
+	void setIterationCap(unsigned int max_iterations, bool adaptive = false);
+
+	/**
+	 * sets the solution the next step starts from
+	 * @param x0 start solution, of the system dimension
+	 */
+	void setInitialSolution(const NumType* x0);
+
+	/**
+	 * starts the next step from zero instead of the last solution
+	 */
+	void clearSolution();
+
+	/**
+	 * solves G x = b, starting from the solution of the last step
+	 * @param b right hand side of the system, of the system dimension
+	 * @param x array to store the solution to, of the system dimension
+	 * @return true if the tolerance was reached within the iteration cap
+	 */
+	bool solve(const NumType* b, NumType* x);
+
+	/**
+	 * solves the system for the present source contributions, aggregating b from them first
+	 * @param sources source vector of the system
+	 * @param b_components source contributions of the components; b_components[index-1] for source index
+	 * @param x array to store the solution to, of the system dimension
+	 * @return true if the tolerance was reached within the iteration cap
+	 */
+	bool solve(const SystemSourceVector& sources, const NumType* b_components, NumType* x);
+
+	unsigned int getDimension() const; ///< @return number of solutions in the system
+	Preconditioner getPreconditioner() const; ///< @return preconditioner of the iterations
+	double getTolerance() const; ///< @return relative residual iterated to
+	unsigned int getIterationCap() const; ///< @return iteration cap of the next step
+
+	/**
+	 * @return relative diagonal shift the incomplete Cholesky factor needed to not break down; 0 if none
+	 */
+	double getPreconditionerShift() const;
+
+	unsigned int getLastIterations() const; ///< @return iterations of the last step
+	double getLastResidual() const; ///< @return relative residual of the last step
+	unsigned long getNumSteps() const; ///< @return number of solve() calls
+	unsigned long getNumIterations() const; ///< @return total iterations of all steps
+	unsigned int getMostIterations() const; ///< @return most iterations of a step
+	double getLargestResidual() const; ///< @return largest relative residual of a step
+	unsigned long getNumUnconverged() const; ///< @return number of steps that reached the cap above tolerance
+
+	/**
+	 * @param record true to record the iterations and relative residual of each step
+	 */
+	void setRecordHistory(bool record);
+
+	const std::vector<unsigned int>& getIterationHistory() const; ///< @return recorded iterations per step
+	const std::vector<double>& getResidualHistory() const; ///< @return recorded relative residual per step
+
+	/**
+	 * exports the recorded history as a CSV text file with columns step, iterations, residual
+	 * @param filename filename of the text file
+	 * @return 0 if successful, -1 if fails to open/write to file
+	 */
+	int exportHistory(const char* filename) const;
+
+	/**
+	 * resets the statistics and the recorded history
+	 */
+	void clearStatistics();
+
+	/**
+	 * creates a report, as a string, of the solver settings and iteration statistics
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+private:
+
+	void factorIncompleteCholesky();
+	void factorBlockJacobi();
+
+		/// z = M^-1 r
+	void precondition();
+};
+
+} //namespace LBLMC
+
+#endif //CONJUGATEGRADIENTSOLVER_HPP
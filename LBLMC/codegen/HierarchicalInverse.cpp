@@ -0,0 +1,860 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "HierarchicalInverse.hpp"
+#include "NodeReordering.hpp"
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <map>
+
+namespace LBLMC
+{
+
+/**
+ * samples rows, columns, and blocks of A = G^-1 in the reordered numbering, either from a dense A or
+ * by sparse solves with G
+ */
+struct HierarchicalInverse::EntrySource
+{
+	const std::vector<unsigned int>& old_of_new;
+	const MatrixRMXd* dense; ///< A in the given numbering; 0 to solve with the factorization of G
+	bool symmetric; ///< G is symmetric, so rows of A are its columns
+	Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldlt;
+	Eigen::SparseLU< Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > lu; ///< factorization of G
+	Eigen::SparseLU< Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > lu_t; ///< factorization of G^T
+	unsigned long num_solves; ///< right-hand sides solved with the factorization of G
+	double error_per_entry; ///< error budget of a block is this times the square root of its entries
+	Eigen::VectorXd unit;
+
+		//least recently used cache of solved rows and columns; blocks of a block row or column, and the
+		//blocks of a subdivided block, sample the same rows and columns
+
+	unsigned int cache_capacity; ///< largest number of cached solutions
+	std::map<unsigned int, unsigned int> cached; ///< solution key -> slot
+	std::vector<Eigen::VectorXd> slots; ///< cached solutions in the given numbering
+	std::vector<unsigned int> slot_keys; ///< solution key of each slot
+	std::vector<unsigned long> slot_uses; ///< last use of each slot
+	unsigned long uses;
+
+	std::vector<std::vector<unsigned int> > adjacency; ///< conductance graph, reordered numbering
+	std::vector<unsigned int> level; ///< breadth-first search levels
+	std::vector<unsigned int> visited; ///< nodes with a level set
+	std::map<std::pair<unsigned int, unsigned int>, unsigned int> diameters; ///< diameter of each cluster (start, size)
+	std::vector<unsigned int> dense_blocks; ///< dense blocks whose entries are filled after the block structure is built
+
+	EntrySource(const std::vector<unsigned int>& old_of_new, const MatrixRMXd* dense) :
+		old_of_new(old_of_new), dense(dense), symmetric(true), num_solves(0), error_per_entry(0.0),
+		unit(), cache_capacity(0), cached(), slots(), slot_keys(), slot_uses(), uses(0),
+		adjacency(old_of_new.size()), level(old_of_new.size(), ~0u), visited(), diameters(), dense_blocks()
+	{
+		//do nothing else
+	}
+
+		/// adds the coupling of G(r,c) between nodes of the given numbering to the graph
+	void couple(unsigned int r, unsigned int c, const std::vector<unsigned int>& new_of_old)
+	{
+		if(r == c) return;
+		adjacency[new_of_old[r]].push_back(new_of_old[c]);
+		adjacency[new_of_old[c]].push_back(new_of_old[r]);
+	}
+
+		/**
+		 * breadth-first search from the nodes of cluster [from0, from0+size) up to a depth
+		 * @return smallest level reached in [to0, to0+to_size), or depth+1 if none is within the depth
+		 */
+	unsigned int distance(unsigned int from0, unsigned int size, unsigned int to0, unsigned int to_size, unsigned int depth)
+	{
+		unsigned int found = depth+1;
+
+		for(unsigned int i = 0; i < size; i++)
+		{
+			level[from0+i] = 0;
+			visited.push_back(from0+i);
+		}
+
+		for(unsigned int q = 0; q < visited.size() && found > depth; q++)
+		{
+			const unsigned int n = visited[q];
+			if(n >= to0 && n < to0+to_size) { found = level[n]; break; }
+			if(level[n] >= depth) continue;
+
+			for(unsigned int i = 0; i < adjacency[n].size(); i++)
+			{
+				const unsigned int next = adjacency[n][i];
+				if(level[next] != ~0u) continue;
+				level[next] = level[n]+1;
+				visited.push_back(next);
+			}
+		}
+
+		for(unsigned int i = 0; i < visited.size(); i++) level[visited[i]] = ~0u;
+		visited.clear();
+
+		return found;
+	}
+
+		/**
+		 * @return largest distance in the conductance graph from the first node of cluster
+		 * [row0, row0+rows) to the other nodes of the cluster; clusters of RCM ordering are level sets
+		 * of the graph, so they need not be connected within themselves
+		 */
+	unsigned int diameter(unsigned int row0, unsigned int rows)
+	{
+		std::map<std::pair<unsigned int, unsigned int>, unsigned int>::const_iterator cached =
+				diameters.find(std::make_pair(row0, rows));
+		if(cached != diameters.end()) return cached->second;
+
+		unsigned int largest = 0;
+		unsigned int remaining = rows-1;
+
+		level[row0] = 0;
+		visited.push_back(row0);
+
+		for(unsigned int q = 0; q < visited.size() && remaining > 0; q++)
+		{
+			const unsigned int n = visited[q];
+
+			for(unsigned int i = 0; i < adjacency[n].size(); i++)
+			{
+				const unsigned int next = adjacency[n][i];
+				if(level[next] != ~0u) continue;
+				level[next] = level[n]+1;
+				visited.push_back(next);
+
+				if(next >= row0 && next < row0+rows)
+				{
+					largest = level[next];
+					remaining--;
+				}
+			}
+		}
+
+		if(remaining > 0) largest = ~0u; //cluster spans disconnected parts of the network
+
+		for(unsigned int i = 0; i < visited.size(); i++) level[visited[i]] = ~0u;
+		visited.clear();
+
+		diameters[std::make_pair(row0, rows)] = largest;
+		return largest;
+	}
+
+	void factor(SparseSystemConductance& conductance)
+	{
+		const Eigen::SparseMatrix<double> G = conductance.asEigen3SparseMatrix();
+
+		symmetric = conductance.isSymmetric(1e-14*G.coeffs().cwiseAbs().maxCoeff());
+
+		bool singular;
+		if(symmetric)
+		{
+			ldlt.compute(G);
+			singular = (ldlt.info() != Eigen::Success);
+			if(!singular)
+			{
+				const Eigen::VectorXd d = ldlt.vectorD().cwiseAbs();
+				singular = (d.minCoeff() <= G.rows()*std::numeric_limits<double>::epsilon()*d.maxCoeff());
+			}
+		}
+		else
+		{
+			const Eigen::SparseMatrix<double> Gt = G.transpose();
+			lu.analyzePattern(G);
+			lu.factorize(G);
+			lu_t.analyzePattern(Gt);
+			lu_t.factorize(Gt);
+			singular = (lu.info() != Eigen::Success || lu_t.info() != Eigen::Success);
+		}
+
+		if(singular)
+		{
+			throw std::runtime_error("HierarchicalInverse: cannot factor conductance matrix as it is singular");
+		}
+
+		unit = Eigen::VectorXd::Zero(G.rows());
+	}
+
+		/// @return A[:,n] (or A[n,:] if transposed) in the given numbering
+	const Eigen::VectorXd& solveUnit(unsigned int n, bool transposed)
+	{
+		const unsigned int key = (symmetric || !transposed) ? 2*n : 2*n+1;
+		uses++;
+
+		std::map<unsigned int, unsigned int>::const_iterator found = cached.find(key);
+		if(found != cached.end())
+		{
+			slot_uses[found->second] = uses;
+			return slots[found->second];
+		}
+
+		unsigned int slot = slots.size();
+		if(slots.size() < cache_capacity)
+		{
+			slots.push_back(Eigen::VectorXd());
+			slot_keys.push_back(key);
+			slot_uses.push_back(uses);
+		}
+		else
+		{
+			slot = std::min_element(slot_uses.begin(), slot_uses.end()) - slot_uses.begin();
+			cached.erase(slot_keys[slot]);
+			slot_keys[slot] = key;
+			slot_uses[slot] = uses;
+		}
+		cached[key] = slot;
+
+		unit(n) = 1.0;
+		if(symmetric) slots[slot] = ldlt.solve(unit);
+		else if(transposed) slots[slot] = lu_t.solve(unit);
+		else slots[slot] = lu.solve(unit);
+		unit(n) = 0.0;
+		num_solves++;
+
+		return slots[slot];
+	}
+
+		/// out = A(row0:row0+rows, j), reordered numbering
+	void column(unsigned int j, unsigned int row0, unsigned int rows, Eigen::VectorXd& out)
+	{
+		out.resize(rows);
+		if(dense)
+		{
+			for(unsigned int r = 0; r < rows; r++) out(r) = (*dense)(old_of_new[row0+r], old_of_new[j]);
+			return;
+		}
+
+		const Eigen::VectorXd& solution = solveUnit(old_of_new[j], false);
+		for(unsigned int r = 0; r < rows; r++) out(r) = solution(old_of_new[row0+r]);
+	}
+
+		/// out = A(i, col0:col0+cols)^T, reordered numbering
+	void row(unsigned int i, unsigned int col0, unsigned int cols, Eigen::VectorXd& out)
+	{
+		out.resize(cols);
+		if(dense)
+		{
+			for(unsigned int c = 0; c < cols; c++) out(c) = (*dense)(old_of_new[i], old_of_new[col0+c]);
+			return;
+		}
+
+		const Eigen::VectorXd& solution = solveUnit(old_of_new[i], true);
+		for(unsigned int c = 0; c < cols; c++) out(c) = solution(old_of_new[col0+c]);
+	}
+
+		/// out = A(:, col0:col0+cols), reordered numbering; the columns are solved as one multi-RHS solve
+	void columns(unsigned int col0, unsigned int cols, Eigen::MatrixXd& out)
+	{
+		const unsigned int n = old_of_new.size();
+		out.resize(n, cols);
+
+		if(dense)
+		{
+			for(unsigned int c = 0; c < cols; c++)
+			{
+				for(unsigned int r = 0; r < n; r++) out(r, c) = (*dense)(old_of_new[r], old_of_new[col0+c]);
+			}
+			return;
+		}
+
+		Eigen::MatrixXd units = Eigen::MatrixXd::Zero(n, cols);
+		for(unsigned int c = 0; c < cols; c++) units(old_of_new[col0+c], c) = 1.0;
+
+		Eigen::MatrixXd solutions;
+		if(symmetric) solutions = ldlt.solve(units);
+		else solutions = lu.solve(units);
+
+		for(unsigned int r = 0; r < n; r++) out.row(r) = solutions.row(old_of_new[r]);
+		num_solves += cols;
+	}
+
+		/// out = A(row0:row0+rows, col0:col0+cols)*w, reordered numbering; one solve
+	void product(unsigned int row0, unsigned int rows, unsigned int col0, unsigned int cols,
+			const Eigen::VectorXd& w, Eigen::VectorXd& out)
+	{
+		out.resize(rows);
+		if(dense)
+		{
+			for(unsigned int r = 0; r < rows; r++)
+			{
+				double sum = 0.0;
+				for(unsigned int c = 0; c < cols; c++) sum += (*dense)(old_of_new[row0+r], old_of_new[col0+c])*w(c);
+				out(r) = sum;
+			}
+			return;
+		}
+
+		Eigen::VectorXd b = Eigen::VectorXd::Zero(old_of_new.size()), x;
+		for(unsigned int c = 0; c < cols; c++) b(old_of_new[col0+c]) = w(c);
+
+		if(symmetric) x = ldlt.solve(b);
+		else x = lu.solve(b);
+
+		for(unsigned int r = 0; r < rows; r++) out(r) = x(old_of_new[row0+r]);
+		num_solves++;
+	}
+
+		/// x = A*b exactly, in the given numbering
+	void solveExact(const Eigen::VectorXd& b, Eigen::VectorXd& x)
+	{
+		if(dense) x = (*dense)*b;
+		else if(symmetric) x = ldlt.solve(b);
+		else x = lu.solve(b);
+	}
+};
+
+HierarchicalInverse::HierarchicalInverse(SystemConductance& conductance, double tolerance, unsigned int leaf_size) :
+	dimension(0), tolerance(tolerance), leaf_size(leaf_size), old_of_new(), blocks(),
+	estimated_error(0.0), num_solves(0), b_work(), x_work()
+{
+	reset(conductance, tolerance, leaf_size);
+}
+
+HierarchicalInverse::HierarchicalInverse(SystemConductance& conductance, SystemResistance& resistance, double tolerance,
+		unsigned int leaf_size) :
+	dimension(0), tolerance(tolerance), leaf_size(leaf_size), old_of_new(), blocks(),
+	estimated_error(0.0), num_solves(0), b_work(), x_work()
+{
+	reset(conductance, resistance, tolerance, leaf_size);
+}
+
+HierarchicalInverse::HierarchicalInverse(SparseSystemConductance& conductance, double tolerance, unsigned int leaf_size) :
+	dimension(0), tolerance(tolerance), leaf_size(leaf_size), old_of_new(), blocks(),
+	estimated_error(0.0), num_solves(0), b_work(), x_work()
+{
+	reset(conductance, tolerance, leaf_size);
+}
+
+HierarchicalInverse::HierarchicalInverse(const HierarchicalInverse& base) :
+	dimension(base.dimension), tolerance(base.tolerance), leaf_size(base.leaf_size), old_of_new(base.old_of_new),
+	blocks(base.blocks), estimated_error(base.estimated_error), num_solves(base.num_solves),
+	b_work(base.b_work), x_work(base.x_work)
+{
+	//do nothing else
+}
+
+void HierarchicalInverse::reset(SystemConductance& conductance, double tolerance, unsigned int leaf_size)
+{
+	SystemResistance resistance(conductance);
+	resistance.invertSelf();
+
+	reset(conductance, resistance, tolerance, leaf_size);
+}
+
+void HierarchicalInverse::reset(SystemConductance& conductance, SystemResistance& resistance, double tolerance,
+		unsigned int leaf_size)
+{
+	dimension = conductance.getDimension();
+	this->tolerance = tolerance;
+	this->leaf_size = std::max(leaf_size, 1u);
+	old_of_new = NodeReordering(conductance, NodeReordering::REVERSE_CUTHILL_MCKEE).getPermutation();
+
+	std::vector<unsigned int> new_of_old(dimension);
+	for(unsigned int p = 0; p < dimension; p++) new_of_old[old_of_new[p]] = p;
+
+	EntrySource source(old_of_new, &resistance.asEigen3Matrix());
+
+	const MatrixRMXd& G = conductance.asEigen3Matrix();
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(unsigned int c = r+1; c < dimension; c++)
+		{
+			if(G(r,c) != 0.0 || G(c,r) != 0.0) source.couple(r, c, new_of_old);
+		}
+	}
+
+	build(source);
+}
+
+void HierarchicalInverse::reset(SparseSystemConductance& conductance, double tolerance, unsigned int leaf_size)
+{
+	dimension = conductance.getDimension();
+	this->tolerance = tolerance;
+	this->leaf_size = std::max(leaf_size, 1u);
+	old_of_new = NodeReordering(conductance, NodeReordering::REVERSE_CUTHILL_MCKEE).getPermutation();
+
+	std::vector<unsigned int> new_of_old(dimension);
+	for(unsigned int p = 0; p < dimension; p++) new_of_old[old_of_new[p]] = p;
+
+	EntrySource source(old_of_new, 0);
+	source.factor(conductance);
+	source.cache_capacity = 4*this->leaf_size; //solutions of a few clusters
+
+	const SparseMatrixRMXd& G = conductance.asEigen3SparseMatrix();
+	for(int r = 0; r < G.outerSize(); r++)
+	{
+		for(SparseMatrixRMXd::InnerIterator it(G, r); it; ++it)
+		{
+			source.couple(r, it.col(), new_of_old);
+		}
+	}
+
+	build(source);
+}
+
+void HierarchicalInverse::reset(const HierarchicalInverse& base)
+{
+	dimension = base.dimension;
+	tolerance = base.tolerance;
+	leaf_size = base.leaf_size;
+	old_of_new = base.old_of_new;
+	blocks = base.blocks;
+	estimated_error = base.estimated_error;
+	num_solves = base.num_solves;
+	b_work = base.b_work;
+	x_work = base.x_work;
+}
+
+void HierarchicalInverse::build(EntrySource& source)
+{
+	blocks.clear();
+	b_work = Eigen::VectorXd::Zero(dimension);
+	x_work = Eigen::VectorXd::Zero(dimension);
+
+	if(dimension == 0) return;
+
+		//exact solution of a smooth, non-zero probe vector; gives the scale of A for the error budget of
+		//the blocks, and the accuracy of the product after the build
+
+	Eigen::VectorXd probe(dimension), exact, approx(dimension);
+	for(unsigned int i = 0; i < dimension; i++) probe(i) = 1.0 + 0.5*std::sin(double(i));
+
+	source.solveExact(probe, exact);
+
+		//budgets are split by block area, so their sum over all blocks is tolerance*|A*probe|/|probe|
+
+	source.error_per_entry = tolerance*(exact.norm()/probe.norm())/double(dimension);
+
+	buildBlock(source, 0, dimension, 0, dimension);
+	fillDenseBlocks(source);
+
+	for(unsigned int p = 0; p < dimension; p++) b_work(p) = probe(old_of_new[p]);
+	multiply(b_work, x_work);
+	for(unsigned int p = 0; p < dimension; p++) approx(old_of_new[p]) = x_work(p);
+
+	const double norm = exact.norm();
+	estimated_error = (norm > 0.0) ? (approx - exact).norm()/norm : 0.0;
+	num_solves = source.num_solves;
+}
+
+void HierarchicalInverse::buildBlock(EntrySource& source, unsigned int row0, unsigned int rows,
+		unsigned int col0, unsigned int cols)
+{
+	Block block;
+	block.row0 = row0;
+	block.rows = rows;
+	block.col0 = col0;
+	block.cols = cols;
+	block.low_rank = false;
+
+	if(row0 == col0)
+	{
+			//diagonal blocks couple a cluster with itself, so they are never low-rank
+
+		if(rows <= leaf_size)
+		{
+			source.dense_blocks.push_back(blocks.size());
+			blocks.push_back(block);
+			return;
+		}
+
+		const unsigned int half = rows/2;
+		buildBlock(source, row0, half, col0, half);
+		buildBlock(source, row0, half, col0+half, cols-half);
+		buildBlock(source, row0+half, rows-half, col0, half);
+		buildBlock(source, row0+half, rows-half, col0+half, cols-half);
+		return;
+	}
+
+		//admissible blocks couple clusters further apart in the conductance graph than the smaller
+		//cluster is wide; their entries vary smoothly, which ACA relies on
+
+	const unsigned int width = std::max(1u, std::min(source.diameter(row0, rows), source.diameter(col0, cols)));
+	const bool admissible = (width == ~0u) || (source.distance(row0, rows, col0, cols, width) > width);
+
+		//low-rank storage (rows+cols)*rank breaks even with dense storage rows*cols at this rank
+
+	const unsigned int max_rank = (unsigned long)(rows)*cols/(rows+cols);
+
+	const double budget = source.error_per_entry*std::sqrt(double(rows)*double(cols));
+
+	if(admissible && max_rank > 0 && approximate(source, block, max_rank, budget))
+	{
+		recompress(block, budget);
+		blocks.push_back(block);
+		return;
+	}
+
+	if(rows <= leaf_size || cols <= leaf_size)
+	{
+		source.dense_blocks.push_back(blocks.size());
+		blocks.push_back(block);
+		return;
+	}
+
+	const unsigned int rhalf = rows/2;
+	const unsigned int chalf = cols/2;
+	buildBlock(source, row0, rhalf, col0, chalf);
+	buildBlock(source, row0, rhalf, col0+chalf, cols-chalf);
+	buildBlock(source, row0+rhalf, rows-rhalf, col0, chalf);
+	buildBlock(source, row0+rhalf, rows-rhalf, col0+chalf, cols-chalf);
+}
+
+void HierarchicalInverse::fillDenseBlocks(EntrySource& source)
+{
+		//dense blocks sharing a column range are filled from one solve of its columns, so a column of A
+		//is solved once for all blocks of the near field instead of once per block
+
+	std::map<std::pair<unsigned int, unsigned int>, std::vector<unsigned int> > by_columns;
+	for(unsigned int i = 0; i < source.dense_blocks.size(); i++)
+	{
+		const Block& block = blocks[source.dense_blocks[i]];
+		by_columns[std::make_pair(block.col0, block.cols)].push_back(source.dense_blocks[i]);
+	}
+
+	Eigen::MatrixXd A_cols;
+
+	std::map<std::pair<unsigned int, unsigned int>, std::vector<unsigned int> >::const_iterator it;
+	for(it = by_columns.begin(); it != by_columns.end(); ++it)
+	{
+		const unsigned int col0 = it->first.first;
+		const unsigned int cols = it->first.second;
+		const std::vector<unsigned int>& members = it->second;
+
+		for(unsigned int i = 0; i < members.size(); i++) blocks[members[i]].D.resize(blocks[members[i]].rows, cols);
+
+			//in chunks of the leaf size, to bound the memory of the solved columns
+
+		for(unsigned int c0 = 0; c0 < cols; c0 += leaf_size)
+		{
+			const unsigned int chunk = std::min(leaf_size, cols-c0);
+			source.columns(col0+c0, chunk, A_cols);
+
+			for(unsigned int i = 0; i < members.size(); i++)
+			{
+				Block& block = blocks[members[i]];
+				block.D.middleCols(c0, chunk) = A_cols.block(block.row0, 0, block.rows, chunk);
+			}
+		}
+
+		for(unsigned int i = 0; i < members.size(); i++)
+		{
+			Block& block = blocks[members[i]];
+			if(block.row0 == block.col0) continue; //diagonal blocks are never dropped
+
+			const double budget = source.error_per_entry*std::sqrt(double(block.rows)*double(block.cols));
+
+			if(block.D.norm() <= budget)
+			{
+					//negligible block; stored as rank zero
+				block.low_rank = true;
+				block.D.resize(0,0);
+				block.U.resize(block.rows, 0);
+				block.V.resize(block.cols, 0);
+			}
+		}
+	}
+}
+
+bool HierarchicalInverse::approximate(EntrySource& source, Block& block, unsigned int max_rank, double budget)
+{
+	const unsigned int m = block.rows;
+	const unsigned int n = block.cols;
+	const unsigned int num_checks = 2;
+
+	std::vector<Eigen::VectorXd> us, vs;
+	std::vector<bool> used_row(m, false);
+	Eigen::VectorXd r, c, w(n);
+	unsigned int seed = block.row0*2654435761u + block.col0;
+
+	unsigned int pivot_row = 0;
+	unsigned int attempts = 0;
+	bool converged = false;
+
+	while(us.size() < max_rank && attempts < m)
+	{
+		attempts++;
+
+			//residual of the pivot row
+
+		used_row[pivot_row] = true;
+		source.row(block.row0 + pivot_row, block.col0, n, r);
+		for(unsigned int l = 0; l < us.size(); l++) r -= us[l](pivot_row)*vs[l];
+
+		unsigned int pivot_col;
+		const double pivot = (n > 0) ? r.cwiseAbs().maxCoeff(&pivot_col) : 0.0;
+
+		bool small = (pivot == 0.0); //row is already reproduced
+
+		if(!small)
+		{
+				//cross through the pivot: u = residual column, v = residual row scaled by the pivot
+
+			Eigen::VectorXd v = r/r(pivot_col);
+			source.column(block.col0 + pivot_col, block.row0, m, c);
+			for(unsigned int l = 0; l < us.size(); l++) c -= vs[l](pivot_col)*us[l];
+
+			const double cross = c.norm()*v.norm();
+
+			us.push_back(c);
+			vs.push_back(v);
+
+				//only the block's share of the budget is allowed, so the errors of all blocks stay within
+				//tolerance*|A| together
+			small = (cross <= budget);
+		}
+
+		if(small)
+		{
+				//the stopping test only sees the sampled crosses, which can miss isolated large entries
+				//or columns of the block; the residual times random signs w confirms it, as the expected
+				//|R*w|^2 is |R|^2 over the whole block
+
+			bool confirmed = true;
+			for(unsigned int k = 0; k < num_checks && confirmed; k++)
+			{
+				for(unsigned int j = 0; j < n; j++)
+				{
+					seed = seed*1664525u + 1013904223u;
+					w(j) = (seed & 0x80000000u) ? 1.0 : -1.0;
+				}
+
+				source.product(block.row0, m, block.col0, n, w, c);
+				for(unsigned int l = 0; l < us.size(); l++) c -= vs[l].dot(w)*us[l];
+
+				unsigned int row_max;
+				const double largest = c.cwiseAbs().maxCoeff(&row_max);
+				if(largest == 0.0) continue;
+
+				if(c.norm() > budget)
+				{
+					confirmed = false;
+					pivot_row = row_max;
+				}
+			}
+
+			if(confirmed) { converged = true; break; }
+			if(!used_row[pivot_row]) continue;
+		}
+		else
+		{
+				//next pivot row: largest entry of the new column among unused rows
+
+			unsigned int next = m;
+			double largest = -1.0;
+			for(unsigned int i = 0; i < m; i++)
+			{
+				if(!used_row[i] && std::fabs(us.back()(i)) > largest) { largest = std::fabs(us.back()(i)); next = i; }
+			}
+
+			if(next != m) { pivot_row = next; continue; }
+		}
+
+			//pivot row already used; take the first unused row
+
+		unsigned int next = m;
+		for(unsigned int i = 0; i < m; i++)
+		{
+			if(!used_row[i]) { next = i; break; }
+		}
+		if(next == m) { converged = true; break; } //every row is reproduced
+
+		pivot_row = next;
+	}
+
+	if(!converged) return false;
+
+	block.low_rank = true;
+	block.U.resize(m, us.size());
+	block.V.resize(n, vs.size());
+	for(unsigned int l = 0; l < us.size(); l++)
+	{
+		block.U.col(l) = us[l];
+		block.V.col(l) = vs[l];
+	}
+
+	return true;
+}
+
+void HierarchicalInverse::recompress(Block& block, double budget)
+{
+	const unsigned int k = block.U.cols();
+	if(k < 1) return;
+
+		//U*V^T = Qu*(Ru*Rv^T)*Qv^T; the SVD of the small core gives the smallest rank within the budget
+
+	Eigen::HouseholderQR<Eigen::MatrixXd> qru(block.U), qrv(block.V);
+	const Eigen::MatrixXd Qu = qru.householderQ()*Eigen::MatrixXd::Identity(block.rows, k);
+	const Eigen::MatrixXd Qv = qrv.householderQ()*Eigen::MatrixXd::Identity(block.cols, k);
+	const Eigen::MatrixXd Ru = qru.matrixQR().topRows(k).triangularView<Eigen::Upper>();
+	const Eigen::MatrixXd Rv = qrv.matrixQR().topRows(k).triangularView<Eigen::Upper>();
+
+	Eigen::JacobiSVD<Eigen::MatrixXd> svd(Ru*Rv.transpose(), Eigen::ComputeFullU | Eigen::ComputeFullV);
+	const Eigen::VectorXd& s = svd.singularValues();
+
+	unsigned int rank = k;
+	double tail = 0.0;
+	const double allowed = budget*budget;
+	while(rank > 0 && tail + s(rank-1)*s(rank-1) <= allowed)
+	{
+		tail += s(rank-1)*s(rank-1);
+		rank--;
+	}
+
+	block.U = Qu*svd.matrixU().leftCols(rank)*s.head(rank).asDiagonal();
+	block.V = Qv*svd.matrixV().leftCols(rank);
+}
+
+void HierarchicalInverse::multiply(const Eigen::VectorXd& b, Eigen::VectorXd& x) const
+{
+	x.setZero();
+
+	for(unsigned int i = 0; i < blocks.size(); i++)
+	{
+		const Block& block = blocks[i];
+
+		if(block.low_rank)
+		{
+			if(block.U.cols() == 0) continue;
+			const Eigen::VectorXd t = block.V.transpose()*b.segment(block.col0, block.cols);
+			x.segment(block.row0, block.rows).noalias() += block.U*t;
+		}
+		else
+		{
+			x.segment(block.row0, block.rows).noalias() += block.D*b.segment(block.col0, block.cols);
+		}
+	}
+}
+
+void HierarchicalInverse::solve(const NumType* b, NumType* x) const
+{
+	for(unsigned int p = 0; p < dimension; p++)
+	{
+		b_work(p) = double(b[old_of_new[p]]);
+	}
+
+	multiply(b_work, x_work);
+
+	for(unsigned int p = 0; p < dimension; p++)
+	{
+		x[old_of_new[p]] = NumType(x_work(p));
+	}
+}
+
+void HierarchicalInverse::solve(const SystemSourceVector& sources, const NumType* b_components, NumType* x) const
+{
+	std::vector<NumType> b(dimension, NumType(0.0));
+
+	const std::map<long, std::vector<long> >& nodes = sources.asMap();
+	for(std::map<long, std::vector<long> >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
+	{
+		if(it->second[0] != 0) b[it->second[0]-1] += b_components[it->first-1];
+		if(it->second[1] != 0) b[it->second[1]-1] -= b_components[it->first-1];
+	}
+
+	solve(&b[0], x);
+}
+
+unsigned int HierarchicalInverse::getDimension() const
+{
+	return dimension;
+}
+
+double HierarchicalInverse::getTolerance() const
+{
+	return tolerance;
+}
+
+unsigned int HierarchicalInverse::getNumBlocks() const
+{
+	return blocks.size();
+}
+
+unsigned int HierarchicalInverse::getNumLowRankBlocks() const
+{
+	unsigned int count = 0;
+	for(unsigned int i = 0; i < blocks.size(); i++)
+	{
+		if(blocks[i].low_rank) count++;
+	}
+	return count;
+}
+
+unsigned int HierarchicalInverse::getMaxRank() const
+{
+	unsigned int rank = 0;
+	for(unsigned int i = 0; i < blocks.size(); i++)
+	{
+		if(blocks[i].low_rank) rank = std::max(rank, (unsigned int)(blocks[i].U.cols()));
+	}
+	return rank;
+}
+
+unsigned long HierarchicalInverse::getStorage() const
+{
+	unsigned long storage = 0;
+	for(unsigned int i = 0; i < blocks.size(); i++)
+	{
+		const Block& block = blocks[i];
+		if(block.low_rank) storage += (unsigned long)(block.rows + block.cols)*block.U.cols();
+		else storage += (unsigned long)(block.rows)*block.cols;
+	}
+	return storage;
+}
+
+double HierarchicalInverse::getCompressionRatio() const
+{
+	if(dimension == 0) return 0.0;
+	return double(getStorage())/(double(dimension)*double(dimension));
+}
+
+double HierarchicalInverse::getEstimatedError() const
+{
+	return estimated_error;
+}
+
+unsigned long HierarchicalInverse::getNumSolves() const
+{
+	return num_solves;
+}
+
+const char* HierarchicalInverse::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	sstrm << "Hierarchical Inverse\n\n";
+	sstrm << "dimension:         " << dimension << "\n";
+	sstrm << "tolerance:         " << tolerance << "\n";
+	sstrm << "leaf size:         " << leaf_size << "\n\n";
+	sstrm << "blocks:            " << blocks.size() << " (" << getNumLowRankBlocks() << " low-rank)\n";
+	sstrm << "max rank:          " << getMaxRank() << "\n";
+	sstrm << "coefficients:      " << getStorage() << " of " << (unsigned long)(dimension)*dimension << "\n";
+	sstrm << "compression ratio: " << getCompressionRatio() << "\n";
+	sstrm << "estimated error:   " << estimated_error << "\n";
+	sstrm << "build solves:      " << num_solves << "\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+} //namespace LBLMC
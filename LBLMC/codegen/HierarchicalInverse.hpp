@@ -0,0 +1,195 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef HIERARCHICALINVERSE_HPP
+#define HIERARCHICALINVERSE_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemConductance.hpp"
+#include "SparseSystemConductance.hpp"
+#include "SystemSourceVector.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief hierarchical low-rank (H-matrix) approximation of the inverted conductance matrix A = G^-1
+ *
+ * For large meshed networks A is dense, but its blocks coupling distant parts of the network are
+ * numerically low-rank.  The nodes are ordered with reverse Cuthill-McKee (NodeReordering), so that
+ * nearby nodes have nearby indices, and the index range is bisected recursively into a cluster
+ * tree.  Blocks of A between clusters that are further apart in the conductance graph than they
+ * are wide are compressed with adaptive cross approximation (ACA with partial pivoting),
+ * A(I,J) ~= U*V^T, followed by a QR/SVD recompression to the rank the tolerance needs.  Other
+ * blocks, and blocks whose approximation does not converge below the break-even rank, are
+ * subdivided, and stored dense at the leaf size.
+ *
+ * The tolerance is relative to the scale of A: each block gets an error budget in proportion to its
+ * size, so that the blocks together stay within tolerance*|A|, and blocks below their budget are
+ * dropped.  A cross approximation is accepted only once the residual of the block times random sign
+ * vectors is within its budget.  Since entries of A decay with distance in the network, most far blocks have rank zero.
+ *
+ * ACA only samples rows and columns of A.  Built from a SparseSystemConductance, these are solved
+ * from one sparse factorization of G, so the dense inverse is never formed.  The dense blocks are
+ * filled after the block structure is known, with one multi-RHS solve per column range shared by all
+ * blocks of that range, and the rows and columns sampled by ACA are kept in a small cache, as
+ * neighbouring blocks sample the same ones; the build takes about 1.5 solves per node of a mesh.
+ *
+ * The product x = A*b then costs about O(N log N * rank) instead of O(N^2).  The accuracy of the
+ * product is estimated at build time against the exact solution of a probe vector.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class HierarchicalInverse
+{
+private:
+
+	/**
+	 * block A(row0:row0+rows, col0:col0+cols) of the reordered inverse; dense or U*V^T
+	 */
+	struct Block
+	{
+		unsigned int row0, rows;
+		unsigned int col0, cols;
+		bool low_rank;
+		Eigen::MatrixXd D; ///< dense block; rows x cols
+		Eigen::MatrixXd U; ///< left factor; rows x rank
+		Eigen::MatrixXd V; ///< right factor; cols x rank
+	};
+
+	struct EntrySource; ///< samples rows and columns of A during the build
+
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	double tolerance; ///< relative accuracy of the approximation
+	unsigned int leaf_size; ///< largest cluster that is not subdivided
+	std::vector<unsigned int> old_of_new; ///< zero-based solution index at each reordered position
+	std::vector<Block> blocks;
+
+	double estimated_error; ///< relative 2-norm error of A*b for the build probe vector
+	unsigned long num_solves; ///< sparse solves used to sample A during the build
+
+	mutable Eigen::VectorXd b_work; ///< reordered b
+	mutable Eigen::VectorXd x_work; ///< reordered x
+
+public:
+
+	/**
+	 * dense constructor; inverts a copy of G, for moderate dimensions
+	 * @param conductance the (not inverted) conductance matrix G of Gx=b
+	 * @param tolerance relative accuracy of the approximation
+	 * @param leaf_size largest cluster that is not subdivided
+	 * @throws std::runtime_error if the conductance matrix is singular
+	 */
+	HierarchicalInverse(SystemConductance& conductance, double tolerance = 1.0e-8, unsigned int leaf_size = 32);
+
+	/**
+	 * dense constructor from an already inverted matrix
+	 * @param conductance the (not inverted) conductance matrix G of Gx=b, for the node ordering
+	 * @param resistance the inverted conductance matrix A = G^-1
+	 * @param tolerance relative accuracy of the approximation
+	 * @param leaf_size largest cluster that is not subdivided
+	 */
+	HierarchicalInverse(SystemConductance& conductance, SystemResistance& resistance, double tolerance = 1.0e-8,
+			unsigned int leaf_size = 32);
+
+	/**
+	 * sparse constructor; samples A from a sparse factorization of G, without forming A
+	 * @param conductance the (not inverted) conductance matrix G of Gx=b
+	 * @param tolerance relative accuracy of the approximation
+	 * @param leaf_size largest cluster that is not subdivided
+	 * @throws std::runtime_error if the conductance matrix is singular
+	 */
+	HierarchicalInverse(SparseSystemConductance& conductance, double tolerance = 1.0e-8, unsigned int leaf_size = 32);
+
+	HierarchicalInverse(const HierarchicalInverse& base);
+
+	void reset(SystemConductance& conductance, double tolerance = 1.0e-8, unsigned int leaf_size = 32);
+	void reset(SystemConductance& conductance, SystemResistance& resistance, double tolerance = 1.0e-8,
+			unsigned int leaf_size = 32);
+	void reset(SparseSystemConductance& conductance, double tolerance = 1.0e-8, unsigned int leaf_size = 32);
+	void reset(const HierarchicalInverse& base);
+
+	/**
+	 * computes x = A*b with the hierarchical approximation
+	 * @param b aggregated source vector of the system dimension
+	 * @param x array to store the solution to, of the system dimension
+	 */
+	void solve(const NumType* b, NumType* x) const;
+
+	/**
+	 * aggregates b from the source contributions and computes x = A*b
+	 * @param sources source vector of the system
+	 * @param b_components source contributions of the components; b_components[index-1] for source index
+	 * @param x array to store the solution to, of the system dimension
+	 */
+	void solve(const SystemSourceVector& sources, const NumType* b_components, NumType* x) const;
+
+	unsigned int getDimension() const; ///< @return number of solutions in the system
+	double getTolerance() const; ///< @return relative accuracy of the approximation
+	unsigned int getNumBlocks() const; ///< @return number of blocks
+	unsigned int getNumLowRankBlocks() const; ///< @return number of low-rank blocks
+	unsigned int getMaxRank() const; ///< @return largest rank of the low-rank blocks
+
+	/**
+	 * @return number of coefficients stored, and multiplies of a product x = A*b
+	 */
+	unsigned long getStorage() const;
+
+	/**
+	 * @return storage relative to the dense inverse, getStorage()/dimension^2
+	 */
+	double getCompressionRatio() const;
+
+	/**
+	 * @return relative 2-norm error of x = A*b for the probe vector used at build time
+	 */
+	double getEstimatedError() const;
+
+	/**
+	 * @return number of right-hand sides solved with the sparse factorization of G during the build;
+	 * 0 for the dense constructors
+	 */
+	unsigned long getNumSolves() const;
+
+	/**
+	 * creates a report, as a string, of the block structure, storage and accuracy
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+private:
+
+	void build(EntrySource& source);
+	void buildBlock(EntrySource& source, unsigned int row0, unsigned int rows, unsigned int col0, unsigned int cols);
+	void fillDenseBlocks(EntrySource& source);
+	bool approximate(EntrySource& source, Block& block, unsigned int max_rank, double budget);
+	void recompress(Block& block, double budget);
+	void multiply(const Eigen::VectorXd& b, Eigen::VectorXd& x) const;
+};
+
+} //namespace LBLMC
+
+#endif //HIERARCHICALINVERSE_HPP
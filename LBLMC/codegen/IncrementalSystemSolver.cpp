@@ -0,0 +1,209 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "IncrementalSystemSolver.hpp"
+#include <sstream>
+#include <cmath>
+
+namespace LBLMC
+{
+
+IncrementalSystemSolver::IncrementalSystemSolver(const SystemSolver& solver, double tolerance, unsigned int full_solve_period) :
+	dimension(0), variable_sources(), AS(), x_const(), x(), bc_applied(),
+	tolerance(tolerance), full_solve_period(full_solve_period), steps_since_full_solve(0), initialized(false),
+	num_steps(0), num_full_solves(0), num_columns_applied(0), num_columns_skipped(0)
+{
+	reset(solver, tolerance, full_solve_period);
+}
+
+IncrementalSystemSolver::IncrementalSystemSolver(const IncrementalSystemSolver& base) :
+	dimension(base.dimension), variable_sources(base.variable_sources), AS(base.AS), x_const(base.x_const),
+	x(base.x), bc_applied(base.bc_applied), tolerance(base.tolerance), full_solve_period(base.full_solve_period),
+	steps_since_full_solve(base.steps_since_full_solve), initialized(base.initialized),
+	num_steps(base.num_steps), num_full_solves(base.num_full_solves),
+	num_columns_applied(base.num_columns_applied), num_columns_skipped(base.num_columns_skipped)
+{
+	//do nothing else
+}
+
+void IncrementalSystemSolver::reset(const SystemSolver& solver, double tolerance, unsigned int full_solve_period)
+{
+	dimension = solver.getDimension();
+	variable_sources = solver.getVariableSources();
+	AS = solver.getSourceMatrix(); //row-major to column-major copy
+	x_const = solver.getConstantSolution();
+	x = x_const;
+	bc_applied = Eigen::VectorXd::Zero(variable_sources.size());
+
+	this->tolerance = tolerance;
+	this->full_solve_period = full_solve_period;
+
+	invalidate();
+	clearStatistics();
+}
+
+void IncrementalSystemSolver::reset(const IncrementalSystemSolver& base)
+{
+	dimension = base.dimension;
+	variable_sources = base.variable_sources;
+	AS = base.AS;
+	x_const = base.x_const;
+	x = base.x;
+	bc_applied = base.bc_applied;
+	tolerance = base.tolerance;
+	full_solve_period = base.full_solve_period;
+	steps_since_full_solve = base.steps_since_full_solve;
+	initialized = base.initialized;
+	num_steps = base.num_steps;
+	num_full_solves = base.num_full_solves;
+	num_columns_applied = base.num_columns_applied;
+	num_columns_skipped = base.num_columns_skipped;
+}
+
+void IncrementalSystemSolver::setTolerance(double tolerance)
+{
+	this->tolerance = tolerance;
+}
+
+void IncrementalSystemSolver::setFullSolvePeriod(unsigned int full_solve_period)
+{
+	this->full_solve_period = full_solve_period;
+}
+
+void IncrementalSystemSolver::invalidate()
+{
+	initialized = false;
+	steps_since_full_solve = 0;
+}
+
+void IncrementalSystemSolver::solve(const NumType* b_components, NumType* x_out)
+{
+	num_steps++;
+
+	if(initialized) steps_since_full_solve++; //counts this step, so a full solve is every full_solve_period steps
+
+	if(!initialized || (full_solve_period != 0 && steps_since_full_solve >= full_solve_period))
+	{
+		fullSolve(b_components);
+	}
+	else
+	{
+		for(unsigned int j = 0; j < variable_sources.size(); j++)
+		{
+			const double delta = double(b_components[variable_sources[j]]) - bc_applied(j);
+
+			if(delta == 0.0) continue;
+
+			if(std::fabs(delta) <= tolerance)
+			{
+				num_columns_skipped++; //change accumulates in delta until it exceeds tolerance
+				continue;
+			}
+
+			x.noalias() += delta*AS.col(j);
+			bc_applied(j) += delta;
+			num_columns_applied++;
+		}
+	}
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		x_out[r] = NumType(x(r));
+	}
+}
+
+void IncrementalSystemSolver::fullSolve(const NumType* b_components)
+{
+	for(unsigned int j = 0; j < variable_sources.size(); j++)
+	{
+		bc_applied(j) = double(b_components[variable_sources[j]]);
+	}
+
+	x = x_const;
+	x.noalias() += AS*bc_applied;
+
+	initialized = true;
+	steps_since_full_solve = 0;
+	num_full_solves++;
+}
+
+unsigned int IncrementalSystemSolver::getDimension() const
+{
+	return dimension;
+}
+
+unsigned long IncrementalSystemSolver::getNumSteps() const
+{
+	return num_steps;
+}
+
+unsigned long IncrementalSystemSolver::getNumFullSolves() const
+{
+	return num_full_solves;
+}
+
+unsigned long IncrementalSystemSolver::getNumColumnsApplied() const
+{
+	return num_columns_applied;
+}
+
+unsigned long IncrementalSystemSolver::getNumColumnsSkipped() const
+{
+	return num_columns_skipped;
+}
+
+double IncrementalSystemSolver::getWorkFraction() const
+{
+	if(num_steps == 0 || variable_sources.empty()) return 0.0;
+
+	const double columns = double(num_full_solves)*double(variable_sources.size()) + double(num_columns_applied);
+
+	return columns / (double(num_steps)*double(variable_sources.size()));
+}
+
+void IncrementalSystemSolver::clearStatistics()
+{
+	num_steps = 0;
+	num_full_solves = 0;
+	num_columns_applied = 0;
+	num_columns_skipped = 0;
+}
+
+const char* IncrementalSystemSolver::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	sstrm << "Incremental System Solver Statistics\n\n";
+	sstrm << "dimension:         " << dimension << "\n";
+	sstrm << "source columns:    " << variable_sources.size() << "\n";
+	sstrm << "tolerance:         " << tolerance << "\n";
+	sstrm << "full solve period: " << full_solve_period << "\n\n";
+	sstrm << "steps:             " << num_steps << "\n";
+	sstrm << "full solves:       " << num_full_solves << "\n";
+	sstrm << "columns applied:   " << num_columns_applied << "\n";
+	sstrm << "changes skipped:   " << num_columns_skipped << "\n";
+	sstrm << "work fraction:     " << getWorkFraction() << "\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+} //namespace LBLMC
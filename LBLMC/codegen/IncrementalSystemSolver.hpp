@@ -0,0 +1,142 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef INCREMENTALSYSTEMSOLVER_HPP
+#define INCREMENTALSYSTEMSOLVER_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemSolver.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief solves a LB-LMC system model at runtime by propagating only the changed source contributions
+ *
+ * Many source contributions change slowly or not at all between steps (idle converters, steady
+ * sources).  Since x = x_const + AS*bc is linear in the contributions, this solver keeps the solution
+ * of the last step and applies
+ *
+ * 	x += AS[:,j] * (bc_j - bc_applied_j)
+ *
+ * only for the contributions whose change since they were last applied exceeds a tolerance.  The
+ * skipped changes are not lost: they accumulate until they exceed the tolerance, so the error of each
+ * contribution is bounded by the tolerance.  AS is stored column-major for this path, and a full
+ * re-solve is done periodically to clear rounding drift of the accumulated updates.
+ *
+ * The source matrix and constant offset are taken from a SystemSolver.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class IncrementalSystemSolver
+{
+private:
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	std::vector<unsigned int> variable_sources; ///< zero-based b_components indices of time-varying sources
+	Eigen::MatrixXd AS; ///< A*S for the time-varying sources, column-major
+	Eigen::VectorXd x_const; ///< solution offset from constant sources
+	Eigen::VectorXd x; ///< solution of the last step
+	Eigen::VectorXd bc_applied; ///< source contributions the present solution is computed with
+
+	double tolerance; ///< smallest change of a source contribution that is propagated
+	unsigned int full_solve_period; ///< number of steps between full re-solves; 0 to never re-solve
+	unsigned int steps_since_full_solve;
+	bool initialized; ///< false until the first full solve
+
+	unsigned long num_steps; ///< statistics: number of solve() calls
+	unsigned long num_full_solves; ///< statistics: number of full re-solves
+	unsigned long num_columns_applied; ///< statistics: number of column updates applied
+	unsigned long num_columns_skipped; ///< statistics: number of changed contributions below tolerance
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param solver runtime solver of the system to take the source matrix and constant offset from
+	 * @param tolerance smallest change of a source contribution that is propagated; 0 propagates any change
+	 * @param full_solve_period number of steps between full re-solves; 0 to never re-solve
+	 */
+	IncrementalSystemSolver(const SystemSolver& solver, double tolerance = 0.0, unsigned int full_solve_period = 1000);
+	IncrementalSystemSolver(const IncrementalSystemSolver& base);
+
+	void reset(const SystemSolver& solver, double tolerance = 0.0, unsigned int full_solve_period = 1000);
+	void reset(const IncrementalSystemSolver& base);
+
+	/**
+	 * @param tolerance smallest change of a source contribution that is propagated
+	 */
+	void setTolerance(double tolerance);
+
+	/**
+	 * @param full_solve_period number of steps between full re-solves; 0 to never re-solve
+	 */
+	void setFullSolvePeriod(unsigned int full_solve_period);
+
+	/**
+	 * forces the next solve() to be a full re-solve
+	 */
+	void invalidate();
+
+	/**
+	 * solves the system for the present source contributions
+	 *
+	 * The first call, and every full_solve_period calls after, computes the full solution.  Other
+	 * calls propagate only the contributions that changed by more than the tolerance.
+	 *
+	 * @param b_components source contributions of the components; b_components[index-1] for source index
+	 * @param x array to store the solution to, of the system dimension
+	 */
+	void solve(const NumType* b_components, NumType* x);
+
+	unsigned int getDimension() const; ///< @return number of solutions in the system
+	unsigned long getNumSteps() const; ///< @return number of solve() calls
+	unsigned long getNumFullSolves() const; ///< @return number of full re-solves
+	unsigned long getNumColumnsApplied() const; ///< @return number of column updates applied
+	unsigned long getNumColumnsSkipped() const; ///< @return number of changed contributions that were below tolerance
+
+	/**
+	 * @return average fraction of the full product's work done per step, from 0 to 1
+	 */
+	double getWorkFraction() const;
+
+	/**
+	 * resets the statistics
+	 */
+	void clearStatistics();
+
+	/**
+	 * creates a report, as a string, of the solve statistics
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+private:
+
+	void fullSolve(const NumType* b_components);
+};
+
+} //namespace LBLMC
+
+#endif //INCREMENTALSYSTEMSOLVER_HPP
@@ -0,0 +1,384 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "LatencyPlacementOptimizer.hpp"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+namespace LBLMC
+{
+
+LatencyPlacementOptimizer::LatencyPlacementOptimizer(const SystemNetlist& netlist, NumType dt, double max_latency_gain) :
+	netlist(netlist), dt(dt), max_latency_gain(max_latency_gain), excluded(netlist.getNumElements(), false),
+	element_triplets(), latency_elements(), latency_gains(),
+	initial_blocks(0), final_blocks(0), initial_largest(0), final_largest(0), initial_cost(0), final_cost(0)
+{
+	//do nothing else
+}
+
+LatencyPlacementOptimizer::LatencyPlacementOptimizer(const LatencyPlacementOptimizer& base) :
+	netlist(base.netlist), dt(base.dt), max_latency_gain(base.max_latency_gain), excluded(base.excluded),
+	element_triplets(base.element_triplets), latency_elements(base.latency_elements), latency_gains(base.latency_gains),
+	initial_blocks(base.initial_blocks), final_blocks(base.final_blocks),
+	initial_largest(base.initial_largest), final_largest(base.final_largest),
+	initial_cost(base.initial_cost), final_cost(base.final_cost)
+{
+	//do nothing else
+}
+
+void LatencyPlacementOptimizer::reset(const SystemNetlist& netlist, NumType dt, double max_latency_gain)
+{
+	this->netlist.reset(netlist);
+	this->dt = dt;
+	this->max_latency_gain = max_latency_gain;
+	excluded.assign(netlist.getNumElements(), false);
+	element_triplets.clear();
+	latency_elements.clear();
+	latency_gains.clear();
+	initial_blocks = final_blocks = 0;
+	initial_largest = final_largest = 0;
+	initial_cost = final_cost = 0;
+}
+
+void LatencyPlacementOptimizer::reset(const LatencyPlacementOptimizer& base)
+{
+	netlist.reset(base.netlist);
+	dt = base.dt;
+	max_latency_gain = base.max_latency_gain;
+	excluded = base.excluded;
+	element_triplets = base.element_triplets;
+	latency_elements = base.latency_elements;
+	latency_gains = base.latency_gains;
+	initial_blocks = base.initial_blocks;
+	final_blocks = base.final_blocks;
+	initial_largest = base.initial_largest;
+	final_largest = base.final_largest;
+	initial_cost = base.initial_cost;
+	final_cost = base.final_cost;
+}
+
+void LatencyPlacementOptimizer::setExcluded(unsigned int index, bool exclude)
+{
+	if(index < excluded.size()) excluded[index] = exclude;
+}
+
+int LatencyPlacementOptimizer::optimize()
+{
+	const unsigned int num_elements = netlist.getNumElements();
+	const unsigned int dim = netlist.getDimension();
+
+	latency_elements.clear();
+	latency_gains.clear();
+
+	element_triplets.assign(num_elements, std::vector<ConductanceTriplet>());
+	for(unsigned int i = 0; i < num_elements; i++)
+	{
+		if(netlist.stampElementConductance(i, dt, element_triplets[i])) return -1;
+	}
+
+	std::vector<bool> latency(num_elements, false);
+	std::vector<unsigned int> block_of, block_sizes;
+
+	const bool grounded = partition(latency, block_of, block_sizes);
+	initial_blocks = block_sizes.size();
+	initial_largest = largestBlock(block_sizes);
+	initial_cost = blockCost(block_sizes);
+
+	unsigned int largest = initial_largest;
+	unsigned long cost = initial_cost;
+
+	while(true)
+	{
+			//conductance stamped at each node by the elements still stamped
+
+		std::vector<double> diagonal(dim, 0.0);
+		for(unsigned int i = 0; i < num_elements; i++)
+		{
+			if(latency[i]) continue;
+			for(unsigned int t = 0; t < element_triplets[i].size(); t++)
+			{
+				const ConductanceTriplet& g = element_triplets[i][t];
+				if(g.row == g.col) diagonal[g.row] += double(g.value);
+			}
+		}
+
+		unsigned int best = num_elements;
+		unsigned int best_largest = largest;
+		unsigned long best_cost = cost;
+		double best_gain = 0.0;
+
+		for(unsigned int i = 0; i < num_elements; i++)
+		{
+			const SystemNetlist::Element& e = netlist.getElement(i);
+
+			if(latency[i] || excluded[i] || e.type != SystemNetlist::INDUCTOR) continue;
+
+				//only an inductor between two nodes of a block can split it
+
+			const unsigned int np = e.nodes[0], nn = e.nodes[1];
+			if(np == 0 || nn == 0 || np == nn) continue;
+			if(block_of[np-1] != block_of[nn-1]) continue;
+
+				//latency gain from the conductance left at each terminal without the inductor
+
+			double own = 0.0;
+			for(unsigned int t = 0; t < element_triplets[i].size(); t++)
+			{
+				const ConductanceTriplet& g = element_triplets[i][t];
+				if(g.row == np-1 && g.col == np-1) own = double(g.value);
+			}
+
+			const double gp = diagonal[np-1] - own;
+			const double gn = diagonal[nn-1] - own;
+			if(gp <= 0.0 || gn <= 0.0) continue;
+
+			const double gain = double(dt)/double(e.params[0]) * (1.0/gp + 1.0/gn);
+			if(gain > max_latency_gain) continue;
+
+			std::vector<unsigned int> trial_block_of, trial_sizes;
+			latency[i] = true;
+			const bool trial_grounded = partition(latency, trial_block_of, trial_sizes);
+			latency[i] = false;
+
+			if(grounded && !trial_grounded) continue; //would leave a singular block
+
+			const unsigned int trial_largest = largestBlock(trial_sizes);
+			const unsigned long trial_cost = blockCost(trial_sizes);
+
+			const bool better =
+					(trial_largest < best_largest) ||
+					(trial_largest == best_largest && trial_cost < best_cost) ||
+					(best != num_elements && trial_largest == best_largest && trial_cost == best_cost && gain < best_gain);
+
+			if(better)
+			{
+				best = i;
+				best_largest = trial_largest;
+				best_cost = trial_cost;
+				best_gain = gain;
+			}
+		}
+
+		if(best == num_elements) break; //no inductor within the accuracy constraint improves the decomposition
+
+		latency[best] = true;
+		latency_elements.push_back(best);
+		latency_gains.push_back(best_gain);
+
+		partition(latency, block_of, block_sizes);
+		largest = best_largest;
+		cost = best_cost;
+	}
+
+	final_blocks = block_sizes.size();
+	final_largest = largest;
+	final_cost = cost;
+
+	return latency_elements.size();
+}
+
+bool LatencyPlacementOptimizer::partition(const std::vector<bool>& latency, std::vector<unsigned int>& block_of,
+		std::vector<unsigned int>& block_sizes) const
+{
+	const unsigned int dim = netlist.getDimension();
+
+		//union-find over the non-zero off-diagonal conductances
+
+	std::vector<unsigned int> parent(dim);
+	for(unsigned int n = 0; n < dim; n++) parent[n] = n;
+
+	for(unsigned int i = 0; i < element_triplets.size(); i++)
+	{
+		if(latency[i]) continue;
+		for(unsigned int t = 0; t < element_triplets[i].size(); t++)
+		{
+			const ConductanceTriplet& g = element_triplets[i][t];
+			if(g.row == g.col || g.value == NumType(0.0)) continue;
+
+			unsigned int a = g.row, b = g.col;
+			while(parent[a] != a) a = parent[a] = parent[parent[a]];
+			while(parent[b] != b) b = parent[b] = parent[parent[b]];
+			if(a != b) parent[std::max(a,b)] = std::min(a,b);
+		}
+	}
+
+		//blocks numbered in order of their lowest node, as SystemDecomposer
+
+	block_of.assign(dim, 0);
+	block_sizes.clear();
+	std::vector<unsigned int> root_block(dim, ~0u);
+	for(unsigned int n = 0; n < dim; n++)
+	{
+		unsigned int r = n;
+		while(parent[r] != r) r = parent[r];
+
+		if(root_block[r] == ~0u)
+		{
+			root_block[r] = block_sizes.size();
+			block_sizes.push_back(0);
+		}
+		block_of[n] = root_block[r];
+		block_sizes[root_block[r]]++;
+	}
+
+		//a block has a path to ground if its rows do not sum to zero, as they do for floating networks
+
+	std::vector<double> row_sum(block_sizes.size(), 0.0);
+	std::vector<double> diag_sum(block_sizes.size(), 0.0);
+	for(unsigned int i = 0; i < element_triplets.size(); i++)
+	{
+		if(latency[i]) continue;
+		for(unsigned int t = 0; t < element_triplets[i].size(); t++)
+		{
+			const ConductanceTriplet& g = element_triplets[i][t];
+			row_sum[block_of[g.row]] += double(g.value);
+			if(g.row == g.col) diag_sum[block_of[g.row]] += std::fabs(double(g.value));
+		}
+	}
+
+	for(unsigned int k = 0; k < block_sizes.size(); k++)
+	{
+		if(!(std::fabs(row_sum[k]) > 1.0e-12*diag_sum[k])) return false;
+	}
+
+	return true;
+}
+
+unsigned long LatencyPlacementOptimizer::blockCost(const std::vector<unsigned int>& block_sizes)
+{
+	unsigned long cost = 0;
+	for(unsigned int k = 0; k < block_sizes.size(); k++)
+	{
+		cost += (unsigned long)(block_sizes[k])*block_sizes[k];
+	}
+	return cost;
+}
+
+unsigned int LatencyPlacementOptimizer::largestBlock(const std::vector<unsigned int>& block_sizes)
+{
+	unsigned int largest = 0;
+	for(unsigned int k = 0; k < block_sizes.size(); k++)
+	{
+		largest = std::max(largest, block_sizes[k]);
+	}
+	return largest;
+}
+
+const std::vector<unsigned int>& LatencyPlacementOptimizer::getLatencyElements() const
+{
+	return latency_elements;
+}
+
+const std::vector<double>& LatencyPlacementOptimizer::getLatencyGains() const
+{
+	return latency_gains;
+}
+
+double LatencyPlacementOptimizer::getMaxLatencyGain() const
+{
+	double gain = 0.0;
+	for(unsigned int i = 0; i < latency_gains.size(); i++)
+	{
+		gain = std::max(gain, latency_gains[i]);
+	}
+	return gain;
+}
+
+unsigned int LatencyPlacementOptimizer::getInitialNumBlocks() const
+{
+	return initial_blocks;
+}
+
+unsigned int LatencyPlacementOptimizer::getFinalNumBlocks() const
+{
+	return final_blocks;
+}
+
+unsigned int LatencyPlacementOptimizer::getInitialLargestBlock() const
+{
+	return initial_largest;
+}
+
+unsigned int LatencyPlacementOptimizer::getFinalLargestBlock() const
+{
+	return final_largest;
+}
+
+unsigned long LatencyPlacementOptimizer::getInitialCost() const
+{
+	return initial_cost;
+}
+
+unsigned long LatencyPlacementOptimizer::getFinalCost() const
+{
+	return final_cost;
+}
+
+int LatencyPlacementOptimizer::applyTo(SystemNetlist& target) const
+{
+	for(unsigned int i = 0; i < latency_elements.size(); i++)
+	{
+		if(latency_elements[i] >= target.getNumElements()) return -1;
+		if(target.getElement(latency_elements[i]).type != SystemNetlist::INDUCTOR) return -1;
+	}
+
+	for(unsigned int i = 0; i < latency_elements.size(); i++)
+	{
+		SystemNetlist::Element& e = target.getElement(latency_elements[i]);
+
+		e.type = SystemNetlist::RL_SWITCH;
+		e.params.resize(2);
+		e.params[1] = NumType(0.0); //(l, r) of RLSwitch; inductance is kept
+	}
+
+	return 0;
+}
+
+const char* LatencyPlacementOptimizer::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	sstrm << "Latency Placement\n\n";
+	sstrm << "time step:            " << dt << "\n";
+	sstrm << "max latency gain:     " << max_latency_gain << "\n\n";
+	sstrm << "                      initial   final\n";
+	sstrm << "blocks:               " << std::setw(7) << initial_blocks << "   " << final_blocks << "\n";
+	sstrm << "largest block:        " << std::setw(7) << initial_largest << "   " << final_largest << "\n";
+	sstrm << "solver mults/step:    " << std::setw(7) << initial_cost << "   " << final_cost << "\n";
+	sstrm << "adder tree depth:     " << std::setw(7) << (initial_largest > 1 ? (unsigned int)std::ceil(std::log(double(initial_largest))/std::log(2.0)) : 0u)
+			<< "   " << (final_largest > 1 ? (unsigned int)std::ceil(std::log(double(final_largest))/std::log(2.0)) : 0u) << "\n\n";
+
+	sstrm << "latency inductors:    " << latency_elements.size() << "\n";
+	for(unsigned int i = 0; i < latency_elements.size(); i++)
+	{
+		const SystemNetlist::Element& e = netlist.getElement(latency_elements[i]);
+		sstrm << "  " << e.name << " (" << e.nodes[0] << "," << e.nodes[1] << "): gain " << latency_gains[i]
+				<< ", est. local error " << 100.0*latency_gains[i]/2.0 << "% per step\n";
+	}
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+} //namespace LBLMC
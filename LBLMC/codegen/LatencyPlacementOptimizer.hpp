@@ -0,0 +1,165 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef LATENCYPLACEMENTOPTIMIZER_HPP
+#define LATENCYPLACEMENTOPTIMIZER_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "LBLMC/comp/ConductanceTriplet.hpp"
+#include "SystemNetlist.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief chooses which inductors of a netlist to model as latency elements to decouple the system
+ *
+ * An inductor stamped as a conductance couples its terminal nodes in G.  Modeled as a latency
+ * element instead (an Euler Forward series RL branch, as RLSwitch, that stamps no conductance), its
+ * current is computed from the previous solution and its terminals are only coupled through source
+ * contributions.  Each latency inductor removes an edge from the conductance graph, and can split a
+ * block of the decomposition (SystemDecomposer) into smaller ones.
+ *
+ * The optimizer greedily picks the inductor whose removal most reduces the largest block, then the
+ * solver cost sum(n_k^2), until no inductor within the accuracy constraint improves either.  A removal that leaves a block without a conductance path to
+ * ground (a singular block) is never chosen.  Being greedy, it will not open a loop of parallel
+ * inductive paths that only decouple when all are removed together.
+ *
+ * The accuracy of a latency inductor is measured by its latency gain
+ *
+ * 	kappa = (dt/L) * (1/g_pos + 1/g_neg)
+ *
+ * where g_pos, g_neg are the conductances to the rest of the system stamped at its terminal nodes
+ * (ground terminals count as 0 in the sum).  Kappa is the fraction of the inductor current the
+ * explicit update corrects per step: the Euler Forward update is unstable for kappa >= 2, and its
+ * local relative error per step is about kappa/2.  Nodes with stiff voltages (large capacitance or
+ * low resistance to ground) give small gains.
+ *
+ * Capacitors are not candidates: the library has no latency capacitor model, as LB-LMC keeps every
+ * capacitor as a conductance stamp.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class LatencyPlacementOptimizer
+{
+private:
+	SystemNetlist netlist; ///< model to place latency elements in
+	NumType dt; ///< simulation time step
+	double max_latency_gain; ///< accuracy constraint: largest latency gain of a chosen inductor
+	std::vector<bool> excluded; ///< per element: true if the element may not be made a latency element
+
+	std::vector<std::vector<ConductanceTriplet> > element_triplets; ///< conductance stamp of each element
+	std::vector<unsigned int> latency_elements; ///< netlist indices of the chosen inductors, in order chosen
+	std::vector<double> latency_gains; ///< latency gain of each chosen inductor when chosen
+
+	unsigned int initial_blocks, final_blocks; ///< number of blocks before/after optimization
+	unsigned int initial_largest, final_largest; ///< largest block dimension before/after optimization
+	unsigned long initial_cost, final_cost; ///< solver multiplies per step, sum(n_k^2), before/after optimization
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param netlist model to place latency elements in; copied
+	 * @param dt simulation time step of the discretized components
+	 * @param max_latency_gain largest latency gain of a chosen inductor; must be below 2 for stability
+	 */
+	LatencyPlacementOptimizer(const SystemNetlist& netlist, NumType dt, double max_latency_gain = 0.1);
+	LatencyPlacementOptimizer(const LatencyPlacementOptimizer& base);
+
+	void reset(const SystemNetlist& netlist, NumType dt, double max_latency_gain = 0.1);
+	void reset(const LatencyPlacementOptimizer& base);
+
+	/**
+	 * prevents or allows an inductor to be chosen as a latency element
+	 * @param index index of the component in the netlist
+	 * @param exclude true to keep the inductor stamped as a conductance
+	 */
+	void setExcluded(unsigned int index, bool exclude = true);
+
+	/**
+	 * chooses the latency inductors
+	 * @return number of inductors chosen, or -1 if the netlist cannot be stamped
+	 */
+	int optimize();
+
+	/**
+	 * @return netlist indices of the chosen inductors, in the order chosen
+	 */
+	const std::vector<unsigned int>& getLatencyElements() const;
+
+	/**
+	 * @return latency gain of each chosen inductor, in order of getLatencyElements()
+	 */
+	const std::vector<double>& getLatencyGains() const;
+
+	/**
+	 * @return largest latency gain of the chosen inductors; 0 if none chosen
+	 */
+	double getMaxLatencyGain() const;
+
+	unsigned int getInitialNumBlocks() const; ///< @return number of blocks of the netlist as given
+	unsigned int getFinalNumBlocks() const; ///< @return number of blocks with the chosen latency inductors
+	unsigned int getInitialLargestBlock() const; ///< @return largest block dimension of the netlist as given
+	unsigned int getFinalLargestBlock() const; ///< @return largest block dimension with the chosen latency inductors
+	unsigned long getInitialCost() const; ///< @return solver multiplies per step, sum(n_k^2), of the netlist as given
+	unsigned long getFinalCost() const; ///< @return solver multiplies per step, sum(n_k^2), with the chosen latency inductors
+
+	/**
+	 * replaces the chosen inductors of a netlist with latency elements
+	 *
+	 * Each chosen inductor becomes a RL_SWITCH element of the same inductance and no resistance.  The
+	 * switch input of these elements must be held closed (true) during simulation.
+	 *
+	 * @param target netlist to modify; normally the netlist given to the optimizer
+	 * @return 0 if successful, -1 if a chosen element of target is not an inductor
+	 */
+	int applyTo(SystemNetlist& target) const;
+
+	/**
+	 * creates a report, as a string, of the chosen latency inductors and their effect
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+private:
+
+	/**
+	 * partitions the nodes into blocks with the conductances of the elements not marked latency
+	 * @param latency per element: true if the element is a latency element (stamps nothing)
+	 * @param block_of stores the block of each zero-based node
+	 * @param block_sizes stores the number of nodes of each block
+	 * @return true if every block has a conductance path to ground
+	 */
+	bool partition(const std::vector<bool>& latency, std::vector<unsigned int>& block_of,
+			std::vector<unsigned int>& block_sizes) const;
+
+	static unsigned long blockCost(const std::vector<unsigned int>& block_sizes);
+	static unsigned int largestBlock(const std::vector<unsigned int>& block_sizes);
+};
+
+} //namespace LBLMC
+
+#endif //LATENCYPLACEMENTOPTIMIZER_HPP
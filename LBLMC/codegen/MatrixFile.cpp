@@ -0,0 +1,241 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "MatrixFile.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace LBLMC
+{
+
+static const char MATRIX_FILE_MAGIC[8] = {'L','B','L','M','C','M','A','T'};
+static const uint32_t MATRIX_FILE_VERSION = 1;
+
+MatrixFile::MatrixFile() :
+	mapping(0), mapping_size(0), header()
+#ifdef _WIN32
+	, file_handle(INVALID_HANDLE_VALUE), map_handle(0)
+#else
+	, file_descriptor(-1)
+#endif
+{
+	//do nothing else
+}
+
+MatrixFile::~MatrixFile()
+{
+	close();
+}
+
+int MatrixFile::open(const char* filename, bool verify_hash)
+{
+	close();
+
+#ifdef _WIN32
+	file_handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if(file_handle == INVALID_HANDLE_VALUE) return -1;
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file_handle, &size) || size.QuadPart < LONGLONG(sizeof(MatrixFileHeader)))
+	{
+		close();
+		return -1;
+	}
+	mapping_size = std::size_t(size.QuadPart);
+
+	map_handle = CreateFileMappingA(file_handle, 0, PAGE_READONLY, 0, 0, 0);
+	if(map_handle == 0)
+	{
+		close();
+		return -1;
+	}
+
+	mapping = static_cast<const unsigned char*>(MapViewOfFile(map_handle, FILE_MAP_READ, 0, 0, 0));
+	if(mapping == 0)
+	{
+		close();
+		return -1;
+	}
+#else
+	file_descriptor = ::open(filename, O_RDONLY);
+	if(file_descriptor < 0) return -1;
+
+	struct stat info;
+	if(fstat(file_descriptor, &info) != 0 || info.st_size < off_t(sizeof(MatrixFileHeader)))
+	{
+		close();
+		return -1;
+	}
+	mapping_size = std::size_t(info.st_size);
+
+	void* map = mmap(0, mapping_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+	if(map == MAP_FAILED)
+	{
+		close();
+		return -1;
+	}
+	mapping = static_cast<const unsigned char*>(map);
+#endif
+
+		//validate header
+
+	std::memcpy(&header, mapping, sizeof(MatrixFileHeader));
+
+		//dimensions of a corrupt header could overflow the size of the data, which then passes the file size check
+
+	const uint64_t max_elements = std::numeric_limits<uint64_t>::max() / sizeof(double);
+
+	if(header.rows != 0 && header.cols > max_elements / header.rows)
+	{
+		close();
+		return -1;
+	}
+
+	const uint64_t bytes = header.rows*header.cols*sizeof(double);
+
+	if(std::memcmp(header.magic, MATRIX_FILE_MAGIC, sizeof(MATRIX_FILE_MAGIC)) != 0 ||
+		header.version != MATRIX_FILE_VERSION ||
+		header.dtype != FLOAT64 ||
+		(header.layout != ROW_MAJOR && header.layout != COL_MAJOR) ||
+		bytes > uint64_t(mapping_size - sizeof(MatrixFileHeader)))
+	{
+		close();
+		return -1;
+	}
+
+	if(verify_hash && hashBytes(mapping + sizeof(MatrixFileHeader), std::size_t(bytes)) != header.hash)
+	{
+		close();
+		return -1;
+	}
+
+	return 0;
+}
+
+void MatrixFile::close()
+{
+#ifdef _WIN32
+	if(mapping != 0) UnmapViewOfFile(mapping);
+	if(map_handle != 0) CloseHandle(map_handle);
+	if(file_handle != INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+	map_handle = 0;
+	file_handle = INVALID_HANDLE_VALUE;
+#else
+	if(mapping != 0) munmap(const_cast<unsigned char*>(mapping), mapping_size);
+	if(file_descriptor >= 0) ::close(file_descriptor);
+	file_descriptor = -1;
+#endif
+
+	mapping = 0;
+	mapping_size = 0;
+	std::memset(&header, 0, sizeof(MatrixFileHeader));
+}
+
+bool MatrixFile::isOpen() const
+{
+	return mapping != 0;
+}
+
+unsigned long MatrixFile::getRows() const
+{
+	return header.rows;
+}
+
+unsigned long MatrixFile::getCols() const
+{
+	return header.cols;
+}
+
+MatrixFile::Layout MatrixFile::getLayout() const
+{
+	return Layout(header.layout);
+}
+
+uint64_t MatrixFile::getHash() const
+{
+	return header.hash;
+}
+
+const double* MatrixFile::data() const
+{
+	if(mapping == 0) return 0;
+
+	return reinterpret_cast<const double*>(mapping + sizeof(MatrixFileHeader));
+}
+
+Eigen::Map<const MatrixRMXd> MatrixFile::asEigen3Map() const
+{
+	if(mapping == 0 || header.layout != ROW_MAJOR) return Eigen::Map<const MatrixRMXd>(0, 0, 0);
+
+	return Eigen::Map<const MatrixRMXd>(data(), header.rows, header.cols);
+}
+
+int MatrixFile::write(const char* filename, const double* data, unsigned long rows, unsigned long cols, Layout layout)
+{
+	const std::size_t bytes = std::size_t(rows)*cols*sizeof(double);
+
+	MatrixFileHeader head;
+	std::memset(&head, 0, sizeof(MatrixFileHeader));
+	std::memcpy(head.magic, MATRIX_FILE_MAGIC, sizeof(MATRIX_FILE_MAGIC));
+	head.version = MATRIX_FILE_VERSION;
+	head.dtype = FLOAT64;
+	head.layout = layout;
+	head.rows = rows;
+	head.cols = cols;
+	head.hash = hashBytes(data, bytes);
+
+	std::FILE* file = std::fopen(filename, "wb");
+	if(file == 0) return -1;
+
+	const bool written =
+		std::fwrite(&head, sizeof(MatrixFileHeader), 1, file) == 1 &&
+		(bytes == 0 || std::fwrite(data, bytes, 1, file) == 1);
+
+	if(std::fclose(file) != 0 || !written) return -1;
+
+	return 0;
+}
+
+uint64_t MatrixFile::hashBytes(const void* data, std::size_t bytes, uint64_t hash)
+{
+	const unsigned char* b = static_cast<const unsigned char*>(data);
+
+	for(std::size_t i = 0; i < bytes; i++)
+	{
+		hash ^= b[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+} //namespace LBLMC
@@ -0,0 +1,160 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef MATRIXFILE_HPP
+#define MATRIXFILE_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include "TBDataTypes.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief header of the LB-LMC binary matrix file format
+ *
+ * A binary matrix file is this 64 byte header followed by the raw matrix entries in native byte
+ * order, so the entries start 64 byte aligned when the file is memory mapped.
+ */
+struct MatrixFileHeader
+{
+	char magic[8]; ///< "LBLMCMAT"
+	uint32_t version; ///< format version; 1
+	uint32_t dtype; ///< entry type; MatrixFile::FLOAT64
+	uint32_t layout; ///< MatrixFile::ROW_MAJOR or MatrixFile::COL_MAJOR
+	uint32_t reserved; ///< zero
+	uint64_t rows; ///< number of rows
+	uint64_t cols; ///< number of columns
+	uint64_t hash; ///< FNV-1a 64 bit hash of the entry bytes
+	uint8_t padding[16]; ///< zero; pads the header to 64 bytes
+};
+
+/**
+ * @brief memory mapped, read-only binary matrix file
+ *
+ * Writing and mapping of the LB-LMC binary matrix format, which replaces text import/export for
+ * large matrices: entries are stored raw, so loading needs no parsing, and a mapped file can be used
+ * without copying (e.g. data() as the A matrix of SystemSolver or the generators).  The header
+ * records dimension, entry type, layout, and a hash of the entries to detect corrupted files.
+ * The hash is computed once when the file is written; opening checks only the header against the
+ * file size, unless the entries are verified on request, as hashing reads the whole file.
+ *
+ * Files are mapped with mmap() on POSIX systems and MapViewOfFile() on Windows.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class MatrixFile
+{
+public:
+
+	enum DataType
+	{
+		FLOAT64 = 1 ///< IEEE 754 double
+	};
+
+	enum Layout
+	{
+		ROW_MAJOR = 0,
+		COL_MAJOR = 1
+	};
+
+private:
+	const unsigned char* mapping; ///< start of the mapped file; 0 if not open
+	std::size_t mapping_size; ///< bytes of the mapped file
+	MatrixFileHeader header;
+
+#ifdef _WIN32
+	void* file_handle;
+	void* map_handle;
+#else
+	int file_descriptor;
+#endif
+
+public:
+
+	MatrixFile();
+
+	/**
+	 * destructor; unmaps the file
+	 */
+	~MatrixFile();
+
+	/**
+	 * maps a binary matrix file into memory
+	 * @param filename filename of the binary matrix file
+	 * @param verify_hash true to also check the entries against the hash of the header, which reads the
+	 * whole file
+	 * @return 0 if successful, -1 if fails to open/map the file or the file is not a valid matrix file
+	 */
+	int open(const char* filename, bool verify_hash = false);
+
+	/**
+	 * unmaps the file
+	 */
+	void close();
+
+	bool isOpen() const; ///< @return true if a file is mapped
+	unsigned long getRows() const; ///< @return number of rows of the mapped matrix
+	unsigned long getCols() const; ///< @return number of columns of the mapped matrix
+	Layout getLayout() const; ///< @return storage order of the mapped matrix
+	uint64_t getHash() const; ///< @return hash of the entries recorded in the header
+
+	/**
+	 * @return pointer to the mapped entries; valid until the file is closed
+	 */
+	const double* data() const;
+
+	/**
+	 * @return the mapped row-major matrix as a Eigen3 map, without copying; empty if not row-major
+	 */
+	Eigen::Map<const MatrixRMXd> asEigen3Map() const;
+
+	/**
+	 * writes a matrix to a binary matrix file
+	 * @param filename filename of the binary matrix file
+	 * @param data matrix entries in given layout
+	 * @param rows number of rows
+	 * @param cols number of columns
+	 * @param layout storage order of data
+	 * @return 0 if successful, -1 if fails to open/write to file
+	 */
+	static int write(const char* filename, const double* data, unsigned long rows, unsigned long cols,
+		Layout layout = ROW_MAJOR);
+
+	/**
+	 * computes the FNV-1a 64 bit hash of a block of bytes
+	 * @param data bytes to hash
+	 * @param bytes number of bytes
+	 * @param hash hash to continue from, to hash several blocks as one
+	 * @return hash of the bytes
+	 */
+	static uint64_t hashBytes(const void* data, std::size_t bytes, uint64_t hash = 14695981039346656037ULL);
+
+private:
+
+	MatrixFile(const MatrixFile& base); ///< not copyable; owns a mapping
+	MatrixFile& operator=(const MatrixFile& base);
+};
+
+} //namespace LBLMC
+
+#endif //MATRIXFILE_HPP
@@ -0,0 +1,298 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "ModelBuildCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define LMC_GETPID _getpid
+#else
+#include <unistd.h>
+#define LMC_GETPID getpid
+#endif
+
+namespace LBLMC
+{
+
+ModelBuildCache::ModelBuildCache(const char* directory) :
+	directory(), num_hits(0), num_misses(0)
+{
+	reset(directory);
+}
+
+ModelBuildCache::ModelBuildCache(const ModelBuildCache& base) :
+	directory(base.directory), num_hits(base.num_hits), num_misses(base.num_misses)
+{
+	//do nothing else
+}
+
+void ModelBuildCache::reset(const char* directory)
+{
+	this->directory = directory;
+
+	if(!this->directory.empty())
+	{
+		const char last = this->directory[this->directory.size()-1];
+		if(last != '/' && last != '\\') this->directory += '/';
+	}
+
+	num_hits = 0;
+	num_misses = 0;
+}
+
+void ModelBuildCache::reset(const ModelBuildCache& base)
+{
+	directory = base.directory;
+	num_hits = base.num_hits;
+	num_misses = base.num_misses;
+}
+
+uint64_t ModelBuildCache::computeKey(SystemConductance& conductance, const SystemSourceVector& sources, NumType dt)
+{
+	const unsigned int dim = conductance.getDimension();
+
+	uint64_t key = MatrixFile::hashBytes(&dim, sizeof(dim));
+	key = MatrixFile::hashBytes(conductance.asPointer(), std::size_t(dim)*dim*sizeof(double), key);
+
+		//source incidence, in source index order, with the values of constant sources
+
+	const std::map<long, std::vector<long> >& nodes = sources.asMap();
+	std::map<long, std::vector<long> >::const_iterator iter = nodes.begin();
+	for(; iter != nodes.end(); iter++)
+	{
+		const long index = iter->first;
+		const long terminals[2] = {iter->second[0], iter->second[1]};
+		const double constant = sources.isConstantSource(index) ? double(sources.getConstantSourceValue(index)) : 0.0;
+		const char is_constant = sources.isConstantSource(index) ? 1 : 0;
+
+		key = MatrixFile::hashBytes(&index, sizeof(index), key);
+		key = MatrixFile::hashBytes(terminals, sizeof(terminals), key);
+		key = MatrixFile::hashBytes(&is_constant, sizeof(is_constant), key);
+		key = MatrixFile::hashBytes(&constant, sizeof(constant), key);
+	}
+
+	const double time_step = double(dt);
+	key = MatrixFile::hashBytes(&time_step, sizeof(time_step), key);
+
+	const char* num_type = LMC_NUM_TYPE_STRING;
+	key = MatrixFile::hashBytes(num_type, std::strlen(num_type), key);
+
+#if defined LMC_USE_FIXED_POINT_TYPES
+		//the type string is the same for every fixed-point resolution, which changes the generated code
+	const int fixed_point_bits[2] = {NUM_FIXED_POINT_SIZE, NUM_FIXED_POINT_FRAC};
+	key = MatrixFile::hashBytes(fixed_point_bits, sizeof(fixed_point_bits), key);
+#endif
+
+	return key;
+}
+
+std::string ModelBuildCache::getItemFilename(uint64_t key, const char* item) const
+{
+	return directory + keyAsString(key) + "_" + item;
+}
+
+bool ModelBuildCache::contains(uint64_t key, const char* item) const
+{
+	std::FILE* file = std::fopen(getItemFilename(key, item).c_str(), "rb");
+	if(file == 0) return false;
+
+	std::fclose(file);
+	return true;
+}
+
+int ModelBuildCache::storeMatrix(uint64_t key, const char* item, const double* data, unsigned long rows, unsigned long cols)
+{
+	const std::string filename = getItemFilename(key, item);
+
+	std::stringstream temporary;
+	temporary << filename << ".tmp" << LMC_GETPID();
+
+	if(MatrixFile::write(temporary.str().c_str(), data, rows, cols, MatrixFile::ROW_MAJOR) != 0)
+	{
+		std::remove(temporary.str().c_str());
+		return -1;
+	}
+
+	return commitFile(temporary.str(), filename);
+}
+
+int ModelBuildCache::loadMatrix(uint64_t key, const char* item, MatrixFile& file)
+{
+		//only the header and size are checked; hashing the entries would read the whole item on every hit
+
+	if(file.open(getItemFilename(key, item).c_str()) != 0)
+	{
+		num_misses++;
+		return -1;
+	}
+
+	num_hits++;
+	return 0;
+}
+
+int ModelBuildCache::storeText(uint64_t key, const char* item, const std::string& text)
+{
+	const std::string filename = getItemFilename(key, item);
+
+	std::stringstream temporary;
+	temporary << filename << ".tmp" << LMC_GETPID();
+
+	std::FILE* file = std::fopen(temporary.str().c_str(), "wb");
+	if(file == 0) return -1;
+
+	const bool written = text.empty() || (std::fwrite(text.data(), text.size(), 1, file) == 1);
+
+	if(std::fclose(file) != 0 || !written)
+	{
+		std::remove(temporary.str().c_str());
+		return -1;
+	}
+
+	return commitFile(temporary.str(), filename);
+}
+
+int ModelBuildCache::loadText(uint64_t key, const char* item, std::string& text)
+{
+	std::FILE* file = std::fopen(getItemFilename(key, item).c_str(), "rb");
+	if(file == 0)
+	{
+		num_misses++;
+		return -1;
+	}
+
+	text.clear();
+
+	char chunk[65536];
+	std::size_t length;
+	while((length = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+	{
+		text.append(chunk, length);
+	}
+	std::fclose(file);
+
+	num_hits++;
+	return 0;
+}
+
+int ModelBuildCache::invertOrLoad(SystemConductance& conductance, uint64_t key)
+{
+	const unsigned int dim = conductance.getDimension();
+	const uint64_t conductance_hash = MatrixFile::hashBytes(conductance.asPointer(), std::size_t(dim)*dim*sizeof(double));
+
+		//the entry is accepted only if it was made from this G, and its A still inverts G
+
+	MatrixFile file;
+	std::string info;
+	if(loadMatrix(key, "A", file) == 0 && file.getRows() == dim && file.getCols() == dim && loadText(key, "A_info", info) == 0)
+	{
+		std::stringstream sstrm(info);
+		std::string stored_hash;
+		double condition = 0.0;
+		std::string method;
+		sstrm >> stored_hash >> condition >> method;
+
+		if(!sstrm.fail() && stored_hash == keyAsString(conductance_hash) &&
+			isInverse(conductance.asEigen3Matrix(), file.data()))
+		{
+			conductance.assignInverse(file.data(), condition, method.c_str());
+			return 1;
+		}
+	}
+
+	conductance.invertSelf();
+
+	std::stringstream entry_info;
+	entry_info << keyAsString(conductance_hash) << " " << std::setprecision(17) << conductance.getConditionEstimate() << " " << conductance.getInversionMethod() << "\n";
+
+	if(storeText(key, "A_info", entry_info.str()) == 0)
+	{
+		storeMatrix(key, "A", conductance.asPointer(), dim, dim);
+	}
+
+	return 0;
+}
+
+unsigned long ModelBuildCache::getNumHits() const
+{
+	return num_hits;
+}
+
+unsigned long ModelBuildCache::getNumMisses() const
+{
+	return num_misses;
+}
+
+std::string ModelBuildCache::keyAsString(uint64_t key)
+{
+	std::stringstream sstrm;
+
+	sstrm << std::hex << std::setw(8) << std::setfill('0') << (unsigned long)(key >> 32);
+	sstrm << std::hex << std::setw(8) << std::setfill('0') << (unsigned long)(key & 0xFFFFFFFFUL);
+
+	return sstrm.str();
+}
+
+bool ModelBuildCache::isInverse(const MatrixRMXd& conductance, const double* inverse)
+{
+	const Eigen::Index dim = conductance.rows();
+	if(dim == 0) return true;
+
+	Eigen::Map<const MatrixRMXd> A(inverse, dim, dim);
+
+		//probe G*(A*v) = v with one fixed vector; residual relative to |G|*|A| as in WoodburyInverseUpdater
+
+	const double tolerance = 1e-9;
+
+	Eigen::VectorXd v(dim);
+	for(Eigen::Index i = 0; i < dim; i++) v(i) = 1.0 + double(i % 7)/7.0;
+
+	const Eigen::VectorXd r = conductance*(A*v) - v;
+
+	const double scale = conductance.cwiseAbs().rowwise().sum().maxCoeff() * A.cwiseAbs().rowwise().sum().maxCoeff() * v.cwiseAbs().maxCoeff();
+	const double residual = r.cwiseAbs().maxCoeff();
+
+	return (residual == residual) && residual <= tolerance*scale;
+}
+
+int ModelBuildCache::commitFile(const std::string& temporary, const std::string& filename)
+{
+	if(std::rename(temporary.c_str(), filename.c_str()) != 0)
+	{
+		std::remove(temporary.c_str());
+
+			//renaming over an existing file fails on some systems; the entry is complete if it exists
+
+		std::FILE* file = std::fopen(filename.c_str(), "rb");
+		if(file == 0) return -1;
+		std::fclose(file);
+	}
+
+	return 0;
+}
+
+} //namespace LBLMC
@@ -0,0 +1,157 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef MODELBUILDCACHE_HPP
+#define MODELBUILDCACHE_HPP
+
+#include <stdint.h>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemConductance.hpp"
+#include "SystemSourceVector.hpp"
+#include "MatrixFile.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief persistent, content-addressed on-disk cache of model build products
+ *
+ * Building a model stamps the components, inverts G, and generates solver code, which for large
+ * models takes minutes although the result only depends on the stamped system.  This cache stores
+ * the build products in a directory under a key computed from the content of the system:
+ *
+ * 	key = hash( stamped G, source incidence and constant sources, dt, NumType )
+ *
+ * where a fixed-point NumType includes its width and fractional bits.
+ *
+ * Items of an entry are files named "<key>_<item>" in the cache directory:  matrices (e.g. the
+ * inverted conductance matrix) in the binary MatrixFile format, loaded by memory mapping, and text
+ * (e.g. generated solver code).  Files are written under a temporary name and renamed, so
+ * concurrent jobs sharing a cache directory never read a partially written item.
+ *
+ * The cache does not evict entries; clear the directory to reclaim space.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class ModelBuildCache
+{
+private:
+	std::string directory; ///< cache directory, with trailing separator
+	unsigned long num_hits; ///< statistics: number of items found
+	unsigned long num_misses; ///< statistics: number of items not found
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param directory existing directory to store the cache entries in
+	 */
+	ModelBuildCache(const char* directory);
+	ModelBuildCache(const ModelBuildCache& base);
+
+	void reset(const char* directory);
+	void reset(const ModelBuildCache& base);
+
+	/**
+	 * computes the cache key of a stamped system
+	 * @param conductance stamped (not inverted) conductance matrix
+	 * @param sources stamped source vector, with constant sources marked
+	 * @param dt simulation time step the system was stamped with
+	 * @return 64 bit key of the system
+	 */
+	static uint64_t computeKey(SystemConductance& conductance, const SystemSourceVector& sources, NumType dt);
+
+	/**
+	 * @param key cache key
+	 * @param item name of the item of the entry
+	 * @return filename of the item in the cache directory
+	 */
+	std::string getItemFilename(uint64_t key, const char* item) const;
+
+	/**
+	 * @param key cache key
+	 * @param item name of the item of the entry
+	 * @return true if the item is in the cache
+	 */
+	bool contains(uint64_t key, const char* item) const;
+
+	/**
+	 * stores a row-major matrix item in the cache
+	 * @return 0 if successful, -1 if fails to write the item
+	 */
+	int storeMatrix(uint64_t key, const char* item, const double* data, unsigned long rows, unsigned long cols);
+
+	/**
+	 * maps a matrix item of the cache; checks its header and size, not the hash of its entries
+	 * @param file matrix file to map the item with
+	 * @return 0 if found, -1 if not in the cache or its header is corrupted
+	 */
+	int loadMatrix(uint64_t key, const char* item, MatrixFile& file);
+
+	/**
+	 * stores a text item, e.g. generated code, in the cache
+	 * @return 0 if successful, -1 if fails to write the item
+	 */
+	int storeText(uint64_t key, const char* item, const std::string& text);
+
+	/**
+	 * loads a text item of the cache
+	 * @param text string to store the text to
+	 * @return 0 if found, -1 if not in the cache
+	 */
+	int loadText(uint64_t key, const char* item, std::string& text);
+
+	/**
+	 * inverts a stamped conductance matrix, or loads its inverse from the cache
+	 *
+	 * On a miss the matrix is inverted with invertSelf() and the inverse stored as item "A", with item
+	 * "A_info" recording the hash of the stamped matrix and the condition estimate and method of the
+	 * inversion.  A cached inverse is used only if the hash matches the given matrix and a G*A*v = v
+	 * probe passes; otherwise the matrix is inverted and the entry replaced.  On a hit the condition
+	 * estimate and inversion method of the conductance are restored from the entry.
+	 *
+	 * @param conductance stamped conductance matrix; replaced with its inverse
+	 * @param key cache key of the system, from computeKey()
+	 * @return 1 if loaded from the cache, 0 if inverted
+	 * @throws std::runtime_error if matrix is singular (non-invertible)
+	 */
+	int invertOrLoad(SystemConductance& conductance, uint64_t key);
+
+	unsigned long getNumHits() const; ///< @return number of items found in the cache
+	unsigned long getNumMisses() const; ///< @return number of items not found in the cache
+
+	/**
+	 * @param key cache key
+	 * @return key as 16 hexadecimal digits
+	 */
+	static std::string keyAsString(uint64_t key);
+
+private:
+
+	static bool isInverse(const MatrixRMXd& conductance, const double* inverse);
+	int commitFile(const std::string& temporary, const std::string& filename);
+};
+
+} //namespace LBLMC
+
+#endif //MODELBUILDCACHE_HPP
@@ -0,0 +1,500 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "NodeReordering.hpp"
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <cmath>
+
+namespace LBLMC
+{
+
+NodeReordering::NodeReordering(SystemConductance& conductance, Method method) :
+	method(method), dimension(0), old_of_new(), new_of_old(),
+	bandwidth_before(0), bandwidth_after(0), profile_before(0), profile_after(0)
+{
+	reset(conductance, method);
+}
+
+NodeReordering::NodeReordering(SparseSystemConductance& conductance, Method method) :
+	method(method), dimension(0), old_of_new(), new_of_old(),
+	bandwidth_before(0), bandwidth_after(0), profile_before(0), profile_after(0)
+{
+	reset(conductance, method);
+}
+
+NodeReordering::NodeReordering(const NodeReordering& base) :
+	method(base.method), dimension(base.dimension), old_of_new(base.old_of_new), new_of_old(base.new_of_old),
+	bandwidth_before(base.bandwidth_before), bandwidth_after(base.bandwidth_after),
+	profile_before(base.profile_before), profile_after(base.profile_after)
+{
+	//do nothing else
+}
+
+void NodeReordering::reset(SystemConductance& conductance, Method method)
+{
+	this->method = method;
+	dimension = conductance.getDimension();
+	const MatrixRMXd& G = conductance.asEigen3Matrix();
+
+		//ordering is computed on the symmetric pattern of G + G^T
+
+	std::vector<std::vector<unsigned int> > adjacency(dimension);
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(unsigned int c = r+1; c < dimension; c++)
+		{
+			if(G(r,c) != 0.0 || G(c,r) != 0.0)
+			{
+				adjacency[r].push_back(c);
+				adjacency[c].push_back(r);
+			}
+		}
+	}
+
+	order(adjacency);
+}
+
+void NodeReordering::reset(SparseSystemConductance& conductance, Method method)
+{
+	this->method = method;
+	dimension = conductance.getDimension();
+	const SparseMatrixRMXd& G = conductance.asEigen3SparseMatrix();
+
+	std::vector<std::vector<unsigned int> > adjacency(dimension);
+	for(int r = 0; r < G.outerSize(); r++)
+	{
+		for(SparseMatrixRMXd::InnerIterator it(G, r); it; ++it)
+		{
+			const unsigned int c = it.col();
+			if(c == unsigned(r)) continue;
+
+			adjacency[r].push_back(c);
+			adjacency[c].push_back(r);
+		}
+	}
+
+	for(unsigned int n = 0; n < dimension; n++)
+	{
+		std::sort(adjacency[n].begin(), adjacency[n].end());
+		adjacency[n].erase(std::unique(adjacency[n].begin(), adjacency[n].end()), adjacency[n].end());
+	}
+
+	order(adjacency);
+}
+
+void NodeReordering::reset(const NodeReordering& base)
+{
+	method = base.method;
+	dimension = base.dimension;
+	old_of_new = base.old_of_new;
+	new_of_old = base.new_of_old;
+	bandwidth_before = base.bandwidth_before;
+	bandwidth_after = base.bandwidth_after;
+	profile_before = base.profile_before;
+	profile_after = base.profile_after;
+}
+
+void NodeReordering::order(const std::vector<std::vector<unsigned int> >& adjacency)
+{
+	old_of_new.clear();
+	old_of_new.reserve(dimension);
+
+	switch(method)
+	{
+	case REVERSE_CUTHILL_MCKEE:
+		orderReverseCuthillMcKee(adjacency);
+		break;
+	case APPROXIMATE_MINIMUM_DEGREE:
+		orderApproximateMinimumDegree(adjacency);
+		break;
+	default:
+		for(unsigned int n = 0; n < dimension; n++) old_of_new.push_back(n);
+		break;
+	}
+
+	new_of_old.assign(dimension, 0);
+	for(unsigned int p = 0; p < dimension; p++)
+	{
+		new_of_old[old_of_new[p]] = p;
+	}
+
+	std::vector<unsigned int> identity(dimension);
+	for(unsigned int n = 0; n < dimension; n++) identity[n] = n;
+
+	measure(adjacency, identity, bandwidth_before, profile_before);
+	measure(adjacency, new_of_old, bandwidth_after, profile_after);
+}
+
+/**
+ * collects the connected component of the graph containing start, in breadth-first order, and the
+ * level (distance from start) of each of its nodes
+ */
+static void breadthFirst(const std::vector<std::vector<unsigned int> >& adjacency, unsigned int start,
+		std::vector<unsigned int>& visit_order, std::vector<unsigned int>& level)
+{
+	const unsigned int unvisited = ~0u;
+
+	for(unsigned int i = 0; i < visit_order.size(); i++) level[visit_order[i]] = unvisited;
+
+	visit_order.clear();
+	visit_order.push_back(start);
+	level[start] = 0;
+
+	for(unsigned int q = 0; q < visit_order.size(); q++)
+	{
+		const std::vector<unsigned int>& neighbours = adjacency[visit_order[q]];
+		for(unsigned int i = 0; i < neighbours.size(); i++)
+		{
+			if(level[neighbours[i]] != unvisited) continue;
+			level[neighbours[i]] = level[visit_order[q]] + 1;
+			visit_order.push_back(neighbours[i]);
+		}
+	}
+}
+
+void NodeReordering::orderReverseCuthillMcKee(const std::vector<std::vector<unsigned int> >& adjacency)
+{
+	const unsigned int unvisited = ~0u;
+
+	std::vector<bool> numbered(dimension, false);
+	std::vector<unsigned int> level(dimension, unvisited);
+	std::vector<unsigned int> component;
+	std::vector<std::pair<unsigned int, unsigned int> > candidates;
+
+	for(unsigned int seed = 0; seed < dimension; seed++)
+	{
+		if(numbered[seed]) continue;
+
+			//pseudo-peripheral start node of the component (George-Liu): restart from a minimum degree
+			//node of the last level while the eccentricity grows
+
+		breadthFirst(adjacency, seed, component, level);
+
+		unsigned int start = seed;
+		for(unsigned int i = 0; i < component.size(); i++)
+		{
+			if(adjacency[component[i]].size() < adjacency[start].size()) start = component[i];
+		}
+
+		breadthFirst(adjacency, start, component, level);
+		unsigned int eccentricity = level[component.back()];
+
+		while(true)
+		{
+			unsigned int next = component.back();
+			for(unsigned int i = component.size(); i-- > 0 && level[component[i]] == eccentricity; )
+			{
+				if(adjacency[component[i]].size() < adjacency[next].size()) next = component[i];
+			}
+
+			breadthFirst(adjacency, next, component, level);
+			if(level[component.back()] <= eccentricity) break;
+
+			start = next;
+			eccentricity = level[component.back()];
+		}
+
+			//Cuthill-McKee: breadth-first from start, visiting neighbours by increasing degree
+
+		const unsigned int first = old_of_new.size();
+		old_of_new.push_back(start);
+		numbered[start] = true;
+
+		for(unsigned int q = first; q < old_of_new.size(); q++)
+		{
+			const std::vector<unsigned int>& neighbours = adjacency[old_of_new[q]];
+
+			candidates.clear();
+			for(unsigned int i = 0; i < neighbours.size(); i++)
+			{
+				if(numbered[neighbours[i]]) continue;
+				candidates.push_back(std::make_pair((unsigned int)(adjacency[neighbours[i]].size()), neighbours[i]));
+				numbered[neighbours[i]] = true;
+			}
+
+			std::sort(candidates.begin(), candidates.end());
+			for(unsigned int i = 0; i < candidates.size(); i++)
+			{
+				old_of_new.push_back(candidates[i].second);
+			}
+		}
+
+			//reversed within the component, so components stay in order of their lowest node
+
+		std::reverse(old_of_new.begin() + first, old_of_new.end());
+
+		for(unsigned int i = 0; i < component.size(); i++) level[component[i]] = unvisited;
+		component.clear();
+	}
+}
+
+void NodeReordering::orderApproximateMinimumDegree(const std::vector<std::vector<unsigned int> >& adjacency)
+{
+	const unsigned int unvisited = ~0u;
+
+	std::vector<unsigned int> level(dimension, unvisited);
+	std::vector<unsigned int> component;
+	std::vector<unsigned int> local(dimension, 0);
+
+	for(unsigned int seed = 0; seed < dimension; seed++)
+	{
+		if(level[seed] != unvisited) continue;
+
+		breadthFirst(adjacency, seed, component, level);
+		std::sort(component.begin(), component.end());
+
+			//Eigen's AMD on the symmetric pattern of the component
+
+		for(unsigned int i = 0; i < component.size(); i++) local[component[i]] = i;
+
+		std::vector<Eigen::Triplet<double, int> > pattern;
+		for(unsigned int i = 0; i < component.size(); i++)
+		{
+			pattern.push_back(Eigen::Triplet<double, int>(i, i, 1.0));
+			const std::vector<unsigned int>& neighbours = adjacency[component[i]];
+			for(unsigned int j = 0; j < neighbours.size(); j++)
+			{
+				pattern.push_back(Eigen::Triplet<double, int>(i, local[neighbours[j]], 1.0));
+			}
+		}
+
+		Eigen::SparseMatrix<double, Eigen::ColMajor, int> P(component.size(), component.size());
+		P.setFromTriplets(pattern.begin(), pattern.end());
+
+		Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int> permutation;
+		Eigen::AMDOrdering<int> amd;
+		amd(P, permutation);
+
+			//indices of the ordering are the local old node at each new position
+
+		for(unsigned int i = 0; i < component.size(); i++)
+		{
+			old_of_new.push_back(component[permutation.indices()(i)]);
+		}
+
+			//levels are left set to mark the component as ordered
+		component.clear();
+	}
+}
+
+void NodeReordering::measure(const std::vector<std::vector<unsigned int> >& adjacency, const std::vector<unsigned int>& new_of_old,
+		unsigned int& bandwidth, unsigned long& profile)
+{
+	const unsigned int dim = adjacency.size();
+
+	std::vector<unsigned int> first_column(dim);
+	for(unsigned int n = 0; n < dim; n++) first_column[new_of_old[n]] = new_of_old[n];
+
+	bandwidth = 0;
+	for(unsigned int n = 0; n < dim; n++)
+	{
+		const unsigned int r = new_of_old[n];
+		for(unsigned int i = 0; i < adjacency[n].size(); i++)
+		{
+			const unsigned int c = new_of_old[adjacency[n][i]];
+			bandwidth = std::max(bandwidth, (c > r) ? (c - r) : (r - c));
+			first_column[r] = std::min(first_column[r], c);
+		}
+	}
+
+	profile = 0;
+	for(unsigned int r = 0; r < dim; r++)
+	{
+		profile += r - first_column[r];
+	}
+}
+
+NodeReordering::Method NodeReordering::getMethod() const
+{
+	return method;
+}
+
+unsigned int NodeReordering::getDimension() const
+{
+	return dimension;
+}
+
+unsigned int NodeReordering::toNew(unsigned int node) const
+{
+	if(node == 0 || node > dimension) return 0;
+	return new_of_old[node-1] + 1;
+}
+
+unsigned int NodeReordering::toOld(unsigned int node) const
+{
+	if(node == 0 || node > dimension) return 0;
+	return old_of_new[node-1] + 1;
+}
+
+std::vector<unsigned int> NodeReordering::toNew(const std::vector<unsigned int>& nodes) const
+{
+	std::vector<unsigned int> mapped(nodes.size());
+	for(unsigned int i = 0; i < nodes.size(); i++)
+	{
+		mapped[i] = toNew(nodes[i]);
+	}
+	return mapped;
+}
+
+const std::vector<unsigned int>& NodeReordering::getPermutation() const
+{
+	return old_of_new;
+}
+
+unsigned int NodeReordering::getBandwidthBefore() const
+{
+	return bandwidth_before;
+}
+
+unsigned int NodeReordering::getBandwidthAfter() const
+{
+	return bandwidth_after;
+}
+
+unsigned long NodeReordering::getProfileBefore() const
+{
+	return profile_before;
+}
+
+unsigned long NodeReordering::getProfileAfter() const
+{
+	return profile_after;
+}
+
+int NodeReordering::applyTo(SystemConductance& conductance) const
+{
+	if(conductance.getDimension() != dimension) return -1;
+
+	MatrixRMXd& G = conductance.asEigen3Matrix();
+	MatrixRMXd reordered(dimension, dimension);
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(unsigned int c = 0; c < dimension; c++)
+		{
+			reordered(r,c) = G(old_of_new[r], old_of_new[c]);
+		}
+	}
+
+	G.swap(reordered);
+
+	return 0;
+}
+
+int NodeReordering::applyTo(SparseSystemConductance& conductance) const
+{
+	if(conductance.getDimension() != dimension) return -1;
+
+	SparseMatrixRMXd& G = conductance.asEigen3SparseMatrix();
+
+	std::vector<Eigen::Triplet<double> > entries;
+	entries.reserve(G.nonZeros());
+	for(int r = 0; r < G.outerSize(); r++)
+	{
+		for(SparseMatrixRMXd::InnerIterator it(G, r); it; ++it)
+		{
+			entries.push_back(Eigen::Triplet<double>(new_of_old[r], new_of_old[it.col()], it.value()));
+		}
+	}
+
+	SparseMatrixRMXd reordered(dimension, dimension);
+	reordered.setFromTriplets(entries.begin(), entries.end());
+	G.swap(reordered);
+
+	return 0;
+}
+
+int NodeReordering::applyTo(SystemSourceVector& sources) const
+{
+	if(sources.getDimension() != dimension) return -1;
+
+		//re-inserting the sources in index order gives them the same indices
+
+	SystemSourceVector reordered(dimension);
+
+	const std::map<long, std::vector<long> >& nodes = sources.asMap();
+	for(std::map<long, std::vector<long> >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
+	{
+		reordered.insertSource(toNew(it->second[0]), toNew(it->second[1]));
+
+		if(sources.isConstantSource(it->first))
+		{
+			reordered.setConstantSource(it->first, sources.getConstantSourceValue(it->first));
+		}
+	}
+
+	sources.reset(reordered);
+
+	return 0;
+}
+
+int NodeReordering::applyTo(SystemNetlist& netlist) const
+{
+	if(netlist.getDimension() != dimension) return -1;
+
+	for(unsigned int i = 0; i < netlist.getNumElements(); i++)
+	{
+		std::vector<unsigned int>& nodes = netlist.getElement(i).nodes;
+		for(unsigned int t = 0; t < nodes.size(); t++)
+		{
+			nodes[t] = toNew(nodes[t]);
+		}
+	}
+
+	return 0;
+}
+
+void NodeReordering::permuteVector(const NumType* old_vector, NumType* new_vector) const
+{
+	for(unsigned int p = 0; p < dimension; p++)
+	{
+		new_vector[p] = old_vector[old_of_new[p]];
+	}
+}
+
+void NodeReordering::restoreVector(const NumType* new_vector, NumType* old_vector) const
+{
+	for(unsigned int p = 0; p < dimension; p++)
+	{
+		old_vector[old_of_new[p]] = new_vector[p];
+	}
+}
+
+const char* NodeReordering::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	const char* names[] = {"natural", "reverse Cuthill-McKee", "approximate minimum degree"};
+
+	sstrm << "Node Reordering\n\n";
+	sstrm << "method:    " << names[method] << "\n";
+	sstrm << "dimension: " << dimension << "\n\n";
+	sstrm << "bandwidth: " << bandwidth_before << "  ->  " << bandwidth_after << "\n";
+	sstrm << "profile:   " << profile_before << "  ->  " << profile_after << "\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+} //namespace LBLMC
@@ -0,0 +1,202 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef NODEREORDERING_HPP
+#define NODEREORDERING_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemConductance.hpp"
+#include "SparseSystemConductance.hpp"
+#include "SystemSourceVector.hpp"
+#include "SystemNetlist.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief renumbers the nodes of a system model to reduce the bandwidth or factorization fill of G
+ *
+ * Node numbers come from whoever wrote the netlist, so the stamped conductance matrix has arbitrary
+ * bandwidth.  This class computes a fill-reducing ordering from the non-zero pattern of G, and applies
+ * it consistently to the conductance matrix, the source vector, and the netlist:
+ *
+ * 	- REVERSE_CUTHILL_MCKEE gives a banded matrix; good for cache locality and band/profile solvers
+ * 	- APPROXIMATE_MINIMUM_DEGREE minimizes the fill of sparse Cholesky/LU factors
+ *
+ * Each connected component of the conductance graph is numbered contiguously, so block structure
+ * (see SystemDecomposer) is kept.  The source indices are not changed, so the b_components layout of
+ * the components stays the same; only the node each source is stamped to moves.
+ *
+ * Node numbers are 1-based with 0 as ground, as in the component stamp methods.  Old node n moves to
+ * new node toNew(n); solutions and probe nodes of the reordered system are mapped back with toOld()
+ * or restoreVector().
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class NodeReordering
+{
+public:
+
+	/**
+	 * ordering methods
+	 */
+	enum Method
+	{
+		NATURAL, ///< keep the given numbering
+		REVERSE_CUTHILL_MCKEE, ///< bandwidth reduction
+		APPROXIMATE_MINIMUM_DEGREE ///< fill reduction for sparse factorization
+	};
+
+private:
+	Method method;
+	unsigned int dimension; ///< number of nodes, excluding ground
+	std::vector<unsigned int> old_of_new; ///< zero-based old node at each zero-based new position
+	std::vector<unsigned int> new_of_old; ///< zero-based new position of each zero-based old node
+	unsigned int bandwidth_before, bandwidth_after; ///< largest |row - col| of a non-zero entry
+	unsigned long profile_before, profile_after; ///< sum over rows of the distance from the diagonal to the first non-zero entry
+
+public:
+
+	/**
+	 * dense ordering constructor
+	 * @param conductance conductance matrix G of the system to compute the ordering from
+	 * @param method ordering method
+	 */
+	NodeReordering(SystemConductance& conductance, Method method = REVERSE_CUTHILL_MCKEE);
+
+	/**
+	 * sparse ordering constructor
+	 * @param conductance sparse conductance matrix G of the system to compute the ordering from
+	 * @param method ordering method
+	 */
+	NodeReordering(SparseSystemConductance& conductance, Method method = REVERSE_CUTHILL_MCKEE);
+
+	NodeReordering(const NodeReordering& base);
+
+	void reset(SystemConductance& conductance, Method method = REVERSE_CUTHILL_MCKEE);
+	void reset(SparseSystemConductance& conductance, Method method = REVERSE_CUTHILL_MCKEE);
+	void reset(const NodeReordering& base);
+
+	Method getMethod() const; ///< @return ordering method used
+	unsigned int getDimension() const; ///< @return number of nodes, excluding ground
+
+	/**
+	 * @param node old node number; 0 is ground
+	 * @return new node number; 0 for ground
+	 */
+	unsigned int toNew(unsigned int node) const;
+
+	/**
+	 * @param node new node number; 0 is ground
+	 * @return old node number; 0 for ground
+	 */
+	unsigned int toOld(unsigned int node) const;
+
+	/**
+	 * maps a list of old node numbers, such as probe nodes, to new node numbers
+	 * @param nodes old node numbers; 0 is ground
+	 * @return new node numbers, in the same order
+	 */
+	std::vector<unsigned int> toNew(const std::vector<unsigned int>& nodes) const;
+
+	/**
+	 * @return permutation where element p is the zero-based old solution index placed at new index p
+	 */
+	const std::vector<unsigned int>& getPermutation() const;
+
+	unsigned int getBandwidthBefore() const; ///< @return bandwidth of G in the old numbering
+	unsigned int getBandwidthAfter() const; ///< @return bandwidth of G in the new numbering
+	unsigned long getProfileBefore() const; ///< @return profile (envelope size) of G in the old numbering
+	unsigned long getProfileAfter() const; ///< @return profile (envelope size) of G in the new numbering
+
+	/**
+	 * renumbers the rows and columns of a conductance matrix
+	 * @param conductance conductance matrix in the old numbering, of the ordering's dimension
+	 * @return 0 if successful, -1 if the dimension does not match
+	 */
+	int applyTo(SystemConductance& conductance) const;
+
+	/**
+	 * renumbers the rows and columns of a sparse conductance matrix; pending triplets are compressed
+	 * @param conductance sparse conductance matrix in the old numbering, of the ordering's dimension
+	 * @return 0 if successful, -1 if the dimension does not match
+	 */
+	int applyTo(SparseSystemConductance& conductance) const;
+
+	/**
+	 * renumbers the nodes of the sources of a source vector
+	 *
+	 * The source indices and constant source markings are kept.
+	 *
+	 * @param sources source vector in the old numbering, of the ordering's dimension
+	 * @return 0 if successful, -1 if the dimension does not match
+	 */
+	int applyTo(SystemSourceVector& sources) const;
+
+	/**
+	 * renumbers the terminal nodes of the components of a netlist
+	 *
+	 * A renumbered netlist stamps the same system as applying the ordering to its stamped conductance
+	 * matrix and source vector.
+	 *
+	 * @param netlist netlist in the old numbering, of the ordering's dimension
+	 * @return 0 if successful, -1 if the dimension does not match
+	 */
+	int applyTo(SystemNetlist& netlist) const;
+
+	/**
+	 * reorders a vector, such as b, from the old numbering to the new
+	 * @param old_vector vector in the old numbering, of the ordering's dimension
+	 * @param new_vector array to store the vector in the new numbering to
+	 */
+	void permuteVector(const NumType* old_vector, NumType* new_vector) const;
+
+	/**
+	 * reorders a vector, such as the solution x, from the new numbering back to the old
+	 * @param new_vector vector in the new numbering, of the ordering's dimension
+	 * @param old_vector array to store the vector in the old numbering to
+	 */
+	void restoreVector(const NumType* new_vector, NumType* old_vector) const;
+
+	/**
+	 * creates a report, as a string, of the ordering and its effect on the matrix structure
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+private:
+
+	void order(const std::vector<std::vector<unsigned int> >& adjacency);
+	void orderReverseCuthillMcKee(const std::vector<std::vector<unsigned int> >& adjacency);
+	void orderApproximateMinimumDegree(const std::vector<std::vector<unsigned int> >& adjacency);
+
+	static void measure(const std::vector<std::vector<unsigned int> >& adjacency, const std::vector<unsigned int>& new_of_old,
+			unsigned int& bandwidth, unsigned long& profile);
+};
+
+} //namespace LBLMC
+
+#endif //NODEREORDERING_HPP
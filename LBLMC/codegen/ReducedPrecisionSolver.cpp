@@ -0,0 +1,353 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "ReducedPrecisionSolver.hpp"
+#include <map>
+#include <algorithm>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+
+namespace LBLMC
+{
+
+namespace
+{
+
+struct WidenValue
+{
+	template<typename T>
+	double operator()(T value) const { return double(value); }
+};
+
+struct WidenBFloat16
+{
+	double operator()(unsigned short bits) const { return double(ReducedPrecisionSolver::fromBFloat16(bits)); }
+};
+
+	//dot product of a stored row with b in double.  Eight independent partial sums let the additions
+	//of consecutive coefficients proceed without waiting on each other, and vectorize.
+
+template<typename T, typename Widen>
+double rowProduct(const T* a, const double* b, unsigned int n, Widen widen)
+{
+	double acc[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+	unsigned int j = 0;
+	for(; j + 8 <= n; j += 8)
+	{
+		for(unsigned int k = 0; k < 8; k++) acc[k] += widen(a[j+k])*b[j+k];
+	}
+
+	double sum = 0.0;
+	for(; j < n; j++) sum += widen(a[j])*b[j];
+
+	return sum + ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+} //namespace
+
+ReducedPrecisionSolver::ReducedPrecisionSolver(const NumType* A, unsigned int dimension, Format format) :
+	dimension(0), format(format), a_single(), a_bfloat16(), a_int16(), row_scale(), row_error(), norm_inf(0.0), bd()
+{
+	reset(A, dimension, format);
+}
+
+ReducedPrecisionSolver::ReducedPrecisionSolver(SystemResistance& A, Format format) :
+	dimension(0), format(format), a_single(), a_bfloat16(), a_int16(), row_scale(), row_error(), norm_inf(0.0), bd()
+{
+	reset(A, format);
+}
+
+ReducedPrecisionSolver::ReducedPrecisionSolver(const ReducedPrecisionSolver& base) :
+	dimension(base.dimension), format(base.format), a_single(base.a_single), a_bfloat16(base.a_bfloat16),
+	a_int16(base.a_int16), row_scale(base.row_scale), row_error(base.row_error), norm_inf(base.norm_inf), bd(base.bd)
+{
+	//do nothing else
+}
+
+void ReducedPrecisionSolver::reset(const NumType* A, unsigned int dimension, Format format)
+{
+	allocate(dimension, format);
+
+	std::vector<double> row(dimension);
+	for(unsigned int i = 0; i < dimension; i++)
+	{
+		for(unsigned int j = 0; j < dimension; j++)
+		{
+			row[j] = double(A[(unsigned long)dimension*i + j]);
+		}
+		storeRow(i, row);
+	}
+}
+
+void ReducedPrecisionSolver::reset(SystemResistance& A, Format format)
+{
+	const unsigned int dimension = A.getDimension();
+	const double* a = A.asPointer();
+
+	allocate(dimension, format);
+
+	std::vector<double> row(dimension);
+	for(unsigned int i = 0; i < dimension; i++)
+	{
+		std::memcpy(&row[0], &a[(unsigned long)dimension*i], dimension*sizeof(double));
+		storeRow(i, row);
+	}
+}
+
+void ReducedPrecisionSolver::reset(const ReducedPrecisionSolver& base)
+{
+	dimension = base.dimension;
+	format = base.format;
+	a_single = base.a_single;
+	a_bfloat16 = base.a_bfloat16;
+	a_int16 = base.a_int16;
+	row_scale = base.row_scale;
+	row_error = base.row_error;
+	norm_inf = base.norm_inf;
+	bd = base.bd;
+}
+
+void ReducedPrecisionSolver::solve(const NumType* b, NumType* x) const
+{
+	const unsigned int n = dimension;
+
+	for(unsigned int j = 0; j < n; j++)
+	{
+		bd[j] = double(b[j]);
+	}
+
+	const double* bp = &bd[0];
+
+	if(format == SINGLE)
+	{
+		const float* a = &a_single[0];
+		for(unsigned int i = 0; i < n; i++, a += n)
+		{
+			x[i] = NumType(rowProduct(a, bp, n, WidenValue()));
+		}
+	}
+	else if(format == BFLOAT16)
+	{
+		const unsigned short* a = &a_bfloat16[0];
+		for(unsigned int i = 0; i < n; i++, a += n)
+		{
+			x[i] = NumType(rowProduct(a, bp, n, WidenBFloat16()));
+		}
+	}
+	else
+	{
+			//the row scale is applied once to the sum of the row
+
+		const short* a = &a_int16[0];
+		for(unsigned int i = 0; i < n; i++, a += n)
+		{
+			x[i] = NumType(row_scale[i]*rowProduct(a, bp, n, WidenValue()));
+		}
+	}
+}
+
+void ReducedPrecisionSolver::solve(const SystemSourceVector& sources, const NumType* b_components, NumType* x) const
+{
+	std::vector<NumType> b(dimension, NumType(0.0));
+
+	const std::map<long, std::vector<long> >& nodes = sources.asMap();
+	for(std::map<long, std::vector<long> >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
+	{
+		if(it->second[0] != 0) b[it->second[0]-1] += b_components[it->first-1];
+		if(it->second[1] != 0) b[it->second[1]-1] -= b_components[it->first-1];
+	}
+
+	solve(&b[0], x);
+}
+
+double ReducedPrecisionSolver::getErrorBound(const NumType* b) const
+{
+	double b_max = 0.0;
+	for(unsigned int j = 0; j < dimension; j++)
+	{
+		b_max = std::max(b_max, std::fabs(double(b[j])));
+	}
+
+	return getErrorBound()*b_max;
+}
+
+double ReducedPrecisionSolver::getErrorBound() const
+{
+	double bound = 0.0;
+	for(unsigned int i = 0; i < dimension; i++)
+	{
+		bound = std::max(bound, row_error[i]);
+	}
+
+	return bound;
+}
+
+double ReducedPrecisionSolver::getRelativeErrorBound() const
+{
+	if(norm_inf == 0.0) return 0.0;
+
+	return getErrorBound()/norm_inf;
+}
+
+const std::vector<double>& ReducedPrecisionSolver::getRowErrors() const
+{
+	return row_error;
+}
+
+unsigned int ReducedPrecisionSolver::getDimension() const
+{
+	return dimension;
+}
+
+ReducedPrecisionSolver::Format ReducedPrecisionSolver::getFormat() const
+{
+	return format;
+}
+
+unsigned long ReducedPrecisionSolver::getStorageBytes() const
+{
+	return a_single.size()*sizeof(float) + a_bfloat16.size()*sizeof(unsigned short) +
+		a_int16.size()*sizeof(short) + row_scale.size()*sizeof(double);
+}
+
+const char* ReducedPrecisionSolver::asString(std::string& buffer)
+{
+	const char* names[] = {"single", "bfloat16", "scaled int16"};
+	const double double_bytes = double(dimension)*double(dimension)*sizeof(double);
+
+	std::stringstream sstrm;
+
+	sstrm << "Reduced Precision Solver\n\n";
+	sstrm << "dimension:            " << dimension << "\n";
+	sstrm << "format:               " << names[format] << "\n";
+	sstrm << "storage bytes:        " << getStorageBytes() << "\n";
+	sstrm << "relative to double:   " << (double_bytes == 0.0 ? 0.0 : double(getStorageBytes())/double_bytes) << "\n\n";
+	sstrm << "||A||_inf:            " << norm_inf << "\n";
+	sstrm << "error bound:          " << getErrorBound() << " * max|b|\n";
+	sstrm << "relative error bound: " << getRelativeErrorBound() << "\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+unsigned short ReducedPrecisionSolver::toBFloat16(float value)
+{
+	unsigned int bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	if((bits & 0x7fffffffu) > 0x7f800000u) return (unsigned short)((bits >> 16) | 0x0040u); //NaN stays NaN
+
+	bits += 0x7fffu + ((bits >> 16) & 1u);
+
+	return (unsigned short)(bits >> 16);
+}
+
+float ReducedPrecisionSolver::fromBFloat16(unsigned short bits)
+{
+	const unsigned int wide = (unsigned int)(bits) << 16;
+
+	float value;
+	std::memcpy(&value, &wide, sizeof(value));
+
+	return value;
+}
+
+void ReducedPrecisionSolver::allocate(unsigned int dimension, Format format)
+{
+	this->dimension = dimension;
+	this->format = format;
+
+	const unsigned long entries = (unsigned long)dimension*dimension;
+
+	a_single.clear();
+	a_bfloat16.clear();
+	a_int16.clear();
+	row_scale.clear();
+
+	if(format == SINGLE) a_single.resize(entries);
+	else if(format == BFLOAT16) a_bfloat16.resize(entries);
+	else
+	{
+		a_int16.resize(entries);
+		row_scale.resize(dimension);
+	}
+
+	row_error.assign(dimension, 0.0);
+	norm_inf = 0.0;
+	bd.assign(dimension, 0.0);
+}
+
+void ReducedPrecisionSolver::storeRow(unsigned int i, const std::vector<double>& row)
+{
+	const unsigned long offset = (unsigned long)dimension*i;
+
+	double row_sum = 0.0;
+	double error = 0.0;
+
+	if(format == SINGLE)
+	{
+		for(unsigned int j = 0; j < dimension; j++)
+		{
+			a_single[offset+j] = float(row[j]);
+			error += std::fabs(row[j] - double(a_single[offset+j]));
+			row_sum += std::fabs(row[j]);
+		}
+	}
+	else if(format == BFLOAT16)
+	{
+		for(unsigned int j = 0; j < dimension; j++)
+		{
+			a_bfloat16[offset+j] = toBFloat16(float(row[j]));
+			error += std::fabs(row[j] - double(fromBFloat16(a_bfloat16[offset+j])));
+			row_sum += std::fabs(row[j]);
+		}
+	}
+	else
+	{
+		double largest = 0.0;
+		for(unsigned int j = 0; j < dimension; j++)
+		{
+			largest = std::max(largest, std::fabs(row[j]));
+		}
+
+		const double scale = (largest == 0.0) ? 1.0 : largest/32767.0;
+		row_scale[i] = scale;
+
+		for(unsigned int j = 0; j < dimension; j++)
+		{
+			double q = std::floor(row[j]/scale + 0.5);
+			if(q > 32767.0) q = 32767.0;
+			if(q < -32767.0) q = -32767.0;
+
+			a_int16[offset+j] = short(q);
+			error += std::fabs(row[j] - scale*q);
+			row_sum += std::fabs(row[j]);
+		}
+	}
+
+	row_error[i] = error;
+	norm_inf = std::max(norm_inf, row_sum);
+}
+
+} //namespace LBLMC
@@ -0,0 +1,186 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef REDUCEDPRECISIONSOLVER_HPP
+#define REDUCEDPRECISIONSOLVER_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemConductance.hpp"
+#include "SystemSourceVector.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief solves x = A*b at runtime with A stored in reduced precision and accumulated in double
+ *
+ * Once the inverted conductance matrix A = G^-1 no longer fits in cache, the per-step product x = A*b
+ * is bound by memory bandwidth: every coefficient of A is read once per step.  Storing A in fewer
+ * bytes reads proportionally less.  Three storage formats are available:
+ *
+ * 	SINGLE: IEEE single precision, 4 bytes; about 7 significant digits.
+ *
+ * 	BFLOAT16: the upper half of single precision, 2 bytes; the range of single precision with about
+ * 	3 significant digits.
+ *
+ * 	SCALED_INT16: 16-bit integer with a double scale factor per row (max |A(i,:)| / 32767), 2 bytes;
+ * 	a resolution of 1/32767 of the largest coefficient of the row, which suits rows of A whose
+ * 	coefficients are of similar size.
+ *
+ * The products and sums are computed in double; only the storage of A is rounded.  The rounding
+ * error of each row, e_i = sum_j |A(i,j) - A~(i,j)|, is kept at construction, so the error of each
+ * solve against the double solve is bounded by
+ *
+ * 	|x_i - x~_i| <= e_i * max_j |b_j|
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class ReducedPrecisionSolver
+{
+public:
+
+	/**
+	 * storage format of the coefficients of A
+	 */
+	enum Format
+	{
+		SINGLE,
+		BFLOAT16,
+		SCALED_INT16
+	};
+
+private:
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	Format format;
+
+	std::vector<float> a_single; ///< SINGLE: row-major coefficients
+	std::vector<unsigned short> a_bfloat16; ///< BFLOAT16: row-major coefficients, upper 16 bits of single
+	std::vector<short> a_int16; ///< SCALED_INT16: row-major coefficients over the row scale
+	std::vector<double> row_scale; ///< SCALED_INT16: scale factor of each row
+
+	std::vector<double> row_error; ///< sum_j |A(i,j) - A~(i,j)| of each row
+	double norm_inf; ///< max_i sum_j |A(i,j)| of the double matrix
+
+	mutable std::vector<double> bd; ///< right hand side converted to double
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param A the inverted conductance matrix ( A = G^-1 of Gx=b ), row-major
+	 * @param dimension number of solutions in the system Gx=b
+	 * @param format storage format of the coefficients of A
+	 */
+	ReducedPrecisionSolver(const NumType* A, unsigned int dimension, Format format = SINGLE);
+
+	/**
+	 * parameter constructor
+	 * @param A the inverted conductance matrix ( A = G^-1 of Gx=b )
+	 * @param format storage format of the coefficients of A
+	 */
+	ReducedPrecisionSolver(SystemResistance& A, Format format = SINGLE);
+
+	ReducedPrecisionSolver(const ReducedPrecisionSolver& base);
+
+	void reset(const NumType* A, unsigned int dimension, Format format = SINGLE);
+	void reset(SystemResistance& A, Format format = SINGLE);
+	void reset(const ReducedPrecisionSolver& base);
+
+	/**
+	 * computes x = A~*b, with A~ the stored reduced precision A, accumulating in double
+	 * @param b right hand side of the system, of the system dimension
+	 * @param x array to store the solution to, of the system dimension
+	 */
+	void solve(const NumType* b, NumType* x) const;
+
+	/**
+	 * solves the system for the present source contributions, aggregating b from them first
+	 * @param sources source vector of the system
+	 * @param b_components source contributions of the components; b_components[index-1] for source index
+	 * @param x array to store the solution to, of the system dimension
+	 */
+	void solve(const SystemSourceVector& sources, const NumType* b_components, NumType* x) const;
+
+	/**
+	 * bounds the error of solve(b, x) against the double precision product A*b
+	 * @param b right hand side of the system, of the system dimension
+	 * @return bound on max_i |x_i - x~_i|
+	 */
+	double getErrorBound(const NumType* b) const;
+
+	/**
+	 * @return bound on max_i |x_i - x~_i| / max_j |b_j|, the infinity norm of the rounding error of A
+	 */
+	double getErrorBound() const;
+
+	/**
+	 * @return getErrorBound() relative to the infinity norm of A
+	 */
+	double getRelativeErrorBound() const;
+
+	/**
+	 * @return rounding error sum_j |A(i,j) - A~(i,j)| of each row i
+	 */
+	const std::vector<double>& getRowErrors() const;
+
+	unsigned int getDimension() const; ///< @return number of solutions in the system
+	Format getFormat() const; ///< @return storage format of the coefficients of A
+
+	/**
+	 * @return bytes of A read per solve, including row scale factors
+	 */
+	unsigned long getStorageBytes() const;
+
+	/**
+	 * creates a report, as a string, of the storage and error bounds
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+	/**
+	 * rounds a single precision value to the nearest bfloat16, ties to even
+	 * @param value value to round
+	 * @return bits of the bfloat16 value
+	 */
+	static unsigned short toBFloat16(float value);
+
+	/**
+	 * @param bits bits of a bfloat16 value
+	 * @return the bfloat16 value as single precision
+	 */
+	static float fromBFloat16(unsigned short bits);
+
+private:
+
+	void allocate(unsigned int dimension, Format format);
+
+		/// rounds row i of A into the storage format and keeps its rounding error
+	void storeRow(unsigned int i, const std::vector<double>& row);
+};
+
+} //namespace LBLMC
+
+#endif //REDUCEDPRECISIONSOLVER_HPP
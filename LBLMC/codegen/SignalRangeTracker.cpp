@@ -0,0 +1,318 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "SignalRangeTracker.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace LBLMC
+{
+
+SignalRangeTracker::SignalRangeTracker(unsigned int guard_bits, unsigned int max_word_bits) :
+	names(), min_values(), max_values(), min_magnitudes(), samples(),
+	guard_bits(guard_bits), max_word_bits(max_word_bits)
+{
+	//do nothing else
+}
+
+SignalRangeTracker::SignalRangeTracker(const SignalRangeTracker& base) :
+	names(base.names), min_values(base.min_values), max_values(base.max_values),
+	min_magnitudes(base.min_magnitudes), samples(base.samples),
+	guard_bits(base.guard_bits), max_word_bits(base.max_word_bits)
+{
+	//do nothing else
+}
+
+void SignalRangeTracker::reset()
+{
+	names.clear();
+	min_values.clear();
+	max_values.clear();
+	min_magnitudes.clear();
+	samples.clear();
+}
+
+void SignalRangeTracker::clearRanges()
+{
+	for(unsigned int i = 0; i < names.size(); i++)
+	{
+		min_values[i] = 0.0;
+		max_values[i] = 0.0;
+		min_magnitudes[i] = 0.0;
+		samples[i] = 0;
+	}
+}
+
+unsigned int SignalRangeTracker::addSignal(const char* name)
+{
+	names.push_back(name);
+	min_values.push_back(0.0);
+	max_values.push_back(0.0);
+	min_magnitudes.push_back(0.0);
+	samples.push_back(0);
+
+	return names.size()-1;
+}
+
+unsigned int SignalRangeTracker::addSignalArray(const char* prefix, unsigned int length)
+{
+	unsigned int first = names.size();
+
+	for(unsigned int i = 0; i < length; i++)
+	{
+		std::stringstream sstrm;
+		sstrm << prefix << "_" << i;
+		addSignal(sstrm.str().c_str());
+	}
+
+	return first;
+}
+
+void SignalRangeTracker::record(unsigned int index, NumType value)
+{
+	const double v = double(value);
+	const double mag = std::fabs(v);
+
+	if(samples[index] == 0)
+	{
+		min_values[index] = v;
+		max_values[index] = v;
+	}
+	else
+	{
+		if(v < min_values[index]) min_values[index] = v;
+		if(v > max_values[index]) max_values[index] = v;
+	}
+
+	if( mag != 0.0 && (min_magnitudes[index] == 0.0 || mag < min_magnitudes[index]) )
+	{
+		min_magnitudes[index] = mag;
+	}
+
+	++samples[index];
+}
+
+void SignalRangeTracker::recordArray(unsigned int first, const NumType* values, unsigned int length)
+{
+	for(unsigned int i = 0; i < length; i++)
+	{
+		record(first+i, values[i]);
+	}
+}
+
+unsigned int SignalRangeTracker::getNumSignals() const
+{
+	return names.size();
+}
+
+const std::string& SignalRangeTracker::getName(unsigned int index) const
+{
+	return names[index];
+}
+
+double SignalRangeTracker::getMinimum(unsigned int index) const
+{
+	return min_values[index];
+}
+
+double SignalRangeTracker::getMaximum(unsigned int index) const
+{
+	return max_values[index];
+}
+
+double SignalRangeTracker::getMinimumMagnitude(unsigned int index) const
+{
+	return min_magnitudes[index];
+}
+
+int SignalRangeTracker::proposeFormat(unsigned int index, double abs_error_target, unsigned int& word_bits,
+		unsigned int& int_bits, double rel_error_target) const
+{
+	const double max_mag = std::max(std::fabs(min_values[index]), std::fabs(max_values[index]));
+
+	double error_target = abs_error_target;
+	if( rel_error_target > 0.0 && min_magnitudes[index] > 0.0 )
+	{
+		error_target = std::min(error_target, rel_error_target*min_magnitudes[index]);
+	}
+
+		//signed range of ap_fixed<W,I> is [-2^(I-1), 2^(I-1)), so one bit over magnitude bits for sign
+	int ibits = 1;
+	if(max_mag > 0.0)
+	{
+		ibits = int(std::floor(std::log(max_mag)/std::log(2.0))) + 2;
+		if(ibits < 1) ibits = 1;
+	}
+	ibits += guard_bits;
+
+		//rounding error is at most half an LSB: 2^-(F+1) <= error_target
+	int fbits = int(std::ceil(-std::log(error_target)/std::log(2.0))) - 1;
+	if(fbits < 0) fbits = 0;
+
+	int ret = 0;
+	if( (unsigned int)(ibits + fbits) > max_word_bits )
+	{
+		ret = -1;
+		fbits = int(max_word_bits) - ibits;
+		if(fbits < 0) fbits = 0;
+	}
+
+	int_bits = ibits;
+	word_bits = ibits + fbits;
+
+	return ret;
+}
+
+const char* SignalRangeTracker::asString(std::string& buffer, double abs_error_target, double rel_error_target) const
+{
+	std::stringstream sstrm;
+
+	sstrm << std::setprecision(6) << std::scientific;
+
+	unsigned int total_bits = 0;
+
+	for(unsigned int i = 0; i < names.size(); i++)
+	{
+		unsigned int w, ib;
+		int ret = proposeFormat(i, abs_error_target, w, ib, rel_error_target);
+		total_bits += w;
+
+		sstrm << names[i] << ": min " << min_values[i] << ", max " << max_values[i]
+			  << ", min |v| " << min_magnitudes[i] << ", samples " << samples[i]
+			  << " -> ap_fixed<" << w << "," << ib << ">";
+
+		if(ret) sstrm << " (clamped to max word size)";
+
+		sstrm << "\n";
+	}
+
+	sstrm << "total bits: " << total_bits << " vs " << names.size()*NUM_FIXED_POINT_SIZE
+		  << " with global ap_fixed<" << NUM_FIXED_POINT_SIZE << "," << NUM_FIXED_POINT_INT << ">\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+int SignalRangeTracker::exportAsCSV(const char* filename, double abs_error_target, double rel_error_target) const
+{
+	std::fstream file;
+
+	try
+	{
+		file.open(filename, std::fstream::out | std::fstream::trunc);
+		if(file.fail()) return -1;
+	}
+	catch(...)
+	{
+		return -1;
+	}
+
+	file << std::setprecision(16);
+	file << std::scientific;
+
+	file << "signal, min, max, min_magnitude, samples, word_bits, int_bits\n";
+
+	for(unsigned int i = 0; i < names.size(); i++)
+	{
+		unsigned int w, ib;
+		proposeFormat(i, abs_error_target, w, ib, rel_error_target);
+
+		file << names[i] << ", " << min_values[i] << ", " << max_values[i] << ", " << min_magnitudes[i]
+			 << ", " << samples[i] << ", " << w << ", " << ib << "\n";
+	}
+	file << std::flush;
+
+	file.close();
+
+	return 0;
+}
+
+int SignalRangeTracker::exportAsCHeader(const char* filename, double abs_error_target, double rel_error_target,
+		const char* type_prefix) const
+{
+	std::fstream file;
+
+	std::string fname = filename;
+	fname += ".hpp";
+
+	try
+	{
+		file.open(fname.c_str(), std::fstream::out | std::fstream::trunc);
+		if(file.fail()) return -1;
+	}
+	catch(...)
+	{
+		return -1;
+	}
+
+	std::string guard = filename;
+	for(unsigned int i = 0; i < guard.size(); i++)
+	{
+		char c = guard[i];
+		if( !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) ) guard[i] = '_';
+	}
+
+	file <<
+			"/**\n"
+			" *\n"
+			" * LBLMC Vivado HLS Simulation Engine for FPGA Designs\n"
+			" *\n"
+			" * Auto-generated by SignalRangeTracker Object\n"
+			" *\n"
+			" * Fixed-point formats proposed from recorded signal ranges\n"
+			" *\n"
+			" */\n\n";
+
+	file << "#ifndef " << guard << "_HPP" << "\n";
+	file << "#define " << guard << "_HPP" << "\n";
+
+	file << "\n#include \"LBLMC/DataTypes.hpp\"\n\n";
+
+	for(unsigned int i = 0; i < names.size(); i++)
+	{
+		unsigned int w, ib;
+		proposeFormat(i, abs_error_target, w, ib, rel_error_target);
+
+		std::string tname = names[i];
+		for(unsigned int k = 0; k < tname.size(); k++)
+		{
+			char c = tname[k];
+			if( !((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_') ) tname[k] = '_';
+		}
+
+		file << "typedef ap_fixed<" << w << ", " << ib << ", AP_RND> " << type_prefix << tname << "_t;"
+			 << "\t// min " << min_values[i] << ", max " << max_values[i] << "\n";
+	}
+
+	file << "\n#endif";
+
+	file << std::flush;
+
+	file.close();
+
+	return 0;
+}
+
+} //namespace LBLMC
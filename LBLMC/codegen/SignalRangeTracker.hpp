@@ -0,0 +1,220 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SIGNALRANGETRACKER_HPP
+#define SIGNALRANGETRACKER_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+
+/**
+ * instrumentation hooks for offline runs that record signal values into a SignalRangeTracker
+ *
+ * These macros only do work when LMC_RANGE_TRACKING_MODE is defined in Params.hpp, so testbenches
+ * can leave them in place without cost in normal offline simulation.
+ */
+#ifdef LMC_RANGE_TRACKING_MODE
+#define LMC_TRACK_RANGE(tracker, index, value) (tracker).record((index), (value))
+#define LMC_TRACK_RANGE_ARRAY(tracker, first, values, length) (tracker).recordArray((first), (values), (length))
+#else
+#define LMC_TRACK_RANGE(tracker, index, value) ((void)0)
+#define LMC_TRACK_RANGE_ARRAY(tracker, first, values, length) ((void)0)
+#endif
+
+namespace LBLMC
+{
+
+/**
+ * @brief tracks the value ranges of simulation signals to propose fixed-point formats per signal
+ *
+ * The globals NUM_FIXED_POINT_SIZE and NUM_FIXED_POINT_INT size every signal of a model for the
+ * widest one.  This class is used in an instrumented offline run to record the minimum, maximum,
+ * and smallest non-zero magnitude of each signal of interest (component states, b_components
+ * entries, solution x entries, etc.).  From the recorded ranges, a fixed-point format
+ * ap_fixed<W,I> is proposed for each signal such that it does not overflow and its rounding error
+ * stays within a given error target.
+ *
+ * Typical usage:
+ * 	SignalRangeTracker tracker;
+ * 	unsigned int x_idx = tracker.addSignalArray("x", dimension);
+ * 	unsigned int b_idx = tracker.addSignalArray("b_components", num_sources);
+ * 	...
+ * 	//each time step
+ * 	LMC_TRACK_RANGE_ARRAY(tracker, x_idx, x, dimension);
+ * 	LMC_TRACK_RANGE_ARRAY(tracker, b_idx, b_components, num_sources);
+ * 	...
+ * 	tracker.exportAsCHeader("model_formats", 1.0e-6);
+ *
+ * Proposed integer bits I include the sign bit, following the ap_fixed convention.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class SignalRangeTracker
+{
+private:
+	std::vector<std::string> names; ///< names of the tracked signals
+	std::vector<double> min_values; ///< minimum recorded value per signal
+	std::vector<double> max_values; ///< maximum recorded value per signal
+	std::vector<double> min_magnitudes; ///< smallest recorded non-zero magnitude per signal; zero if none recorded
+	std::vector<unsigned long> samples; ///< number of recorded values per signal
+	unsigned int guard_bits; ///< extra integer bits added to proposed formats as overflow headroom
+	unsigned int max_word_bits; ///< upper limit on proposed word size in bits
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param guard_bits extra integer bits added to proposed formats as overflow headroom; defaults to 1
+	 * @param max_word_bits upper limit on proposed word size in bits; defaults to 72
+	 */
+	SignalRangeTracker(unsigned int guard_bits = 1, unsigned int max_word_bits = 72);
+
+	/**
+	 * copy constructor
+	 * @param base object to copy from
+	 */
+	SignalRangeTracker(const SignalRangeTracker& base);
+
+	/**
+	 * clears all tracked signals and their recorded ranges
+	 */
+	void reset();
+
+	/**
+	 * clears the recorded ranges of all tracked signals, keeping the signals themselves
+	 */
+	void clearRanges();
+
+	/**
+	 * adds a signal to be tracked
+	 * @param name name of the signal
+	 * @return index of the signal used with record()
+	 */
+	unsigned int addSignal(const char* name);
+
+	/**
+	 * adds an array of signals to be tracked, named "<prefix>_<i>"
+	 * @param prefix name prefix of the signals
+	 * @param length number of signals in the array
+	 * @return index of first signal of array used with record() and recordArray()
+	 */
+	unsigned int addSignalArray(const char* prefix, unsigned int length);
+
+	/**
+	 * records a value of a tracked signal
+	 * @param index index of the signal
+	 * @param value present value of the signal
+	 */
+	void record(unsigned int index, NumType value);
+
+	/**
+	 * records values of an array of tracked signals
+	 * @param first index of first signal of the array
+	 * @param values present values of the signals
+	 * @param length number of values to record
+	 */
+	void recordArray(unsigned int first, const NumType* values, unsigned int length);
+
+	/**
+	 * @return number of tracked signals
+	 */
+	unsigned int getNumSignals() const;
+
+	/**
+	 * @param index index of the signal
+	 * @return name of the signal
+	 */
+	const std::string& getName(unsigned int index) const;
+
+	/**
+	 * @param index index of the signal
+	 * @return minimum recorded value of the signal; zero if nothing recorded
+	 */
+	double getMinimum(unsigned int index) const;
+
+	/**
+	 * @param index index of the signal
+	 * @return maximum recorded value of the signal; zero if nothing recorded
+	 */
+	double getMaximum(unsigned int index) const;
+
+	/**
+	 * @param index index of the signal
+	 * @return smallest recorded non-zero magnitude of the signal; zero if none recorded
+	 */
+	double getMinimumMagnitude(unsigned int index) const;
+
+	/**
+	 * proposes a fixed-point format ap_fixed<word_bits,int_bits> for a tracked signal
+	 *
+	 * The integer bits are sized to hold the recorded range plus guard bits.  The fractional bits
+	 * are sized so the rounding error (half of the LSB) is within the error target.  When a
+	 * relative error target is given, the target used is the lesser of the absolute target and
+	 * the relative target scaled by the smallest non-zero magnitude recorded for the signal.
+	 *
+	 * @param index index of the signal
+	 * @param abs_error_target maximum absolute rounding error allowed for the signal; must be > 0
+	 * @param word_bits stores the proposed word size in bits
+	 * @param int_bits stores the proposed number of integer bits (including sign)
+	 * @param rel_error_target maximum rounding error relative to smallest non-zero magnitude; 0 disables
+	 * @return 0 if successful, -1 if the format would exceed the maximum word size (the format is then clamped)
+	 */
+	int proposeFormat(unsigned int index, double abs_error_target, unsigned int& word_bits, unsigned int& int_bits,
+			double rel_error_target = 0.0) const;
+
+	/**
+	 * creates a table, as a string, of recorded ranges and proposed formats of tracked signals
+	 * @param buffer string that will store the table
+	 * @param abs_error_target maximum absolute rounding error allowed for each signal
+	 * @param rel_error_target maximum rounding error relative to smallest non-zero magnitude; 0 disables
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer, double abs_error_target, double rel_error_target = 0.0) const;
+
+	/**
+	 * exports recorded ranges and proposed formats of tracked signals to a CSV text file
+	 * @param filename filename of the text file
+	 * @param abs_error_target maximum absolute rounding error allowed for each signal
+	 * @param rel_error_target maximum rounding error relative to smallest non-zero magnitude; 0 disables
+	 * @return 0 if successful, -1 if fails to open/write to file
+	 */
+	int exportAsCSV(const char* filename, double abs_error_target, double rel_error_target = 0.0) const;
+
+	/**
+	 * exports the proposed formats as a C/C++ header of ap_fixed typedefs, one per tracked signal
+	 *
+	 * Each typedef is named "<type_prefix><signal name>_t" with non-identifier characters of the
+	 * signal name replaced by underscores.
+	 *
+	 * @param filename filename of the header file, without file extension; the actual filename will be "<filename>.hpp"
+	 * @param abs_error_target maximum absolute rounding error allowed for each signal
+	 * @param rel_error_target maximum rounding error relative to smallest non-zero magnitude; 0 disables
+	 * @param type_prefix prefix of the typedef names
+	 * @return 0 if successful, -1 if fails to open/write to file
+	 */
+	int exportAsCHeader(const char* filename, double abs_error_target, double rel_error_target = 0.0,
+			const char* type_prefix = "") const;
+};
+
+} //namespace LBLMC
+
+#endif //SIGNALRANGETRACKER_HPP
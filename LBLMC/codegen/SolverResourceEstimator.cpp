@@ -0,0 +1,365 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "SolverResourceEstimator.hpp"
+
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+
+namespace LBLMC
+{
+
+//ceiling of log2(n) for n >= 1; depth of a balanced tree of n leaves
+static unsigned int treeDepth(unsigned int n)
+{
+	unsigned int depth = 0;
+	unsigned int width = 1;
+	while(width < n)
+	{
+		width <<= 1;
+		++depth;
+	}
+	return depth;
+}
+
+SolverResourceEstimator::SolverResourceEstimator(const NumType* A, unsigned int dimension, SystemSourceVector& sources,
+		NumType zero_bound) :
+	dimension(dimension), num_sources(sources.getNumSources()), row_terms(dimension, 0), b_terms(dimension, 0),
+	components(), op_kind(DOUBLE_FLOAT), word_bits(NUM_FIXED_POINT_SIZE), mul_ns(0.0), add_ns(0.0),
+	dsp_per_mul(0), dsp_per_add(0), clock_ns(10.0), timestep(LMC_TIMESTEP),
+	est_multipliers(0), est_adders(0), est_tree_depth(0), est_latency_cycles(0), est_latency_ns(0.0), est_dsps(0)
+{
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(unsigned int c = 0; c < dimension; c++)
+		{
+			if( A[dimension*r+c] < zero_bound && A[dimension*r+c] > -zero_bound ) continue;
+			++row_terms[r];
+		}
+
+		b_terms[r] = sources.asVector(r+1).size();
+	}
+
+#if defined LMC_USE_FIXED_POINT_TYPES
+	setNumType(FIXED_POINT, NUM_FIXED_POINT_SIZE);
+#elif defined LMC_USE_HALF_FLOAT_POINT_TYPES
+	setNumType(HALF_FLOAT);
+#elif defined LMC_USE_SINGLE_FLOAT_POINT_TYPES
+	setNumType(SINGLE_FLOAT);
+#else
+	setNumType(DOUBLE_FLOAT);
+#endif
+}
+
+SolverResourceEstimator::SolverResourceEstimator(const SolverResourceEstimator& base) :
+	dimension(base.dimension), num_sources(base.num_sources), row_terms(base.row_terms), b_terms(base.b_terms),
+	components(base.components), op_kind(base.op_kind), word_bits(base.word_bits), mul_ns(base.mul_ns),
+	add_ns(base.add_ns), dsp_per_mul(base.dsp_per_mul), dsp_per_add(base.dsp_per_add), clock_ns(base.clock_ns),
+	timestep(base.timestep), est_multipliers(base.est_multipliers), est_adders(base.est_adders),
+	est_tree_depth(base.est_tree_depth), est_latency_cycles(base.est_latency_cycles),
+	est_latency_ns(base.est_latency_ns), est_dsps(base.est_dsps)
+{
+	//do nothing else
+}
+
+void SolverResourceEstimator::setNumType(OperatorKind kind, unsigned int word_bits)
+{
+	op_kind = kind;
+	this->word_bits = word_bits;
+
+	switch(kind)
+	{
+	case FIXED_POINT:
+		//carry chain adders; multipliers cascaded from 25x18 DSP slices
+		add_ns = 0.4 + 0.025*word_bits;
+		mul_ns = 2.5 + 1.0*((word_bits+16)/17 - 1);
+		dsp_per_mul = ((word_bits+24)/25)*((word_bits+17)/18);
+		dsp_per_add = 0;
+		break;
+	case HALF_FLOAT:
+		add_ns = 6.0;
+		mul_ns = 5.0;
+		dsp_per_mul = 1;
+		dsp_per_add = 0;
+		break;
+	case SINGLE_FLOAT:
+		add_ns = 10.0;
+		mul_ns = 8.0;
+		dsp_per_mul = 3;
+		dsp_per_add = 2;
+		break;
+	case DOUBLE_FLOAT:
+	default:
+		add_ns = 14.0;
+		mul_ns = 16.0;
+		dsp_per_mul = 11;
+		dsp_per_add = 3;
+		break;
+	}
+}
+
+void SolverResourceEstimator::setOperatorModel(double mul_ns, double add_ns, unsigned int dsp_per_mul, unsigned int dsp_per_add)
+{
+	this->mul_ns = mul_ns;
+	this->add_ns = add_ns;
+	this->dsp_per_mul = dsp_per_mul;
+	this->dsp_per_add = dsp_per_add;
+}
+
+void SolverResourceEstimator::setTargetClock(double period_ns)
+{
+	clock_ns = period_ns;
+}
+
+void SolverResourceEstimator::setTimestep(double timestep)
+{
+	this->timestep = timestep;
+}
+
+void SolverResourceEstimator::addComponent(ComponentKind kind, unsigned int count)
+{
+		//operation counts follow the update() methods of the component models
+	switch(kind)
+	{
+	case RESISTOR:
+		addCustomComponent("Resistor", 0, 0, 0, 0, count);
+		break;
+	case INDUCTOR:
+		addCustomComponent("Inductor", 2, 3, 1, 3, count);
+		break;
+	case CAPACITOR:
+		addCustomComponent("Capacitor", 2, 3, 1, 3, count);
+		break;
+	case DC_VOLTAGE_SOURCE:
+		addCustomComponent("DCVoltageSource", 0, 0, 0, 0, count);
+		break;
+	case RL_SWITCH:
+		addCustomComponent("RLSwitch", 2, 3, 2, 3, count);
+		break;
+	case MUTUAL_INDUCTANCE2:
+		addCustomComponent("MutualInductance2", 4, 6, 1, 3, count);
+		break;
+	case MUTUAL_INDUCTANCE3:
+		addCustomComponent("MutualInductance3", 12, 12, 2, 4, count);
+		break;
+	case TWO_PHASE_HB_CONVERTER:
+		addCustomComponent("TwoPhaseHBConverter", 10, 14, 3, 4, count);
+		break;
+	case THREE_PHASE_HB_CONVERTER:
+		addCustomComponent("ThreePhaseHBConverter", 12, 19, 3, 5, count);
+		break;
+	case THREE_PHASE_HB_CONVERTER_UNGROUNDED_CAP:
+		addCustomComponent("ThreePhaseHBConverterUngroundedCap", 12, 25, 3, 6, count);
+		break;
+	case TWO_PORT_TRANSCONDUCTOR:
+		addCustomComponent("TwoPortTransconductor", 0, 0, 0, 0, count);
+		break;
+	}
+}
+
+void SolverResourceEstimator::addCustomComponent(const char* name, unsigned int multipliers, unsigned int adders,
+		unsigned int mul_depth, unsigned int add_depth, unsigned int count)
+{
+	ComponentCost cost;
+	cost.name = name;
+	cost.multipliers = multipliers;
+	cost.adders = adders;
+	cost.mul_depth = mul_depth;
+	cost.add_depth = add_depth;
+	cost.count = count;
+
+	components.push_back(cost);
+}
+
+unsigned int SolverResourceEstimator::opCycles(double op_ns) const
+{
+	return (unsigned int)std::ceil(op_ns/clock_ns);
+}
+
+int SolverResourceEstimator::estimate()
+{
+	unsigned int comp_mults = 0, comp_adds = 0;
+	unsigned int comp_mul_depth = 0, comp_add_depth = 0;
+	double comp_path_ns = 0.0;
+
+	for(unsigned int i = 0; i < components.size(); i++)
+	{
+		const ComponentCost& cost = components[i];
+		comp_mults += cost.multipliers*cost.count;
+		comp_adds += cost.adders*cost.count;
+
+		double path_ns = cost.mul_depth*mul_ns + cost.add_depth*add_ns;
+		if(cost.count != 0 && path_ns > comp_path_ns)
+		{
+			comp_path_ns = path_ns;
+			comp_mul_depth = cost.mul_depth;
+			comp_add_depth = cost.add_depth;
+		}
+	}
+
+	unsigned int agg_adds = 0, agg_depth = 0;
+	for(unsigned int i = 0; i < dimension; i++)
+	{
+		if(b_terms[i] > 1) agg_adds += b_terms[i] - 1;
+		unsigned int depth = treeDepth(b_terms[i]);
+		if(depth > agg_depth) agg_depth = depth;
+	}
+
+	unsigned int solve_mults = 0, solve_adds = 0, solve_depth = 0;
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		solve_mults += row_terms[r];
+		if(row_terms[r] > 1) solve_adds += row_terms[r] - 1;
+		unsigned int depth = treeDepth(row_terms[r]);
+		if(depth > solve_depth) solve_depth = depth;
+	}
+
+	unsigned int path_mults = comp_mul_depth + 1;
+	unsigned int path_adds = comp_add_depth + agg_depth + solve_depth;
+
+	est_multipliers = comp_mults + solve_mults;
+	est_adders = comp_adds + agg_adds + solve_adds;
+	est_tree_depth = solve_depth;
+	est_dsps = est_multipliers*dsp_per_mul + est_adders*dsp_per_add;
+
+	if(op_kind == FIXED_POINT)
+	{
+			//fixed-point operators chain combinationally within a clock cycle
+		est_latency_cycles = (unsigned int)std::ceil( (path_mults*mul_ns + path_adds*add_ns)/clock_ns );
+	}
+	else
+	{
+			//floating-point operators are pipelined cores registered on each stage
+		est_latency_cycles = path_mults*opCycles(mul_ns) + path_adds*opCycles(add_ns);
+	}
+
+	est_latency_ns = est_latency_cycles*clock_ns;
+
+	return (est_latency_ns <= timestep*1.0e9) ? 0 : -1;
+}
+
+unsigned int SolverResourceEstimator::getMultipliers() const
+{
+	return est_multipliers;
+}
+
+unsigned int SolverResourceEstimator::getAdders() const
+{
+	return est_adders;
+}
+
+unsigned int SolverResourceEstimator::getAdderTreeDepth() const
+{
+	return est_tree_depth;
+}
+
+unsigned int SolverResourceEstimator::getLatencyCycles() const
+{
+	return est_latency_cycles;
+}
+
+double SolverResourceEstimator::getLatency() const
+{
+	return est_latency_ns;
+}
+
+unsigned int SolverResourceEstimator::getDSPs() const
+{
+	return est_dsps;
+}
+
+const char* SolverResourceEstimator::asString(std::string& buffer)
+{
+	int fits = estimate();
+
+	const unsigned int budget_cycles = (unsigned int)std::floor(timestep*1.0e9/clock_ns + 1.0e-9);
+
+	std::stringstream sstrm;
+
+	const char* kind_name[] = {"fixed point", "half float", "single float", "double float"};
+
+	sstrm << "numerical type: " << kind_name[op_kind];
+	if(op_kind == FIXED_POINT) sstrm << " (" << word_bits << " bits)";
+	sstrm << "\n";
+	sstrm << "clock period: " << clock_ns << " ns, time step: " << timestep*1.0e9 << " ns ("
+		  << budget_cycles << " cycles)\n";
+	sstrm << "system dimension: " << dimension << ", source contributions: " << num_sources << "\n";
+
+	for(unsigned int i = 0; i < components.size(); i++)
+	{
+		sstrm << "  " << components[i].name << " x" << components[i].count << ": "
+			  << components[i].multipliers*components[i].count << " mul, "
+			  << components[i].adders*components[i].count << " add\n";
+	}
+
+	sstrm << "multipliers: " << est_multipliers << "\n";
+	sstrm << "adders/subtractors: " << est_adders << "\n";
+	sstrm << "solver adder tree depth: " << est_tree_depth << "\n";
+	sstrm << "DSP slices (unshared): " << est_dsps << "\n";
+	sstrm << "critical path latency: " << est_latency_cycles << " cycles (" << est_latency_ns << " ns)\n";
+
+	if(fits == 0)
+	{
+		sstrm << "fits time step";
+		if(budget_cycles > 1)
+		{
+			sstrm << "; with PIPELINE II=" << budget_cycles << ", multipliers could be shared down to "
+				  << (est_multipliers + budget_cycles - 1)/budget_cycles;
+		}
+		sstrm << "\n";
+	}
+	else
+	{
+		sstrm << "DOES NOT fit time step; exceeds by " << est_latency_ns - timestep*1.0e9 << " ns\n";
+	}
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+const char* SolverResourceEstimator::generatePragmas(std::string& buffer, const char* A_name)
+{
+	estimate();
+
+	unsigned int budget_cycles = (unsigned int)std::floor(timestep*1.0e9/clock_ns + 1.0e-9);
+	if(budget_cycles == 0) budget_cycles = 1;
+
+	std::stringstream sstrm;
+
+	sstrm << "#pragma HLS ARRAY_PARTITION variable=" << A_name << " complete dim=0\n";
+	sstrm << "#pragma HLS ARRAY_PARTITION variable=x complete dim=1\n";
+	sstrm << "#pragma HLS ARRAY_PARTITION variable=b complete dim=1\n";
+	sstrm << "#pragma HLS ARRAY_PARTITION variable=b_components complete dim=1\n";
+	sstrm << "#pragma HLS PIPELINE II=" << budget_cycles << "\n";
+	sstrm << "#pragma HLS LATENCY max=" << budget_cycles << "\n";
+
+	if(op_kind != FIXED_POINT)
+	{
+		sstrm << "// floating-point sums are not rebalanced into trees unless enabled with:\n";
+		sstrm << "// config_compile -unsafe_math_optimizations\n";
+	}
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+} //namespace LBLMC
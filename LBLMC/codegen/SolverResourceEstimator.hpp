@@ -0,0 +1,218 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SOLVERRESOURCEESTIMATOR_HPP
+#define SOLVERRESOURCEESTIMATOR_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "SystemSourceVector.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief estimates HLS resources and latency of a LB-LMC simulation engine before synthesis
+ *
+ * The estimate is built from the same inputs used to generate the engine: the inverted conductance
+ * matrix A given to SystemSolverGenerator, the SystemSourceVector used to generate the source
+ * aggregation function, and the list of components in the model.  From these, the number of
+ * multipliers and adders, the depth of the adder trees, and the critical path latency of one time
+ * step are estimated for a chosen numerical type and target clock.  Since a time step depends on the
+ * solution of the previous step, the whole critical path must fit within LMC_TIMESTEP.
+ *
+ * The critical path is modeled as:
+ * 	deepest component update -> source aggregation tree -> multiply by A -> row adder tree
+ * with balanced adder trees.  Operator delays and DSP usage per operator are coarse defaults for
+ * Xilinx devices and can be overridden with setOperatorModel() for a particular part and tool.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class SolverResourceEstimator
+{
+public:
+
+	/**
+	 * component models of the library whose operation counts are known to the estimator
+	 */
+	enum ComponentKind
+	{
+		RESISTOR,
+		INDUCTOR,
+		CAPACITOR,
+		DC_VOLTAGE_SOURCE,
+		RL_SWITCH,
+		MUTUAL_INDUCTANCE2,
+		MUTUAL_INDUCTANCE3,
+		TWO_PHASE_HB_CONVERTER,
+		THREE_PHASE_HB_CONVERTER,
+		THREE_PHASE_HB_CONVERTER_UNGROUNDED_CAP,
+		TWO_PORT_TRANSCONDUCTOR
+	};
+
+	/**
+	 * numerical types of NumType the operator model can be set to
+	 */
+	enum OperatorKind
+	{
+		FIXED_POINT,
+		HALF_FLOAT,
+		SINGLE_FLOAT,
+		DOUBLE_FLOAT
+	};
+
+private:
+
+	/**
+	 * operation counts of a component update
+	 */
+	struct ComponentCost
+	{
+		std::string name;
+		unsigned int multipliers; ///< multipliers per instance
+		unsigned int adders; ///< adders/subtractors per instance
+		unsigned int mul_depth; ///< multipliers on the critical path of the update
+		unsigned int add_depth; ///< adders on the critical path of the update
+		unsigned int count; ///< number of instances
+	};
+
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	unsigned int num_sources; ///< number of source contributions b_components
+	std::vector<unsigned int> row_terms; ///< number of non-zero terms per row of A
+	std::vector<unsigned int> b_terms; ///< number of source contributions per element of b
+
+	std::vector<ComponentCost> components;
+
+	OperatorKind op_kind; ///< numerical type of the operators
+	unsigned int word_bits; ///< word size of fixed-point operators
+	double mul_ns; ///< delay of a multiplier
+	double add_ns; ///< delay of an adder/subtractor
+	unsigned int dsp_per_mul; ///< DSP slices per multiplier
+	unsigned int dsp_per_add; ///< DSP slices per adder
+	double clock_ns; ///< target clock period
+	double timestep; ///< simulation time step in seconds
+
+	unsigned int est_multipliers;
+	unsigned int est_adders;
+	unsigned int est_tree_depth;
+	unsigned int est_latency_cycles;
+	double est_latency_ns;
+	unsigned int est_dsps;
+
+public:
+
+	/**
+	 * parameter constructor
+	 *
+	 * The operator model defaults to the NumType selected in Params.hpp, the clock to 100 MHz, and
+	 * the time step to LMC_TIMESTEP.
+	 *
+	 * @param A the inverted conductance matrix ( A = G^-1 of Gx=b ) given to SystemSolverGenerator
+	 * @param dimension number of solutions in the system Gx=b
+	 * @param sources source vector used to generate the source aggregation function
+	 * @param zero_bound range from zero when determining whether Aij is close to zero to be ignored; defaults to 1e-12.
+	 */
+	SolverResourceEstimator(const NumType* A, unsigned int dimension, SystemSourceVector& sources,
+			NumType zero_bound = 1.0e-12);
+	SolverResourceEstimator(const SolverResourceEstimator& base);
+
+	/**
+	 * sets operator model to defaults of given numerical type
+	 * @param kind numerical type of NumType
+	 * @param word_bits word size of fixed-point types; ignored for floating-point types
+	 */
+	void setNumType(OperatorKind kind, unsigned int word_bits = NUM_FIXED_POINT_SIZE);
+
+	/**
+	 * overrides the operator model
+	 * @param mul_ns delay of a multiplier in nanoseconds
+	 * @param add_ns delay of an adder/subtractor in nanoseconds
+	 * @param dsp_per_mul DSP slices used per multiplier
+	 * @param dsp_per_add DSP slices used per adder
+	 */
+	void setOperatorModel(double mul_ns, double add_ns, unsigned int dsp_per_mul, unsigned int dsp_per_add);
+
+	/**
+	 * @param period_ns target clock period in nanoseconds
+	 */
+	void setTargetClock(double period_ns);
+
+	/**
+	 * @param timestep simulation time step in seconds that a step must fit in
+	 */
+	void setTimestep(double timestep);
+
+	/**
+	 * adds instances of a library component to the model
+	 * @param kind component model
+	 * @param count number of instances
+	 */
+	void addComponent(ComponentKind kind, unsigned int count = 1);
+
+	/**
+	 * adds instances of a user component to the model
+	 * @param name name of the component
+	 * @param multipliers multipliers per instance
+	 * @param adders adders/subtractors per instance
+	 * @param mul_depth multipliers on the critical path of the update
+	 * @param add_depth adders on the critical path of the update
+	 * @param count number of instances
+	 */
+	void addCustomComponent(const char* name, unsigned int multipliers, unsigned int adders,
+			unsigned int mul_depth, unsigned int add_depth, unsigned int count = 1);
+
+	/**
+	 * estimates resources and latency of a time step
+	 * @return 0 if a time step fits within the time step, -1 if it does not
+	 */
+	int estimate();
+
+	unsigned int getMultipliers() const; ///< @return multipliers of last estimate
+	unsigned int getAdders() const; ///< @return adders/subtractors of last estimate
+	unsigned int getAdderTreeDepth() const; ///< @return deepest solver row adder tree of last estimate
+	unsigned int getLatencyCycles() const; ///< @return critical path latency in clock cycles of last estimate
+	double getLatency() const; ///< @return critical path latency in nanoseconds of last estimate
+	unsigned int getDSPs() const; ///< @return DSP slices of last estimate, without resource sharing
+
+	/**
+	 * creates a report, as a string, of the estimate
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+	/**
+	 * generates suggested HLS pragmas for the simulation engine top function
+	 * @param buffer string that will store the pragmas
+	 * @param A_name name of the inverted conductance matrix array in generated code
+	 * @return the buffer string as a const char* string
+	 */
+	const char* generatePragmas(std::string& buffer, const char* A_name = "mat_name");
+
+private:
+
+	unsigned int opCycles(double op_ns) const;
+};
+
+} //namespace LBLMC
+
+#endif //SOLVERRESOURCEESTIMATOR_HPP
@@ -0,0 +1,403 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "SparseDirectSolver.hpp"
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+
+namespace LBLMC
+{
+
+SparseDirectSolver::SparseDirectSolver(SparseSystemConductance& conductance) :
+	dimension(0), G(), symmetric(true), ldlt(), lu(), perm(), col_start(), rows(), values(), inverse_diagonal(),
+	y(), y_lu(), num_factorizations(0), num_analyses(0)
+{
+	reset(conductance);
+}
+
+SparseDirectSolver::SparseDirectSolver(const SparseDirectSolver& base) :
+	dimension(0), G(), symmetric(true), ldlt(), lu(), perm(), col_start(), rows(), values(), inverse_diagonal(),
+	y(), y_lu(), num_factorizations(0), num_analyses(0)
+{
+	reset(base);
+}
+
+void SparseDirectSolver::reset(SparseSystemConductance& conductance)
+{
+	dimension = conductance.getDimension();
+	G = conductance.asEigen3SparseMatrix();
+	G.makeCompressed();
+
+	const double largest = (G.nonZeros() == 0) ? 0.0 : G.coeffs().cwiseAbs().maxCoeff();
+	symmetric = conductance.isSymmetric(1e-14*largest);
+
+	num_factorizations = 0;
+	num_analyses = 0;
+
+	factor(true);
+}
+
+void SparseDirectSolver::reset(const SparseDirectSolver& base)
+{
+		//the Eigen factorizations cannot be copied, so the factor is recomputed from the matrix of base
+
+	dimension = base.dimension;
+	G = base.G;
+	symmetric = base.symmetric;
+
+	factor(true);
+
+	num_factorizations = base.num_factorizations;
+	num_analyses = base.num_analyses;
+}
+
+bool SparseDirectSolver::refactor(SparseSystemConductance& conductance)
+{
+	Eigen::SparseMatrix<double> next = conductance.asEigen3SparseMatrix();
+	next.makeCompressed();
+
+	const double largest = (next.nonZeros() == 0) ? 0.0 : next.coeffs().cwiseAbs().maxCoeff();
+	const bool next_symmetric = conductance.isSymmetric(1e-14*largest);
+
+		//the symbolic analysis holds for the same pattern of non-zeros and kind of factor
+
+	bool same_pattern =
+		(next.rows() == G.rows()) &&
+		(next.nonZeros() == G.nonZeros()) &&
+		(next_symmetric == symmetric);
+
+	for(unsigned int j = 0; same_pattern && j <= (unsigned int)G.cols(); j++)
+	{
+		same_pattern = (next.outerIndexPtr()[j] == G.outerIndexPtr()[j]);
+	}
+
+	for(unsigned long p = 0; same_pattern && p < (unsigned long)G.nonZeros(); p++)
+	{
+		same_pattern = (next.innerIndexPtr()[p] == G.innerIndexPtr()[p]);
+	}
+
+	dimension = conductance.getDimension();
+	G = next;
+	symmetric = next_symmetric;
+
+	factor(!same_pattern);
+
+	return same_pattern;
+}
+
+void SparseDirectSolver::solve(const NumType* b, NumType* x) const
+{
+	if(symmetric)
+	{
+		for(unsigned int i = 0; i < dimension; i++)
+		{
+			y[perm[i]] = double(b[i]);
+		}
+
+		substitute(&y[0], 1);
+
+		for(unsigned int i = 0; i < dimension; i++)
+		{
+			x[i] = NumType(y[perm[i]]);
+		}
+	}
+	else
+	{
+		for(unsigned int i = 0; i < dimension; i++)
+		{
+			y_lu(i) = double(b[i]);
+		}
+
+		y_lu = lu.rowsPermutation()*y_lu;
+		lu.matrixL().solveInPlace(y_lu);
+		lu.matrixU().solveInPlace(y_lu);
+		y_lu = lu.colsPermutation().inverse()*y_lu;
+
+		for(unsigned int i = 0; i < dimension; i++)
+		{
+			x[i] = NumType(y_lu(i));
+		}
+	}
+}
+
+void SparseDirectSolver::solve(const SystemSourceVector& sources, const NumType* b_components, NumType* x) const
+{
+	std::vector<NumType> b(dimension, NumType(0.0));
+
+	const std::map<long, std::vector<long> >& nodes = sources.asMap();
+	for(std::map<long, std::vector<long> >::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
+	{
+		if(it->second[0] != 0) b[it->second[0]-1] += b_components[it->first-1];
+		if(it->second[1] != 0) b[it->second[1]-1] -= b_components[it->first-1];
+	}
+
+	solve(&b[0], x);
+}
+
+void SparseDirectSolver::solve(const Eigen::MatrixXd& rhs, Eigen::MatrixXd& x) const
+{
+	const unsigned int k = rhs.cols();
+
+	if(symmetric)
+	{
+			//interleave the right hand sides, so each entry of L is applied to all of them at once
+
+		std::vector<double> yk((unsigned long)dimension*k);
+
+		for(unsigned int i = 0; i < dimension; i++)
+		{
+			for(unsigned int c = 0; c < k; c++)
+			{
+				yk[(unsigned long)perm[i]*k + c] = rhs(i,c);
+			}
+		}
+
+		if(k > 0) substitute(&yk[0], k);
+
+		x.resize(dimension, k);
+		for(unsigned int i = 0; i < dimension; i++)
+		{
+			for(unsigned int c = 0; c < k; c++)
+			{
+				x(i,c) = yk[(unsigned long)perm[i]*k + c];
+			}
+		}
+	}
+	else
+	{
+		x = lu.rowsPermutation()*rhs;
+		lu.matrixL().solveInPlace(x);
+		lu.matrixU().solveInPlace(x);
+		x = lu.colsPermutation().inverse()*x;
+	}
+}
+
+unsigned int SparseDirectSolver::getDimension() const
+{
+	return dimension;
+}
+
+bool SparseDirectSolver::isSymmetric() const
+{
+	return symmetric;
+}
+
+unsigned long SparseDirectSolver::getFactorNonZeros() const
+{
+	if(symmetric) return values.size() + dimension;
+
+	return (unsigned long)(lu.nnzL() + lu.nnzU());
+}
+
+double SparseDirectSolver::getFillRatio() const
+{
+	if(G.nonZeros() == 0) return 0.0;
+
+	return double(getFactorNonZeros())/double(G.nonZeros());
+}
+
+unsigned long SparseDirectSolver::getNumFactorizations() const
+{
+	return num_factorizations;
+}
+
+unsigned long SparseDirectSolver::getNumAnalyses() const
+{
+	return num_analyses;
+}
+
+const char* SparseDirectSolver::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	sstrm << "Sparse Direct Solver\n\n";
+	sstrm << "dimension:         " << dimension << "\n";
+	sstrm << "factorization:     " << (symmetric ? "LDL^T (AMD ordering)" : "supernodal LU (COLAMD ordering)") << "\n";
+	sstrm << "non-zeros of G:    " << G.nonZeros() << "\n";
+	sstrm << "factor non-zeros:  " << getFactorNonZeros() << "\n";
+	sstrm << "fill ratio:        " << getFillRatio() << "\n";
+	sstrm << "dense inverse:     " << (unsigned long)dimension*dimension << "\n\n";
+	sstrm << "factorizations:    " << num_factorizations << "\n";
+	sstrm << "symbolic analyses: " << num_analyses << "\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+void SparseDirectSolver::factor(bool analyze)
+{
+	if(analyze) num_analyses++;
+	num_factorizations++;
+
+	if(symmetric)
+	{
+		if(analyze) ldlt.analyzePattern(G);
+		ldlt.factorize(G);
+
+		bool singular = (ldlt.info() != Eigen::Success);
+
+		const Eigen::VectorXd d = ldlt.vectorD();
+		if(!singular && dimension > 0)
+		{
+			const Eigen::VectorXd d_abs = d.cwiseAbs();
+			singular = (d_abs.minCoeff() <= dimension*std::numeric_limits<double>::epsilon()*d_abs.maxCoeff());
+		}
+
+		if(singular)
+		{
+			throw std::runtime_error("SparseDirectSolver: cannot factor conductance matrix as it is singular");
+		}
+
+			//copy the strictly lower part of L to CSC arrays, and the permutation to factor ordering
+
+		const Eigen::SparseMatrix<double>& L = ldlt.matrixL().nestedExpression();
+
+		col_start.assign(dimension+1, 0);
+		rows.clear();
+		values.clear();
+		rows.reserve(L.nonZeros());
+		values.reserve(L.nonZeros());
+
+		for(unsigned int j = 0; j < dimension; j++)
+		{
+			for(Eigen::SparseMatrix<double>::InnerIterator it(L, j); it; ++it)
+			{
+				if((unsigned int)it.row() <= j) continue;
+				rows.push_back(it.row());
+				values.push_back(it.value());
+			}
+			col_start[j+1] = rows.size();
+		}
+
+		inverse_diagonal.resize(dimension);
+		for(unsigned int i = 0; i < dimension; i++)
+		{
+			inverse_diagonal[i] = 1.0/d(i);
+		}
+
+		perm.resize(dimension);
+		for(unsigned int i = 0; i < dimension; i++)
+		{
+			perm[i] = (ldlt.permutationP().size() > 0) ? ldlt.permutationP().indices()(i) : i;
+		}
+
+		y.assign(dimension, 0.0);
+	}
+	else
+	{
+		if(analyze) lu.analyzePattern(G);
+		lu.factorize(G);
+
+		if(lu.info() != Eigen::Success)
+		{
+			throw std::runtime_error("SparseDirectSolver: cannot factor conductance matrix as it is singular");
+		}
+
+		perm.clear();
+		col_start.clear();
+		rows.clear();
+		values.clear();
+		inverse_diagonal.clear();
+
+		y_lu = Eigen::VectorXd::Zero(dimension);
+	}
+}
+
+void SparseDirectSolver::substitute(double* w, unsigned int k) const
+{
+	const unsigned int* cs = &col_start[0];
+	const unsigned int* ri = rows.empty() ? 0 : &rows[0];
+	const double* lv = values.empty() ? 0 : &values[0];
+
+	if(k == 1)
+	{
+			//L y = y, by columns of L
+
+		for(unsigned int j = 0; j < dimension; j++)
+		{
+			const double yj = w[j];
+			if(yj == 0.0) continue; //b is sparse in source nodes
+
+			for(unsigned int p = cs[j]; p < cs[j+1]; p++)
+			{
+				w[ri[p]] -= lv[p]*yj;
+			}
+		}
+
+			//y = D^-1 y
+
+		for(unsigned int j = 0; j < dimension; j++)
+		{
+			w[j] *= inverse_diagonal[j];
+		}
+
+			//L^T y = y, by dot products with columns of L
+
+		for(unsigned int j = dimension; j-- > 0;)
+		{
+			double sum = w[j];
+			for(unsigned int p = cs[j]; p < cs[j+1]; p++)
+			{
+				sum -= lv[p]*w[ri[p]];
+			}
+			w[j] = sum;
+		}
+
+		return;
+	}
+
+	for(unsigned int j = 0; j < dimension; j++)
+	{
+		const double* yj = &w[(unsigned long)j*k];
+
+		for(unsigned int p = cs[j]; p < cs[j+1]; p++)
+		{
+			double* yi = &w[(unsigned long)ri[p]*k];
+			const double l = lv[p];
+			for(unsigned int c = 0; c < k; c++) yi[c] -= l*yj[c];
+		}
+	}
+
+	for(unsigned int j = 0; j < dimension; j++)
+	{
+		double* yj = &w[(unsigned long)j*k];
+		const double dinv = inverse_diagonal[j];
+		for(unsigned int c = 0; c < k; c++) yj[c] *= dinv;
+	}
+
+	for(unsigned int j = dimension; j-- > 0;)
+	{
+		double* yj = &w[(unsigned long)j*k];
+
+		for(unsigned int p = cs[j]; p < cs[j+1]; p++)
+		{
+			const double* yi = &w[(unsigned long)ri[p]*k];
+			const double l = lv[p];
+			for(unsigned int c = 0; c < k; c++) yj[c] -= l*yi[c];
+		}
+	}
+}
+
+} //namespace LBLMC
@@ -0,0 +1,165 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef SPARSEDIRECTSOLVER_HPP
+#define SPARSEDIRECTSOLVER_HPP
+
+#include <vector>
+#include <string>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseLU>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SparseSystemConductance.hpp"
+#include "SystemSourceVector.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief solves a LB-LMC system model at runtime exactly, by substitution with a cached sparse factor of G
+ *
+ * Instead of the dense inverse A = G^-1, G is factored once and each step only does the forward and
+ * backward substitutions on b.  Memory and work per step are proportional to the fill-in of the
+ * factor instead of the square of the node count, which for mid-to-large sparse networks is far
+ * below the dense product x = A*b.
+ *
+ * Symmetric G (networks without controlled sources) is factored P G P^T = L D L^T with fill-reducing
+ * AMD ordering.  The unit lower factor L is copied out to compressed sparse column arrays, with D
+ * inverted, and solved with substitution kernels of this class that do not allocate: the forward
+ * substitution updates with each column of L, the backward substitution takes dot products with
+ * them, so both stream the same arrays.  Several right hand sides can be solved together, stored
+ * interleaved, so each entry of L is loaded once for all of them.
+ *
+ * Other G are factored with supernodal sparse LU (COLAMD ordering), and solved in place.
+ *
+ * The symbolic analysis (ordering and factor pattern) is cached: refactor() of a conductance matrix
+ * with the same pattern of non-zeros, e.g. after switch states change the conductances of stamped
+ * entries, only redoes the numeric factorization.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class SparseDirectSolver
+{
+private:
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	Eigen::SparseMatrix<double> G; ///< conductance matrix the factor is of, column-major
+	bool symmetric; ///< true if G is factored L D L^T, otherwise LU
+
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > ldlt; ///< symmetric: symbolic analysis and factorization
+	Eigen::SparseLU<Eigen::SparseMatrix<double> > lu; ///< non-symmetric: symbolic analysis and factorization
+
+	std::vector<unsigned int> perm; ///< symmetric: y[perm[i]] = b[i] into the factor ordering
+	std::vector<unsigned int> col_start; ///< symmetric: CSC column offsets of strictly lower L
+	std::vector<unsigned int> rows; ///< symmetric: CSC row indices of strictly lower L
+	std::vector<double> values; ///< symmetric: CSC values of strictly lower L
+	std::vector<double> inverse_diagonal; ///< symmetric: 1/D
+
+	mutable std::vector<double> y; ///< substitution work array
+	mutable Eigen::VectorXd y_lu; ///< non-symmetric: substitution work vector
+
+	unsigned long num_factorizations; ///< statistics: numeric factorizations
+	unsigned long num_analyses; ///< statistics: symbolic analyses
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param conductance the (not inverted) conductance matrix G of Gx=b
+	 * @throws std::runtime_error if the conductance matrix is singular
+	 */
+	SparseDirectSolver(SparseSystemConductance& conductance);
+
+	/**
+	 * copy constructor; the factor is recomputed from the conductance matrix of base
+	 * @param base solver to copy from
+	 */
+	SparseDirectSolver(const SparseDirectSolver& base);
+
+	void reset(SparseSystemConductance& conductance);
+	void reset(const SparseDirectSolver& base);
+
+	/**
+	 * factors a new conductance matrix, reusing the cached symbolic analysis if its pattern of
+	 * non-zeros is the same as that of the present one
+	 * @param conductance the (not inverted) conductance matrix G of Gx=b
+	 * @return true if the symbolic analysis was reused, false if redone
+	 * @throws std::runtime_error if the conductance matrix is singular
+	 */
+	bool refactor(SparseSystemConductance& conductance);
+
+	/**
+	 * solves G x = b by substitution with the factor
+	 * @param b right hand side of the system, of the system dimension
+	 * @param x array to store the solution to, of the system dimension; may be b
+	 */
+	void solve(const NumType* b, NumType* x) const;
+
+	/**
+	 * solves the system for the present source contributions, aggregating b from them first
+	 * @param sources source vector of the system
+	 * @param b_components source contributions of the components; b_components[index-1] for source index
+	 * @param x array to store the solution to, of the system dimension
+	 */
+	void solve(const SystemSourceVector& sources, const NumType* b_components, NumType* x) const;
+
+	/**
+	 * solves G x = rhs for a few right hand sides together
+	 * @param rhs right hand sides as columns; dimension rows
+	 * @param x matrix to store the solutions to, as columns
+	 */
+	void solve(const Eigen::MatrixXd& rhs, Eigen::MatrixXd& x) const;
+
+	unsigned int getDimension() const; ///< @return number of solutions in the system
+	bool isSymmetric() const; ///< @return true if G is factored L D L^T, false if LU
+
+	/**
+	 * @return number of non-zeros of the factor(s), including the diagonal
+	 */
+	unsigned long getFactorNonZeros() const;
+
+	/**
+	 * @return fill-in of the factor(s) relative to the non-zeros of G
+	 */
+	double getFillRatio() const;
+
+	unsigned long getNumFactorizations() const; ///< @return number of numeric factorizations
+	unsigned long getNumAnalyses() const; ///< @return number of symbolic analyses
+
+	/**
+	 * creates a report, as a string, of the factor and its fill-in
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+private:
+
+	void factor(bool analyze);
+
+		/// w = L^-T D^-1 L^-1 w in the factor ordering, for k interleaved right hand sides
+	void substitute(double* w, unsigned int k) const;
+};
+
+} //namespace LBLMC
+
+#endif //SPARSEDIRECTSOLVER_HPP
@@ -0,0 +1,306 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "SparseSystemConductance.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <stdexcept>
+#include <limits>
+
+namespace LBLMC
+{
+
+SparseSystemConductance::SparseSystemConductance(unsigned int dimension) :
+	matrix(dimension, dimension), triplets(), dimension(dimension)
+{
+	//do nothing else
+}
+
+SparseSystemConductance::SparseSystemConductance(const SparseSystemConductance& base) :
+	matrix(base.matrix), triplets(base.triplets), dimension(base.dimension)
+{
+	//do nothing else
+}
+
+void SparseSystemConductance::reset(unsigned int dimension)
+{
+	this->dimension = dimension;
+	matrix.resize(dimension, dimension);
+	matrix.setZero();
+	triplets.clear();
+}
+
+void SparseSystemConductance::reset(const SparseSystemConductance& base)
+{
+	dimension = base.dimension;
+	matrix = base.matrix;
+	triplets = base.triplets;
+}
+
+std::vector<ConductanceTriplet>& SparseSystemConductance::asTriplets()
+{
+	return triplets;
+}
+
+void SparseSystemConductance::compress()
+{
+	if(triplets.empty()) return;
+
+	std::vector< Eigen::Triplet<double> > entries;
+	entries.reserve(triplets.size());
+
+	for(unsigned int k = 0; k < triplets.size(); k++)
+	{
+		entries.push_back(Eigen::Triplet<double>(triplets[k].row, triplets[k].col, double(triplets[k].value)));
+	}
+
+	std::vector<ConductanceTriplet>().swap(triplets); //release pending memory
+
+	SparseMatrixRMXd stamped(dimension, dimension);
+	stamped.setFromTriplets(entries.begin(), entries.end()); //sums duplicate entries
+
+	if(matrix.nonZeros() == 0)
+		matrix.swap(stamped);
+	else
+		matrix = matrix + stamped;
+
+	matrix.prune(0.0, 0.0); //removes entries that cancelled to zero
+	matrix.makeCompressed();
+}
+
+SparseMatrixRMXd& SparseSystemConductance::asEigen3SparseMatrix()
+{
+	compress();
+	return matrix;
+}
+
+unsigned int SparseSystemConductance::getDimension()
+{
+	return dimension;
+}
+
+unsigned long SparseSystemConductance::getNumNonZeros()
+{
+	compress();
+	return matrix.nonZeros();
+}
+
+double SparseSystemConductance::getDensity()
+{
+	if(dimension == 0) return 0.0;
+
+	return double(getNumNonZeros()) / (double(dimension)*double(dimension));
+}
+
+unsigned int SparseSystemConductance::getMaxRowNonZeros()
+{
+	compress();
+
+	unsigned int max_nnz = 0;
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		const unsigned int nnz = matrix.outerIndexPtr()[r+1] - matrix.outerIndexPtr()[r];
+		if(nnz > max_nnz) max_nnz = nnz;
+	}
+
+	return max_nnz;
+}
+
+unsigned int SparseSystemConductance::getBandwidth()
+{
+	compress();
+
+	unsigned int bandwidth = 0;
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(SparseMatrixRMXd::InnerIterator it(matrix, r); it; ++it)
+		{
+			const unsigned int c = it.col();
+			const unsigned int dist = (c > r) ? (c - r) : (r - c);
+			if(dist > bandwidth) bandwidth = dist;
+		}
+	}
+
+	return bandwidth;
+}
+
+unsigned long SparseSystemConductance::getStorageBytes()
+{
+	const unsigned long nnz = getNumNonZeros();
+
+	return nnz*(sizeof(double) + sizeof(SparseMatrixRMXd::StorageIndex)) +
+		(dimension+1)*sizeof(SparseMatrixRMXd::StorageIndex);
+}
+
+bool SparseSystemConductance::isSymmetric(double tolerance)
+{
+	compress();
+
+	SparseMatrixRMXd transpose = matrix.transpose();
+	SparseMatrixRMXd diff = matrix - transpose;
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(SparseMatrixRMXd::InnerIterator it(diff, r); it; ++it)
+		{
+			if(std::fabs(it.value()) > tolerance) return false;
+		}
+	}
+
+	return true;
+}
+
+const char* SparseSystemConductance::statistics(std::string& buffer)
+{
+	const unsigned long nnz = getNumNonZeros();
+	const double dense_bytes = double(dimension)*double(dimension)*sizeof(double);
+
+	std::stringstream sstrm;
+
+	sstrm << "Sparse System Conductance Statistics\n\n";
+	sstrm << "dimension:           " << dimension << "\n";
+	sstrm << "non-zeros:           " << nnz << "\n";
+	sstrm << "density:             " << getDensity() << "\n";
+	sstrm << "average row fill:    " << ((dimension != 0) ? double(nnz)/dimension : 0.0) << "\n";
+	sstrm << "max row fill:        " << getMaxRowNonZeros() << "\n";
+	sstrm << "bandwidth:           " << getBandwidth() << "\n";
+	sstrm << "symmetric:           " << (isSymmetric() ? "yes" : "no") << "\n\n";
+	sstrm << "CSR bytes:           " << getStorageBytes() << "\n";
+	sstrm << "dense bytes:         " << std::fixed << std::setprecision(0) << dense_bytes << "\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+int SparseSystemConductance::exportAsMatrixMarket(const char* filename)
+{
+	std::fstream file;
+
+	try
+	{
+		file.open(filename, std::fstream::out | std::fstream::trunc);
+	}
+	catch(...)
+	{
+		return -1;
+	}
+
+	if(!file.is_open()) return -1;
+
+	compress();
+
+	file << std::setprecision(16);
+	file << std::scientific;
+
+	file << "%%MatrixMarket matrix coordinate real general\n";
+	file << "% LB-LMC system conductance matrix\n";
+	file << dimension << " " << dimension << " " << matrix.nonZeros() << "\n";
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(SparseMatrixRMXd::InnerIterator it(matrix, r); it; ++it)
+		{
+			file << (r+1) << " " << (it.col()+1) << " " << it.value() << "\n";
+		}
+	}
+	file << std::flush;
+
+	file.close();
+
+	return 0;
+}
+
+int SparseSystemConductance::toSystemConductance(SystemConductance& dense)
+{
+	if(dense.getDimension() != dimension) return -1;
+
+	compress();
+
+	dense.asEigen3Matrix() = MatrixRMXd(matrix);
+
+	return 0;
+}
+
+void SparseSystemConductance::solve(const Eigen::MatrixXd& rhs, Eigen::MatrixXd& x)
+{
+	compress();
+
+	const Eigen::SparseMatrix<double> G = matrix; //column-major for the sparse factorizations
+
+	if(isSymmetric(1e-14*G.coeffs().cwiseAbs().maxCoeff()))
+	{
+		Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > ldlt(G);
+
+		bool singular = (ldlt.info() != Eigen::Success);
+		if(!singular)
+		{
+			const Eigen::VectorXd d = ldlt.vectorD().cwiseAbs();
+			singular = (d.minCoeff() <= dimension*std::numeric_limits<double>::epsilon()*d.maxCoeff());
+		}
+
+		if(singular)
+		{
+			throw std::runtime_error("SparseSystemConductance: cannot factor conductance matrix as it is singular");
+		}
+
+		x = ldlt.solve(rhs);
+	}
+	else
+	{
+		Eigen::SparseLU< Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > lu;
+		lu.analyzePattern(G);
+		lu.factorize(G);
+
+		if(lu.info() != Eigen::Success)
+		{
+			throw std::runtime_error("SparseSystemConductance: cannot factor conductance matrix as it is singular");
+		}
+
+		x = lu.solve(rhs);
+	}
+
+	if(!x.allFinite())
+	{
+		throw std::runtime_error("SparseSystemConductance: cannot factor conductance matrix as it is singular");
+	}
+}
+
+void SparseSystemConductance::computeInverseColumns(const std::vector<unsigned int>& nodes, Eigen::MatrixXd& columns)
+{
+	Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(dimension, nodes.size());
+
+	for(unsigned int j = 0; j < nodes.size(); j++)
+	{
+		if(nodes[j] == 0 || nodes[j] > dimension)
+		{
+			throw std::runtime_error("SparseSystemConductance: node index of inverse column is out of range");
+		}
+
+		rhs(nodes[j]-1, j) = 1.0;
+	}
+
+	solve(rhs, columns);
+}
+
+} //namespace LBLMC
@@ -0,0 +1,195 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SPARSESYSTEMCONDUCTANCE_HPP
+#define SPARSESYSTEMCONDUCTANCE_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "LBLMC/comp/ConductanceTriplet.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemConductance.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief encapsulates the square conductance matrix of a large system model in sparse form
+ *
+ * Sparse counterpart of SystemConductance for systems with too many nodes to store the conductance
+ * matrix densely.  Components stamp their conductances as triplets (COO form) into the list returned
+ * by asTriplets(); the pending triplets are then compressed, summing duplicate entries, into a
+ * compressed sparse row (CSR) matrix.  Memory is proportional to the number of stamped entries
+ * instead of the square of the node count.
+ *
+ * Stamping can be done in several passes: each compress() adds the pending triplets to the
+ * matrix and releases them, so large netlists need not hold all triplets at once.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class SparseSystemConductance
+{
+private:
+	SparseMatrixRMXd matrix; ///< compressed conductance matrix
+	std::vector<ConductanceTriplet> triplets; ///< stamped entries not yet compressed into the matrix
+	unsigned int dimension;
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param dimension non-zero dimension of square conductance matrix (length or width)
+	 */
+	SparseSystemConductance(unsigned int dimension);
+
+	/**
+	 * copy constructor
+	 * @param base conductance matrix to copy from
+	 */
+	SparseSystemConductance(const SparseSystemConductance& base);
+
+	/**
+	 * clears the conductance matrix and pending triplets, and resizes the matrix to given dimension
+	 * @param dimension non-zero dimension of square conductance matrix (length or width)
+	 */
+	void reset(unsigned int dimension);
+
+	/**
+	 * resets conductance matrix to that of given SparseSystemConductance
+	 * @param base
+	 */
+	void reset(const SparseSystemConductance& base);
+
+	/**
+	 * returns the list of pending conductance triplets for components to stamp into
+	 * @return reference to the pending triplets
+	 */
+	std::vector<ConductanceTriplet>& asTriplets();
+
+	/**
+	 * adds the pending triplets into the compressed matrix and releases them
+	 *
+	 * Entries that cancel to exactly zero are removed from the matrix.
+	 */
+	void compress();
+
+	/**
+	 * returns the conductance matrix as a Eigen3 sparse matrix, compressing pending triplets first
+	 * @return compressed row-major conductance matrix
+	 */
+	SparseMatrixRMXd& asEigen3SparseMatrix();
+
+	/**
+	 * gets dimension of square conductance matrix
+	 * @return dimension of matrix
+	 */
+	unsigned int getDimension();
+
+	/**
+	 * @return number of stored non-zero entries of the conductance matrix
+	 */
+	unsigned long getNumNonZeros();
+
+	/**
+	 * @return fraction of the entries of the matrix that are non-zero, from 0 to 1
+	 */
+	double getDensity();
+
+	/**
+	 * @return largest number of non-zero entries in a row
+	 */
+	unsigned int getMaxRowNonZeros();
+
+	/**
+	 * @return largest distance |row - col| of a non-zero entry from the diagonal
+	 */
+	unsigned int getBandwidth();
+
+	/**
+	 * @return bytes used to store the compressed matrix (values, column indices, and row offsets)
+	 */
+	unsigned long getStorageBytes();
+
+	/**
+	 * checks if the conductance matrix is symmetric
+	 * @param tolerance largest allowed absolute difference between mirrored entries
+	 * @return true if symmetric
+	 */
+	bool isSymmetric(double tolerance = 0.0);
+
+	/**
+	 * creates a report, as a string, of the sparsity statistics of the conductance matrix
+	 *
+	 * The report includes the number of non-zeros, density, row fill, bandwidth, and storage compared
+	 * with dense storage.
+	 *
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* statistics(std::string& buffer);
+
+	/**
+	 * exports the conductance matrix to a Matrix Market coordinate text file
+	 *
+	 * The exported file can be opened by MATLAB/Octave (mmread), SciPy (scipy.io.mmread), and most
+	 * sparse matrix tools.  Indices in the file are one-based.
+	 *
+	 * @param filename filename of the text file to store matrix
+	 * @return 0 if successful, -1 if fails to open/write to file
+	 */
+	int exportAsMatrixMarket(const char* filename);
+
+	/**
+	 * copies the conductance matrix into a dense SystemConductance, for small systems
+	 * @param dense dense conductance matrix of the same dimension to copy to
+	 * @return 0 if successful, -1 if dimensions do not match
+	 */
+	int toSystemConductance(SystemConductance& dense);
+
+	/**
+	 * solves G*x = rhs for several right hand sides without forming the inverse of G
+	 *
+	 * G is factored once: symmetric matrices with sparse LDLT (AMD ordering), others with sparse LU
+	 * (COLAMD ordering).  Fill-in, not the square of the dimension, bounds the memory.
+	 *
+	 * @param rhs right hand sides as columns; dimension rows
+	 * @param x matrix to store the solutions to, as columns
+	 * @throws std::runtime_error if matrix is singular
+	 */
+	void solve(const Eigen::MatrixXd& rhs, Eigen::MatrixXd& x);
+
+	/**
+	 * computes selected columns of the inverted conductance matrix A = G^-1
+	 *
+	 * Only the columns of the nodes that sources are stamped to are read by the system solvers, so
+	 * for large systems this is much cheaper than inverting the whole matrix.
+	 *
+	 * @param nodes node indices (1 to dimension) of the columns to compute
+	 * @param columns matrix to store the columns to; dimension x nodes.size()
+	 * @throws std::runtime_error if matrix is singular
+	 */
+	void computeInverseColumns(const std::vector<unsigned int>& nodes, Eigen::MatrixXd& columns);
+};
+
+} //namespace LBLMC
+
+#endif //SPARSESYSTEMCONDUCTANCE_HPP
@@ -0,0 +1,399 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "SwitchedSystemSolverBank.hpp"
+#include "SystemSourceVector.hpp"
+#include "WoodburyInverseUpdater.hpp"
+#include "LBLMC/comp/ResistiveSwitch.hpp"
+#include <sstream>
+#include <stdexcept>
+
+namespace LBLMC
+{
+
+SwitchedSystemSolverBank::SwitchedSystemSolverBank(const SystemNetlist& netlist, NumType dt, unsigned int capacity,
+		unsigned int max_update_switches) :
+	dimension(0), G_open(), switch_elements(), switch_npos(), switch_nneg(), switch_delta(), initial_mask(0),
+	capacity(capacity), max_update_switches(max_update_switches), entries(), use_order(),
+	num_selects(0), num_hits(0), num_inversions(0), num_updates(0), num_evictions(0)
+{
+	reset(netlist, dt, capacity, max_update_switches);
+}
+
+SwitchedSystemSolverBank::SwitchedSystemSolverBank(const SwitchedSystemSolverBank& base) :
+	dimension(0), G_open(), switch_elements(), switch_npos(), switch_nneg(), switch_delta(), initial_mask(0),
+	capacity(0), max_update_switches(0), entries(), use_order(),
+	num_selects(0), num_hits(0), num_inversions(0), num_updates(0), num_evictions(0)
+{
+	reset(base);
+}
+
+void SwitchedSystemSolverBank::reset(const SystemNetlist& netlist, NumType dt, unsigned int capacity,
+		unsigned int max_update_switches)
+{
+	dimension = netlist.getDimension();
+
+		//find the switches, and stamp the netlist with all of them open
+
+	SystemNetlist open(netlist);
+
+	switch_elements.clear();
+	switch_npos.clear();
+	switch_nneg.clear();
+	switch_delta.clear();
+	initial_mask = 0;
+
+	for(unsigned int i = 0; i < open.getNumElements(); i++)
+	{
+		SystemNetlist::Element& e = open.getElement(i);
+		if(e.type != SystemNetlist::RESISTIVE_SWITCH) continue;
+
+		if(switch_elements.size() == sizeof(unsigned long)*8)
+		{
+			throw std::runtime_error("SwitchedSystemSolverBank: netlist has more switches than bits of the switch state mask");
+		}
+
+		if(e.params[2] != NumType(0.0)) initial_mask |= (1ul << switch_elements.size());
+
+		ResistiveSwitch comp(e.params[0], e.params[1]);
+
+		switch_elements.push_back(i);
+		switch_npos.push_back(e.nodes[0]);
+		switch_nneg.push_back(e.nodes[1]);
+		switch_delta.push_back(double(comp.getConductance(true)) - double(comp.getConductance(false)));
+
+		e.params[2] = NumType(0.0);
+	}
+
+	SystemConductance conductance(dimension);
+	SystemSourceVector sources(dimension);
+
+	if(open.stampSystem(dt, conductance, sources))
+	{
+		throw std::runtime_error("SwitchedSystemSolverBank: cannot stamp netlist");
+	}
+
+	G_open = conductance.asEigen3Matrix();
+
+	this->capacity = (capacity == 0) ? 1 : capacity;
+	this->max_update_switches = max_update_switches;
+
+	entries.clear();
+	use_order.clear();
+
+	num_selects = 0;
+	num_hits = 0;
+	num_inversions = 0;
+	num_updates = 0;
+	num_evictions = 0;
+}
+
+void SwitchedSystemSolverBank::reset(const SwitchedSystemSolverBank& base)
+{
+	dimension = base.dimension;
+	G_open = base.G_open;
+	switch_elements = base.switch_elements;
+	switch_npos = base.switch_npos;
+	switch_nneg = base.switch_nneg;
+	switch_delta = base.switch_delta;
+	initial_mask = base.initial_mask;
+	capacity = base.capacity;
+	max_update_switches = base.max_update_switches;
+
+		//the entries refer to positions in the use order, so they are rebuilt on the copied order
+
+	use_order = base.use_order;
+	entries.clear();
+	for(std::list<unsigned long>::iterator it = use_order.begin(); it != use_order.end(); ++it)
+	{
+		const Entry& from = base.entries.find(*it)->second;
+		Entry& to = entries[*it];
+		to.A = from.A;
+		to.exact = from.exact;
+		to.use = it;
+	}
+
+	num_selects = base.num_selects;
+	num_hits = base.num_hits;
+	num_inversions = base.num_inversions;
+	num_updates = base.num_updates;
+	num_evictions = base.num_evictions;
+}
+
+const double* SwitchedSystemSolverBank::select(unsigned long mask)
+{
+	num_selects++;
+	if(isCached(mask)) num_hits++;
+
+	return fetch(mask).A.data();
+}
+
+unsigned long SwitchedSystemSolverBank::toMask(const bool* closed) const
+{
+	unsigned long mask = 0;
+	for(unsigned int k = 0; k < switch_elements.size(); k++)
+	{
+		if(closed[k]) mask |= (1ul << k);
+	}
+
+	return mask;
+}
+
+void SwitchedSystemSolverBank::precompute(const std::vector<unsigned long>& masks)
+{
+	for(unsigned int i = 0; i < masks.size() && i < capacity; i++)
+	{
+		fetch(masks[i]);
+	}
+}
+
+int SwitchedSystemSolverBank::precomputeAll()
+{
+	const unsigned int n = switch_elements.size();
+
+	if(n >= sizeof(unsigned long)*8 || (1ul << n) > capacity) return -1;
+
+	for(unsigned long mask = 0; mask < (1ul << n); mask++)
+	{
+		fetch(mask);
+	}
+
+	return 0;
+}
+
+bool SwitchedSystemSolverBank::isCached(unsigned long mask) const
+{
+	return entries.find(mask) != entries.end();
+}
+
+int SwitchedSystemSolverBank::stampConductance(unsigned long mask, SystemConductance& conductance) const
+{
+	if(conductance.getDimension() != dimension) return -1;
+
+	stampConductance(mask, conductance.asEigen3Matrix());
+
+	return 0;
+}
+
+unsigned int SwitchedSystemSolverBank::getDimension() const
+{
+	return dimension;
+}
+
+unsigned int SwitchedSystemSolverBank::getNumSwitches() const
+{
+	return switch_elements.size();
+}
+
+unsigned int SwitchedSystemSolverBank::getSwitchElement(unsigned int k) const
+{
+	return switch_elements[k];
+}
+
+unsigned long SwitchedSystemSolverBank::getInitialMask() const
+{
+	return initial_mask;
+}
+
+unsigned int SwitchedSystemSolverBank::getCapacity() const
+{
+	return capacity;
+}
+
+unsigned int SwitchedSystemSolverBank::getNumCached() const
+{
+	return entries.size();
+}
+
+unsigned long SwitchedSystemSolverBank::getNumSelects() const
+{
+	return num_selects;
+}
+
+unsigned long SwitchedSystemSolverBank::getNumHits() const
+{
+	return num_hits;
+}
+
+unsigned long SwitchedSystemSolverBank::getNumInversions() const
+{
+	return num_inversions;
+}
+
+unsigned long SwitchedSystemSolverBank::getNumUpdates() const
+{
+	return num_updates;
+}
+
+unsigned long SwitchedSystemSolverBank::getNumEvictions() const
+{
+	return num_evictions;
+}
+
+const char* SwitchedSystemSolverBank::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	sstrm << "Switched System Solver Bank\n\n";
+	sstrm << "dimension:         " << dimension << "\n";
+	sstrm << "switches:          " << switch_elements.size() << "\n";
+	sstrm << "cached inverses:   " << entries.size() << " of " << capacity << "\n";
+	sstrm << "update switches:   " << max_update_switches << "\n\n";
+	sstrm << "selects:           " << num_selects << "\n";
+	sstrm << "hits:              " << num_hits << "\n";
+	sstrm << "full inversions:   " << num_inversions << "\n";
+	sstrm << "low-rank updates:  " << num_updates << "\n";
+	sstrm << "evictions:         " << num_evictions << "\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+void SwitchedSystemSolverBank::stampConductance(unsigned long mask, MatrixRMXd& G) const
+{
+	G = G_open;
+
+	for(unsigned int k = 0; k < switch_elements.size(); k++)
+	{
+		if(!(mask & (1ul << k))) continue;
+
+		const unsigned int npos = switch_npos[k];
+		const unsigned int nneg = switch_nneg[k];
+		const double g = switch_delta[k];
+
+		if(npos == nneg) continue; //switch is shorted out
+
+		if(npos != 0) G(npos-1, npos-1) += g;
+		if(nneg != 0) G(nneg-1, nneg-1) += g;
+		if(npos != 0 && nneg != 0)
+		{
+			G(npos-1, nneg-1) -= g;
+			G(nneg-1, npos-1) -= g;
+		}
+	}
+}
+
+SwitchedSystemSolverBank::Entry& SwitchedSystemSolverBank::fetch(unsigned long mask)
+{
+	std::map<unsigned long, Entry>::iterator found = entries.find(mask);
+
+	if(found != entries.end())
+	{
+		use_order.splice(use_order.begin(), use_order, found->second.use);
+		return found->second;
+	}
+
+		//compute before evicting, so the inverse can be derived from any cached one
+
+	Entry computed;
+	compute(mask, computed);
+
+	while(entries.size() >= capacity)
+	{
+		entries.erase(use_order.back());
+		use_order.pop_back();
+		num_evictions++;
+	}
+
+	use_order.push_front(mask);
+
+	Entry& entry = entries[mask];
+	entry.A.swap(computed.A);
+	entry.exact = computed.exact;
+	entry.use = use_order.begin();
+
+	return entry;
+}
+
+void SwitchedSystemSolverBank::compute(unsigned long mask, Entry& entry)
+{
+		//nearest fully inverted state, by number of differing switches
+
+	if(max_update_switches > 0)
+	{
+		unsigned long base = 0;
+		unsigned int fewest = max_update_switches + 1;
+
+		for(std::map<unsigned long, Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+		{
+			if(!it->second.exact) continue;
+
+			unsigned int differing = 0;
+			for(unsigned long diff = it->first ^ mask; diff != 0; diff &= diff - 1) differing++;
+
+			if(differing < fewest)
+			{
+				fewest = differing;
+				base = it->first;
+			}
+		}
+
+		if(fewest <= max_update_switches)
+		{
+			deriveInverse(mask, base, entry);
+			return;
+		}
+	}
+
+	SystemConductance conductance(dimension);
+	stampConductance(mask, conductance.asEigen3Matrix());
+	conductance.invertSelf();
+
+	entry.A.swap(conductance.asEigen3Matrix());
+	entry.exact = true;
+	num_inversions++;
+}
+
+void SwitchedSystemSolverBank::deriveInverse(unsigned long mask, unsigned long base, Entry& entry)
+{
+	MatrixRMXd G_base;
+	stampConductance(base, G_base);
+
+	WoodburyInverseUpdater updater(G_base, entries.find(base)->second.A);
+
+		//change of G by the differing switches
+
+	for(unsigned int s = 0; s < switch_elements.size(); s++)
+	{
+		if(!((mask ^ base) & (1ul << s))) continue;
+
+		const double g = (mask & (1ul << s)) ? switch_delta[s] : -switch_delta[s];
+		updater.addBranchChange(switch_npos[s], switch_nneg[s], g);
+	}
+
+		//the updater re-inverts the changed G if the update is singular or its residual is too large
+
+	if(updater.update() == 0)
+	{
+		entry.exact = false;
+		num_updates++;
+	}
+	else
+	{
+		entry.exact = true;
+		num_inversions++;
+	}
+
+	entry.A = updater.getInverse();
+}
+
+} //namespace LBLMC
@@ -0,0 +1,204 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef SWITCHEDSYSTEMSOLVERBANK_HPP
+#define SWITCHEDSYSTEMSOLVERBANK_HPP
+
+#include <vector>
+#include <list>
+#include <map>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemConductance.hpp"
+#include "SystemNetlist.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief cache of inverted conductance matrices A = G^-1 of a netlist, one per state of its resistive switches
+ *
+ * A ResistiveSwitch stamps a different conductance when closed and open, so each combination of
+ * switch states has its own conductance matrix and inverse.  The states are numbered by a bitmask:
+ * bit k is the state (1 closed) of the k-th RESISTIVE_SWITCH element of the netlist, in netlist order.
+ *
+ * select() returns the inverse of a state, computing it on first use, so at runtime changing the
+ * switch states costs only the swap of a pointer to a cached matrix.  The inverses are kept in a
+ * least recently used (LRU) store of limited capacity; states can also be precomputed.
+ *
+ * A missing inverse is derived from a cached one that was fully inverted and whose state differs in
+ * few switches, with the Sherman-Morrison-Woodbury identity.  With K the k nodes of the differing
+ * switches and C = dG[K,K] the change of their conductances:
+ *
+ * 	A' = A - A[:,K] * (I + C*A[K,K])^-1 * C * A[K,:]
+ *
+ * which costs O(n^2 k) instead of the O(n^3) of a full inversion.  The update is done by
+ * WoodburyInverseUpdater, so a derived inverse whose residual exceeds its tolerance, or whose update is
+ * singular, is replaced by a full inversion.  Inverses are only derived from fully inverted ones, so
+ * the rounding error of the updates does not chain.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class SwitchedSystemSolverBank
+{
+private:
+
+	/**
+	 * cached inverse of a switch state
+	 */
+	struct Entry
+	{
+		MatrixRMXd A; ///< inverted conductance matrix of the state
+		bool exact; ///< true if fully inverted, false if derived by a low-rank update
+		std::list<unsigned long>::iterator use; ///< position in the use order
+	};
+
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	MatrixRMXd G_open; ///< conductance matrix with all switches open
+
+	std::vector<unsigned int> switch_elements; ///< netlist indices of the switches, in bit order
+	std::vector<unsigned int> switch_npos; ///< positive node of each switch
+	std::vector<unsigned int> switch_nneg; ///< negative node of each switch
+	std::vector<double> switch_delta; ///< conductance change of each switch from open to closed
+	unsigned long initial_mask; ///< switch states stamped in the netlist
+
+	unsigned int capacity; ///< largest number of cached inverses
+	unsigned int max_update_switches; ///< largest number of differing switches to derive an inverse from; 0 to always invert
+
+	std::map<unsigned long, Entry> entries; ///< cached inverses by switch state
+	std::list<unsigned long> use_order; ///< cached switch states, most recently used first
+
+	unsigned long num_selects; ///< statistics: select() calls
+	unsigned long num_hits; ///< statistics: select() calls with the inverse cached
+	unsigned long num_inversions; ///< statistics: full inversions
+	unsigned long num_updates; ///< statistics: inverses derived by low-rank updates
+	unsigned long num_evictions; ///< statistics: inverses evicted from the cache
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param netlist netlist of the system, with RESISTIVE_SWITCH elements
+	 * @param dt simulation time step of the discretized components
+	 * @param capacity largest number of cached inverses
+	 * @param max_update_switches largest number of switches a state may differ in from a fully inverted
+	 * cached state to be derived from it by a low-rank update; 0 to always fully invert
+	 * @throws std::runtime_error if the netlist has more switches than bits of the mask, or cannot be stamped
+	 */
+	SwitchedSystemSolverBank(const SystemNetlist& netlist, NumType dt, unsigned int capacity = 16,
+			unsigned int max_update_switches = 2);
+
+	SwitchedSystemSolverBank(const SwitchedSystemSolverBank& base);
+
+	void reset(const SystemNetlist& netlist, NumType dt, unsigned int capacity = 16, unsigned int max_update_switches = 2);
+	void reset(const SwitchedSystemSolverBank& base);
+
+	/**
+	 * returns the inverted conductance matrix of a switch state, computing it if not cached
+	 *
+	 * The returned matrix stays valid until it is evicted, which happens when capacity more recently
+	 * used states have been selected.
+	 *
+	 * @param mask switch states; bit k is the state (1 closed) of switch k
+	 * @return inverted conductance matrix A = G^-1 of the state, row-major
+	 * @throws std::runtime_error if the conductance matrix of the state is singular
+	 */
+	const double* select(unsigned long mask);
+
+	/**
+	 * @param closed states of the switches, in bit order; true if closed
+	 * @return mask of the switch states
+	 */
+	unsigned long toMask(const bool* closed) const;
+
+	/**
+	 * computes and caches the inverses of the given switch states, up to the capacity
+	 * @param masks switch states to precompute
+	 * @throws std::runtime_error if a conductance matrix is singular
+	 */
+	void precompute(const std::vector<unsigned long>& masks);
+
+	/**
+	 * computes and caches the inverses of all switch states
+	 * @return 0 if successful, -1 if the capacity is less than the number of states
+	 * @throws std::runtime_error if a conductance matrix is singular
+	 */
+	int precomputeAll();
+
+	/**
+	 * @param mask switch states
+	 * @return true if the inverse of the switch states is cached
+	 */
+	bool isCached(unsigned long mask) const;
+
+	/**
+	 * stamps the conductance matrix of a switch state
+	 * @param mask switch states
+	 * @param conductance conductance matrix of the system dimension to store to
+	 * @return 0 if successful, -1 if the dimension does not match
+	 */
+	int stampConductance(unsigned long mask, SystemConductance& conductance) const;
+
+	unsigned int getDimension() const; ///< @return number of solutions in the system
+	unsigned int getNumSwitches() const; ///< @return number of switches, and bits of the mask
+
+	/**
+	 * @param k bit of the switch in the mask
+	 * @return netlist index of the switch
+	 */
+	unsigned int getSwitchElement(unsigned int k) const;
+
+	unsigned long getInitialMask() const; ///< @return switch states stamped in the netlist
+	unsigned int getCapacity() const; ///< @return largest number of cached inverses
+	unsigned int getNumCached() const; ///< @return number of cached inverses
+
+	unsigned long getNumSelects() const; ///< @return number of select() calls
+	unsigned long getNumHits() const; ///< @return number of select() calls with the inverse cached
+	unsigned long getNumInversions() const; ///< @return number of full inversions
+	unsigned long getNumUpdates() const; ///< @return number of inverses derived by low-rank updates
+	unsigned long getNumEvictions() const; ///< @return number of inverses evicted from the cache
+
+	/**
+	 * creates a report, as a string, of the cache and its statistics
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+private:
+
+	void stampConductance(unsigned long mask, MatrixRMXd& G) const;
+
+		/// returns the cached entry of a switch state, computing it and evicting the least recently used if not cached
+	Entry& fetch(unsigned long mask);
+
+		/// computes the inverse of a switch state into entry
+	void compute(unsigned long mask, Entry& entry);
+
+		/// derives the inverse of mask from the fully inverted one of base with WoodburyInverseUpdater; fully inverts instead if the update is singular or inaccurate
+	void deriveInverse(unsigned long mask, unsigned long base, Entry& entry);
+};
+
+} //namespace LBLMC
+
+#endif //SWITCHEDSYSTEMSOLVERBANK_HPP
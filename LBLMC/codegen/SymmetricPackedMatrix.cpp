@@ -0,0 +1,196 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "SymmetricPackedMatrix.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace LBLMC
+{
+
+SymmetricPackedMatrix::SymmetricPackedMatrix(SystemResistance& A, double tolerance) :
+	dimension(0), packed(false), values(), xd()
+{
+	reset(A, tolerance);
+}
+
+SymmetricPackedMatrix::SymmetricPackedMatrix(const NumType* A, unsigned int dimension, double tolerance) :
+	dimension(0), packed(false), values(), xd()
+{
+	reset(A, dimension, tolerance);
+}
+
+SymmetricPackedMatrix::SymmetricPackedMatrix(const SymmetricPackedMatrix& base) :
+	dimension(base.dimension), packed(base.packed), values(base.values), xd(base.xd)
+{
+	//do nothing else
+}
+
+void SymmetricPackedMatrix::reset(SystemResistance& A, double tolerance)
+{
+	store(A.asPointer(), A.getDimension(), tolerance);
+}
+
+void SymmetricPackedMatrix::reset(const NumType* A, unsigned int dimension, double tolerance)
+{
+	store(A, dimension, tolerance);
+}
+
+void SymmetricPackedMatrix::reset(const SymmetricPackedMatrix& base)
+{
+	dimension = base.dimension;
+	packed = base.packed;
+	values = base.values;
+	xd = base.xd;
+}
+
+void SymmetricPackedMatrix::multiply(const NumType* b, NumType* x) const
+{
+	const double* a = values.empty() ? 0 : &values[0];
+
+	if(packed)
+	{
+			//each coefficient of the lower triangle is read once, for its row and its mirrored column
+
+		for(unsigned int r = 0; r < dimension; r++)
+		{
+			const double br = double(b[r]);
+			double sum = 0.0;
+
+			for(unsigned int c = 0; c < r; c++)
+			{
+				sum += a[c]*double(b[c]);
+				xd[c] += a[c]*br;
+			}
+
+			xd[r] = sum + a[r]*br;
+			a += r+1;
+		}
+	}
+	else
+	{
+		for(unsigned int r = 0; r < dimension; r++, a += dimension)
+		{
+			double sum = 0.0;
+			for(unsigned int c = 0; c < dimension; c++)
+			{
+				sum += a[c]*double(b[c]);
+			}
+			xd[r] = sum;
+		}
+	}
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		x[r] = NumType(xd[r]);
+	}
+}
+
+double SymmetricPackedMatrix::get(unsigned int r, unsigned int c) const
+{
+	if(packed) return values[index(r, c)];
+
+	return values[(unsigned long)dimension*r + c];
+}
+
+unsigned int SymmetricPackedMatrix::getDimension() const
+{
+	return dimension;
+}
+
+bool SymmetricPackedMatrix::isPacked() const
+{
+	return packed;
+}
+
+unsigned long SymmetricPackedMatrix::getNumStored() const
+{
+	return values.size();
+}
+
+const std::vector<double>& SymmetricPackedMatrix::getValues() const
+{
+	return values;
+}
+
+unsigned long SymmetricPackedMatrix::index(unsigned int r, unsigned int c)
+{
+	if(c > r)
+	{
+		const unsigned int t = r;
+		r = c;
+		c = t;
+	}
+
+	return (unsigned long)r*(r+1)/2 + c;
+}
+
+template<typename T>
+void SymmetricPackedMatrix::store(const T* A, unsigned int dimension, double tolerance)
+{
+	this->dimension = dimension;
+
+	double largest = 0.0;
+	for(unsigned long i = 0; i < (unsigned long)dimension*dimension; i++)
+	{
+		largest = std::max(largest, std::fabs(double(A[i])));
+	}
+
+	const double bound = tolerance*largest;
+
+	packed = true;
+	for(unsigned int r = 0; r < dimension && packed; r++)
+	{
+		for(unsigned int c = 0; c < r; c++)
+		{
+			if(std::fabs(double(A[(unsigned long)dimension*r+c]) - double(A[(unsigned long)dimension*c+r])) > bound)
+			{
+				packed = false;
+				break;
+			}
+		}
+	}
+
+	if(packed)
+	{
+		values.resize((unsigned long)dimension*(dimension+1)/2);
+		for(unsigned int r = 0; r < dimension; r++)
+		{
+			for(unsigned int c = 0; c <= r; c++)
+			{
+				values[index(r, c)] = 0.5*(double(A[(unsigned long)dimension*r+c]) + double(A[(unsigned long)dimension*c+r]));
+			}
+		}
+	}
+	else
+	{
+		values.resize((unsigned long)dimension*dimension);
+		for(unsigned long i = 0; i < values.size(); i++)
+		{
+			values[i] = double(A[i]);
+		}
+	}
+
+	xd.assign(dimension, 0.0);
+}
+
+} //namespace LBLMC
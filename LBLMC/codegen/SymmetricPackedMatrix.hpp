@@ -0,0 +1,121 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef SYMMETRICPACKEDMATRIX_HPP
+#define SYMMETRICPACKEDMATRIX_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "SystemConductance.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief symmetric packed storage of the inverted conductance matrix A = G^-1, with a symmetric product kernel
+ *
+ * The inverse of the conductance matrix of a passive network is symmetric, so only its lower
+ * triangle is stored, row by row: entry (r,c) with c <= r is at index r*(r+1)/2 + c.  This halves
+ * the coefficient memory, and the product x = A*b reads each stored coefficient once:
+ *
+ * 	x[r] += A(r,c)*b[c],  x[c] += A(r,c)*b[r]   for c < r
+ *
+ * The layout is the same as SystemConductance::exportAsPackedCHeader() and the coefficient arrays
+ * indexed by SystemSolverGenerator::generateSymmetricSystemSolver().
+ *
+ * If the matrix is not symmetric within tolerance, as when stamped with a TwoPortTransconductor,
+ * the full matrix is stored instead and the product falls back to the row-by-row kernel.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class SymmetricPackedMatrix
+{
+private:
+	unsigned int dimension; ///< number of rows and columns of the matrix
+	bool packed; ///< true if the lower triangle is stored packed, false if the full matrix is stored
+	std::vector<double> values; ///< packed lower triangle, or full row-major matrix
+
+	mutable std::vector<double> xd; ///< product accumulated in double
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param A the inverted conductance matrix ( A = G^-1 of Gx=b )
+	 * @param tolerance largest allowed difference between mirrored entries, relative to the largest magnitude entry
+	 */
+	SymmetricPackedMatrix(SystemResistance& A, double tolerance = 1.0e-12);
+
+	/**
+	 * parameter constructor
+	 * @param A the inverted conductance matrix ( A = G^-1 of Gx=b ), row-major
+	 * @param dimension number of solutions in the system Gx=b
+	 * @param tolerance largest allowed difference between mirrored entries, relative to the largest magnitude entry
+	 */
+	SymmetricPackedMatrix(const NumType* A, unsigned int dimension, double tolerance = 1.0e-12);
+
+	SymmetricPackedMatrix(const SymmetricPackedMatrix& base);
+
+	void reset(SystemResistance& A, double tolerance = 1.0e-12);
+	void reset(const NumType* A, unsigned int dimension, double tolerance = 1.0e-12);
+	void reset(const SymmetricPackedMatrix& base);
+
+	/**
+	 * computes x = A*b
+	 * @param b vector of the matrix dimension
+	 * @param x array to store the product to, of the matrix dimension
+	 */
+	void multiply(const NumType* b, NumType* x) const;
+
+	/**
+	 * @param r row index, zero-based
+	 * @param c column index, zero-based
+	 * @return entry (r,c) of the matrix
+	 */
+	double get(unsigned int r, unsigned int c) const;
+
+	unsigned int getDimension() const; ///< @return number of rows and columns of the matrix
+	bool isPacked() const; ///< @return true if stored packed, false if the matrix was not symmetric and is stored full
+	unsigned long getNumStored() const; ///< @return number of stored coefficients
+
+	/**
+	 * @return stored coefficients; the packed lower triangle if isPacked(), otherwise the full row-major matrix
+	 */
+	const std::vector<double>& getValues() const;
+
+	/**
+	 * @param r row index, zero-based
+	 * @param c column index, zero-based
+	 * @return index of entry (r,c) in the packed lower triangle; entries above the diagonal map to their mirror
+	 */
+	static unsigned long index(unsigned int r, unsigned int c);
+
+private:
+
+	template<typename T>
+	void store(const T* A, unsigned int dimension, double tolerance);
+};
+
+} //namespace LBLMC
+
+#endif //SYMMETRICPACKEDMATRIX_HPP
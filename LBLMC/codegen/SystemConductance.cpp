@@ -25,30 +25,100 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #include <fstream>
 #include <iomanip>
 #include <stdexcept>
+#include <limits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <string>
+
+#include "MatrixFile.hpp"
 
 namespace LBLMC
 {
+
+static const int TEXT_EXPORT_BLOCK_ROWS = 256; ///< rows formatted (in parallel) per write of the text exports
+
+/**
+ * formats a matrix row as text, as iostreams would with setprecision(16) and scientific
+ */
+static void formatRow(std::string& line, const MatrixRMXd& matrix, unsigned int r,
+	const char* first_separator, const char* separator)
+{
+	char value[40];
+
+	line.clear();
+	line.reserve(matrix.cols()*26 + 1);
+
+	for(unsigned int c = 0; c < matrix.cols(); c++)
+	{
+		const int length = std::sprintf(value, "%.16e", matrix(r,c));
+		line += (c == 0) ? first_separator : separator;
+		line.append(value, length);
+	}
+	line += '\n';
+}
+
+/**
+ * writes a matrix as text rows, formatting blocks of rows in parallel (with OpenMP)
+ */
+static int writeTextRows(const char* filename, const MatrixRMXd& matrix, const char* first_separator, const char* separator)
+{
+	std::FILE* file = std::fopen(filename, "wb");
+	if(file == 0) return -1;
+
+	const int rows = matrix.rows();
+	std::vector<std::string> lines(TEXT_EXPORT_BLOCK_ROWS);
+
+	bool written = true;
+	for(int block = 0; block < rows && written; block += TEXT_EXPORT_BLOCK_ROWS)
+	{
+		const int block_rows = std::min(TEXT_EXPORT_BLOCK_ROWS, rows - block);
+
+#ifdef _OPENMP
+		#pragma omp parallel for
+#endif
+		for(int k = 0; k < block_rows; k++)
+		{
+			formatRow(lines[k], matrix, block+k, first_separator, separator);
+		}
+
+		for(int k = 0; k < block_rows && written; k++)
+		{
+			written = (std::fwrite(lines[k].data(), 1, lines[k].size(), file) == lines[k].size());
+		}
+	}
+
+	if(std::fclose(file) != 0 || !written) return -1;
+
+	return 0;
+}
 
 SystemConductance::SystemConductance(unsigned int dimension):
-	matrix(MatrixRMXd::Zero(dimension,dimension)), dimension(dimension)
+	matrix(MatrixRMXd::Zero(dimension,dimension)), dimension(dimension), condition(0.0), inversion_method("none")
 {
 	//do nothing else
 }
 
 SystemConductance::SystemConductance(unsigned int dimension, MatrixRMXd* base):
-		matrix(*base), dimension(dimension)
+		matrix(*base), dimension(dimension), condition(0.0), inversion_method("none")
 {
 	//do nothing else
 }
 
 SystemConductance::SystemConductance(const SystemConductance& base) :
-		matrix(base.matrix), dimension(base.dimension)
+		matrix(base.matrix), dimension(base.dimension), condition(base.condition), inversion_method(base.inversion_method)
 {
 	//do nothing else
 }
 
 void SystemConductance::reset(unsigned int dimension, MatrixRMXd* base)
 {
+	condition = 0.0;
+	inversion_method = "none";
+
 	if(base == 0)
 	{
 		this->dimension = dimension;
@@ -64,6 +134,8 @@ void SystemConductance::reset(const SystemConductance& base)
 {
 	dimension = base.dimension;
 	matrix = base.matrix;
+	condition = base.condition;
+	inversion_method = base.inversion_method;
 }
 
 double* SystemConductance::asPointer()
@@ -92,12 +164,106 @@ unsigned int SystemConductance::getDimension()
 
 void SystemConductance::invertSelf()
 {
-	if(!matrix.fullPivLu().isInvertible())
+	if(dimension == 0) return; //an empty matrix is its own inverse; maxCoeff() below needs an entry
+
+	const MatrixRMXd identity = MatrixRMXd::Identity(dimension, dimension);
+	const double min_rcond = std::numeric_limits<double>::epsilon();
+
+	double rcond = 0.0;
+	const char* method;
+
+	const double scale = matrix.cwiseAbs().maxCoeff();
+	const bool symmetric = ((matrix - matrix.transpose()).cwiseAbs().maxCoeff() <= 1e-14*scale);
+
+	if(symmetric)
+	{
+		Eigen::LLT<MatrixRMXd> llt(matrix);
+
+		if(llt.info() == Eigen::Success)
+		{
+			rcond = llt.rcond();
+			if(!(rcond > min_rcond))
+			{
+				throw std::runtime_error("SystemConductance: cannot invert conductance matrix as it is singular");
+			}
+			method = "LLT";
+			matrix = llt.solve(identity);
+		}
+		else //symmetric but not positive definite
+		{
+			Eigen::LDLT<MatrixRMXd> ldlt(matrix);
+
+			rcond = ldlt.rcond();
+
+				//rcond of LDLT does not see rounding-level pivots of singular matrices, so check D too
+			const Eigen::VectorXd d = ldlt.vectorD().cwiseAbs();
+			const bool small_pivot = (d.minCoeff() <= dimension*min_rcond*d.maxCoeff());
+
+			if(ldlt.info() != Eigen::Success || small_pivot || !(rcond > min_rcond))
+			{
+				throw std::runtime_error("SystemConductance: cannot invert conductance matrix as it is singular");
+			}
+			method = "LDLT";
+			matrix = ldlt.solve(identity);
+		}
+	}
+	else
+	{
+		Eigen::PartialPivLU<MatrixRMXd> lu(matrix);
+
+		rcond = lu.rcond();
+		if(!(rcond > min_rcond))
+		{
+			throw std::runtime_error("SystemConductance: cannot invert conductance matrix as it is singular");
+		}
+		method = "PartialPivLU";
+		matrix = lu.solve(identity);
+	}
+
+	condition = 1.0/rcond;
+	inversion_method = method;
+}
+
+double SystemConductance::getConditionEstimate()
+{
+	return condition;
+}
+
+const char* SystemConductance::getInversionMethod()
+{
+	return inversion_method;
+}
+
+void SystemConductance::assignInverse(const double* inverse, double condition, const char* method)
+{
+	std::memcpy(matrix.data(), inverse, std::size_t(dimension)*dimension*sizeof(double));
+
+		//keep inversion_method pointing to a string literal, as invertSelf() does
+	const char* const methods[3] = {"LLT", "LDLT", "PartialPivLU"};
+
+	this->condition = condition;
+	inversion_method = "none";
+	for(unsigned int i = 0; i < 3; i++)
 	{
-		throw std::runtime_error("SystemConductance: cannot invert conductance matrix as it is singular");
+		if(std::strcmp(method, methods[i]) == 0) inversion_method = methods[i];
+	}
+}
+
+bool SystemConductance::isSymmetric(double tolerance)
+{
+	if(dimension == 0) return true;
+
+	const double bound = tolerance*matrix.cwiseAbs().maxCoeff();
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(unsigned int c = 0; c < r; c++)
+		{
+			if(std::fabs(matrix(r,c) - matrix(c,r)) > bound) return false;
+		}
 	}
 
-	matrix = matrix.fullPivLu().inverse();
+	return true;
 }
 
 const char* SystemConductance::spy(std::string& buffer)
@@ -152,44 +318,24 @@ int SystemConductance::exportSpy(const char* filename)
 
 int SystemConductance::exportAsASCIIMatlab(const char* filename)
 {
-	std::fstream file;
-
-	try
-	{
-		file.open(filename, std::fstream::out | std::fstream::trunc);
-	}
-	catch(...)
-	{
-		return -1;
-	}
-
-	file << std::setprecision(16);
-	file << std::fixed;
-	file << std::scientific;
-
-	for(unsigned int r = 0; r < dimension; r++)
-	{
-		for(unsigned int c = 0; c < dimension; c++)
-		{
-			file << "   " << matrix(r,c);
-		}
-		file << "\n";
-	}
-	file << std::flush;
-
-	file.close();
-
-	return 0;
-
+	return writeTextRows(filename, matrix, "   ", "   ");
 }
 
 int SystemConductance::exportAsCSV(const char* filename)
+{
+	return writeTextRows(filename, matrix, "", ", ");
+}
+
+int SystemConductance::exportAsCHeader(const char* filename, const char* mat_name)
 {
 	std::fstream file;
 
+	std::string fname = filename;
+	fname += ".hpp";
+
 	try
 	{
-		file.open(filename, std::fstream::out | std::fstream::trunc);
+		file.open(fname.c_str(), std::fstream::out | std::fstream::trunc);
 	}
 	catch(...)
 	{
@@ -200,16 +346,43 @@ int SystemConductance::exportAsCSV(const char* filename)
 	file << std::fixed;
 	file << std::scientific;
 
+	file <<
+			"/**\n"
+			" *\n"
+			" * LBLMC Vivado HLS Simulation Engine for FPGA Designs\n"
+			" *\n"
+			" * Auto-generated by SystemConductance Object\n"
+			" *\n"
+			" * NOTE: For this header, do not include outside the system solver to avoid linkage/compilation issues\n"
+			" *\n"
+			" */\n\n";
+
+	file << "#ifndef " << mat_name << "_HPP" << "\n";
+	file << "#define " << mat_name << "_HPP" << "\n";
+
+	file << "\n#include \"LBLMC/DataTypes.hpp\"\n\n";
+
+	file << "const LBLMC::NumType " << mat_name << "[" << dimension << "][" << dimension << "] =\n{";
+
 	for(unsigned int r = 0; r < dimension; r++)
 	{
-		file << matrix(r,0);
+		file << "{" << matrix(r,0);
 
 		for(unsigned int c = 1; c < dimension; c++)
 		{
-			file << ", " << matrix(r,c);
+			file << "," << matrix(r,c);
 		}
+		file << "}";
+
+		if(r != dimension-1) file << ",";
+
 		file << "\n";
 	}
+
+	file << "};\n";
+
+	file << "\n#endif";
+
 	file << std::flush;
 
 	file.close();
@@ -217,8 +390,10 @@ int SystemConductance::exportAsCSV(const char* filename)
 	return 0;
 }
 
-int SystemConductance::exportAsCHeader(const char* filename, const char* mat_name)
+int SystemConductance::exportAsPackedCHeader(const char* filename, const char* mat_name, double tolerance)
 {
+	if(!isSymmetric(tolerance)) return exportAsCHeader(filename, mat_name);
+
 	std::fstream file;
 
 	std::string fname = filename;
@@ -233,8 +408,9 @@ int SystemConductance::exportAsCHeader(const char* filename, const char* mat_nam
 		return -1;
 	}
 
+	if(!file.is_open()) return -1;
+
 	file << std::setprecision(16);
-	file << std::fixed;
 	file << std::scientific;
 
 	file <<
@@ -242,8 +418,10 @@ int SystemConductance::exportAsCHeader(const char* filename, const char* mat_nam
 			" *\n"
 			" * LBLMC Vivado HLS Simulation Engine for FPGA Designs\n"
 			" *\n"
-			" * Auto-generated by SystemConductance Object\n"
-			" *\n"
+			" * Auto-generated by SystemConductance Object\n"
+			" *\n"
+			" * Symmetric matrix packed by rows of its lower triangle: entry (r,c), c <= r, is at r*(r+1)/2 + c\n"
+			" *\n"
 			" * NOTE: For this header, do not include outside the system solver to avoid linkage/compilation issues\n"
 			" *\n"
 			" */\n\n";
@@ -253,17 +431,15 @@ int SystemConductance::exportAsCHeader(const char* filename, const char* mat_nam
 
 	file << "\n#include \"LBLMC/DataTypes.hpp\"\n\n";
 
-	file << "const LBLMC::NumType " << mat_name << "[" << dimension << "][" << dimension << "] =\n{";
+	file << "const LBLMC::NumType " << mat_name << "[" << (unsigned long)dimension*(dimension+1)/2 << "] =\n{";
 
 	for(unsigned int r = 0; r < dimension; r++)
 	{
-		file << "{" << matrix(r,0);
-
-		for(unsigned int c = 1; c < dimension; c++)
+		for(unsigned int c = 0; c <= r; c++)
 		{
-			file << "," << matrix(r,c);
+			if(c != 0) file << ",";
+			file << 0.5*(matrix(r,c) + matrix(c,r));
 		}
-		file << "}";
 
 		if(r != dimension-1) file << ",";
 
@@ -276,35 +452,108 @@ int SystemConductance::exportAsCHeader(const char* filename, const char* mat_nam
 
 	file << std::flush;
 
+	const bool good = file.good();
+
 	file.close();
 
-	return 0;
+	return good ? 0 : -1;
 }
 
 int SystemConductance::importFromASCIIMatlab(const char* filename)
 {
-	std::fstream file;
+		//read the whole file, then parse it from memory
 
-	try
+	std::FILE* file = std::fopen(filename, "rb");
+	if(file == 0) return -1;
+
+	std::vector<char> text;
+	char chunk[65536];
+	std::size_t length;
+	while((length = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
 	{
-		file.open(filename, std::fstream::in);
-		if(file.fail()) return -1;
+		text.insert(text.end(), chunk, chunk+length);
 	}
-	catch(...)
+	std::fclose(file);
+	text.push_back('\0');
+
+	reset(dimension);
+
+		//one matrix row per text line: rows are parsed in parallel (with OpenMP)
+
+	std::vector<std::size_t> line_starts;
+	for(std::size_t k = 0; k+1 < text.size(); )
 	{
-		return -1;
+		std::size_t end = k;
+		while(end+1 < text.size() && text[end] != '\n') end++;
+
+		bool blank = true;
+		for(std::size_t m = k; m < end && blank; m++) blank = (std::isspace((unsigned char)text[m]) != 0);
+		if(!blank) line_starts.push_back(k);
+
+		k = end+1;
 	}
 
-	reset(dimension);
+	bool parsed = (line_starts.size() == dimension);
+
+	if(parsed)
+	{
+		int failed = 0;
+
+#ifdef _OPENMP
+		#pragma omp parallel for reduction(+:failed)
+#endif
+		for(int r = 0; r < int(dimension); r++)
+		{
+			const char* p = &text[line_starts[r]];
+			const char* line_end = (unsigned(r)+1 < dimension) ? &text[line_starts[r+1]] : &text[text.size()-1];
+
+			for(unsigned int c = 0; c < dimension; c++)
+			{
+				char* next;
+				matrix(r,c) = std::strtod(p, &next);
+				if(next == p || next > line_end) failed++;
+				p = next;
+			}
+		}
 
-	//in a lazy way, we are not checking the matlab file for proper formatting here, so beware!
+		parsed = (failed == 0);
+	}
 
-	for(unsigned int i = 0; i < dimension*dimension; i++)
+	if(!parsed) //not one row per line; parse as a stream of values
 	{
-		file >> (matrix.data())[i];
+		const char* p = &text[0];
+
+		for(unsigned int i = 0; i < dimension*dimension; i++)
+		{
+			char* next;
+			(matrix.data())[i] = std::strtod(p, &next);
+			if(next == p) return -1;
+			p = next;
+		}
 	}
 
-	file.close();
+	return 0;
+}
+
+int SystemConductance::exportAsBinary(const char* filename)
+{
+	return MatrixFile::write(filename, matrix.data(), dimension, dimension, MatrixFile::ROW_MAJOR);
+}
+
+int SystemConductance::importFromBinary(const char* filename)
+{
+	MatrixFile file;
+
+	if(file.open(filename, true) != 0) return -1; //the entries are read anyway, so verifying them is cheap
+
+	if(file.getRows() != dimension || file.getCols() != dimension) return -1;
+
+	reset(dimension);
+
+	if(file.getLayout() == MatrixFile::ROW_MAJOR)
+		std::memcpy(matrix.data(), file.data(), std::size_t(dimension)*dimension*sizeof(double));
+	else
+		matrix = Eigen::Map<const Eigen::MatrixXd>(file.data(), dimension, dimension);
 
 	return 0;
 }
@@ -54,6 +54,8 @@ class SystemConductance
 private:
 	MatrixRMXd matrix;
 	unsigned int dimension;
+	double condition; ///< L1 condition number estimate of the last inverted matrix; 0 if not inverted
+	const char* inversion_method; ///< factorization used by the last invertSelf()
 
 public:
 
@@ -132,12 +134,53 @@ public:
 	 */
 	unsigned int getDimension();
 
+	/**
+	 * checks if the matrix is symmetric
+	 * @param tolerance largest allowed difference between mirrored entries, relative to the largest magnitude entry
+	 * @return true if symmetric
+	 */
+	bool isSymmetric(double tolerance = 1.0e-12);
+
 	/**
 	 * inverts the conductance matrix and stores the result into itself
+	 *
+	 * The matrix is factored once.  Symmetric matrices, as stamped by passive networks, are factored
+	 * with Cholesky (LLT), or LDLT if not positive definite; other matrices with partial pivot LU.
+	 * The inverse is solved from the factorization with Eigen's blocked kernels, which run
+	 * multithreaded when compiled with OpenMP (-fopenmp).
+	 *
 	 * @throws std::runtime_error if matrix is singular (non-invertible)
 	 */
 	void invertSelf();
 
+	/**
+	 * gets the condition number estimate of the matrix inverted by the last invertSelf()
+	 *
+	 * The estimate is the reciprocal of the factorization's L1 reciprocal condition estimate (rcond).
+	 * Large values (above ~1e12) mean the inverse has few accurate digits.
+	 *
+	 * @return condition number estimate; 0 if the matrix has not been inverted
+	 */
+	double getConditionEstimate();
+
+	/**
+	 * gets the factorization used by the last invertSelf()
+	 * @return "LLT", "LDLT", "PartialPivLU", or "none" if the matrix has not been inverted
+	 */
+	const char* getInversionMethod();
+
+	/**
+	 * replaces the matrix with a precomputed inverse of it, e.g. one loaded from a cache
+	 *
+	 * The condition number estimate and inversion method are set as if invertSelf() had computed the
+	 * inverse.
+	 *
+	 * @param inverse row-major dimension x dimension inverse of the matrix
+	 * @param condition condition number estimate of the inversion
+	 * @param method factorization used by the inversion: "LLT", "LDLT", or "PartialPivLU"
+	 */
+	void assignInverse(const double* inverse, double condition, const char* method);
+
 	/**
 	 * generates a sparsity pattern of conductance matrix and stores into given string buffer
 	 *
@@ -196,19 +239,62 @@ public:
 	 */
 	int exportAsCHeader(const char* filename, const char* mat_name);
 
+	/**
+	 * exports a symmetric matrix to a C/C++ Header file as a packed constant 1D array of its lower triangle
+	 *
+	 * Inverses of passive conductance matrices are symmetric, so only the N*(N+1)/2 entries on and below
+	 * the diagonal are written, row by row: entry (r,c) with c <= r is at index r*(r+1)/2 + c
+	 * (SymmetricPackedMatrix::index()).  Each entry is the mean of the mirrored pair.  If the matrix is
+	 * not symmetric within tolerance (e.g. stamped with a TwoPortTransconductor), the full matrix is
+	 * written as by exportAsCHeader() instead.
+	 *
+	 * @param filename filename of the header file to store matrix as array, without file extension; the actual filename will be "<filename>.hpp"
+	 * @param mat_name C/C++ compatible name for the matrix array in header file; with no spaces
+	 * @param tolerance largest allowed difference between mirrored entries, relative to the largest magnitude entry
+	 * @return 0 if successful, -1 if fails to open/write to file
+	 */
+	int exportAsPackedCHeader(const char* filename, const char* mat_name, double tolerance = 1.0e-12);
+
 	/**
 	 * imports a matrix from a given MATLAB ASCII text file into the conductance matrix
 	 *
 	 * The imported MATLAB ASCII file must have been generated with MATLAB command: save file.txt matrix -ascii -double
 	 *
 	 * In this version, the imported matrix from the file is expected to be square and same dimension as this object.
-	 * Also, this version does not check the file for proper formatting, so beware!
+	 * The file is read at once and parsed from memory, one row per line in parallel (with OpenMP).
+	 * Formatting is only checked for missing values, so beware!
 	 *
 	 * @param filename filename of the matlab ASCII text file from which to import the matrix
-	 * @return 0 if successful, -1 if fails to open/read the file
+	 * @return 0 if successful, -1 if fails to open/read the file or it has too few values
 	 */
 	int importFromASCIIMatlab(const char* filename);
 
+	/**
+	 * exports the conductance matrix to a LB-LMC binary matrix file
+	 *
+	 * The entries are stored raw, row-major, after a header with the dimension, entry type, layout, and
+	 * a hash of the entries.  Binary files are written and loaded without text conversion, so they
+	 * should be preferred over the text formats for large matrices.
+	 *
+	 * @see MatrixFile
+	 *
+	 * @param filename filename of the binary matrix file
+	 * @return 0 if successful, -1 if fails to open/write to file
+	 */
+	int exportAsBinary(const char* filename);
+
+	/**
+	 * imports a matrix from a LB-LMC binary matrix file into the conductance matrix
+	 *
+	 * The file is memory mapped and its entries copied directly into the matrix.  To use a matrix
+	 * file without any copy, map it with MatrixFile.
+	 *
+	 * @param filename filename of the binary matrix file
+	 * @return 0 if successful, -1 if fails to open/read the file, the file is corrupted, or its
+	 * dimension does not match
+	 */
+	int importFromBinary(const char* filename);
+
 };
 
 typedef SystemConductance SystemResistance;	///< lazy alias of SystemConductance for Inverted Conductance matrix A = G^-1
@@ -0,0 +1,566 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "SystemDecomposer.hpp"
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+namespace LBLMC
+{
+
+SystemDecomposer::SystemDecomposer(SystemConductance& conductance, double zero_bound) :
+	dimension(0), blocks(), block_of(), position_of(), block_conductances(), block_inverses(), inverted(false)
+{
+	reset(conductance, zero_bound);
+}
+
+SystemDecomposer::SystemDecomposer(SparseSystemConductance& conductance, double zero_bound) :
+	dimension(0), blocks(), block_of(), position_of(), block_conductances(), block_inverses(), inverted(false)
+{
+	reset(conductance, zero_bound);
+}
+
+SystemDecomposer::SystemDecomposer(const SystemDecomposer& base) :
+	dimension(base.dimension), blocks(base.blocks), block_of(base.block_of), position_of(base.position_of),
+	block_conductances(base.block_conductances), block_inverses(base.block_inverses), inverted(base.inverted)
+{
+	//do nothing else
+}
+
+void SystemDecomposer::reset(SystemConductance& conductance, double zero_bound)
+{
+	dimension = conductance.getDimension();
+	const MatrixRMXd& G = conductance.asEigen3Matrix();
+
+		//nodes r and c are coupled if either G(r,c) or G(c,r) is non-zero
+
+	std::vector<std::vector<unsigned int> > adjacency(dimension);
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(unsigned int c = r+1; c < dimension; c++)
+		{
+			if(std::fabs(G(r,c)) > zero_bound || std::fabs(G(c,r)) > zero_bound)
+			{
+				adjacency[r].push_back(c);
+				adjacency[c].push_back(r);
+			}
+		}
+	}
+
+	decompose(adjacency);
+
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		const std::vector<unsigned int>& nodes = blocks[k];
+		MatrixRMXd& Gk = block_conductances[k];
+
+		for(unsigned int i = 0; i < nodes.size(); i++)
+		{
+			for(unsigned int j = 0; j < nodes.size(); j++)
+			{
+				Gk(i,j) = G(nodes[i], nodes[j]);
+			}
+		}
+	}
+}
+
+void SystemDecomposer::reset(SparseSystemConductance& conductance, double zero_bound)
+{
+	dimension = conductance.getDimension();
+	const SparseMatrixRMXd& G = conductance.asEigen3SparseMatrix();
+
+	std::vector<std::vector<unsigned int> > adjacency(dimension);
+	for(int r = 0; r < G.outerSize(); r++)
+	{
+		for(SparseMatrixRMXd::InnerIterator it(G, r); it; ++it)
+		{
+			const unsigned int c = it.col();
+			if(c == unsigned(r) || std::fabs(it.value()) <= zero_bound) continue;
+
+			adjacency[r].push_back(c);
+			adjacency[c].push_back(r);
+		}
+	}
+
+	decompose(adjacency);
+
+	for(int r = 0; r < G.outerSize(); r++)
+	{
+		for(SparseMatrixRMXd::InnerIterator it(G, r); it; ++it)
+		{
+			const unsigned int c = it.col();
+			if(block_of[r] != block_of[c]) continue; //at or below zero_bound
+
+			block_conductances[block_of[r]](position_of[r], position_of[c]) = it.value();
+		}
+	}
+}
+
+void SystemDecomposer::reset(const SystemDecomposer& base)
+{
+	dimension = base.dimension;
+	blocks = base.blocks;
+	block_of = base.block_of;
+	position_of = base.position_of;
+	block_conductances = base.block_conductances;
+	block_inverses = base.block_inverses;
+	inverted = base.inverted;
+}
+
+void SystemDecomposer::decompose(const std::vector<std::vector<unsigned int> >& adjacency)
+{
+	const unsigned int unassigned = ~0u;
+
+	blocks.clear();
+	block_of.assign(dimension, unassigned);
+	position_of.assign(dimension, 0);
+
+		//breadth-first search from the lowest unassigned node gives one connected component per pass
+
+	std::vector<unsigned int> queue;
+	for(unsigned int n = 0; n < dimension; n++)
+	{
+		if(block_of[n] != unassigned) continue;
+
+		const unsigned int k = blocks.size();
+		queue.clear();
+		queue.push_back(n);
+		block_of[n] = k;
+
+		for(unsigned int q = 0; q < queue.size(); q++)
+		{
+			const std::vector<unsigned int>& neighbours = adjacency[queue[q]];
+			for(unsigned int i = 0; i < neighbours.size(); i++)
+			{
+				if(block_of[neighbours[i]] != unassigned) continue;
+				block_of[neighbours[i]] = k;
+				queue.push_back(neighbours[i]);
+			}
+		}
+
+		std::sort(queue.begin(), queue.end());
+		blocks.push_back(queue);
+
+		for(unsigned int i = 0; i < queue.size(); i++)
+		{
+			position_of[queue[i]] = i;
+		}
+	}
+
+	block_conductances.resize(blocks.size());
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		block_conductances[k] = MatrixRMXd::Zero(blocks[k].size(), blocks[k].size());
+	}
+
+	block_inverses.clear();
+	inverted = false;
+}
+
+void SystemDecomposer::invertBlocks()
+{
+	std::vector<MatrixRMXd> inverses(blocks.size());
+
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		SystemConductance Gk(blocks[k].size());
+		Gk.asEigen3Matrix() = block_conductances[k];
+
+		try
+		{
+			Gk.invertSelf();
+		}
+		catch(std::runtime_error& e)
+		{
+			std::stringstream sstrm;
+			sstrm << "SystemDecomposer::invertBlocks() : block " << k << " (node " << (blocks[k][0]+1) << ") -- " << e.what();
+			throw std::runtime_error(sstrm.str());
+		}
+
+		inverses[k] = Gk.asEigen3Matrix();
+	}
+
+	block_inverses.swap(inverses);
+	inverted = true;
+}
+
+bool SystemDecomposer::isInverted() const
+{
+	return inverted;
+}
+
+unsigned int SystemDecomposer::getDimension() const
+{
+	return dimension;
+}
+
+unsigned int SystemDecomposer::getNumBlocks() const
+{
+	return blocks.size();
+}
+
+unsigned int SystemDecomposer::getBlockDimension(unsigned int k) const
+{
+	return blocks[k].size();
+}
+
+unsigned int SystemDecomposer::getLargestBlockDimension() const
+{
+	unsigned int largest = 0;
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		largest = std::max(largest, (unsigned int)(blocks[k].size()));
+	}
+	return largest;
+}
+
+const std::vector<unsigned int>& SystemDecomposer::getBlockNodes(unsigned int k) const
+{
+	return blocks[k];
+}
+
+unsigned int SystemDecomposer::getBlockOf(unsigned int node) const
+{
+	return block_of[node];
+}
+
+std::vector<unsigned int> SystemDecomposer::getPermutation() const
+{
+	std::vector<unsigned int> permutation;
+	permutation.reserve(dimension);
+
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		permutation.insert(permutation.end(), blocks[k].begin(), blocks[k].end());
+	}
+
+	return permutation;
+}
+
+const MatrixRMXd& SystemDecomposer::getBlockConductance(unsigned int k) const
+{
+	return block_conductances[k];
+}
+
+const MatrixRMXd& SystemDecomposer::getBlockInverse(unsigned int k) const
+{
+	static const MatrixRMXd empty;
+	if(!inverted) return empty;
+	return block_inverses[k];
+}
+
+unsigned long SystemDecomposer::getBlockStorage() const
+{
+	unsigned long storage = 0;
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		storage += (unsigned long)(blocks[k].size())*blocks[k].size();
+	}
+	return storage;
+}
+
+int SystemDecomposer::assembleInverse(NumType* A) const
+{
+	if(!inverted) return -1;
+
+	for(unsigned int i = 0; i < dimension*dimension; i++)
+	{
+		A[i] = NumType(0.0);
+	}
+
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		const std::vector<unsigned int>& nodes = blocks[k];
+		const MatrixRMXd& Ak = block_inverses[k];
+
+		for(unsigned int i = 0; i < nodes.size(); i++)
+		{
+			for(unsigned int j = 0; j < nodes.size(); j++)
+			{
+				A[dimension*nodes[i] + nodes[j]] = NumType(Ak(i,j));
+			}
+		}
+	}
+
+	return 0;
+}
+
+int SystemDecomposer::solve(const NumType* b, NumType* x) const
+{
+	if(!inverted) return -1;
+
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		const std::vector<unsigned int>& nodes = blocks[k];
+		const MatrixRMXd& Ak = block_inverses[k];
+
+		for(unsigned int i = 0; i < nodes.size(); i++)
+		{
+			double xi = 0.0;
+			for(unsigned int j = 0; j < nodes.size(); j++)
+			{
+				xi += Ak(i,j)*double(b[nodes[j]]);
+			}
+			x[nodes[i]] = NumType(xi);
+		}
+	}
+
+	return 0;
+}
+
+const char* SystemDecomposer::generateSystemSolver(std::string& buffer, unsigned int num_components, const char* solver_name,
+		const char* A_name, const char* b_func_name, NumType zero_bound)
+{
+	buffer.clear();
+	if(!inverted) return buffer.c_str();
+
+	std::stringstream sstrm;
+
+		//one function per block; each reads and writes only the elements of b and x of its nodes
+
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		const std::vector<unsigned int>& nodes = blocks[k];
+		const MatrixRMXd& Ak = block_inverses[k];
+
+		sstrm <<
+		"void " << solver_name << "_block" << k << "(LBLMC::NumType x["<<dimension<<"], const LBLMC::NumType b["<<dimension<<"])\n"
+		"{\n\t";
+
+		for(unsigned int i = 0; i < nodes.size(); i++)
+		{
+			sstrm << "x[" << nodes[i] << "] = ";
+
+			bool first = true;
+			for(unsigned int j = 0; j < nodes.size(); j++)
+			{
+				if( Ak(i,j) < zero_bound && Ak(i,j) > -zero_bound )
+					continue; // A_k[i,j] is close to zero, so ignore the term.
+
+				if(!first) sstrm << "+ ";
+				sstrm << A_name << "_block" << k << "[" << i << "][" << j << "]*b[" << nodes[j] << "] ";
+				first = false;
+			}
+
+			if(first) sstrm << "LBLMC::NumType(0.0) ";
+
+			sstrm << ";\n\t";
+		}
+
+		sstrm << "\n}\n\n";
+	}
+
+	sstrm <<
+	"void " << solver_name << "(LBLMC::NumType x["<<dimension<<"], LBLMC::NumType b_components["<<num_components<<"])\n"
+	"{\n\t"
+		"LBLMC::NumType b[" << dimension << "];\n\n\t";
+
+	sstrm << b_func_name <<
+	"(b, b_components);\n\n\t";
+
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		sstrm << solver_name << "_block" << k << "(x, b);\n\t";
+	}
+
+	sstrm << "\n}";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+int SystemDecomposer::generateSystemSolverAndExportC(const char* dir, const char* filename, unsigned int num_components,
+		const char* solver_name, const char* A_name, const char* b_func_name, NumType zero_bound)
+{
+	if(!inverted) return -1;
+
+	std::string buf;
+	generateSystemSolver(buf, num_components, solver_name, A_name, b_func_name, zero_bound);
+
+	std::fstream header;
+	std::fstream source;
+
+	std::string hname = dir; hname +=filename; hname += ".hpp";
+	std::string sname = dir; sname +=filename; sname += ".cpp";
+
+	try
+	{
+		header.open((hname).c_str(), std::fstream::out | std::fstream::trunc);
+		source.open((sname).c_str(), std::fstream::out | std::fstream::trunc);
+	}
+	catch(...)
+	{
+		header.close();
+		source.close();
+		return -1;
+	}
+
+	if(!header.is_open() || !source.is_open())
+	{
+		header.close();
+		source.close();
+		return -1;
+	}
+
+	header <<
+			"/**\n"
+			" *\n"
+			" * LBLMC Vivado HLS Simulation Engine for FPGA Designs\n"
+			" *\n"
+			" * Auto-generated by SystemDecomposer Object\n"
+			" *\n"
+			" */\n\n";
+
+	header << "#ifndef " << solver_name << "_HPP\n";
+	header << "#define " << solver_name << "_HPP\n\n";
+	header << "\n#include \"LBLMC/DataTypes.hpp\"\n";
+	header << "#include \""<< A_name << ".hpp\"\n";
+	header << "#include \""<< b_func_name << ".hpp\"\n\n";
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		header << "void " << solver_name << "_block" << k << "(LBLMC::NumType x["<<dimension<<"], const LBLMC::NumType b["<<dimension<<"]);\n";
+	}
+	header << "\nvoid " << solver_name << "(LBLMC::NumType x["<<dimension<<"], LBLMC::NumType b_components["<<num_components<<"]);\n\n";
+	header << "#endif";
+	header.close();
+
+	source << "#include \"" << filename << ".hpp" << "\"\n\n";
+
+	source << buf;
+	source.close();
+
+	return 0;
+}
+
+int SystemDecomposer::exportBlocksAsCHeader(const char* filename, const char* A_name)
+{
+	if(!inverted) return -1;
+
+	std::fstream file;
+
+	std::string fname = filename;
+	fname += ".hpp";
+
+	try
+	{
+		file.open(fname.c_str(), std::fstream::out | std::fstream::trunc);
+	}
+	catch(...)
+	{
+		return -1;
+	}
+
+	if(!file.is_open()) return -1;
+
+	file << std::setprecision(16);
+	file << std::scientific;
+
+	file <<
+			"/**\n"
+			" *\n"
+			" * LBLMC Vivado HLS Simulation Engine for FPGA Designs\n"
+			" *\n"
+			" * Auto-generated by SystemDecomposer Object\n"
+			" *\n"
+			" * NOTE: For this header, do not include outside the system solver to avoid linkage/compilation issues\n"
+			" *\n"
+			" */\n\n";
+
+	file << "#ifndef " << A_name << "_HPP" << "\n";
+	file << "#define " << A_name << "_HPP" << "\n";
+
+	file << "\n#include \"LBLMC/DataTypes.hpp\"\n";
+
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		const unsigned int n = blocks[k].size();
+		const MatrixRMXd& Ak = block_inverses[k];
+
+		file << "\n//block " << k << ": nodes";
+		for(unsigned int i = 0; i < n; i++)
+		{
+			file << " " << (blocks[k][i]+1);
+		}
+		file << "\n";
+
+		file << "const LBLMC::NumType " << A_name << "_block" << k << "[" << n << "][" << n << "] =\n{";
+
+		for(unsigned int r = 0; r < n; r++)
+		{
+			file << "{" << Ak(r,0);
+
+			for(unsigned int c = 1; c < n; c++)
+			{
+				file << "," << Ak(r,c);
+			}
+			file << "}";
+
+			if(r != n-1) file << ",";
+
+			file << "\n";
+		}
+
+		file << "};\n";
+	}
+
+	file << "\n#endif";
+
+	file << std::flush;
+
+	file.close();
+
+	return 0;
+}
+
+const char* SystemDecomposer::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	const double full_storage = double(dimension)*double(dimension);
+
+	sstrm << "System Decomposition\n\n";
+	sstrm << "dimension:       " << dimension << "\n";
+	sstrm << "blocks:          " << blocks.size() << "\n";
+	sstrm << "largest block:   " << getLargestBlockDimension() << "\n";
+	sstrm << "inverse storage: " << getBlockStorage() << " of " << (unsigned long)(full_storage) << " coefficients";
+	if(full_storage > 0.0) sstrm << " (" << 100.0*double(getBlockStorage())/full_storage << "%)";
+	sstrm << "\n\n";
+
+	for(unsigned int k = 0; k < blocks.size(); k++)
+	{
+		sstrm << "block " << k << " (" << blocks[k].size() << "):";
+		for(unsigned int i = 0; i < blocks[k].size(); i++)
+		{
+			sstrm << " " << (blocks[k][i]+1);
+		}
+		sstrm << "\n";
+	}
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+} //namespace LBLMC
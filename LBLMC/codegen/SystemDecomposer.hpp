@@ -0,0 +1,212 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef SYSTEMDECOMPOSER_HPP
+#define SYSTEMDECOMPOSER_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemConductance.hpp"
+#include "SparseSystemConductance.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief decomposes a LB-LMC system model into independent subnetworks (LMC_MODEL_DECOMPOSITION_MODE)
+ *
+ * Under LB-LMC, components such as RLSwitch, MutualInductance2/3 and the converters stamp no
+ * conductance between their terminals; they couple their sides only through source contributions
+ * computed from the previous step.  The conductance matrix G then splits into independent blocks:
+ * the connected components of the graph whose edges are the non-zero off-diagonal entries of G.
+ *
+ * With the nodes reordered into block-diagonal form, G = diag(G_0, G_1, ...), and the inverse is
+ * A = diag(G_0^-1, G_1^-1, ...).  Each block is inverted separately, which costs sum(n_k^3) instead
+ * of n^3, and stores sum(n_k^2) coefficients instead of n^2.  The generated solver has one small
+ * function per block, which are independent of each other and can be scheduled in parallel.
+ *
+ * Nodes are zero-based solution indices here: node n of the netlist is index n-1.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class SystemDecomposer
+{
+private:
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	std::vector<std::vector<unsigned int> > blocks; ///< zero-based solution indices of each block, ascending
+	std::vector<unsigned int> block_of; ///< block of each solution index
+	std::vector<unsigned int> position_of; ///< position of each solution index within its block
+	std::vector<MatrixRMXd> block_conductances; ///< G_k of each block
+	std::vector<MatrixRMXd> block_inverses; ///< A_k = G_k^-1 of each block; empty until invertBlocks()
+	bool inverted;
+
+public:
+
+	/**
+	 * dense decomposition constructor
+	 * @param conductance the (not inverted) conductance matrix G of Gx=b
+	 * @param zero_bound off-diagonal entries with magnitude at or below this bound do not couple nodes
+	 */
+	SystemDecomposer(SystemConductance& conductance, double zero_bound = 0.0);
+
+	/**
+	 * sparse decomposition constructor
+	 * @param conductance the (not inverted) conductance matrix G of Gx=b; pending triplets are compressed
+	 * @param zero_bound off-diagonal entries with magnitude at or below this bound do not couple nodes
+	 */
+	SystemDecomposer(SparseSystemConductance& conductance, double zero_bound = 0.0);
+
+	SystemDecomposer(const SystemDecomposer& base);
+
+	void reset(SystemConductance& conductance, double zero_bound = 0.0);
+	void reset(SparseSystemConductance& conductance, double zero_bound = 0.0);
+	void reset(const SystemDecomposer& base);
+
+	/**
+	 * inverts the conductance matrix of each block
+	 *
+	 * Blocks are inverted with SystemConductance::invertSelf(), so each uses the same factorization
+	 * choice and singularity checks as a full inversion.
+	 *
+	 * @throws std::runtime_error if a block is singular; e.g. a subnetwork with no path to ground
+	 */
+	void invertBlocks();
+
+	/**
+	 * @return true if invertBlocks() has been done
+	 */
+	bool isInverted() const;
+
+	unsigned int getDimension() const; ///< @return number of solutions in the system
+	unsigned int getNumBlocks() const; ///< @return number of independent blocks
+	unsigned int getBlockDimension(unsigned int k) const; ///< @return number of solutions in block k
+	unsigned int getLargestBlockDimension() const; ///< @return number of solutions in the largest block
+
+	/**
+	 * @param k block index
+	 * @return zero-based solution indices of block k, in ascending order
+	 */
+	const std::vector<unsigned int>& getBlockNodes(unsigned int k) const;
+
+	/**
+	 * @param node zero-based solution index
+	 * @return index of the block the node belongs to
+	 */
+	unsigned int getBlockOf(unsigned int node) const;
+
+	/**
+	 * gets the block-diagonal ordering of the nodes
+	 *
+	 * Blocks are in order of their lowest node, and nodes are in ascending order within a block.
+	 *
+	 * @return permutation where element p is the zero-based solution index placed at position p
+	 */
+	std::vector<unsigned int> getPermutation() const;
+
+	/**
+	 * @param k block index
+	 * @return conductance matrix G_k of block k; row/column i is solution getBlockNodes(k)[i]
+	 */
+	const MatrixRMXd& getBlockConductance(unsigned int k) const;
+
+	/**
+	 * @param k block index
+	 * @return inverse A_k of block k, empty if invertBlocks() has not been done
+	 */
+	const MatrixRMXd& getBlockInverse(unsigned int k) const;
+
+	/**
+	 * @return number of coefficients stored by the block inverses, sum(n_k^2)
+	 */
+	unsigned long getBlockStorage() const;
+
+	/**
+	 * scatters the block inverses into a full inverse matrix
+	 *
+	 * Entries coupling different blocks are zero.  The result can be used with generators and
+	 * solvers that take a full A.
+	 *
+	 * @param A array of dimension*dimension elements to store the row-major inverse to
+	 * @return 0 if successful, -1 if the blocks have not been inverted
+	 */
+	int assembleInverse(NumType* A) const;
+
+	/**
+	 * solves x = A*b block by block
+	 * @param b aggregated source vector of the system dimension
+	 * @param x array to store the solution to, of the system dimension
+	 * @return 0 if successful, -1 if the blocks have not been inverted
+	 */
+	int solve(const NumType* b, NumType* x) const;
+
+	/**
+	 * generates a system solver with one function per block
+	 *
+	 * The block functions are named <solver_name>_block<k> and read the block inverses
+	 * <A_name>_block<k> exported by exportBlocksAsCHeader().  The top-level solver has the same
+	 * signature as the one from SystemSolverGenerator::generateSystemSolver().
+	 *
+	 * @param buffer string that will store the source code of the solver
+	 * @param num_components number of components in system to contribute to vector b of Gx=b
+	 * @param solver_name name of the generated solver function
+	 * @param A_name prefix of the block inverse array names in generated code
+	 * @param b_func_name name of the source aggregation function in generated code
+	 * @param zero_bound range from zero within which block inverse coefficients are ignored
+	 * @return the buffer string as a const char* string; empty if the blocks have not been inverted
+	 */
+	const char* generateSystemSolver(std::string& buffer, unsigned int num_components, const char* solver_name = "solveSystem",
+			const char* A_name = "mat_name", const char* b_func_name = "aggregateSources", NumType zero_bound = 1.0e-12);
+
+	/**
+	 * generates the block system solver and exports it as C++ header and source files
+	 * @see generateSystemSolver()
+	 * @return 0 if successful, -1 if the files could not be opened or the blocks have not been inverted
+	 */
+	int generateSystemSolverAndExportC(const char* dir, const char* filename, unsigned int num_components,
+			const char* solver_name = "solveSystem", const char* A_name = "mat_name", const char* b_func_name = "aggregateSources",
+			NumType zero_bound = 1.0e-12);
+
+	/**
+	 * exports the block inverses as constant arrays <A_name>_block<k> in a C++ header file
+	 * @param filename name of the file without the .hpp extension
+	 * @param A_name prefix of the block inverse array names; also the header guard name
+	 * @return 0 if successful, -1 if the file could not be opened or the blocks have not been inverted
+	 */
+	int exportBlocksAsCHeader(const char* filename, const char* A_name);
+
+	/**
+	 * creates a report, as a string, of the blocks of the decomposition
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+private:
+
+	void decompose(const std::vector<std::vector<unsigned int> >& adjacency);
+};
+
+} //namespace LBLMC
+
+#endif //SYSTEMDECOMPOSER_HPP
@@ -0,0 +1,412 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "SystemNetlist.hpp"
+
+#include "LBLMC/comp/Components.hpp"
+#include "LBLMC/comp/RLSwitch.hpp"
+#include "LBLMC/comp/TwoPortTransconductor.hpp"
+#include "LBLMC/comp/ResistiveSwitch.hpp"
+
+namespace LBLMC
+{
+
+SystemNetlist::SystemNetlist(unsigned int dimension) :
+	elements(), dimension(dimension)
+{
+	//do nothing else
+}
+
+SystemNetlist::SystemNetlist(const SystemNetlist& base) :
+	elements(base.elements), dimension(base.dimension)
+{
+	//do nothing else
+}
+
+void SystemNetlist::reset(unsigned int dimension)
+{
+	elements.clear();
+	this->dimension = dimension;
+}
+
+void SystemNetlist::reset(const SystemNetlist& base)
+{
+	elements = base.elements;
+	dimension = base.dimension;
+}
+
+unsigned int SystemNetlist::getDimension() const
+{
+	return dimension;
+}
+
+unsigned int SystemNetlist::getNumElements() const
+{
+	return elements.size();
+}
+
+SystemNetlist::Element& SystemNetlist::getElement(unsigned int index)
+{
+	return elements[index];
+}
+
+const SystemNetlist::Element& SystemNetlist::getElement(unsigned int index) const
+{
+	return elements[index];
+}
+
+unsigned int SystemNetlist::addElement(ElementType type, const char* name, const std::vector<unsigned int>& nodes,
+		const std::vector<NumType>& params)
+{
+	Element elem;
+	elem.type = type;
+	elem.name = name;
+	elem.nodes = nodes;
+	elem.params = params;
+
+	elements.push_back(elem);
+
+	return elements.size()-1;
+}
+
+unsigned int SystemNetlist::addResistor(const char* name, unsigned int npos, unsigned int nneg, NumType res)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(npos); nodes.push_back(nneg);
+	std::vector<NumType> params;
+	params.push_back(res);
+
+	return addElement(RESISTOR, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addInductor(const char* name, unsigned int npos, unsigned int nneg, NumType ind)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(npos); nodes.push_back(nneg);
+	std::vector<NumType> params;
+	params.push_back(ind);
+
+	return addElement(INDUCTOR, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addCapacitor(const char* name, unsigned int npos, unsigned int nneg, NumType cap)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(npos); nodes.push_back(nneg);
+	std::vector<NumType> params;
+	params.push_back(cap);
+
+	return addElement(CAPACITOR, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addDCVoltageSource(const char* name, unsigned int npos, unsigned int nneg, NumType vs, NumType rs)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(npos); nodes.push_back(nneg);
+	std::vector<NumType> params;
+	params.push_back(vs); params.push_back(rs);
+
+	return addElement(DC_VOLTAGE_SOURCE, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addRLSwitch(const char* name, unsigned int npos, unsigned int nneg, NumType l, NumType r)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(npos); nodes.push_back(nneg);
+	std::vector<NumType> params;
+	params.push_back(l); params.push_back(r);
+
+	return addElement(RL_SWITCH, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addMutualInductance2(const char* name, unsigned int npos1, unsigned int nneg1,
+		unsigned int npos2, unsigned int nneg2, NumType L1, NumType L2, NumType M)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(npos1); nodes.push_back(nneg1);
+	nodes.push_back(npos2); nodes.push_back(nneg2);
+	std::vector<NumType> params;
+	params.push_back(L1); params.push_back(L2); params.push_back(M);
+
+	return addElement(MUTUAL_INDUCTANCE2, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addMutualInductance3(const char* name, unsigned int npos1, unsigned int nneg1,
+		unsigned int npos2, unsigned int nneg2, unsigned int npos3, unsigned int nneg3,
+		NumType L1, NumType L2, NumType L3, NumType M12, NumType M23, NumType M31)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(npos1); nodes.push_back(nneg1);
+	nodes.push_back(npos2); nodes.push_back(nneg2);
+	nodes.push_back(npos3); nodes.push_back(nneg3);
+	std::vector<NumType> params;
+	params.push_back(L1); params.push_back(L2); params.push_back(L3);
+	params.push_back(M12); params.push_back(M23); params.push_back(M31);
+
+	return addElement(MUTUAL_INDUCTANCE3, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addTwoPhaseHBConverter(const char* name, unsigned int np, unsigned int nn,
+		unsigned int na, unsigned int nb, NumType cap, NumType ind, NumType res)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(np); nodes.push_back(nn);
+	nodes.push_back(na); nodes.push_back(nb);
+	std::vector<NumType> params;
+	params.push_back(cap); params.push_back(ind); params.push_back(res);
+
+	return addElement(TWO_PHASE_HB_CONVERTER, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addThreePhaseHBConverter(const char* name, unsigned int np, unsigned int nn,
+		unsigned int na, unsigned int nb, unsigned int nc, NumType cap, NumType ind, NumType res)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(np); nodes.push_back(nn);
+	nodes.push_back(na); nodes.push_back(nb); nodes.push_back(nc);
+	std::vector<NumType> params;
+	params.push_back(cap); params.push_back(ind); params.push_back(res);
+
+	return addElement(THREE_PHASE_HB_CONVERTER, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addThreePhaseHBConverterUngroundedCap(const char* name, unsigned int np, unsigned int nu,
+		unsigned int nn, unsigned int na, unsigned int nb, unsigned int nc, NumType cap, NumType ind, NumType res)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(np); nodes.push_back(nu); nodes.push_back(nn);
+	nodes.push_back(na); nodes.push_back(nb); nodes.push_back(nc);
+	std::vector<NumType> params;
+	params.push_back(cap); params.push_back(ind); params.push_back(res);
+
+	return addElement(THREE_PHASE_HB_CONVERTER_UNGROUNDED_CAP, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addTwoPortTransconductor(const char* name, unsigned int port1a, unsigned int port1b,
+		unsigned int port2a, unsigned int port2b, NumType transconductance12, NumType transconductance21)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(port1a); nodes.push_back(port1b);
+	nodes.push_back(port2a); nodes.push_back(port2b);
+	std::vector<NumType> params;
+	params.push_back(transconductance12); params.push_back(transconductance21);
+
+	return addElement(TWO_PORT_TRANSCONDUCTOR, name, nodes, params);
+}
+
+unsigned int SystemNetlist::addResistiveSwitch(const char* name, unsigned int npos, unsigned int nneg, NumType r_on, NumType r_off,
+		bool closed)
+{
+	std::vector<unsigned int> nodes;
+	nodes.push_back(npos); nodes.push_back(nneg);
+	std::vector<NumType> params;
+	params.push_back(r_on); params.push_back(r_off); params.push_back(closed ? 1.0 : 0.0);
+
+	return addElement(RESISTIVE_SWITCH, name, nodes, params);
+}
+
+std::vector<unsigned int> SystemNetlist::getConsumedNodes() const
+{
+	std::vector<bool> consumed(dimension, false);
+
+	for(unsigned int i = 0; i < elements.size(); i++)
+	{
+		const Element& e = elements[i];
+
+		if(e.type == RESISTOR || e.type == RESISTIVE_SWITCH || e.type == DC_VOLTAGE_SOURCE || e.type == TWO_PORT_TRANSCONDUCTOR)
+			continue; // update does not read terminal voltages
+
+		for(unsigned int k = 0; k < e.nodes.size(); k++)
+		{
+			const unsigned int n = e.nodes[k];
+			if(n != 0 && n <= dimension) consumed[n-1] = true;
+		}
+	}
+
+	std::vector<unsigned int> nodes;
+	for(unsigned int n = 1; n <= dimension; n++)
+	{
+		if(consumed[n-1]) nodes.push_back(n);
+	}
+
+	return nodes;
+}
+
+int SystemNetlist::stampSystem(NumType dt, SystemConductance& conductance, SystemSourceVector& sources)
+{
+	return stampElements<NumType*>(dt, conductance.asPointer(), conductance.getDimension(), sources);
+}
+
+int SystemNetlist::stampSystem(NumType dt, SparseSystemConductance& conductance, SystemSourceVector& sources)
+{
+	int ret = stampElements<std::vector<ConductanceTriplet>&>(dt, conductance.asTriplets(), conductance.getDimension(), sources);
+
+	conductance.compress();
+
+	return ret;
+}
+
+int SystemNetlist::stampElementConductance(unsigned int index, NumType dt, std::vector<ConductanceTriplet>& triplets) const
+{
+	std::vector<unsigned int> src;
+	bool constant = false;
+	NumType constant_value = 0.0;
+
+	return stampElement<std::vector<ConductanceTriplet>&>(elements[index], dt, triplets, dimension, src, constant, constant_value);
+}
+
+template<class ConductanceStorage>
+int SystemNetlist::stampElements(NumType dt, ConductanceStorage G, unsigned int dim, SystemSourceVector& sources)
+{
+	for(unsigned int i = 0; i < elements.size(); i++)
+	{
+		Element& e = elements[i];
+
+		std::vector<unsigned int> src;
+		bool constant = false; //component output is time-invariant
+		NumType constant_value = 0.0;
+
+		int ret = stampElement<ConductanceStorage>(e, dt, G, dim, src, constant, constant_value);
+
+		if(ret) return ret;
+
+		e.sources.clear();
+		for(unsigned int k = 0; k+1 < src.size(); k+=2)
+		{
+			e.sources.push_back(sources.insertSource(src[k], src[k+1]));
+		}
+
+		if(constant && !e.sources.empty() && e.sources[0] != 0)
+		{
+			sources.setConstantSource(e.sources[0], constant_value);
+		}
+	}
+
+	return 0;
+}
+
+template<class ConductanceStorage>
+int SystemNetlist::stampElement(const Element& e, NumType dt, ConductanceStorage G, unsigned int dim,
+		std::vector<unsigned int>& src, bool& constant, NumType& constant_value)
+{
+	const std::vector<unsigned int>& n = e.nodes;
+	const std::vector<NumType>& p = e.params;
+
+	int ret = 0;
+
+	switch(e.type)
+	{
+	case RESISTOR:
+	{
+		Resistor comp(p[0]);
+		ret = comp.stampConductance(G, dim, n[0], n[1]);
+		break;
+	}
+	case INDUCTOR:
+	{
+		Inductor comp(dt, p[0]);
+		ret = comp.stampConductance(G, dim, n[0], n[1]);
+		comp.stampSources(src, n[0], n[1]);
+		break;
+	}
+	case CAPACITOR:
+	{
+		Capacitor comp(dt, p[0]);
+		ret = comp.stampConductance(G, dim, n[0], n[1]);
+		comp.stampSources(src, n[0], n[1]);
+		break;
+	}
+	case DC_VOLTAGE_SOURCE:
+	{
+		DCVoltageSource comp(p[0], p[1]);
+		ret = comp.stampConductance(G, dim, n[0], n[1]);
+		comp.stampSources(src, n[0], n[1]);
+		constant = true;
+		constant_value = comp.getSourceCurrent();
+		break;
+	}
+	case RL_SWITCH:
+	{
+		RLSwitch comp(dt, p[0], p[1]);
+		ret = comp.stampConductance(G, dim, n[0], n[1]);
+		comp.stampSources(src, n[0], n[1]);
+		break;
+	}
+	case MUTUAL_INDUCTANCE2:
+	{
+		MutualInductance2 comp(dt, p[0], p[1], p[2]);
+		ret = comp.stampConductance(G, dim, n[0], n[1], n[2], n[3]);
+			//one source across each coil, in order of update() outputs
+		src.push_back(n[0]); src.push_back(n[1]);
+		src.push_back(n[2]); src.push_back(n[3]);
+		break;
+	}
+	case MUTUAL_INDUCTANCE3:
+	{
+		MutualInductance3 comp(dt, p[0], p[1], p[2], p[3], p[4], p[5]);
+		ret = comp.stampConductance(G, dim, n[0], n[1], n[2], n[3], n[4], n[5]);
+		comp.stampSources(src, n[0], n[1], n[2], n[3], n[4], n[5]);
+		break;
+	}
+	case TWO_PHASE_HB_CONVERTER:
+	{
+		TwoPhaseHBConverter comp(dt, p[0], p[1], p[2]);
+		ret = comp.stampConductance(G, dim, n[0], n[1], n[2], n[3]);
+			//grounded sources at each terminal, in order of update() outputs
+		for(unsigned int k = 0; k < 4; k++)
+		{
+			src.push_back(n[k]);
+			src.push_back(0);
+		}
+		break;
+	}
+	case THREE_PHASE_HB_CONVERTER:
+	{
+		ThreePhaseHBConverter comp(dt, p[0], p[1], p[2]);
+		ret = comp.stampConductance(G, dim, n[0], n[1], n[2], n[3], n[4]);
+		comp.stampSources(src, n[0], n[1], n[2], n[3], n[4]);
+		break;
+	}
+	case THREE_PHASE_HB_CONVERTER_UNGROUNDED_CAP:
+	{
+		ThreePhaseHBConverterUngroundedCap comp(dt, p[0], p[1], p[2]);
+		ret = comp.stampConductance(G, dim, n[0], n[1], n[2], n[3], n[4], n[5]);
+		comp.stampSources(src, n[0], n[1], n[2], n[3], n[4], n[5]);
+		break;
+	}
+	case TWO_PORT_TRANSCONDUCTOR:
+	{
+		TwoPortTransconductor comp(p[0], p[1]);
+		ret = comp.stampConductance(G, dim, n[0], n[1], n[2], n[3]);
+		break;
+	}
+	case RESISTIVE_SWITCH:
+	{
+		ResistiveSwitch comp(p[0], p[1], p[2] != NumType(0.0));
+		ret = comp.stampConductance(G, dim, n[0], n[1]);
+		break;
+	}
+	}
+
+	return ret;
+}
+
+} //namespace LBLMC
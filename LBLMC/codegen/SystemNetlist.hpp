@@ -0,0 +1,248 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SYSTEMNETLIST_HPP
+#define SYSTEMNETLIST_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "SystemConductance.hpp"
+#include "SparseSystemConductance.hpp"
+#include "SystemSourceVector.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief describes the components of a LB-LMC system model and the nodes they connect
+ *
+ * The netlist holds the type, terminal nodes, and parameters of each component of a model so
+ * that the model can be stamped and processed by code generators as a whole, instead of calling
+ * each component's stamp methods by hand.  Stamping is done by the component classes themselves,
+ * so the netlist stays consistent with the component models.
+ *
+ * Node indices follow the component stamp methods: zero is ground, and node n is solution x[n-1].
+ *
+ * After stampSystem(), each element records the indices of its source contributions in the
+ * SystemSourceVector (b_components[index-1]), in the order of the outputs of its update() method.
+ * A source index of zero means that output was shorted out and has no effect.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class SystemNetlist
+{
+public:
+
+	/**
+	 * component models that can be placed in the netlist
+	 */
+	enum ElementType
+	{
+		RESISTOR,
+		INDUCTOR,
+		CAPACITOR,
+		DC_VOLTAGE_SOURCE,
+		RL_SWITCH,
+		MUTUAL_INDUCTANCE2,
+		MUTUAL_INDUCTANCE3,
+		TWO_PHASE_HB_CONVERTER,
+		THREE_PHASE_HB_CONVERTER,
+		THREE_PHASE_HB_CONVERTER_UNGROUNDED_CAP,
+		TWO_PORT_TRANSCONDUCTOR,
+		RESISTIVE_SWITCH
+	};
+
+	/**
+	 * a component placed in the netlist
+	 */
+	struct Element
+	{
+		ElementType type; ///< component model
+		std::string name; ///< user name of the component
+		std::vector<unsigned int> nodes; ///< terminal nodes, in order of the component stamp methods
+		std::vector<NumType> params; ///< parameters, in order of the component constructor (excluding dt)
+		std::vector<unsigned int> sources; ///< source indices of the component outputs; filled by stampSystem()
+	};
+
+private:
+	std::vector<Element> elements;
+	unsigned int dimension; ///< number of nodes (solutions) of the system, excluding ground
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param dimension number of nodes (solutions) of the system, excluding ground
+	 */
+	SystemNetlist(unsigned int dimension);
+
+	/**
+	 * copy constructor
+	 * @param base netlist to copy from
+	 */
+	SystemNetlist(const SystemNetlist& base);
+
+	/**
+	 * clears the netlist
+	 * @param dimension number of nodes (solutions) of the system, excluding ground
+	 */
+	void reset(unsigned int dimension);
+
+	/**
+	 * resets netlist to be copy of another netlist
+	 * @param base netlist to copy from
+	 */
+	void reset(const SystemNetlist& base);
+
+	/**
+	 * @return number of nodes (solutions) of the system, excluding ground
+	 */
+	unsigned int getDimension() const;
+
+	/**
+	 * @return number of components in the netlist
+	 */
+	unsigned int getNumElements() const;
+
+	/**
+	 * @param index index of the component, as returned when added
+	 * @return reference to the component
+	 */
+	Element& getElement(unsigned int index);
+	const Element& getElement(unsigned int index) const;
+
+	/**
+	 * adds a component to the netlist
+	 * @param type component model
+	 * @param name user name of the component
+	 * @param nodes terminal nodes, in order of the component stamp methods
+	 * @param params parameters, in order of the component constructor (excluding dt)
+	 * @return index of the component in the netlist
+	 */
+	unsigned int addElement(ElementType type, const char* name, const std::vector<unsigned int>& nodes,
+			const std::vector<NumType>& params);
+
+	unsigned int addResistor(const char* name, unsigned int npos, unsigned int nneg, NumType res);
+
+	unsigned int addInductor(const char* name, unsigned int npos, unsigned int nneg, NumType ind);
+
+	unsigned int addCapacitor(const char* name, unsigned int npos, unsigned int nneg, NumType cap);
+
+	unsigned int addDCVoltageSource(const char* name, unsigned int npos, unsigned int nneg, NumType vs, NumType rs);
+
+	unsigned int addRLSwitch(const char* name, unsigned int npos, unsigned int nneg, NumType l, NumType r);
+
+	unsigned int addMutualInductance2(const char* name, unsigned int npos1, unsigned int nneg1,
+			unsigned int npos2, unsigned int nneg2, NumType L1, NumType L2, NumType M);
+
+	unsigned int addMutualInductance3(const char* name, unsigned int npos1, unsigned int nneg1,
+			unsigned int npos2, unsigned int nneg2, unsigned int npos3, unsigned int nneg3,
+			NumType L1, NumType L2, NumType L3, NumType M12, NumType M23, NumType M31);
+
+	unsigned int addTwoPhaseHBConverter(const char* name, unsigned int np, unsigned int nn,
+			unsigned int na, unsigned int nb, NumType cap, NumType ind, NumType res);
+
+	unsigned int addThreePhaseHBConverter(const char* name, unsigned int np, unsigned int nn,
+			unsigned int na, unsigned int nb, unsigned int nc, NumType cap, NumType ind, NumType res);
+
+	unsigned int addThreePhaseHBConverterUngroundedCap(const char* name, unsigned int np, unsigned int nu,
+			unsigned int nn, unsigned int na, unsigned int nb, unsigned int nc, NumType cap, NumType ind, NumType res);
+
+	unsigned int addTwoPortTransconductor(const char* name, unsigned int port1a, unsigned int port1b,
+			unsigned int port2a, unsigned int port2b, NumType transconductance12, NumType transconductance21);
+
+	/**
+	 * adds a ResistiveSwitch; its parameters are r_on, r_off, and the stamped state (1 closed, 0 open)
+	 */
+	unsigned int addResistiveSwitch(const char* name, unsigned int npos, unsigned int nneg, NumType r_on, NumType r_off,
+			bool closed = false);
+
+	/**
+	 * returns the nodes whose voltages are read by the updates of the components
+	 *
+	 * Resistors, resistive switches, DC voltage sources, and transconductors do not read their terminal voltages, so
+	 * nodes only connected to these are not consumed.  Probe nodes must be added by the user.
+	 *
+	 * @return sorted node indices (1 to dimension) read by component updates
+	 */
+	std::vector<unsigned int> getConsumedNodes() const;
+
+	/**
+	 * stamps the conductances and sources of all components into the system (Gx=b)
+	 *
+	 * The conductance matrix and source vector are expected to be empty and of the netlist's
+	 * dimension.  The source indices of each component are recorded in the netlist, and the sources
+	 * of DC voltage sources are marked constant in the source vector.
+	 *
+	 * @param dt simulation time step of the discretized components
+	 * @param conductance conductance matrix to stamp
+	 * @param sources source vector to stamp
+	 * @return 0 if successful, -1 if a component cannot be stamped due to matrix dimension size
+	 */
+	int stampSystem(NumType dt, SystemConductance& conductance, SystemSourceVector& sources);
+
+	/**
+	 * stamps the conductances and sources of all components into the system (Gx=b), with the
+	 * conductance matrix in sparse form for large systems
+	 *
+	 * Same as the dense stampSystem(); the stamped triplets are compressed before returning.
+	 *
+	 * @param dt simulation time step of the discretized components
+	 * @param conductance sparse conductance matrix to stamp
+	 * @param sources source vector to stamp
+	 * @return 0 if successful, -1 if a component cannot be stamped due to matrix dimension size
+	 */
+	int stampSystem(NumType dt, SparseSystemConductance& conductance, SystemSourceVector& sources);
+
+	/**
+	 * stamps the conductance of a single component as triplets
+	 *
+	 * Stamping a component before and after changing its parameters or nodes gives the change of the
+	 * conductance matrix, e.g. for WoodburyInverseUpdater.
+	 *
+	 * @param index index of the component, as returned when added
+	 * @param dt simulation time step of the discretized components
+	 * @param triplets list of conductance triplets to append to
+	 * @return 0 if successful, -1 if the component cannot be stamped due to matrix dimension size
+	 */
+	int stampElementConductance(unsigned int index, NumType dt, std::vector<ConductanceTriplet>& triplets) const;
+
+private:
+
+	/**
+	 * stamps all components into a conductance matrix that is either a dense NumType* array or a
+	 * std::vector<ConductanceTriplet>& list, since the components overload stampConductance() for both
+	 */
+	template<class ConductanceStorage>
+	int stampElements(NumType dt, ConductanceStorage G, unsigned int dim, SystemSourceVector& sources);
+
+	/**
+	 * stamps a component into the conductance storage and appends its source node pairs to src
+	 */
+	template<class ConductanceStorage>
+	static int stampElement(const Element& e, NumType dt, ConductanceStorage G, unsigned int dim,
+			std::vector<unsigned int>& src, bool& constant, NumType& constant_value);
+};
+
+} //namespace LBLMC
+
+#endif //SYSTEMNETLIST_HPP
@@ -0,0 +1,188 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "SystemSolver.hpp"
+#include <map>
+
+namespace LBLMC
+{
+
+SystemSolver::SystemSolver(const NumType* A, unsigned int dimension, SystemSourceVector& sources) :
+	dimension(0), num_sources(0), variable_sources(), AS(), x_const(), bc()
+{
+	reset(A, dimension, sources);
+}
+
+SystemSolver::SystemSolver(SparseSystemConductance& conductance, SystemSourceVector& sources) :
+	dimension(0), num_sources(0), variable_sources(), AS(), x_const(), bc()
+{
+	reset(conductance, sources);
+}
+
+SystemSolver::SystemSolver(const SystemSolver& base) :
+	dimension(base.dimension), num_sources(base.num_sources), variable_sources(base.variable_sources),
+	AS(base.AS), x_const(base.x_const), bc(base.bc)
+{
+	//do nothing else
+}
+
+void SystemSolver::reset(const NumType* A, unsigned int dimension, SystemSourceVector& sources)
+{
+	this->dimension = dimension;
+	setVariableSources(sources);
+
+		//column j of AS is A[:,npos] - A[:,nneg] of source j
+
+	std::map<long, std::vector<long> >& nodes = sources.asMap();
+
+	AS = MatrixRMXd::Zero(dimension, variable_sources.size());
+	for(unsigned int j = 0; j < variable_sources.size(); j++)
+	{
+		const std::vector<long>& n = nodes[variable_sources[j]+1];
+
+		for(unsigned int r = 0; r < dimension; r++)
+		{
+			double a = 0.0;
+			if(n[0] != 0) a += double(A[dimension*r + (n[0]-1)]);
+			if(n[1] != 0) a -= double(A[dimension*r + (n[1]-1)]);
+			AS(r,j) = a;
+		}
+	}
+
+		//x_const = A*b_const
+
+	std::vector<NumType> b_const;
+	sources.computeConstantVector(b_const);
+
+	x_const = Eigen::VectorXd::Zero(dimension);
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		double x = 0.0;
+		for(unsigned int c = 0; c < dimension; c++)
+		{
+			x += double(A[dimension*r+c])*double(b_const[c]);
+		}
+		x_const(r) = x;
+	}
+
+	bc = Eigen::VectorXd::Zero(variable_sources.size());
+}
+
+void SystemSolver::reset(SparseSystemConductance& conductance, SystemSourceVector& sources)
+{
+	dimension = conductance.getDimension();
+	setVariableSources(sources);
+
+		//right hand sides: column j is the incidence S[:,j] of source j, last column is b_const
+
+	std::map<long, std::vector<long> >& nodes = sources.asMap();
+
+	Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(dimension, variable_sources.size()+1);
+	for(unsigned int j = 0; j < variable_sources.size(); j++)
+	{
+		const std::vector<long>& n = nodes[variable_sources[j]+1];
+
+		if(n[0] != 0) rhs(n[0]-1, j) += 1.0;
+		if(n[1] != 0) rhs(n[1]-1, j) -= 1.0;
+	}
+
+	std::vector<NumType> b_const;
+	sources.computeConstantVector(b_const);
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		rhs(r, variable_sources.size()) = double(b_const[r]);
+	}
+
+	Eigen::MatrixXd solution;
+	conductance.solve(rhs, solution);
+
+	AS = solution.leftCols(variable_sources.size());
+	x_const = solution.col(variable_sources.size());
+
+	bc = Eigen::VectorXd::Zero(variable_sources.size());
+}
+
+void SystemSolver::reset(const SystemSolver& base)
+{
+	dimension = base.dimension;
+	num_sources = base.num_sources;
+	variable_sources = base.variable_sources;
+	AS = base.AS;
+	x_const = base.x_const;
+	bc = base.bc;
+}
+
+void SystemSolver::solve(const NumType* b_components, NumType* x)
+{
+	for(unsigned int j = 0; j < variable_sources.size(); j++)
+	{
+		bc(j) = double(b_components[variable_sources[j]]);
+	}
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		x[r] = NumType(x_const(r) + AS.row(r).dot(bc));
+	}
+}
+
+unsigned int SystemSolver::getDimension() const
+{
+	return dimension;
+}
+
+unsigned int SystemSolver::getNumSources() const
+{
+	return num_sources;
+}
+
+unsigned int SystemSolver::getNumVariableSources() const
+{
+	return variable_sources.size();
+}
+
+const Eigen::VectorXd& SystemSolver::getConstantSolution() const
+{
+	return x_const;
+}
+
+const MatrixRMXd& SystemSolver::getSourceMatrix() const
+{
+	return AS;
+}
+
+const std::vector<unsigned int>& SystemSolver::getVariableSources() const
+{
+	return variable_sources;
+}
+
+void SystemSolver::setVariableSources(SystemSourceVector& sources)
+{
+	num_sources = sources.getNumSources();
+
+	variable_sources.clear();
+	for(unsigned int s = 1; s <= num_sources; s++)
+	{
+		if(!sources.isConstantSource(s)) variable_sources.push_back(s-1);
+	}
+}
+
+} //namespace LBLMC
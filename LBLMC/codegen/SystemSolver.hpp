@@ -0,0 +1,126 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SYSTEMSOLVER_HPP
+#define SYSTEMSOLVER_HPP
+
+#include <vector>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemSourceVector.hpp"
+#include "SparseSystemConductance.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief solves a LB-LMC system model at runtime on the host, from source contributions directly
+ *
+ * This is the software counterpart of the solvers generated by SystemSolverGenerator, for offline
+ * simulation and testbenches.  Instead of aggregating b from b_components and computing x = A*b,
+ * the solver works in source space: with S the incidence of the sources on the nodes (b = S*bc),
+ * the matrix AS = A*S is precomputed so that x = AS*bc.
+ *
+ * Sources marked constant in the SystemSourceVector (e.g. DCVoltageSource) are folded into the
+ * offset x_const = A*b_const at construction, so their columns are not part of the per-step product:
+ *
+ * 	x = x_const + AS_var * bc_var
+ *
+ * For large systems, the solver can be built from a SparseSystemConductance instead of A: AS and
+ * x_const are then solved from one sparse factorization of G, and the dense inverse is never formed.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class SystemSolver
+{
+private:
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	unsigned int num_sources; ///< number of source contributions b_components
+	std::vector<unsigned int> variable_sources; ///< zero-based b_components indices of time-varying sources
+	MatrixRMXd AS; ///< A*S for the time-varying sources; dimension x variable_sources.size()
+	Eigen::VectorXd x_const; ///< solution offset from constant sources
+	Eigen::VectorXd bc; ///< gathered time-varying source contributions; written by solve()
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param A the inverted conductance matrix ( A = G^-1 of Gx=b ), row-major
+	 * @param dimension number of solutions in the system Gx=b
+	 * @param sources source vector of the system, with constant sources marked
+	 */
+	SystemSolver(const NumType* A, unsigned int dimension, SystemSourceVector& sources);
+
+	/**
+	 * sparse build constructor
+	 *
+	 * Solves G*AS = S and G*x_const = b_const with a single sparse factorization of G.
+	 *
+	 * @param conductance the (not inverted) conductance matrix G of Gx=b
+	 * @param sources source vector of the system, with constant sources marked
+	 * @throws std::runtime_error if the conductance matrix is singular
+	 */
+	SystemSolver(SparseSystemConductance& conductance, SystemSourceVector& sources);
+
+	SystemSolver(const SystemSolver& base);
+
+	void reset(const NumType* A, unsigned int dimension, SystemSourceVector& sources);
+	void reset(SparseSystemConductance& conductance, SystemSourceVector& sources);
+	void reset(const SystemSolver& base);
+
+	/**
+	 * solves the system for the present source contributions
+	 *
+	 * Entries of b_components of constant sources are not read.  Writes the work vector of the solver,
+	 * so a solver is not to be shared between threads; copy it for each thread instead.
+	 *
+	 * @param b_components source contributions of the components; b_components[index-1] for source index
+	 * @param x array to store the solution to, of the system dimension
+	 */
+	void solve(const NumType* b_components, NumType* x);
+
+	unsigned int getDimension() const; ///< @return number of solutions in the system
+	unsigned int getNumSources() const; ///< @return number of source contributions
+	unsigned int getNumVariableSources() const; ///< @return number of time-varying source contributions in the per-step product
+
+	/**
+	 * @return solution offset x_const = A*b_const of the constant sources
+	 */
+	const Eigen::VectorXd& getConstantSolution() const;
+
+	/**
+	 * @return A*S of the time-varying sources; column j is the response of x to source variable_sources[j]
+	 */
+	const MatrixRMXd& getSourceMatrix() const;
+
+	/**
+	 * @return zero-based b_components indices of the time-varying sources, in column order of getSourceMatrix()
+	 */
+	const std::vector<unsigned int>& getVariableSources() const;
+
+private:
+
+	void setVariableSources(SystemSourceVector& sources);
+};
+
+} //namespace LBLMC
+
+#endif //SYSTEMSOLVER_HPP
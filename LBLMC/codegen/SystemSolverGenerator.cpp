@@ -23,6 +23,10 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
 
 namespace LBLMC
 {
@@ -58,6 +62,7 @@ void SystemSolverGenerator::reset(const SystemSolverGenerator& base)
 const char* SystemSolverGenerator::generateSystemSolver(std::string& buffer, const char* solver_name,const char* A_name, const char* b_func_name)
 {
 	std::stringstream sstrm;
+	std::string row;
 
 	sstrm <<
 	"void " << solver_name << "(LBLMC::NumType x["<<dimension<<"], LBLMC::NumType b_components["<<num_components<<"])\n"
@@ -69,21 +74,104 @@ const char* SystemSolverGenerator::generateSystemSolver(std::string& buffer, con
 
 	for(int r = 0; r < dimension; r++)
 	{
-		sstrm << "x[" << r << "] = ";
-		if( !(A[dimension*r+0] < zero_bound && A[dimension*r+0] > -zero_bound) )
-			sstrm << A_name << "[" << r << "][" << int(0) <<"]*b[" << int(0) << "] ";
-		else
-			sstrm << "LBLMC::NumType(0.0) ";
-		for(int c = 1; c < dimension; c++)
+		generateRow(row, r, A_name);
+		sstrm << row;
+	}
+
+	sstrm << "\n}";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+int SystemSolverGenerator::generateSystemSolverAndExportC(const char* dir, const char* filename, const char* solver_name,const char* A_name, const char* b_func_name)
+{
+	std::string buf;
+	generateSystemSolver(buf,solver_name,A_name,b_func_name);
+
+	return exportC(dir, filename, solver_name, A_name, b_func_name, buf);
+}
+
+const char* SystemSolverGenerator::generatePrunedSystemSolver(std::string& buffer, const std::vector<unsigned int>& consumed_nodes,
+		const char* solver_name, const char* A_name, const char* b_func_name)
+{
+	std::stringstream sstrm;
+	std::string row;
+
+	std::vector<bool> consumed = consumedRows(consumed_nodes);
+
+	sstrm <<
+	"void " << solver_name << "(LBLMC::NumType x["<<dimension<<"], LBLMC::NumType b_components["<<num_components<<"])\n"
+	"{\n\t"
+		"LBLMC::NumType b[" << dimension << "];\n\n\t";
+
+	sstrm << b_func_name <<
+	"(b, b_components);\n\n\t";
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		if(!consumed[r]) continue; // x[r] is never read, so row is eliminated
+
+		generateRow(row, r, A_name);
+		sstrm << row;
+	}
+
+	sstrm << "\n}";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+int SystemSolverGenerator::generatePrunedSystemSolverAndExportC(const char* dir, const char* filename,
+		const std::vector<unsigned int>& consumed_nodes, const char* solver_name, const char* A_name, const char* b_func_name)
+{
+	std::string buf;
+	generatePrunedSystemSolver(buf, consumed_nodes, solver_name, A_name, b_func_name);
+
+	return exportC(dir, filename, solver_name, A_name, b_func_name, buf);
+}
+
+const char* SystemSolverGenerator::generateFoldedSystemSolver(std::string& buffer, SystemSourceVector& sources,
+		const char* solver_name, const char* A_name, const char* b_func_name)
+{
+	std::stringstream sstrm;
+	std::string row;
+
+		//x_const = A*b_const from constant sources
+
+	std::vector<NumType> b_const;
+	sources.computeConstantVector(b_const);
+
+		//columns of A that still have a time-varying source
+
+	std::vector<bool> variable_columns(dimension, false);
+	for(unsigned int c = 0; c < dimension; c++)
+	{
+		std::vector<long>& terms = sources.asVector(c+1);
+		for(unsigned int t = 0; t < terms.size(); t++)
 		{
-			if( A[dimension*r+c] < zero_bound && A[dimension*r+c] > -zero_bound )
-				continue; // A[r,c] is close to zero, so ignore the term.
+			if(!sources.isConstantSource(abs(terms[t]))) variable_columns[c] = true;
+		}
+	}
 
-//			sstrm << "+ " << A_name << "[" << (dimension*r+c) << "]*b[" << c << "] ";
-			sstrm << "+ " << A_name << "[" << r << "][" << c <<"]*b[" << c << "] ";
+	sstrm <<
+	"void " << solver_name << "(LBLMC::NumType x["<<dimension<<"], LBLMC::NumType b_components["<<num_components<<"])\n"
+	"{\n\t"
+		"LBLMC::NumType b[" << dimension << "];\n\n\t";
+
+	sstrm << b_func_name <<
+	"(b, b_components);\n\n\t";
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		double offset = 0.0;
+		for(unsigned int c = 0; c < dimension; c++)
+		{
+			offset += double(A[dimension*r+c])*double(b_const[c]);
 		}
 
-		sstrm << ";\n\t";
+		generateFoldedRow(row, r, A_name, variable_columns, offset);
+		sstrm << row;
 	}
 
 	sstrm << "\n}";
@@ -92,7 +180,220 @@ const char* SystemSolverGenerator::generateSystemSolver(std::string& buffer, con
 	return buffer.c_str();
 }
 
-int SystemSolverGenerator::generateSystemSolverAndExportC(const char* dir, const char* filename, const char* solver_name,const char* A_name, const char* b_func_name)
+int SystemSolverGenerator::generateFoldedSystemSolverAndExportC(const char* dir, const char* filename, SystemSourceVector& sources,
+		const char* solver_name, const char* A_name, const char* b_func_name)
+{
+	std::string buf;
+	generateFoldedSystemSolver(buf, sources, solver_name, A_name, b_func_name);
+
+	return exportC(dir, filename, solver_name, A_name, b_func_name, buf);
+}
+
+bool SystemSolverGenerator::isSymmetric(double tolerance) const
+{
+	double largest = 0.0;
+	for(unsigned long i = 0; i < (unsigned long)dimension*dimension; i++)
+	{
+		largest = std::max(largest, std::fabs(double(A[i])));
+	}
+
+	const double bound = tolerance*largest;
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		for(unsigned int c = 0; c < r; c++)
+		{
+			if(std::fabs(double(A[dimension*r+c]) - double(A[dimension*c+r])) > bound) return false;
+		}
+	}
+
+	return true;
+}
+
+const char* SystemSolverGenerator::generateSymmetricSystemSolver(std::string& buffer, const char* solver_name,
+		const char* A_name, const char* b_func_name, double tolerance)
+{
+	if(!isSymmetric(tolerance)) return generateSystemSolver(buffer, solver_name, A_name, b_func_name);
+
+	std::stringstream sstrm;
+	std::string row;
+
+	sstrm <<
+	"void " << solver_name << "(LBLMC::NumType x["<<dimension<<"], LBLMC::NumType b_components["<<num_components<<"])\n"
+	"{\n\t"
+		"LBLMC::NumType b[" << dimension << "];\n\n\t";
+
+	sstrm << b_func_name <<
+	"(b, b_components);\n\n\t";
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		generatePackedRow(row, r, A_name);
+		sstrm << row;
+	}
+
+	sstrm << "\n}";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+int SystemSolverGenerator::generateSymmetricSystemSolverAndExportC(const char* dir, const char* filename, const char* solver_name,
+		const char* A_name, const char* b_func_name, double tolerance)
+{
+	std::string buf;
+	generateSymmetricSystemSolver(buf, solver_name, A_name, b_func_name, tolerance);
+
+	return exportC(dir, filename, solver_name, A_name, b_func_name, buf);
+}
+
+const char* SystemSolverGenerator::prunedRowsReport(std::string& buffer, const std::vector<unsigned int>& consumed_nodes)
+{
+	std::stringstream sstrm;
+
+	std::vector<bool> consumed = consumedRows(consumed_nodes);
+
+	unsigned int rows_kept = 0;
+	unsigned int terms_total = 0;
+	unsigned int terms_kept = 0;
+	std::vector<unsigned int> eliminated;
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		unsigned int terms = 0;
+		for(unsigned int c = 0; c < dimension; c++)
+		{
+			if( !(A[dimension*r+c] < zero_bound && A[dimension*r+c] > -zero_bound) ) terms++;
+		}
+
+		terms_total += terms;
+
+		if(consumed[r])
+		{
+			rows_kept++;
+			terms_kept += terms;
+		}
+		else
+		{
+			eliminated.push_back(r);
+		}
+	}
+
+	sstrm << "Pruned System Solver Report\n\n";
+	sstrm << "rows computed:    " << rows_kept << " of " << dimension << "\n";
+	sstrm << "rows eliminated:  " << eliminated.size() << "\n";
+	sstrm << "multiply-adds:    " << terms_kept << " of " << terms_total << "\n\n";
+
+	sstrm << "eliminated rows (node : solution):\n";
+	for(unsigned int i = 0; i < eliminated.size(); i++)
+	{
+		sstrm << "\t" << (eliminated[i]+1) << " : x[" << eliminated[i] << "]\n";
+	}
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+void SystemSolverGenerator::generateRow(std::string& buffer, unsigned int r, const char* A_name)
+{
+	std::stringstream sstrm;
+
+	sstrm << "x[" << r << "] = ";
+	if( !(A[dimension*r+0] < zero_bound && A[dimension*r+0] > -zero_bound) )
+		sstrm << A_name << "[" << r << "][" << int(0) <<"]*b[" << int(0) << "] ";
+	else
+		sstrm << "LBLMC::NumType(0.0) ";
+	for(int c = 1; c < dimension; c++)
+	{
+		if( A[dimension*r+c] < zero_bound && A[dimension*r+c] > -zero_bound )
+			continue; // A[r,c] is close to zero, so ignore the term.
+
+//		sstrm << "+ " << A_name << "[" << (dimension*r+c) << "]*b[" << c << "] ";
+		sstrm << "+ " << A_name << "[" << r << "][" << c <<"]*b[" << c << "] ";
+	}
+
+	sstrm << ";\n\t";
+
+	buffer = sstrm.str();
+}
+
+void SystemSolverGenerator::generateFoldedRow(std::string& buffer, unsigned int r, const char* A_name,
+		const std::vector<bool>& variable_columns, double offset)
+{
+	std::stringstream sstrm;
+
+	sstrm << "x[" << r << "] = ";
+
+	bool first = true;
+	if(offset != 0.0)
+	{
+		sstrm << std::setprecision(17) << "LBLMC::NumType(" << offset << ") ";
+		first = false;
+	}
+
+	for(unsigned int c = 0; c < dimension; c++)
+	{
+		if(!variable_columns[c]) continue; // b[c] only has constant sources, which are in the offset
+		if( A[dimension*r+c] < zero_bound && A[dimension*r+c] > -zero_bound )
+			continue; // A[r,c] is close to zero, so ignore the term.
+
+		if(!first) sstrm << "+ ";
+		sstrm << A_name << "[" << r << "][" << c <<"]*b[" << c << "] ";
+		first = false;
+	}
+
+	if(first) sstrm << "LBLMC::NumType(0.0) ";
+
+	sstrm << ";\n\t";
+
+	buffer = sstrm.str();
+}
+
+void SystemSolverGenerator::generatePackedRow(std::string& buffer, unsigned int r, const char* A_name)
+{
+	std::stringstream sstrm;
+
+	sstrm << "x[" << r << "] = ";
+
+	bool first = true;
+	for(unsigned int c = 0; c < dimension; c++)
+	{
+		const NumType a = (A[dimension*r+c] + A[dimension*c+r])/NumType(2.0); // as stored by exportAsPackedCHeader()
+		if( a < zero_bound && a > -zero_bound )
+			continue; // A[r,c] is close to zero, so ignore the term.
+
+		const unsigned int i = (c <= r) ? r : c; // lower triangle entry (i,j) of A[r,c] or its mirror
+		const unsigned int j = (c <= r) ? c : r;
+
+		if(!first) sstrm << "+ ";
+		sstrm << A_name << "[" << ((unsigned long)i*(i+1)/2 + j) << "]*b[" << c << "] ";
+		first = false;
+	}
+
+	if(first) sstrm << "LBLMC::NumType(0.0) ";
+
+	sstrm << ";\n\t";
+
+	buffer = sstrm.str();
+}
+
+std::vector<bool> SystemSolverGenerator::consumedRows(const std::vector<unsigned int>& consumed_nodes) const
+{
+	std::vector<bool> consumed(dimension, false);
+
+	for(unsigned int i = 0; i < consumed_nodes.size(); i++)
+	{
+		const unsigned int n = consumed_nodes[i];
+		if(n == 0 || n > dimension) continue; // ground or not a node of the system
+
+		consumed[n-1] = true;
+	}
+
+	return consumed;
+}
+
+int SystemSolverGenerator::exportC(const char* dir, const char* filename, const char* solver_name, const char* A_name,
+		const char* b_func_name, const std::string& solver_source)
 {
 	//std::fstream file;
 	std::fstream header;
@@ -135,8 +436,7 @@ int SystemSolverGenerator::generateSystemSolverAndExportC(const char* dir, const
 
 	source << "#include \"" << filename << ".hpp" << "\"\n\n";
 
-	std::string buf;
-	source << generateSystemSolver(buf,solver_name,A_name,b_func_name);
+	source << solver_source;
 	source.close();
 
 	return 0;
@@ -25,6 +25,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #include <vector>
 #include <string>
 #include "LBLMC/DataTypes.hpp"
+#include "SystemSourceVector.hpp"
 
 namespace LBLMC
 {
@@ -56,6 +57,114 @@ public:
 
 	int generateSystemSolverAndExportC(const char* dir, const char* filename, const char* solver_name = "solveSystem",
 			const char* A_name = "mat_name", const char* b_func_name = "aggregateSources");
+
+	/**
+	 * generates a system solver that only computes the solutions of the given consumed nodes
+	 *
+	 * In many models, only the nodes that feed component inputs (epos, eneg, ...) or probes are ever
+	 * read after a solve.  The rows of x = A*b for all other nodes are not emitted, and those
+	 * elements of x are left unchanged by the generated solver.  The generated solver has the same
+	 * signature as the one from generateSystemSolver().
+	 *
+	 * @param buffer string that will store the source code of the solver
+	 * @param consumed_nodes node indices (1 to dimension) whose solutions are read; node n is x[n-1].
+	 * Zero (ground) and out of range indices are ignored.
+	 * @param solver_name name of the generated solver function
+	 * @param A_name name of the inverted conductance matrix array in generated code
+	 * @param b_func_name name of the source aggregation function in generated code
+	 * @return the buffer string as a const char* string
+	 */
+	const char* generatePrunedSystemSolver(std::string& buffer, const std::vector<unsigned int>& consumed_nodes,
+			const char* solver_name = "solveSystem", const char* A_name = "mat_name", const char* b_func_name = "aggregateSources");
+
+	/**
+	 * generates pruned system solver and exports it as C++ header and source files
+	 * @see generatePrunedSystemSolver()
+	 * @return 0 if successful, -1 if the files could not be opened
+	 */
+	int generatePrunedSystemSolverAndExportC(const char* dir, const char* filename, const std::vector<unsigned int>& consumed_nodes,
+			const char* solver_name = "solveSystem", const char* A_name = "mat_name", const char* b_func_name = "aggregateSources");
+
+	/**
+	 * generates a system solver with the constant sources of the source vector folded out
+	 *
+	 * The contribution of constant sources (SystemSourceVector::setConstantSource()) to the solution
+	 * never changes, so it is precomputed as the offset x_const = A*b_const and emitted as literals.
+	 * Columns of A for elements of b with only constant sources are dropped from the per-step product.
+	 * The generated solver has the same signature as the one from generateSystemSolver(), and must be
+	 * used with the aggregation function generated by SystemSourceVector::asCFunction() with
+	 * fold_constants set, which leaves constant sources out of b.
+	 *
+	 * @param buffer string that will store the source code of the solver
+	 * @param sources source vector of the system, with constant sources marked
+	 * @param solver_name name of the generated solver function
+	 * @param A_name name of the inverted conductance matrix array in generated code
+	 * @param b_func_name name of the source aggregation function in generated code
+	 * @return the buffer string as a const char* string
+	 */
+	const char* generateFoldedSystemSolver(std::string& buffer, SystemSourceVector& sources,
+			const char* solver_name = "solveSystem", const char* A_name = "mat_name", const char* b_func_name = "aggregateSources");
+
+	/**
+	 * generates constant-folded system solver and exports it as C++ header and source files
+	 * @see generateFoldedSystemSolver()
+	 * @return 0 if successful, -1 if the files could not be opened
+	 */
+	int generateFoldedSystemSolverAndExportC(const char* dir, const char* filename, SystemSourceVector& sources,
+			const char* solver_name = "solveSystem", const char* A_name = "mat_name", const char* b_func_name = "aggregateSources");
+
+	/**
+	 * checks if the inverted conductance matrix is symmetric
+	 * @param tolerance largest allowed difference between mirrored entries, relative to the largest magnitude entry
+	 * @return true if symmetric
+	 */
+	bool isSymmetric(double tolerance = 1.0e-12) const;
+
+	/**
+	 * generates a system solver that reads the inverted conductance matrix from symmetric packed storage
+	 *
+	 * The inverse of a passive conductance matrix is symmetric, so the generated solver indexes a 1D
+	 * array of its lower triangle, as exported by SystemConductance::exportAsPackedCHeader(): A[r][c]
+	 * is read as A_name[r*(r+1)/2 + c] for c <= r, and as its mirror otherwise.  This halves the
+	 * coefficient memory of the solver.  If the matrix is not symmetric within tolerance (e.g. with a
+	 * TwoPortTransconductor), the full solver of generateSystemSolver() is generated instead, which
+	 * matches the full header exportAsPackedCHeader() falls back to with the same tolerance.
+	 *
+	 * @param buffer string that will store the source code of the solver
+	 * @param solver_name name of the generated solver function
+	 * @param A_name name of the packed inverted conductance matrix array in generated code
+	 * @param b_func_name name of the source aggregation function in generated code
+	 * @param tolerance largest allowed difference between mirrored entries, relative to the largest magnitude entry
+	 * @return the buffer string as a const char* string
+	 */
+	const char* generateSymmetricSystemSolver(std::string& buffer, const char* solver_name = "solveSystem",
+			const char* A_name = "mat_name", const char* b_func_name = "aggregateSources", double tolerance = 1.0e-12);
+
+	/**
+	 * generates symmetric packed system solver and exports it as C++ header and source files
+	 * @see generateSymmetricSystemSolver()
+	 * @return 0 if successful, -1 if the files could not be opened
+	 */
+	int generateSymmetricSystemSolverAndExportC(const char* dir, const char* filename, const char* solver_name = "solveSystem",
+			const char* A_name = "mat_name", const char* b_func_name = "aggregateSources", double tolerance = 1.0e-12);
+
+	/**
+	 * creates a report, as a string, of the rows a pruned system solver eliminates
+	 * @param buffer string that will store the report
+	 * @param consumed_nodes node indices (1 to dimension) whose solutions are read
+	 * @return the buffer string as a const char* string
+	 */
+	const char* prunedRowsReport(std::string& buffer, const std::vector<unsigned int>& consumed_nodes);
+
+private:
+
+	void generateRow(std::string& buffer, unsigned int r, const char* A_name);
+	void generatePackedRow(std::string& buffer, unsigned int r, const char* A_name);
+	void generateFoldedRow(std::string& buffer, unsigned int r, const char* A_name,
+			const std::vector<bool>& variable_columns, double offset);
+	std::vector<bool> consumedRows(const std::vector<unsigned int>& consumed_nodes) const;
+	int exportC(const char* dir, const char* filename, const char* solver_name, const char* A_name,
+			const char* b_func_name, const std::string& solver_source);
 };
 
 } //namespace LBLMC
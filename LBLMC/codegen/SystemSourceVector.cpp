@@ -31,13 +31,13 @@ namespace LBLMC
 {
 
 SystemSourceVector::SystemSourceVector(unsigned int dimension) :
-	vector(dimension, std::vector<long>()), source_nodes(), dimension(dimension), src_index(0)
+	vector(dimension, std::vector<long>()), source_nodes(), constant_sources(), dimension(dimension), src_index(0)
 {
 	//do nothing else
 }
 
 SystemSourceVector::SystemSourceVector(const SystemSourceVector& base) :
-	vector(base.vector), source_nodes(base.source_nodes), dimension(base.dimension),
+	vector(base.vector), source_nodes(base.source_nodes), constant_sources(base.constant_sources), dimension(base.dimension),
 	src_index(base.src_index)
 {
 	//do nothing else
@@ -47,6 +47,7 @@ void SystemSourceVector::reset(unsigned int dimension)
 {
 	vector = std::vector<std::vector<long> >(dimension, std::vector<long>());
 	source_nodes.clear();
+	constant_sources.clear();
 	this->dimension = dimension;
 	src_index = 0;
 }
@@ -55,6 +56,7 @@ void SystemSourceVector::reset(const SystemSourceVector& base)
 {
 	vector = base.vector;
 	source_nodes = base.source_nodes;
+	constant_sources = base.constant_sources;
 	dimension = base.dimension;
 	src_index = base.src_index;
 }
@@ -69,6 +71,11 @@ std::map<long, std::vector<long> >& SystemSourceVector::asMap()
 	return source_nodes;
 }
 
+const std::map<long, std::vector<long> >& SystemSourceVector::asMap() const
+{
+	return source_nodes;
+}
+
 unsigned int SystemSourceVector::getDimension() const
 {
 	return dimension;
@@ -79,6 +86,70 @@ unsigned int SystemSourceVector::getNumSources() const
 	return src_index;
 }
 
+std::vector<unsigned int> SystemSourceVector::getSourceNodes() const
+{
+	std::vector<bool> connected(dimension, false);
+
+	std::map<long,std::vector<long> >::const_iterator iter = source_nodes.begin();
+	for(; iter != source_nodes.end(); iter++)
+	{
+		for(unsigned int i = 0; i < iter->second.size(); i++)
+		{
+			const long n = iter->second[i];
+			if(n > 0 && n <= long(dimension)) connected[n-1] = true;
+		}
+	}
+
+	std::vector<unsigned int> nodes;
+	for(unsigned int n = 1; n <= dimension; n++)
+	{
+		if(connected[n-1]) nodes.push_back(n);
+	}
+
+	return nodes;
+}
+
+int SystemSourceVector::setConstantSource(unsigned int src_index, NumType value)
+{
+	if(src_index == 0 || src_index > this->src_index) return -1;
+
+	constant_sources[src_index] = value;
+
+	return 0;
+}
+
+bool SystemSourceVector::isConstantSource(unsigned int src_index) const
+{
+	return constant_sources.find(src_index) != constant_sources.end();
+}
+
+NumType SystemSourceVector::getConstantSourceValue(unsigned int src_index) const
+{
+	std::map<long,NumType>::const_iterator iter = constant_sources.find(src_index);
+	if(iter == constant_sources.end()) return NumType(0.0);
+
+	return iter->second;
+}
+
+unsigned int SystemSourceVector::getNumConstantSources() const
+{
+	return constant_sources.size();
+}
+
+void SystemSourceVector::computeConstantVector(std::vector<NumType>& b_const) const
+{
+	b_const.assign(dimension, NumType(0.0));
+
+	std::map<long,NumType>::const_iterator iter = constant_sources.begin();
+	for(; iter != constant_sources.end(); iter++)
+	{
+		const std::vector<long>& nodes = source_nodes.find(iter->first)->second;
+
+		if(nodes[0] != 0) b_const[nodes[0]-1] += iter->second;
+		if(nodes[1] != 0) b_const[nodes[1]-1] -= iter->second;
+	}
+}
+
 unsigned int SystemSourceVector::insertSource(unsigned int npos, unsigned int nneg)
 {
 	if(npos == nneg) return 0;
@@ -87,11 +158,11 @@ unsigned int SystemSourceVector::insertSource(unsigned int npos, unsigned int nn
 
 	if(npos != 0)
 	{
-		vector[npos-1].push_back(+src_index);
+		vector[npos-1].push_back(+long(src_index));
 	}
 	if(nneg != 0)
 	{
-		vector[nneg-1].push_back(-src_index);
+		vector[nneg-1].push_back(-long(src_index));
 	}
 
 	source_nodes[src_index].push_back(npos);
@@ -149,7 +220,7 @@ const char* SystemSourceVector::asString(std::string& buffer)
 	return buffer.c_str();
 }
 
-const char* SystemSourceVector::asCFunction(std::string& buffer, const char* func_name)
+const char* SystemSourceVector::asCFunction(std::string& buffer, const char* func_name, bool fold_constants)
 {
 	std::stringstream sstrm;
 
@@ -160,7 +231,14 @@ const char* SystemSourceVector::asCFunction(std::string& buffer, const char* fun
 
 	for(unsigned int i = 0; i < dimension; i++)
 	{
-		if(vector[i].empty())
+		std::vector<long> terms;
+		for(unsigned int t = 0; t < vector[i].size(); t++)
+		{
+			if(fold_constants && isConstantSource(abs(vector[i][t]))) continue; // folded into solver offset
+			terms.push_back(vector[i][t]);
+		}
+
+		if(terms.empty())
 		{
 			sstrm << "b[" << i << "] = 0.0;\n\t";
 			continue;
@@ -168,8 +246,8 @@ const char* SystemSourceVector::asCFunction(std::string& buffer, const char* fun
 
 		sstrm << "b[" << i << "] = ";
 
-		std::vector<long>::iterator iter = vector[i].begin();
-		std::vector<long>::iterator end  = vector[i].end();
+		std::vector<long>::iterator iter = terms.begin();
+		std::vector<long>::iterator end  = terms.end();
 		for(iter; iter != end; iter++)
 		{
 			if( (*iter) >= 0)
@@ -194,7 +272,7 @@ const char* SystemSourceVector::asCFunction(std::string& buffer, const char* fun
 	return buffer.c_str();
 }
 
-int SystemSourceVector::exportAsCFunctionSource(const char* dir, const char* filename, const char* func_name)
+int SystemSourceVector::exportAsCFunctionSource(const char* dir, const char* filename, const char* func_name, bool fold_constants)
 {
 	std::fstream file;
 	std::fstream header;
@@ -236,7 +314,7 @@ int SystemSourceVector::exportAsCFunctionSource(const char* dir, const char* fil
 	source << "#include \"" << filename<< ".hpp" << "\"\n\n";
 
 	std::string buf;
-	source << asCFunction(buf,func_name);
+	source << asCFunction(buf,func_name,fold_constants);
 	source.close();
 
 	return 0;
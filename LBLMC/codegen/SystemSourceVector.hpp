@@ -62,6 +62,7 @@ class SystemSourceVector
 private:
 	std::vector<std::vector<long> > vector; ///< vector of vectors that contains the indices of sources that contribute to the source vector b
 	std::map<long,std::vector<long> > source_nodes; ///< map of index of source to source's nodes
+	std::map<long,NumType> constant_sources; ///< map of index of time-invariant source to its value
 	unsigned int dimension; ///< size of the source vector; number of solutions in system Gx=b
 	unsigned int src_index; ///< tracks the current used source index
 
@@ -103,6 +104,7 @@ public:
 	 * @return reference to the ordered map
 	 */
 	std::map<long, std::vector<long> >& asMap();
+	const std::map<long, std::vector<long> >& asMap() const;
 
 	/**
 	 * @return the dimension (number of solutions in Gx=b) of the source vector
@@ -114,6 +116,16 @@ public:
 	 */
 	unsigned int getNumSources() const;
 
+	/**
+	 * returns the nodes that sources are connected across, excluding ground
+	 *
+	 * Components with sources generally read the voltages of these nodes in their update, so this
+	 * is the usual starting set of consumed nodes of SystemSolverGenerator::generatePrunedSystemSolver().
+	 *
+	 * @return sorted node indices (1 to dimension) that sources are connected to
+	 */
+	std::vector<unsigned int> getSourceNodes() const;
+
 	/**
 	 * inserts a contributing source's index into the source vector between given nodes
 	 * @param npos positive node of the source
@@ -139,6 +151,42 @@ public:
     **/
 	std::vector<unsigned int> insertComponents(std::vector<unsigned int> nodes);
 
+	/**
+	 * marks a source as time-invariant, such as the Norton current of a DCVoltageSource
+	 *
+	 * Constant sources can be folded out of the per-step solve: their contribution to the solution is
+	 * a constant offset x_const = A*b_const, so they are left out of the generated aggregation function
+	 * when fold_constants is set, and out of the solvers built from this source vector.
+	 *
+	 * @param src_index nonzero index of the source, as returned by insertSource()
+	 * @param value constant value of the source contribution
+	 * @return 0 if successful, -1 if src_index is not an inserted source
+	 */
+	int setConstantSource(unsigned int src_index, NumType value);
+
+	/**
+	 * @param src_index nonzero index of the source
+	 * @return true if source is marked time-invariant
+	 */
+	bool isConstantSource(unsigned int src_index) const;
+
+	/**
+	 * @param src_index nonzero index of the source
+	 * @return value of the constant source; zero if source is not constant
+	 */
+	NumType getConstantSourceValue(unsigned int src_index) const;
+
+	/**
+	 * @return the number of sources marked time-invariant
+	 */
+	unsigned int getNumConstantSources() const;
+
+	/**
+	 * computes the part of source vector b that is contributed by constant sources
+	 * @param b_const vector that will store the constant part of b; resized to the dimension
+	 */
+	void computeConstantVector(std::vector<NumType>& b_const) const;
+
 	/**
 	 * creates a table, as a string, of the contributing source indices corresponding to each source vector element
 	 * @param buffer string that will store the table
@@ -151,9 +199,10 @@ public:
 	 * The generated function is created from the indices stored in this object.
 	 * @param buffer string that will store the source code for the function
 	 * @param func_name the name of the generated function
+	 * @param fold_constants if true, constant sources are left out of b as they are folded into the solver
 	 * @return buffer string as a const char* string
 	 */
-	const char* asCFunction(std::string& buffer, const char* func_name="aggregateSources");
+	const char* asCFunction(std::string& buffer, const char* func_name="aggregateSources", bool fold_constants = false);
 
 	/**
 	 * Generates the C/C++ source code for a function that aggregates/computes the source vector b from array of given source contributions
@@ -161,9 +210,10 @@ public:
 	 * @param dir existing directory to store source files in, written as "/dir/loc/"; input "" for local directory of calling program; given directory must already exist!
 	 * @param filename filename of the source code files, without extension
 	 * @param func_name the name of the generated function; default is "aggregateSources"
+	 * @param fold_constants if true, constant sources are left out of b as they are folded into the solver
 	 * @return 0 if successful, -1 if fails
 	 */
-	int exportAsCFunctionSource(const char* dir, const char* filename, const char* func_name="aggregateSources");
+	int exportAsCFunctionSource(const char* dir, const char* filename, const char* func_name="aggregateSources", bool fold_constants = false);
 };
 
 } //namespace LBLMC
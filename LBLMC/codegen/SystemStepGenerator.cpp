@@ -0,0 +1,893 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "SystemStepGenerator.hpp"
+#include "SystemConductance.hpp"
+#include "SystemSourceVector.hpp"
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace LBLMC
+{
+
+/**
+ * @return constant as a NumType literal of generated code
+ */
+static std::string literal(double value)
+{
+	std::stringstream sstrm;
+	sstrm << std::setprecision(17) << "LBLMC::NumType(" << value << ")";
+	return sstrm.str();
+}
+
+/**
+ * @return constant of generated code with a value per time step; a literal if the value is the same
+ * for all time steps, else an element of the constant table <step_name>_K indexed by dt_sel
+ * @param values value of the constant for each time step
+ * @param table columns of the constant table; values are appended if not already a column
+ */
+static std::string timestepConstant(const std::vector<double>& values, std::vector< std::vector<double> >& table,
+		const char* step_name)
+{
+	bool uniform = true;
+	for(unsigned int j = 1; j < values.size(); j++)
+	{
+		if(values[j] != values[0]) uniform = false;
+	}
+
+	if(uniform) return literal(values[0]);
+
+	unsigned int column = 0;
+	while(column < table.size() && table[column] != values) column++;
+	if(column == table.size()) table.push_back(values);
+
+	std::stringstream sstrm;
+	sstrm << step_name << "_K[dt_sel][" << column << "]";
+	return sstrm.str();
+}
+
+/**
+ * @return voltage of node n in generated code; zero is ground
+ */
+static std::string nodeVoltage(unsigned int n)
+{
+	if(n == 0) return "LBLMC::NumType(0.0)";
+
+	std::stringstream sstrm;
+	sstrm << "x[" << (n-1) << "]";
+	return sstrm.str();
+}
+
+/**
+ * @return voltage across nodes npos and nneg in generated code; zero is ground
+ */
+static std::string voltageAcross(unsigned int npos, unsigned int nneg)
+{
+	if(npos == 0 && nneg == 0) return "LBLMC::NumType(0.0)";
+	if(nneg == 0) return nodeVoltage(npos);
+	if(npos == 0) return "(-" + nodeVoltage(nneg) + ")";
+	return "(" + nodeVoltage(npos) + " - " + nodeVoltage(nneg) + ")";
+}
+
+/**
+ * @return name of state variable of element in generated code
+ */
+static std::string stateName(unsigned int element, const char* var)
+{
+	std::stringstream sstrm;
+	sstrm << "e" << element << "_" << var;
+	return sstrm.str();
+}
+
+/**
+ * @return number of switch inputs of the update() of element type
+ */
+static unsigned int numSwitchInputs(SystemNetlist::ElementType type)
+{
+	switch(type)
+	{
+	case SystemNetlist::RL_SWITCH: return 1;
+	case SystemNetlist::TWO_PHASE_HB_CONVERTER: return 2;
+	case SystemNetlist::THREE_PHASE_HB_CONVERTER: return 4;
+	case SystemNetlist::THREE_PHASE_HB_CONVERTER_UNGROUNDED_CAP: return 4;
+	default: return 0;
+	}
+}
+
+/**
+ * emits the update of a half-bridge converter component
+ *
+ * Follows TwoPhaseHBConverter::update() (no sw_en) and ThreePhaseHBConverter::update() with the
+ * terminal voltages of the present call, where ipos/ineg are folded into the capacitor updates.
+ * The constants are given as generated code: il_past_gain = 1-hol*res, vc_gain = hoc*cap_conduct.
+ */
+static void emitHBConverterUpdate(std::stringstream& sstrm, unsigned int element, const SystemNetlist::Element& elem,
+		unsigned int phases, bool has_enable, unsigned int sw_offset,
+		const std::string& il_past_gain, const std::string& hol, const std::string& vc_gain, const std::string& hoc)
+{
+	const bool ungrounded = (elem.type == SystemNetlist::THREE_PHASE_HB_CONVERTER_UNGROUNDED_CAP);
+	const unsigned int np = elem.nodes[0];
+	const unsigned int nn = ungrounded ? elem.nodes[2] : elem.nodes[1];
+	const unsigned int first_out = ungrounded ? 3 : 2;
+	const std::string eneu = ungrounded ? nodeVoltage(elem.nodes[1]) : std::string();
+
+	std::string s_il[3] = { "s." + stateName(element, "il1"), "s." + stateName(element, "il2"), "s." + stateName(element, "il3") };
+	std::string s_vc1 = "s." + stateName(element, "vc1");
+	std::string s_vc2 = "s." + stateName(element, "vc2");
+
+	sstrm << "\t{\n";
+	for(unsigned int p = 0; p < phases; p++)
+		sstrm << "\t\tconst LBLMC::NumType il" << (p+1) << "_past = " << s_il[p] << ";\n";
+	sstrm << "\t\tconst LBLMC::NumType vc1_past = " << s_vc1 << ";\n";
+	sstrm << "\t\tconst LBLMC::NumType vc2_past = " << s_vc2 << ";\n";
+	for(unsigned int p = 0; p < phases; p++)
+		sstrm << "\t\tLBLMC::NumType a" << (p+1) << ", b" << (p+1) << ", v" << (p+1) << ";\n";
+	sstrm << "\n";
+
+		//a#, b# are inductor currents into the caps, v# is the cap voltage an inductor is switched to
+
+	std::string indent = "\t\t";
+	if(has_enable)
+	{
+		sstrm << "\t\tif(sw[" << (sw_offset+phases) << "])\n\t\t{\n";
+		indent = "\t\t\t";
+	}
+
+	for(unsigned int p = 0; p < phases; p++)
+	{
+		sstrm <<
+		indent << "if(sw[" << (sw_offset+p) << "]) { a" << (p+1) << " = il" << (p+1) << "_past; b" << (p+1)
+			<< " = LBLMC::NumType(0.0); v" << (p+1) << " = vc1_past; }\n" <<
+		indent << "else { a" << (p+1) << " = LBLMC::NumType(0.0); b" << (p+1) << " = il" << (p+1)
+			<< "_past; v" << (p+1) << " = vc2_past; }\n";
+	}
+
+	if(has_enable)
+	{
+		sstrm << "\t\t}\n\t\telse //switches off, anti-parallel diodes conduct\n\t\t{\n";
+		for(unsigned int p = 0; p < phases; p++)
+		{
+			std::string eout = nodeVoltage(elem.nodes[first_out+p]);
+			sstrm <<
+			"\t\t\tif(il" << (p+1) << "_past > LBLMC::NumType(0.0)) { v" << (p+1) << " = vc2_past; a" << (p+1)
+				<< " = LBLMC::NumType(0.0); b" << (p+1) << " = -il" << (p+1) << "_past; }\n"
+			"\t\t\telse { v" << (p+1) << " = (il" << (p+1) << "_past < LBLMC::NumType(0.0)) ? vc1_past : "
+				<< eout << "; a" << (p+1) << " = il" << (p+1) << "_past; b" << (p+1) << " = LBLMC::NumType(0.0); }\n";
+		}
+		sstrm << "\t\t}\n";
+	}
+	sstrm << "\n";
+
+		//il = il_past + hol*(v - eout - res*il_past)
+
+	for(unsigned int p = 0; p < phases; p++)
+	{
+		sstrm << "\t\t" << s_il[p] << " = " << il_past_gain << "*il" << (p+1) << "_past + "
+			<< hol << "*(v" << (p+1);
+		if(ungrounded) sstrm << " + " << eneu;
+		sstrm << " - " << nodeVoltage(elem.nodes[first_out+p]) << ");\n";
+	}
+
+		//vc = vc_past + hoc*(ipos - a1 - a2 ...), with ipos = cap_conduct*(epos - vc_past) folded in
+
+	sstrm << "\t\t" << s_vc1 << " = vc1_past + " << vc_gain << "*(" << nodeVoltage(np) << " - vc1_past";
+	if(ungrounded) sstrm << " - " << eneu;
+	sstrm << ") - " << hoc << "*(a1";
+	for(unsigned int p = 1; p < phases; p++) sstrm << " + a" << (p+1);
+	sstrm << ");\n";
+
+	sstrm << "\t\t" << s_vc2 << " = vc2_past + " << vc_gain << "*(" << nodeVoltage(nn) << " - vc2_past";
+	if(ungrounded) sstrm << " - " << eneu;
+	sstrm << ") - " << hoc << "*(b1";
+	for(unsigned int p = 1; p < phases; p++) sstrm << " + b" << (p+1);
+	sstrm << ");\n";
+
+	sstrm << "\t}\n";
+}
+
+SystemStepGenerator::SystemStepGenerator(const SystemNetlist& netlist, NumType dt, NumType zero_bound) :
+	netlist(netlist), zero_bound(zero_bound), dimension(netlist.getDimension()), num_sources(0),
+	runtime_timestep(false), bank(netlist, std::vector<NumType>(1, dt)), x_const(), b_terms(), switch_offsets(),
+	num_switches(0), computed_rows()
+{
+	build();
+}
+
+SystemStepGenerator::SystemStepGenerator(const SystemNetlist& netlist, const std::vector<NumType>& timesteps, NumType zero_bound) :
+	netlist(netlist), zero_bound(zero_bound), dimension(netlist.getDimension()), num_sources(0),
+	runtime_timestep(true), bank(netlist, timesteps), x_const(), b_terms(), switch_offsets(),
+	num_switches(0), computed_rows()
+{
+	build();
+}
+
+SystemStepGenerator::SystemStepGenerator(const SystemStepGenerator& base) :
+	netlist(base.netlist), zero_bound(base.zero_bound), dimension(base.dimension),
+	num_sources(base.num_sources), runtime_timestep(base.runtime_timestep), bank(base.bank), x_const(base.x_const),
+	b_terms(base.b_terms), switch_offsets(base.switch_offsets), num_switches(base.num_switches), computed_rows(base.computed_rows)
+{
+	//do nothing else
+}
+
+void SystemStepGenerator::reset(const SystemNetlist& netlist, NumType dt, NumType zero_bound)
+{
+	bank.reset(netlist, std::vector<NumType>(1, dt));
+	this->netlist.reset(netlist);
+	this->zero_bound = zero_bound;
+	dimension = netlist.getDimension();
+	runtime_timestep = false;
+	computed_rows.clear();
+
+	build();
+}
+
+void SystemStepGenerator::reset(const SystemNetlist& netlist, const std::vector<NumType>& timesteps, NumType zero_bound)
+{
+	bank.reset(netlist, timesteps);
+	this->netlist.reset(netlist);
+	this->zero_bound = zero_bound;
+	dimension = netlist.getDimension();
+	runtime_timestep = true;
+	computed_rows.clear();
+
+	build();
+}
+
+void SystemStepGenerator::reset(const SystemStepGenerator& base)
+{
+	netlist.reset(base.netlist);
+	zero_bound = base.zero_bound;
+	dimension = base.dimension;
+	num_sources = base.num_sources;
+	runtime_timestep = base.runtime_timestep;
+	bank.reset(base.bank);
+	x_const = base.x_const;
+	b_terms = base.b_terms;
+	switch_offsets = base.switch_offsets;
+	num_switches = base.num_switches;
+	computed_rows = base.computed_rows;
+}
+
+void SystemStepGenerator::build()
+{
+		//the bank has stamped and inverted the conductance matrix of each time step; the sources are
+		//stamped again for the constant vector of each time step
+
+	SystemConductance conductance(dimension);
+	SystemSourceVector sources(dimension);
+
+	x_const.resize(bank.getNumTimesteps());
+
+	for(unsigned int j = 0; j < bank.getNumTimesteps(); j++)
+	{
+		conductance.reset(dimension);
+		sources.reset(dimension);
+
+		if(netlist.stampSystem(bank.getTimestep(j), conductance, sources))
+		{
+			throw std::runtime_error("SystemStepGenerator: cannot stamp netlist as a component node exceeds the system dimension");
+		}
+
+			//constant sources are folded into the offset x_const = A*b_const
+
+		const double* A = bank.getInverse(j);
+
+		std::vector<NumType> b_const;
+		sources.computeConstantVector(b_const);
+
+		x_const[j].assign(dimension, 0.0);
+		for(unsigned int r = 0; r < dimension; r++)
+		{
+			for(unsigned int c = 0; c < dimension; c++)
+			{
+				x_const[j][r] += double(A[dimension*r+c])*double(b_const[c]);
+			}
+		}
+	}
+
+	num_sources = sources.getNumSources();
+
+	b_terms.resize(dimension);
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		b_terms[r] = sources.asVector(r+1);
+	}
+
+	switch_offsets.resize(netlist.getNumElements());
+	num_switches = 0;
+	for(unsigned int i = 0; i < netlist.getNumElements(); i++)
+	{
+		switch_offsets[i] = num_switches;
+		num_switches += numSwitchInputs(netlist.getElement(i).type);
+	}
+}
+
+unsigned int SystemStepGenerator::getDimension() const
+{
+	return dimension;
+}
+
+unsigned int SystemStepGenerator::getNumSwitches() const
+{
+	return num_switches;
+}
+
+unsigned int SystemStepGenerator::getSwitchOffset(unsigned int element) const
+{
+	return switch_offsets[element];
+}
+
+bool SystemStepGenerator::hasRuntimeTimestep() const
+{
+	return runtime_timestep;
+}
+
+const TimestepBank& SystemStepGenerator::getTimestepBank() const
+{
+	return bank;
+}
+
+void SystemStepGenerator::setProbeNodes(const std::vector<unsigned int>& probe_nodes)
+{
+	computed_rows.assign(dimension, false);
+
+	std::vector<unsigned int> consumed = netlist.getConsumedNodes();
+	consumed.insert(consumed.end(), probe_nodes.begin(), probe_nodes.end());
+
+	for(unsigned int i = 0; i < consumed.size(); i++)
+	{
+		const unsigned int n = consumed[i];
+		if(n == 0 || n > dimension) continue; // ground or not a node of the system
+
+		computed_rows[n-1] = true;
+	}
+}
+
+void SystemStepGenerator::clearProbeNodes()
+{
+	computed_rows.clear();
+}
+
+const char* SystemStepGenerator::generateStateStruct(std::string& buffer, const char* step_name)
+{
+	std::stringstream sstrm;
+
+	sstrm << "struct " << step_name << "State\n{\n";
+
+	unsigned int members = 0;
+
+	for(unsigned int i = 0; i < netlist.getNumElements(); i++)
+	{
+		const SystemNetlist::Element& elem = netlist.getElement(i);
+
+		const char* vars[5] = {0, 0, 0, 0, 0};
+		unsigned int num_vars = 0;
+		bool has_sw_past = false;
+
+		switch(elem.type)
+		{
+		case SystemNetlist::INDUCTOR:
+		case SystemNetlist::CAPACITOR:
+			vars[0] = "current_eq"; num_vars = 1;
+			if(runtime_timestep) { vars[1] = "current"; vars[2] = "delta_v"; num_vars = 3; } //history term is re-derived each step
+			break;
+		case SystemNetlist::RL_SWITCH:
+			vars[0] = "current_past"; num_vars = 1; has_sw_past = true;
+			break;
+		case SystemNetlist::MUTUAL_INDUCTANCE2:
+			vars[0] = "current_comp1"; vars[1] = "current_comp2"; num_vars = 2;
+			break;
+		case SystemNetlist::MUTUAL_INDUCTANCE3:
+			vars[0] = "current_comp1"; vars[1] = "current_comp2"; vars[2] = "current_comp3"; num_vars = 3;
+			break;
+		case SystemNetlist::TWO_PHASE_HB_CONVERTER:
+			vars[0] = "il1"; vars[1] = "il2"; vars[2] = "vc1"; vars[3] = "vc2"; num_vars = 4;
+			break;
+		case SystemNetlist::THREE_PHASE_HB_CONVERTER:
+		case SystemNetlist::THREE_PHASE_HB_CONVERTER_UNGROUNDED_CAP:
+			vars[0] = "il1"; vars[1] = "il2"; vars[2] = "il3"; vars[3] = "vc1"; vars[4] = "vc2"; num_vars = 5;
+			break;
+		default:
+			break; //stateless component
+		}
+
+		for(unsigned int v = 0; v < num_vars; v++)
+		{
+			sstrm << "\tLBLMC::NumType " << stateName(i, vars[v]) << "; ///< " << elem.name << "\n";
+			members++;
+		}
+		if(has_sw_past)
+		{
+			sstrm << "\tbool " << stateName(i, "sw_past") << "; ///< " << elem.name << "\n";
+			members++;
+		}
+	}
+
+	if(members == 0) sstrm << "\tbool unused; ///< model has no stateful components\n";
+
+	sstrm << "};";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+const char* SystemStepGenerator::generateStepSignature(std::string& buffer, const char* step_name)
+{
+	std::stringstream sstrm;
+
+	sstrm << "void " << step_name << "(" << step_name << "State& s, LBLMC::NumType x[" << dimension << "]";
+	if(num_switches) sstrm << ", const bool sw[" << num_switches << "]";
+	if(runtime_timestep) sstrm << ", unsigned int dt_sel";
+	sstrm << ")";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+const char* SystemStepGenerator::generateStep(std::string& buffer, const char* step_name)
+{
+	std::stringstream sstrm;
+	std::string buf;
+
+	const unsigned int num_dt = bank.getNumTimesteps();
+
+		//columns of the constant table <step_name>_K of time step dependent constants
+
+	std::vector< std::vector<double> > table;
+	std::vector<double> values(num_dt);
+
+		//expression of each source contribution (b_components) in terms of updated state
+
+	std::vector<std::string> src_expr(num_sources+1);
+	std::vector<int> src_sign(num_sources+1, 1);
+
+		//state initialization
+
+	std::stringstream init;
+
+	init << "void " << step_name << "Init(" << step_name << "State& s)\n{\n";
+
+		//component updates
+
+	std::stringstream upd;
+
+	for(unsigned int i = 0; i < netlist.getNumElements(); i++)
+	{
+		const SystemNetlist::Element& elem = netlist.getElement(i);
+		const std::vector<unsigned int>& n = elem.nodes;
+		const std::vector<NumType>& p = elem.params;
+		const std::vector<unsigned int>& src = elem.sources;
+
+		upd << "\t// " << elem.name << "\n";
+
+		switch(elem.type)
+		{
+		case SystemNetlist::RESISTOR:
+		case SystemNetlist::TWO_PORT_TRANSCONDUCTOR:
+			upd << "\t// (no sources)\n";
+			break;
+
+		case SystemNetlist::RESISTIVE_SWITCH:
+			upd << "\t// (no sources; conductance of the stamped state is in A)\n";
+			break;
+
+		case SystemNetlist::INDUCTOR:
+		{
+			std::string eq = "s." + stateName(i, "current_eq");
+			if(runtime_timestep)
+			{
+				std::string cur = "s." + stateName(i, "current");
+				std::string dv = "s." + stateName(i, "delta_v");
+				for(unsigned int j = 0; j < num_dt; j++) values[j] = double(bank.getTimestep(j))/2.0/double(p[0]);
+				const std::string hol2 = timestepConstant(values, table, step_name);
+
+					//as Inductor::setTimestep(), the history term of the selected time step is derived from
+					//the current and voltage of the previous step
+				upd << "\t{\n";
+				upd << "\t\tconst LBLMC::NumType current_eq_past = -" << cur << " - " << hol2 << "*" << dv << ";\n";
+				upd << "\t\t" << dv << " = " << voltageAcross(n[0], n[1]) << ";\n";
+				upd << "\t\t" << cur << " = " << hol2 << "*" << dv << " - current_eq_past;\n";
+				upd << "\t\t" << eq << " = -" << cur << " - " << hol2 << "*" << dv << ";\n";
+				upd << "\t}\n";
+				init << "\t" << cur << " = LBLMC::NumType(0.0);\n";
+				init << "\t" << dv << " = LBLMC::NumType(0.0);\n";
+			}
+			else
+			{
+				const double hol2 = double(bank.getTimestep(0))/2.0/double(p[0]);
+				upd << "\t" << eq << " = " << eq << " - " << literal(2.0*hol2) << "*" << voltageAcross(n[0], n[1]) << ";\n";
+			}
+			init << "\t" << eq << " = LBLMC::NumType(0.0);\n";
+			if(src[0]) src_expr[src[0]] = eq;
+			break;
+		}
+		case SystemNetlist::CAPACITOR:
+		{
+			std::string eq = "s." + stateName(i, "current_eq");
+			if(runtime_timestep)
+			{
+				std::string cur = "s." + stateName(i, "current");
+				std::string dv = "s." + stateName(i, "delta_v");
+				for(unsigned int j = 0; j < num_dt; j++) values[j] = 2.0*double(p[0])/double(bank.getTimestep(j));
+				const std::string hoc2 = timestepConstant(values, table, step_name);
+
+					//as Capacitor::setTimestep(), the history term of the selected time step is derived from
+					//the current and voltage of the previous step
+				upd << "\t{\n";
+				upd << "\t\tconst LBLMC::NumType current_eq_past = " << cur << " + " << hoc2 << "*" << dv << ";\n";
+				upd << "\t\t" << dv << " = " << voltageAcross(n[0], n[1]) << ";\n";
+				upd << "\t\t" << cur << " = " << hoc2 << "*" << dv << " - current_eq_past;\n";
+				upd << "\t\t" << eq << " = " << cur << " + " << hoc2 << "*" << dv << ";\n";
+				upd << "\t}\n";
+				init << "\t" << cur << " = LBLMC::NumType(0.0);\n";
+				init << "\t" << dv << " = LBLMC::NumType(0.0);\n";
+			}
+			else
+			{
+				const double hoc2 = 2.0*double(p[0])/double(bank.getTimestep(0));
+				upd << "\t" << eq << " = " << literal(2.0*hoc2) << "*" << voltageAcross(n[0], n[1]) << " - " << eq << ";\n";
+			}
+			init << "\t" << eq << " = LBLMC::NumType(0.0);\n";
+			if(src[0]) src_expr[src[0]] = eq;
+			break;
+		}
+		case SystemNetlist::DC_VOLTAGE_SOURCE:
+		{
+			upd << "\t// (constant source, folded into solution offset)\n";
+			break;
+		}
+		case SystemNetlist::RL_SWITCH:
+		{
+			std::string cur = "s." + stateName(i, "current_past");
+			std::string swp = "s." + stateName(i, "sw_past");
+			std::vector<double> hol(num_dt);
+			for(unsigned int j = 0; j < num_dt; j++)
+			{
+				const double HOL = double(bank.getTimestep(j))/double(p[0]);
+				values[j] = 1.0 - HOL*double(p[1]);
+				hol[j] = HOL;
+			}
+			const std::string cur_gain = timestepConstant(values, table, step_name);
+			const std::string volt_gain = timestepConstant(hol, table, step_name);
+			upd << "\t" << cur << " = (" << swp << ") ? LBLMC::NumType(" << cur_gain << "*" << cur
+				<< " + " << volt_gain << "*" << voltageAcross(n[0], n[1]) << ") : LBLMC::NumType(0.0);\n";
+			upd << "\t" << swp << " = sw[" << switch_offsets[i] << "];\n";
+			init << "\t" << cur << " = LBLMC::NumType(0.0);\n";
+			init << "\t" << swp << " = false;\n";
+			if(src[0])
+			{
+				src_expr[src[0]] = cur;
+				src_sign[src[0]] = -1; //bout = -current
+			}
+			break;
+		}
+		case SystemNetlist::MUTUAL_INDUCTANCE2:
+		{
+			const double L1 = p[0], L2 = p[1], M = p[2];
+			const double det = L1*L2 - M*M;
+
+				//k[r][c][j] is the coefficient of time step j; its sign does not depend on the time step
+			std::vector<double> k[2][2];
+			for(unsigned int j = 0; j < num_dt; j++)
+			{
+				const double dt = bank.getTimestep(j);
+				const double kj[2][2] = { { dt*L2/det, dt*(-M/det) }, { dt*(-M/det), dt*L1/det } };
+				for(unsigned int r = 0; r < 4; r++) k[r/2][r%2].push_back(kj[r/2][r%2]);
+			}
+
+			upd << "\t{\n";
+			upd << "\t\tconst LBLMC::NumType v1 = " << voltageAcross(n[0], n[1]) << ";\n";
+			upd << "\t\tconst LBLMC::NumType v2 = " << voltageAcross(n[2], n[3]) << ";\n";
+			for(unsigned int r = 0; r < 2; r++)
+			{
+				std::stringstream var; var << "current_comp" << (r+1);
+				std::string cc = "s." + stateName(i, var.str().c_str());
+				upd << "\t\t" << cc << " = " << cc;
+				for(unsigned int c = 0; c < 2; c++)
+				{
+					for(unsigned int j = 0; j < num_dt; j++) values[j] = (k[r][c][0] < 0.0) ? -k[r][c][j] : k[r][c][j];
+					if(k[r][c][0] > 0.0) upd << " - " << timestepConstant(values, table, step_name) << "*v" << (c+1);
+					else if(k[r][c][0] < 0.0) upd << " + " << timestepConstant(values, table, step_name) << "*v" << (c+1);
+				}
+				upd << ";\n";
+				init << "\t" << cc << " = LBLMC::NumType(0.0);\n";
+				if(src[r]) src_expr[src[r]] = cc;
+			}
+			upd << "\t}\n";
+			break;
+		}
+		case SystemNetlist::MUTUAL_INDUCTANCE3:
+		{
+			const double L1 = p[0], L2 = p[1], L3 = p[2], M12 = p[3], M23 = p[4], M31 = p[5];
+
+				//k[r][c][j] is the coefficient of time step j; its sign does not depend on the time step
+			std::vector<double> k[3][3];
+			for(unsigned int j = 0; j < num_dt; j++)
+			{
+				const double d = double(bank.getTimestep(j)) / (L3*M12*M12 - 2.0*M12*M23*M31 + L1*M23*M23 + L2*M31*M31 - L1*L2*L3);
+				const double kj[3][3] =
+				{
+					{ d*(M23*M23 - L2*L3), d*(L3*M12 - M23*M31), d*(L2*M31 - M12*M23) },
+					{ d*(L3*M12 - M23*M31), d*(M31*M31 - L1*L3), d*(L1*M23 - M12*M31) },
+					{ d*(L2*M31 - M12*M23), d*(L1*M23 - M12*M31), d*(M12*M12 - L1*L2) }
+				};
+				for(unsigned int r = 0; r < 9; r++) k[r/3][r%3].push_back(kj[r/3][r%3]);
+			}
+
+			upd << "\t{\n";
+			for(unsigned int c = 0; c < 3; c++)
+				upd << "\t\tconst LBLMC::NumType v" << (c+1) << " = " << voltageAcross(n[2*c], n[2*c+1]) << ";\n";
+			for(unsigned int r = 0; r < 3; r++)
+			{
+				std::stringstream var; var << "current_comp" << (r+1);
+				std::string cc = "s." + stateName(i, var.str().c_str());
+				upd << "\t\t" << cc << " = " << cc;
+				for(unsigned int c = 0; c < 3; c++)
+				{
+					for(unsigned int j = 0; j < num_dt; j++) values[j] = (k[r][c][0] < 0.0) ? -k[r][c][j] : k[r][c][j];
+					if(k[r][c][0] > 0.0) upd << " - " << timestepConstant(values, table, step_name) << "*v" << (c+1);
+					else if(k[r][c][0] < 0.0) upd << " + " << timestepConstant(values, table, step_name) << "*v" << (c+1);
+				}
+				upd << ";\n";
+				init << "\t" << cc << " = LBLMC::NumType(0.0);\n";
+				if(src[r]) src_expr[src[r]] = cc;
+			}
+			upd << "\t}\n";
+			break;
+		}
+		case SystemNetlist::TWO_PHASE_HB_CONVERTER:
+		case SystemNetlist::THREE_PHASE_HB_CONVERTER:
+		case SystemNetlist::THREE_PHASE_HB_CONVERTER_UNGROUNDED_CAP:
+		{
+			const unsigned int phases = (elem.type == SystemNetlist::TWO_PHASE_HB_CONVERTER) ? 2 : 3;
+			const double cap = p[0], ind = p[1], res = p[2];
+			std::vector<double> il_past_gain(num_dt), hol(num_dt), vc_gain(num_dt), hoc(num_dt);
+			for(unsigned int j = 0; j < num_dt; j++)
+			{
+				hol[j] = double(bank.getTimestep(j))/ind;
+				hoc[j] = double(bank.getTimestep(j))/cap;
+				il_past_gain[j] = 1.0 - hol[j]*res;
+				vc_gain[j] = hoc[j]*LMC_HB_CAP_CONDUCT;
+			}
+
+			std::string s_il[3] = { "s." + stateName(i, "il1"), "s." + stateName(i, "il2"), "s." + stateName(i, "il3") };
+			std::string s_vc1 = "s." + stateName(i, "vc1");
+			std::string s_vc2 = "s." + stateName(i, "vc2");
+
+			const std::string il_past_gain_k = timestepConstant(il_past_gain, table, step_name);
+			const std::string hol_k = timestepConstant(hol, table, step_name);
+			const std::string vc_gain_k = timestepConstant(vc_gain, table, step_name);
+			const std::string hoc_k = timestepConstant(hoc, table, step_name);
+
+			emitHBConverterUpdate(upd, i, elem, phases, (phases == 3), switch_offsets[i], il_past_gain_k, hol_k, vc_gain_k, hoc_k);
+
+			for(unsigned int ph = 0; ph < phases; ph++) init << "\t" << s_il[ph] << " = LBLMC::NumType(0.0);\n";
+			init << "\t" << s_vc1 << " = LBLMC::NumType(0.0);\n";
+			init << "\t" << s_vc2 << " = LBLMC::NumType(0.0);\n";
+
+				//sources in order of update() outputs: bpos, bneg, bout1, bout2[, bout3]
+			if(src[0]) src_expr[src[0]] = s_vc1 + "*" + literal(LMC_HB_CAP_CONDUCT);
+			if(src[1]) src_expr[src[1]] = s_vc2 + "*" + literal(LMC_HB_CAP_CONDUCT);
+			for(unsigned int ph = 0; ph < phases; ph++)
+				if(src[2+ph]) src_expr[src[2+ph]] = s_il[ph];
+			break;
+		}
+		}
+	}
+
+	init << "}";
+
+	sstrm << init.str() << "\n\n";
+
+		//the solution is generated before the step function, so that the solution offsets are in the
+		//constant table emitted ahead of it
+
+	std::stringstream sol;
+
+		//system source vector b from updated component sources
+
+	sol << "\t//// system source vector\n\n";
+
+	std::vector<bool> b_used(dimension, false);
+
+		//A[r,c] is ignored if it is close to zero for all time steps
+
+	std::vector<bool> a_used(dimension*dimension, false);
+	for(unsigned int j = 0; j < num_dt; j++)
+	{
+		const double* A = bank.getInverse(j);
+		for(unsigned int rc = 0; rc < dimension*dimension; rc++)
+		{
+			if( !(A[rc] < zero_bound && A[rc] > -zero_bound) ) a_used[rc] = true;
+		}
+	}
+
+		//columns of A read by the computed rows of x
+
+	std::vector<bool> column_read(dimension, false);
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		if(!computed_rows.empty() && !computed_rows[r]) continue;
+
+		for(unsigned int c = 0; c < dimension; c++)
+		{
+			if(a_used[dimension*r+c]) column_read[c] = true;
+		}
+	}
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		if(!column_read[r]) continue; // b[r] does not contribute to a computed solution
+
+		const std::vector<long>& terms = b_terms[r];
+
+		bool first = true;
+		std::stringstream expr;
+		for(unsigned int t = 0; t < terms.size(); t++)
+		{
+			const unsigned long idx = (terms[t] < 0) ? -terms[t] : terms[t];
+			if(src_expr[idx].empty()) continue;
+
+			const bool negative = ((terms[t] < 0) != (src_sign[idx] < 0));
+			if(negative) expr << (first ? "-" : " - ");
+			else if(!first) expr << " + ";
+			expr << src_expr[idx];
+			first = false;
+		}
+
+		if(first) continue; // no source drives node, so b[r] is zero and column r of A is dropped
+
+		b_used[r] = true;
+		sol << "\tconst LBLMC::NumType b" << r << " = " << expr.str() << ";\n";
+	}
+
+		//solution x = A*b with literal coefficients, or with A of the selected time step
+
+	sol << "\n\t//// system solution\n\n";
+
+	for(unsigned int r = 0; r < dimension; r++)
+	{
+		if(!computed_rows.empty() && !computed_rows[r]) continue; // x[r] is never read, so row is eliminated
+
+		sol << "\tx[" << r << "] = ";
+
+		bool first = true;
+		bool has_const = false;
+		for(unsigned int j = 0; j < num_dt; j++)
+		{
+			values[j] = x_const[j][r];
+			if(values[j] != 0.0) has_const = true;
+		}
+		if(has_const)
+		{
+			sol << timestepConstant(values, table, step_name);
+			first = false;
+		}
+
+		for(unsigned int c = 0; c < dimension; c++)
+		{
+			if(!b_used[c]) continue;
+			if(!a_used[dimension*r+c]) continue; // A[r,c] is close to zero, so ignore the term.
+
+			if(!first) sol << " + ";
+			if(runtime_timestep) sol << step_name << "_A[dt_sel][" << r << "][" << c << "]*b" << c;
+			else sol << literal(bank.getInverse(0)[dimension*r+c]) << "*b" << c;
+			first = false;
+		}
+		if(first) sol << "LBLMC::NumType(0.0)";
+
+		sol << ";\n";
+	}
+
+		//constant table of time step dependent constants; row dt_sel holds the constants of time step dt_sel
+
+	if(!table.empty())
+	{
+		sstrm << "static const LBLMC::NumType " << step_name << "_K[" << num_dt << "][" << table.size() << "] =\n{\n";
+		for(unsigned int j = 0; j < num_dt; j++)
+		{
+			sstrm << "\t{";
+			for(unsigned int t = 0; t < table.size(); t++)
+			{
+				if(t) sstrm << ", ";
+				sstrm << std::setprecision(17) << table[t][j];
+			}
+			sstrm << "}" << ((j != num_dt-1) ? "," : "") << " // dt = " << double(bank.getTimestep(j)) << "\n";
+		}
+		sstrm << "};\n\n";
+	}
+
+	sstrm << generateStepSignature(buf, step_name) << "\n{\n";
+
+	sstrm << "\t//// component updates from solution of previous step\n\n";
+	sstrm << upd.str() << "\n";
+	sstrm << sol.str();
+
+	sstrm << "}";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+int SystemStepGenerator::generateStepAndExportC(const char* dir, const char* filename, const char* step_name)
+{
+	std::fstream header;
+	std::fstream source;
+
+	std::string hname = dir; hname +=filename; hname += ".hpp";
+	std::string sname = dir; sname +=filename; sname += ".cpp";
+
+	header.open((hname).c_str(), std::fstream::out | std::fstream::trunc);
+	source.open((sname).c_str(), std::fstream::out | std::fstream::trunc);
+
+	if(!header.is_open() || !source.is_open())
+	{
+		header.close();
+		source.close();
+		return -1;
+	}
+
+	std::string buf;
+
+	header <<
+			"/**\n"
+			" *\n"
+			" * LBLMC Vivado HLS Simulation Engine for FPGA Designs\n"
+			" *\n"
+			" * Auto-generated by SystemStepGenerator Object\n"
+			" *\n"
+			" */\n\n";
+
+	header << "#ifndef " << step_name << "_HPP\n";
+	header << "#define " << step_name << "_HPP\n\n";
+	header << "\n#include \"LBLMC/DataTypes.hpp\"\n\n";
+	header << generateStateStruct(buf, step_name) << "\n\n";
+	header << "void " << step_name << "Init(" << step_name << "State& s);\n\n";
+	header << generateStepSignature(buf, step_name) << ";\n\n";
+	header << "#endif";
+	header.close();
+
+	source << "#include \"" << filename << ".hpp" << "\"\n";
+
+	if(runtime_timestep)
+	{
+		std::string bank_file = dir; bank_file += filename; bank_file += "_A";
+		std::string bank_name = step_name; bank_name += "_A";
+
+		if(bank.exportAsCHeader(bank_file.c_str(), bank_name.c_str()))
+		{
+			source.close();
+			return -1;
+		}
+
+		source << "#include \"" << filename << "_A.hpp" << "\"\n";
+	}
+
+	source << "\n";
+	source << generateStep(buf, step_name);
+	source.close();
+
+	return 0;
+}
+
+} // namespace LBLMC
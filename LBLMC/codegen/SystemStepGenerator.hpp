@@ -0,0 +1,209 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SYSTEMSTEPGENERATOR_HPP
+#define SYSTEMSTEPGENERATOR_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "SystemNetlist.hpp"
+#include "TimestepBank.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief generates a fused time step function of a whole LB-LMC system model
+ *
+ * A time step is normally done by calling update() of each component, then the source aggregation
+ * function generated by SystemSourceVector, then the solver generated by SystemSolverGenerator,
+ * with component state and the b_components and b arrays passed through memory between them.  This
+ * generator instead takes the netlist of the model and emits a single step function:
+ *
+ * 	1. the component updates are emitted inline, reading the previous solution x, with their
+ * 	   internal constants (hol2, hoc2, HOL, cap_conduct, ...) folded into literals
+ * 	2. the elements of b are summed directly from the updated component state as locals
+ * 	3. each x[r] is computed from the b locals with the elements of A = G^-1 as literals
+ *
+ * Constant sources (DCVoltageSource) are folded into a literal offset of each x[r], so elements of b
+ * with only constant sources and their columns of A are dropped from the step.
+ *
+ * The only state that persists between steps is kept in a flat struct (<step_name>State) of the
+ * component integrator states; values a component only registers for the next call (such as
+ * epos_past) are not kept since they are the present inputs.  The generated code is equivalent to
+ * the component-by-component form, so the compiler is free to keep the state and intermediate
+ * values in registers.
+ *
+ * The generated step function has the signature:
+ *
+ * 	void <step_name>(<step_name>State& s, LBLMC::NumType x[N], const bool sw[K]);
+ *
+ * where the sw array is only present if the model has switching components.  Switch inputs are
+ * ordered by netlist element, with the order of each component's update() switch parameters (e.g.
+ * sw_ctrl1, sw_ctrl2, sw_ctrl3, sw_en for ThreePhaseHBConverter).  getSwitchOffset() gives the
+ * first switch index of an element.
+ *
+ * Built with a list of time steps, the step function instead selects its time step at runtime:
+ *
+ * 	void <step_name>(<step_name>State& s, LBLMC::NumType x[N], const bool sw[K], unsigned int dt_sel);
+ *
+ * where dt_sel indexes the time steps in ascending order.  The elements of A are read from the array
+ * <step_name>_A[dt_sel][row][column] exported by TimestepBank::exportAsCHeader(), and the time step
+ * dependent constants of the component updates and the solution offsets from the table
+ * <step_name>_K[dt_sel][...] emitted with the step function.  Constants that do not depend on the time
+ * step stay literals.  The state also keeps the current and voltage of each inductor and capacitor, from
+ * which their history terms are derived for the selected time step as in Inductor::setTimestep() and
+ * Capacitor::setTimestep(), so the time step can change between any two steps.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class SystemStepGenerator
+{
+private:
+
+	SystemNetlist netlist;
+	NumType zero_bound; ///< range from zero when determining whether Aij is close to zero to be ignored
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	unsigned int num_sources; ///< number of source contributions of the system
+	bool runtime_timestep; ///< true if the step function selects its time step at runtime
+	TimestepBank bank; ///< time steps and inverted conductance matrices A = G^-1; one time step unless runtime_timestep
+	std::vector< std::vector<double> > x_const; ///< solution offset A*b_const of constant sources, per time step
+	std::vector< std::vector<long> > b_terms; ///< signed source indices contributing to each element of b
+	std::vector<unsigned int> switch_offsets; ///< first switch input index of each element
+	unsigned int num_switches; ///< number of switch inputs of the step function
+	std::vector<bool> computed_rows; ///< rows of x computed by the step function; empty if all are computed
+
+public:
+
+	/**
+	 * parameter constructor
+	 *
+	 * Stamps and inverts the conductance matrix of the netlist.  Throws std::runtime_error if the
+	 * conductance matrix is singular or a component cannot be stamped.
+	 *
+	 * @param netlist netlist of the system model
+	 * @param dt simulation time step of the discretized components
+	 * @param zero_bound range from zero when determining whether Aij is close to zero to be ignored; defaults to 1e-12.
+	 */
+	SystemStepGenerator(const SystemNetlist& netlist, NumType dt = LMC_TIMESTEP, NumType zero_bound = 1.0e-12);
+
+	/**
+	 * parameter constructor for a step function that selects its time step at runtime
+	 *
+	 * Stamps and inverts the conductance matrix of the netlist for each time step.  Throws
+	 * std::runtime_error if no time step is given, a time step is not positive, or the conductance
+	 * matrix of a time step is singular or a component cannot be stamped.
+	 *
+	 * @param netlist netlist of the system model
+	 * @param timesteps time steps the step function selects from; sorted ascending, duplicates removed
+	 * @param zero_bound range from zero when determining whether Aij is close to zero to be ignored; defaults to 1e-12.
+	 */
+	SystemStepGenerator(const SystemNetlist& netlist, const std::vector<NumType>& timesteps, NumType zero_bound = 1.0e-12);
+	SystemStepGenerator(const SystemStepGenerator& base);
+
+	void reset(const SystemNetlist& netlist, NumType dt = LMC_TIMESTEP, NumType zero_bound = 1.0e-12);
+	void reset(const SystemNetlist& netlist, const std::vector<NumType>& timesteps, NumType zero_bound = 1.0e-12);
+	void reset(const SystemStepGenerator& base);
+
+	/**
+	 * @return number of solutions in the system Gx=b
+	 */
+	unsigned int getDimension() const;
+
+	/**
+	 * @return number of switch inputs of the generated step function
+	 */
+	unsigned int getNumSwitches() const;
+
+	/**
+	 * @param element index of the netlist element
+	 * @return index of the first switch input of the element in the generated step function
+	 */
+	unsigned int getSwitchOffset(unsigned int element) const;
+
+	/**
+	 * @return true if the generated step function selects its time step at runtime
+	 */
+	bool hasRuntimeTimestep() const;
+
+	/**
+	 * @return time steps and inverted conductance matrices of the step function; index dt_sel of the
+	 * step function selects time step getTimestepBank().getTimestep(dt_sel)
+	 */
+	const TimestepBank& getTimestepBank() const;
+
+	/**
+	 * prunes the rows of x computed by the step function to the nodes read by the component updates
+	 * (SystemNetlist::getConsumedNodes()) and the given probe nodes.  The other elements of x are left
+	 * unchanged by the step function, and elements of b only they depend on are not computed.
+	 * @param probe_nodes node indices (1 to dimension) read outside of the step function
+	 */
+	void setProbeNodes(const std::vector<unsigned int>& probe_nodes);
+
+	/**
+	 * disables pruning so the step function computes all rows of x; this is the default
+	 */
+	void clearProbeNodes();
+
+	/**
+	 * generates the state struct of the step function, as a string
+	 * @param buffer string that will store the generated code
+	 * @param step_name name of the step function; the struct is named <step_name>State
+	 * @return the buffer string as a const char* string
+	 */
+	const char* generateStateStruct(std::string& buffer, const char* step_name = "stepSystem");
+
+	/**
+	 * generates the fused step function and the function <step_name>Init() which zeroes the state, as a string
+	 *
+	 * With a runtime time step, the code also defines the constant table <step_name>_K, and reads A from
+	 * the array <step_name>_A, which must be declared before it (see generateStepAndExportC()).
+	 *
+	 * @param buffer string that will store the generated code
+	 * @param step_name name of the step function
+	 * @return the buffer string as a const char* string
+	 */
+	const char* generateStep(std::string& buffer, const char* step_name = "stepSystem");
+
+	/**
+	 * generates the state struct and step function, and exports them as C++ header and source files
+	 *
+	 * With a runtime time step, the inverted conductance matrices are also exported with
+	 * TimestepBank::exportAsCHeader() as <filename>_A.hpp, declaring <step_name>_A and the time steps
+	 * <step_name>_A_DT, and included by the source file.
+	 *
+	 * @param dir directory to export files to; must end with a slash
+	 * @param filename name of the files without extension
+	 * @param step_name name of the step function
+	 * @return 0 if successful, -1 if the files could not be opened
+	 */
+	int generateStepAndExportC(const char* dir, const char* filename, const char* step_name = "stepSystem");
+
+private:
+
+	void build();
+	const char* generateStepSignature(std::string& buffer, const char* step_name);
+};
+
+} //namespace LBLMC
+
+#endif //SYSTEMSTEPGENERATOR_HPP
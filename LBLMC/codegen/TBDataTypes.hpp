@@ -31,6 +31,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #endif
 
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 
 namespace LBLMC
 {
@@ -43,6 +44,9 @@ typedef Eigen::Matrix<double,
 		Eigen::RowMajor>
 MatrixRMXd; ///< Dynamically-allocated row-major double Eigen3 matrix type
 
+typedef Eigen::SparseMatrix<double, Eigen::RowMajor>
+SparseMatrixRMXd; ///< Row-major (compressed sparse row) double Eigen3 sparse matrix type
+
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
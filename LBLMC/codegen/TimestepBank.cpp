@@ -0,0 +1,303 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "TimestepBank.hpp"
+#include "SystemConductance.hpp"
+#include "SystemSourceVector.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <cmath>
+
+namespace LBLMC
+{
+
+TimestepBank::TimestepBank(const SystemNetlist& netlist, const std::vector<NumType>& timesteps) :
+	dimension(0), timesteps(), inverses(), solvers(), selected(0)
+{
+	reset(netlist, timesteps);
+}
+
+TimestepBank::TimestepBank(const TimestepBank& base) :
+	dimension(base.dimension), timesteps(base.timesteps), inverses(base.inverses), solvers(base.solvers),
+	selected(base.selected)
+{
+	//do nothing else
+}
+
+void TimestepBank::reset(const SystemNetlist& netlist, const std::vector<NumType>& timesteps)
+{
+	if(timesteps.empty())
+	{
+		throw std::runtime_error("TimestepBank: no time steps given");
+	}
+
+	std::vector<NumType> sorted(timesteps);
+	std::sort(sorted.begin(), sorted.end());
+	sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+	if(!(sorted.front() > NumType(0.0)))
+	{
+		throw std::runtime_error("TimestepBank: time steps must be positive");
+	}
+
+		//stamp and invert each time step into new storage, so a failure leaves the bank unchanged
+
+	const unsigned int dim = netlist.getDimension();
+
+	std::vector<MatrixRMXd> new_inverses;
+	std::vector<SystemSolver> new_solvers;
+	new_inverses.reserve(sorted.size());
+	new_solvers.reserve(sorted.size());
+
+	for(unsigned int i = 0; i < sorted.size(); i++)
+	{
+		SystemNetlist stamped(netlist);
+		SystemConductance conductance(dim);
+		SystemSourceVector sources(dim);
+
+		if(stamped.stampSystem(sorted[i], conductance, sources))
+		{
+			throw std::runtime_error("TimestepBank: cannot stamp netlist");
+		}
+
+		conductance.invertSelf();
+
+		new_inverses.push_back(conductance.asEigen3Matrix());
+
+		const double* A = conductance.asPointer();
+		std::vector<NumType> A_num(A, A + dim*dim);
+		new_solvers.push_back(SystemSolver(&A_num[0], dim, sources));
+	}
+
+	dimension = dim;
+	this->timesteps.swap(sorted);
+	inverses.swap(new_inverses);
+	solvers.swap(new_solvers);
+	selected = 0;
+}
+
+void TimestepBank::reset(const TimestepBank& base)
+{
+	dimension = base.dimension;
+	timesteps = base.timesteps;
+	inverses = base.inverses;
+	solvers = base.solvers;
+	selected = base.selected;
+}
+
+unsigned int TimestepBank::getDimension() const
+{
+	return dimension;
+}
+
+unsigned int TimestepBank::getNumTimesteps() const
+{
+	return timesteps.size();
+}
+
+NumType TimestepBank::getTimestep(unsigned int index) const
+{
+	return timesteps[index];
+}
+
+int TimestepBank::findTimestep(NumType dt, double tolerance) const
+{
+	for(unsigned int i = 0; i < timesteps.size(); i++)
+	{
+		if(std::fabs(double(timesteps[i]) - double(dt)) <= tolerance*std::fabs(double(dt))) return int(i);
+	}
+
+	return -1;
+}
+
+int TimestepBank::select(unsigned int index)
+{
+	if(index >= timesteps.size()) return -1;
+
+	selected = index;
+
+	return 0;
+}
+
+int TimestepBank::selectLonger()
+{
+	return select(selected + 1);
+}
+
+int TimestepBank::selectShorter()
+{
+	if(selected == 0) return -1;
+
+	return select(selected - 1);
+}
+
+unsigned int TimestepBank::getSelected() const
+{
+	return selected;
+}
+
+NumType TimestepBank::getSelectedTimestep() const
+{
+	return timesteps[selected];
+}
+
+const double* TimestepBank::getInverse(unsigned int index) const
+{
+	return inverses[index].data();
+}
+
+const SystemSolver& TimestepBank::getSolver(unsigned int index) const
+{
+	return solvers[index];
+}
+
+SystemSolver& TimestepBank::getSolver(unsigned int index)
+{
+	return solvers[index];
+}
+
+const double* TimestepBank::getSelectedInverse() const
+{
+	return inverses[selected].data();
+}
+
+const SystemSolver& TimestepBank::getSelectedSolver() const
+{
+	return solvers[selected];
+}
+
+SystemSolver& TimestepBank::getSelectedSolver()
+{
+	return solvers[selected];
+}
+
+int TimestepBank::exportAsCHeader(const char* filename, const char* bank_name)
+{
+	std::fstream file;
+
+	std::string fname = filename;
+	fname += ".hpp";
+
+	try
+	{
+		file.open(fname.c_str(), std::fstream::out | std::fstream::trunc);
+	}
+	catch(...)
+	{
+		return -1;
+	}
+
+	if(!file.is_open()) return -1;
+
+	file << std::setprecision(16);
+	file << std::scientific;
+
+	file <<
+			"/**\n"
+			" *\n"
+			" * LBLMC Vivado HLS Simulation Engine for FPGA Designs\n"
+			" *\n"
+			" * Auto-generated by TimestepBank Object\n"
+			" *\n"
+			" * Inverted conductance matrices of the system for each time step; " << bank_name << "[i] is the\n"
+			" * matrix of time step " << bank_name << "_DT[i]\n"
+			" *\n"
+			" * NOTE: For this header, do not include outside the system solver to avoid linkage/compilation issues\n"
+			" *\n"
+			" */\n\n";
+
+	file << "#ifndef " << bank_name << "_HPP" << "\n";
+	file << "#define " << bank_name << "_HPP" << "\n";
+
+	file << "\n#include \"LBLMC/DataTypes.hpp\"\n\n";
+
+	file << "#define " << bank_name << "_NUM_TIMESTEPS " << timesteps.size() << "\n\n";
+
+	file << "const LBLMC::NumType " << bank_name << "_DT[" << timesteps.size() << "] =\n{";
+
+	for(unsigned int i = 0; i < timesteps.size(); i++)
+	{
+		file << double(timesteps[i]);
+
+		if(i != timesteps.size()-1) file << ",";
+	}
+
+	file << "};\n\n";
+
+	file << "const LBLMC::NumType " << bank_name << "[" << timesteps.size() << "][" << dimension << "][" << dimension << "] =\n{";
+
+	for(unsigned int i = 0; i < timesteps.size(); i++)
+	{
+		file << "{\n";
+
+		for(unsigned int r = 0; r < dimension; r++)
+		{
+			file << "{" << inverses[i](r,0);
+
+			for(unsigned int c = 1; c < dimension; c++)
+			{
+				file << "," << inverses[i](r,c);
+			}
+			file << "}";
+
+			if(r != dimension-1) file << ",";
+
+			file << "\n";
+		}
+
+		file << "}";
+
+		if(i != timesteps.size()-1) file << ",";
+	}
+
+	file << "};\n";
+
+	file << "\n#endif";
+
+	file << std::flush;
+
+	file.close();
+
+	return 0;
+}
+
+const char* TimestepBank::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	sstrm << "Timestep Bank\n\n";
+	sstrm << "dimension:  " << dimension << "\n";
+	sstrm << "time steps: " << timesteps.size() << "\n\n";
+
+	for(unsigned int i = 0; i < timesteps.size(); i++)
+	{
+		sstrm << ((i == selected) ? "* " : "  ") << i << ": dt = " << double(timesteps[i]) << "\n";
+	}
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+} //namespace LBLMC
@@ -0,0 +1,157 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef TIMESTEPBANK_HPP
+#define TIMESTEPBANK_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemNetlist.hpp"
+#include "SystemSolver.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief bank of inverted conductance matrices and solvers of a netlist, one per simulation time step
+ *
+ * The conductances of the discretized components (capacitors, inductors) depend on the time step, so
+ * a system model is only valid for the time step it was stamped with.  Instead of selecting one of a
+ * fixed set of matrices at compile time (the LMC_DT_* macros of Params.hpp), the bank stamps and
+ * inverts the netlist for a list of time steps at once, so the time step can be switched at runtime,
+ * e.g. to fall back to a longer step when the engine cannot keep up, or to compare results of several
+ * steps from one build.
+ *
+ * The time steps are kept in ascending order.  When switching the time step, each component of the
+ * model must also be given the new step with its setTimestep() method, so that its internal constants
+ * (hol2, hoc2, HOL, ...) and history terms are consistent with the selected matrix; setTimestep() is
+ * only defined with LMC_RUNTIME_TIMESTEP (Params.hpp).  A step function generated by
+ * SystemStepGenerator from a list of time steps instead indexes the exported matrices and its own
+ * constant table by a time step selector.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class TimestepBank
+{
+private:
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	std::vector<NumType> timesteps; ///< time steps of the bank, ascending
+	std::vector<MatrixRMXd> inverses; ///< inverted conductance matrix of each time step
+	std::vector<SystemSolver> solvers; ///< runtime solver of each time step
+	unsigned int selected; ///< index of the selected time step
+
+public:
+
+	/**
+	 * parameter constructor
+	 * @param netlist netlist of the system
+	 * @param timesteps time steps to stamp the netlist with; duplicates are stamped once
+	 * @throws std::runtime_error if no time step is given, a time step is not positive, or the netlist
+	 * cannot be stamped or has a singular conductance matrix for a time step
+	 */
+	TimestepBank(const SystemNetlist& netlist, const std::vector<NumType>& timesteps);
+	TimestepBank(const TimestepBank& base);
+
+	void reset(const SystemNetlist& netlist, const std::vector<NumType>& timesteps);
+	void reset(const TimestepBank& base);
+
+	unsigned int getDimension() const; ///< @return number of solutions in the system
+	unsigned int getNumTimesteps() const; ///< @return number of time steps in the bank
+
+	/**
+	 * @param index index of the time step, in ascending order of the time steps
+	 * @return the time step
+	 */
+	NumType getTimestep(unsigned int index) const;
+
+	/**
+	 * @param dt time step to find
+	 * @param tolerance largest relative difference of a matching time step
+	 * @return index of the time step, or -1 if the bank does not have it
+	 */
+	int findTimestep(NumType dt, double tolerance = 1.0e-9) const;
+
+	/**
+	 * selects the time step used by getSelectedInverse() and getSelectedSolver()
+	 * @param index index of the time step
+	 * @return 0 if successful, -1 if the index is out of range
+	 */
+	int select(unsigned int index);
+
+	/**
+	 * selects the next longer time step, for falling back when a step cannot be computed in time
+	 * @return 0 if successful, -1 if the longest time step is already selected
+	 */
+	int selectLonger();
+
+	/**
+	 * selects the next shorter time step, for returning from a fallback
+	 * @return 0 if successful, -1 if the shortest time step is already selected
+	 */
+	int selectShorter();
+
+	unsigned int getSelected() const; ///< @return index of the selected time step
+	NumType getSelectedTimestep() const; ///< @return the selected time step
+
+	/**
+	 * @param index index of the time step
+	 * @return inverted conductance matrix A = G^-1 of the time step, row-major
+	 */
+	const double* getInverse(unsigned int index) const;
+
+	/**
+	 * @param index index of the time step
+	 * @return runtime solver of the time step
+	 */
+	const SystemSolver& getSolver(unsigned int index) const;
+	SystemSolver& getSolver(unsigned int index);
+
+	const double* getSelectedInverse() const; ///< @return inverted conductance matrix of the selected time step
+	const SystemSolver& getSelectedSolver() const; ///< @return runtime solver of the selected time step
+	SystemSolver& getSelectedSolver(); ///< @return runtime solver of the selected time step
+
+	/**
+	 * exports the time steps and inverted conductance matrices of the bank as a C header file
+	 *
+	 * The header defines bank_name_NUM_TIMESTEPS, the array bank_name_DT of the time steps, and the
+	 * array bank_name[index][row][column] of the inverted conductance matrices, so a system solver can
+	 * index the matrix of the selected time step at runtime.
+	 *
+	 * @param filename name of the file, without the .hpp extension
+	 * @param bank_name name of the matrix array
+	 * @return 0 if successful, -1 if the file cannot be written
+	 */
+	int exportAsCHeader(const char* filename, const char* bank_name);
+
+	/**
+	 * creates a report, as a string, of the time steps of the bank
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+};
+
+} //namespace LBLMC
+
+#endif //TIMESTEPBANK_HPP
@@ -0,0 +1,344 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "WoodburyInverseUpdater.hpp"
+
+#include <map>
+#include <sstream>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace LBLMC
+{
+
+WoodburyInverseUpdater::WoodburyInverseUpdater(SystemConductance& conductance, double tolerance, unsigned int max_update_rank) :
+	dimension(0), G(), A(), pending(), tolerance(tolerance), max_update_rank(max_update_rank),
+	rank_since_refresh(0), residual(0.0), num_updates(0), num_refreshes(0)
+{
+	reset(conductance, tolerance, max_update_rank);
+}
+
+WoodburyInverseUpdater::WoodburyInverseUpdater(const MatrixRMXd& conductance, const MatrixRMXd& inverse,
+	double tolerance, unsigned int max_update_rank) :
+	dimension(0), G(), A(), pending(), tolerance(tolerance), max_update_rank(max_update_rank),
+	rank_since_refresh(0), residual(0.0), num_updates(0), num_refreshes(0)
+{
+	reset(conductance, inverse, tolerance, max_update_rank);
+}
+
+WoodburyInverseUpdater::WoodburyInverseUpdater(const WoodburyInverseUpdater& base) :
+	dimension(base.dimension), G(base.G), A(base.A), pending(base.pending), tolerance(base.tolerance),
+	max_update_rank(base.max_update_rank), rank_since_refresh(base.rank_since_refresh), residual(base.residual),
+	num_updates(base.num_updates), num_refreshes(base.num_refreshes)
+{
+	//do nothing else
+}
+
+void WoodburyInverseUpdater::reset(SystemConductance& conductance, double tolerance, unsigned int max_update_rank)
+{
+	MatrixRMXd G_new = conductance.asEigen3Matrix();
+	MatrixRMXd A_new;
+	invert(G_new, A_new);
+
+	dimension = conductance.getDimension();
+	G.swap(G_new);
+	A.swap(A_new);
+	pending.clear();
+
+	this->tolerance = tolerance;
+	this->max_update_rank = max_update_rank;
+
+	rank_since_refresh = 0;
+	residual = computeResidual(G, A);
+
+	num_updates = 0;
+	num_refreshes = 0;
+}
+
+void WoodburyInverseUpdater::reset(const MatrixRMXd& conductance, const MatrixRMXd& inverse,
+	double tolerance, unsigned int max_update_rank)
+{
+	dimension = conductance.rows();
+	G = conductance;
+	A = inverse;
+	pending.clear();
+
+	this->tolerance = tolerance;
+	this->max_update_rank = max_update_rank;
+
+	rank_since_refresh = 0;
+	residual = computeResidual(G, A);
+
+	num_updates = 0;
+	num_refreshes = 0;
+}
+
+void WoodburyInverseUpdater::reset(const WoodburyInverseUpdater& base)
+{
+	dimension = base.dimension;
+	G = base.G;
+	A = base.A;
+	pending = base.pending;
+	tolerance = base.tolerance;
+	max_update_rank = base.max_update_rank;
+	rank_since_refresh = base.rank_since_refresh;
+	residual = base.residual;
+	num_updates = base.num_updates;
+	num_refreshes = base.num_refreshes;
+}
+
+void WoodburyInverseUpdater::addChange(const std::vector<ConductanceTriplet>& delta)
+{
+	pending.insert(pending.end(), delta.begin(), delta.end());
+}
+
+void WoodburyInverseUpdater::addChange(const std::vector<ConductanceTriplet>& old_stamp,
+	const std::vector<ConductanceTriplet>& new_stamp)
+{
+	for(unsigned int t = 0; t < old_stamp.size(); t++)
+	{
+		pending.push_back(ConductanceTriplet(old_stamp[t].row, old_stamp[t].col, -old_stamp[t].value));
+	}
+
+	addChange(new_stamp);
+}
+
+void WoodburyInverseUpdater::addBranchChange(unsigned int npos, unsigned int nneg, NumType delta_conductance)
+{
+	stampBranchConductance(pending, npos, nneg, delta_conductance);
+}
+
+int WoodburyInverseUpdater::update()
+{
+	if(pending.empty()) return 0;
+
+		//touched nodes K and the change C = dG[K,K]
+
+	std::map<unsigned int, unsigned int> position;
+	for(unsigned int t = 0; t < pending.size(); t++)
+	{
+		position[pending[t].row] = 0;
+		position[pending[t].col] = 0;
+	}
+
+	std::vector<unsigned int> K;
+	for(std::map<unsigned int, unsigned int>::iterator it = position.begin(); it != position.end(); it++)
+	{
+		it->second = K.size();
+		K.push_back(it->first);
+	}
+
+	const unsigned int k = K.size();
+
+	if(max_update_rank != 0 && rank_since_refresh + k > max_update_rank)
+	{
+		refresh();
+		return 1;
+	}
+
+	Eigen::MatrixXd C = Eigen::MatrixXd::Zero(k, k);
+	for(unsigned int t = 0; t < pending.size(); t++)
+	{
+		C(position[pending[t].row], position[pending[t].col]) += double(pending[t].value);
+	}
+
+	Eigen::MatrixXd A_cols(dimension, k); //A[:,K]
+	Eigen::MatrixXd A_rows(k, dimension); //A[K,:]
+	for(unsigned int j = 0; j < k; j++)
+	{
+		A_cols.col(j) = A.col(K[j]);
+		A_rows.row(j) = A.row(K[j]);
+	}
+
+	Eigen::MatrixXd A_KK(k, k);
+	for(unsigned int j = 0; j < k; j++)
+	{
+		A_KK.col(j) = A_rows.col(K[j]);
+	}
+
+		//A' = A - A[:,K] * (I + C*A[K,K])^-1 * C * A[K,:]
+
+	Eigen::PartialPivLU<Eigen::MatrixXd> lu(Eigen::MatrixXd::Identity(k, k) + C*A_KK);
+
+	if(!(lu.rcond() > std::numeric_limits<double>::epsilon()))
+	{
+		refresh(); //update is singular, e.g. the old and new stamps disconnect a node
+		return 1;
+	}
+
+	const Eigen::MatrixXd Z = lu.solve(C*A_rows);
+
+	MatrixRMXd A_new = A;
+	A_new.noalias() -= A_cols*Z;
+
+	MatrixRMXd G_new = G;
+	applyPending(G_new);
+
+	const double new_residual = computeResidual(G_new, A_new, &A);
+	if(!(new_residual <= tolerance))
+	{
+		refresh(); //rounding error of the updates is too large
+		return 1;
+	}
+
+	G.swap(G_new);
+	A.swap(A_new);
+	pending.clear();
+
+	rank_since_refresh += k;
+	residual = new_residual;
+	num_updates++;
+
+	return 0;
+}
+
+void WoodburyInverseUpdater::refresh()
+{
+		//invert into new storage, so G and A are unchanged if the changed G is singular
+
+	MatrixRMXd G_new = G;
+	applyPending(G_new);
+
+	MatrixRMXd A_new;
+	invert(G_new, A_new);
+
+	G.swap(G_new);
+	A.swap(A_new);
+	pending.clear();
+
+	rank_since_refresh = 0;
+	residual = computeResidual(G, A);
+	num_refreshes++;
+}
+
+const MatrixRMXd& WoodburyInverseUpdater::getInverse() const
+{
+	return A;
+}
+
+const double* WoodburyInverseUpdater::asPointer() const
+{
+	return A.data();
+}
+
+const MatrixRMXd& WoodburyInverseUpdater::getConductance() const
+{
+	return G;
+}
+
+unsigned int WoodburyInverseUpdater::getDimension() const
+{
+	return dimension;
+}
+
+unsigned int WoodburyInverseUpdater::getNumPendingChanges() const
+{
+	return pending.size();
+}
+
+unsigned int WoodburyInverseUpdater::getRankSinceRefresh() const
+{
+	return rank_since_refresh;
+}
+
+double WoodburyInverseUpdater::getResidualEstimate() const
+{
+	return residual;
+}
+
+unsigned long WoodburyInverseUpdater::getNumUpdates() const
+{
+	return num_updates;
+}
+
+unsigned long WoodburyInverseUpdater::getNumRefreshes() const
+{
+	return num_refreshes;
+}
+
+const char* WoodburyInverseUpdater::asString(std::string& buffer)
+{
+	std::stringstream sstrm;
+
+	sstrm << "Woodbury Inverse Updater Statistics\n\n";
+	sstrm << "dimension:          " << dimension << "\n";
+	sstrm << "tolerance:          " << tolerance << "\n";
+	sstrm << "max update rank:    " << max_update_rank << "\n\n";
+	sstrm << "updates:            " << num_updates << "\n";
+	sstrm << "full re-inversions: " << num_refreshes << "\n";
+	sstrm << "rank since refresh: " << rank_since_refresh << "\n";
+	sstrm << "residual estimate:  " << residual << "\n";
+	sstrm << "pending changes:    " << pending.size() << "\n";
+
+	buffer = sstrm.str();
+	return buffer.c_str();
+}
+
+void WoodburyInverseUpdater::applyPending(MatrixRMXd& conductance) const
+{
+	for(unsigned int t = 0; t < pending.size(); t++)
+	{
+		conductance(pending[t].row, pending[t].col) += double(pending[t].value);
+	}
+}
+
+void WoodburyInverseUpdater::invert(const MatrixRMXd& conductance, MatrixRMXd& inverse) const
+{
+	SystemConductance inverted(conductance.rows(), const_cast<MatrixRMXd*>(&conductance)); //copies the matrix
+	inverted.invertSelf();
+
+	inverse.swap(inverted.asEigen3Matrix());
+}
+
+double WoodburyInverseUpdater::computeResidual(const MatrixRMXd& conductance, const MatrixRMXd& inverse, const MatrixRMXd* base_inverse) const
+{
+	const unsigned int n = conductance.rows();
+
+	if(n == 0) return 0.0;
+
+		//fixed probe vector with varied entries, so the residual does not depend on the call
+
+	Eigen::VectorXd v(n);
+	for(unsigned int i = 0; i < n; i++)
+	{
+		v(i) = 1.0 + 0.5*std::sin(double(i));
+	}
+
+	const Eigen::VectorXd r = conductance*(inverse*v) - v;
+
+		//scaled by |G|*|A| (infinity norms), so the rounding error of a fresh inversion of a stiff G is
+		//near machine precision instead of growing with the spread of its conductances
+
+	const double G_norm = conductance.cwiseAbs().rowwise().sum().maxCoeff();
+	double A_norm = inverse.cwiseAbs().rowwise().sum().maxCoeff();
+
+		//an update that cancels catastrophically inflates A, which would hide its residual in the scale
+
+	if(base_inverse != 0) A_norm = std::min(A_norm, base_inverse->cwiseAbs().rowwise().sum().maxCoeff());
+	const double scale = G_norm*A_norm*v.cwiseAbs().maxCoeff();
+
+	if(!(scale > 0.0)) return r.cwiseAbs().maxCoeff();
+
+	return r.cwiseAbs().maxCoeff() / scale;
+}
+
+} //namespace LBLMC
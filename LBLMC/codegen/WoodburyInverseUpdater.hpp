@@ -0,0 +1,191 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef WOODBURYINVERSEUPDATER_HPP
+#define WOODBURYINVERSEUPDATER_HPP
+
+#include <vector>
+#include <string>
+#include "LBLMC/DataTypes.hpp"
+#include "LBLMC/comp/ConductanceTriplet.hpp"
+#include "TBDataTypes.hpp"
+#include "SystemConductance.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief keeps the inverted conductance matrix A = G^-1 of a system up to date under component changes
+ *
+ * Changing a component's parameters or nodes changes only the entries of G at the component's
+ * terminals; a two-terminal stamp is a rank-1 change.  Instead of re-stamping and re-inverting G,
+ * queued changes dG are applied to A with the Sherman-Morrison-Woodbury identity.  With K the set of
+ * k nodes touched by the changes and C = dG[K,K]:
+ *
+ * 	A' = A - A[:,K] * (I + C*A[K,K])^-1 * C * A[K,:]
+ *
+ * which costs O(n^2 k) instead of O(n^3).
+ *
+ * The rounding error of the updates accumulates, so after each update the residual of a probe vector
+ * v is checked, relative to the norms of the matrices:
+ *
+ * 	|G'*A'*v - v| / (|G'|*|A'|*|v|)
+ *
+ * which stays near machine precision for a freshly inverted G however stiff it is (conductances
+ * spanning many decades), so only the error added by the updates is measured.  After an update |A'| is
+ * taken as the smaller of the norms of A' and of A before the update, as an update that fails by
+ * cancellation (e.g. opening a very stiff branch) inflates A' and would otherwise pass the check.  A full re-inversion of
+ * G is done when the residual exceeds the tolerance, when the rank of the updates since the last
+ * inversion exceeds a limit, or when an update is singular.  The rank of an update is counted as its
+ * number of touched nodes k, an upper bound.
+ *
+ * The changes are given as conductance triplets, typically from SystemNetlist::stampElementConductance()
+ * of a component before (removed) and after (added) changing it.
+ *
+ * @note This class is NOT intended for RTL Synthesis.
+ */
+class WoodburyInverseUpdater
+{
+private:
+	unsigned int dimension; ///< number of solutions in the system Gx=b
+	MatrixRMXd G; ///< present conductance matrix, with applied changes
+	MatrixRMXd A; ///< present inverted conductance matrix
+	std::vector<ConductanceTriplet> pending; ///< queued changes of G not applied yet
+
+	double tolerance; ///< largest allowed relative residual before a full re-inversion
+	unsigned int max_update_rank; ///< largest total rank of updates between full re-inversions; 0 for no limit
+	unsigned int rank_since_refresh; ///< total rank of updates since the last full inversion
+	double residual; ///< relative residual estimate of the present inverse, scaled by |G|*|A|
+
+	unsigned long num_updates; ///< statistics: number of Woodbury updates applied
+	unsigned long num_refreshes; ///< statistics: number of full re-inversions
+
+public:
+
+	/**
+	 * parameter constructor
+	 *
+	 * Inverts the given conductance matrix.
+	 *
+	 * @param conductance (not inverted) conductance matrix of the system
+	 * @param tolerance largest allowed residual, relative to |G|*|A|, before a full re-inversion
+	 * @param max_update_rank largest total rank of updates between full re-inversions; 0 for no limit
+	 * @throws std::runtime_error if the conductance matrix is singular
+	 */
+	WoodburyInverseUpdater(SystemConductance& conductance, double tolerance = 1e-9, unsigned int max_update_rank = 0);
+	/**
+	 * parameter constructor
+	 *
+	 * Starts from an already inverted conductance matrix, e.g. a cached one, instead of inverting it.
+	 *
+	 * @param conductance (not inverted) conductance matrix of the system
+	 * @param inverse inverted conductance matrix A = G^-1
+	 * @param tolerance largest allowed residual, relative to |G|*|A|, before a full re-inversion
+	 * @param max_update_rank largest total rank of updates between full re-inversions; 0 for no limit
+	 */
+	WoodburyInverseUpdater(const MatrixRMXd& conductance, const MatrixRMXd& inverse, double tolerance = 1e-9, unsigned int max_update_rank = 0);
+	WoodburyInverseUpdater(const WoodburyInverseUpdater& base);
+
+	void reset(SystemConductance& conductance, double tolerance = 1e-9, unsigned int max_update_rank = 0);
+	void reset(const MatrixRMXd& conductance, const MatrixRMXd& inverse, double tolerance = 1e-9, unsigned int max_update_rank = 0);
+	void reset(const WoodburyInverseUpdater& base);
+
+	/**
+	 * queues a change of the conductance matrix
+	 * @param delta conductance triplets to add to G
+	 */
+	void addChange(const std::vector<ConductanceTriplet>& delta);
+
+	/**
+	 * queues the change of a component's stamp
+	 * @param old_stamp conductance triplets of the component before the change; removed from G
+	 * @param new_stamp conductance triplets of the component after the change; added to G
+	 */
+	void addChange(const std::vector<ConductanceTriplet>& old_stamp, const std::vector<ConductanceTriplet>& new_stamp);
+
+	/**
+	 * queues a change of the conductance between two nodes, e.g. of a resistor
+	 * @param npos index of positive node; zero is ground
+	 * @param nneg index of negative node; zero is ground
+	 * @param delta_conductance change of the conductance between the nodes
+	 */
+	void addBranchChange(unsigned int npos, unsigned int nneg, NumType delta_conductance);
+
+	/**
+	 * applies the queued changes to the inverted matrix
+	 *
+	 * Falls back to a full re-inversion of the changed G when the update is singular, the update rank
+	 * limit is reached, or the residual after the update exceeds the tolerance.
+	 *
+	 * @return 0 if the changes were applied as an update, 1 if a full re-inversion was done
+	 * @throws std::runtime_error if the changed conductance matrix is singular; G, A and the queued
+	 * changes are then left unchanged
+	 */
+	int update();
+
+	/**
+	 * applies the queued changes to G and fully re-inverts it
+	 *
+	 * If the changed G is singular, G, A and the queued changes are left unchanged.
+	 *
+	 * @throws std::runtime_error if the changed conductance matrix is singular
+	 */
+	void refresh();
+
+	/**
+	 * @return present inverted conductance matrix A = G^-1, row-major; pending changes are not applied
+	 */
+	const MatrixRMXd& getInverse() const;
+
+	/**
+	 * @return present inverted conductance matrix as a row-major array, e.g. for SystemSolver
+	 */
+	const double* asPointer() const;
+
+	/**
+	 * @return present conductance matrix G, with applied changes
+	 */
+	const MatrixRMXd& getConductance() const;
+
+	unsigned int getDimension() const; ///< @return number of solutions in the system
+	unsigned int getNumPendingChanges() const; ///< @return number of queued conductance triplets
+	unsigned int getRankSinceRefresh() const; ///< @return total rank of updates since the last full inversion
+	double getResidualEstimate() const; ///< @return relative residual |G*A*v - v|/(|G|*|A|*|v|) of the last probe
+	unsigned long getNumUpdates() const; ///< @return number of Woodbury updates applied
+	unsigned long getNumRefreshes() const; ///< @return number of full re-inversions
+
+	/**
+	 * creates a report, as a string, of the update statistics
+	 * @param buffer string that will store the report
+	 * @return the buffer string as a const char* string
+	 */
+	const char* asString(std::string& buffer);
+
+private:
+
+	void applyPending(MatrixRMXd& conductance) const;
+	void invert(const MatrixRMXd& conductance, MatrixRMXd& inverse) const;
+	double computeResidual(const MatrixRMXd& conductance, const MatrixRMXd& inverse, const MatrixRMXd* base_inverse = 0) const;
+};
+
+} //namespace LBLMC
+
+#endif //WOODBURYINVERSEUPDATER_HPP
@@ -33,6 +33,16 @@ Capacitor::Capacitor(NumType dt, NumType cap)
 , current(0.0),current_eq(0.0),current_past(0.0),current_eq_past(0.0)
 {}
 
+#ifdef LMC_RUNTIME_TIMESTEP
+void Capacitor::setTimestep(NumType dt)
+{
+	this->dt = dt;
+	hoc2 = NumType(2.0)*cap/dt;
+
+	current_eq = (current) + (hoc2)*(delta_v);
+}
+#endif
+
 void Capacitor::update(NumType epos, NumType eneg, NumType* bout)
 {
 	//#pragma HLS inline
@@ -77,6 +87,15 @@ int Capacitor::stampConductance(NumType* conduct_mat, unsigned int dim, unsigned
 	return 0;
 }
 
+int Capacitor::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos, unsigned int nneg)
+{
+	if( (dim < npos) || (dim < nneg) ) return -1;
+
+	stampBranchConductance(triplets, npos, nneg, hoc2);
+
+	return 0;
+}
+
 void Capacitor::stampSources(std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg)
 {
     sources.push_back(npos);
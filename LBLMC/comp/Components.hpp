@@ -32,5 +32,6 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #include "LBLMC/comp/TwoPhaseHBConverter.hpp"
 #include "LBLMC/comp/MutualInductance2.hpp"
 #include "LBLMC/comp/MutualInductance3.hpp"
+#include "LBLMC/comp/ResistiveSwitch.hpp"
 
 #endif //LBLMCCOMPONENTS_HPP
@@ -0,0 +1,82 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CONDUCTANCETRIPLET_HPP
+#define CONDUCTANCETRIPLET_HPP
+
+#include <vector>
+
+#include "LBLMC/DataTypes.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief single conductance entry (row, col, value) of a conductance matrix in coordinate (COO) form
+ *
+ * Components stamp lists of these triplets instead of a dense dim*dim array when the system is too
+ * large to store densely.  Row and column are zero-based matrix indices (node index - 1).  Entries
+ * with the same row and column are summed when the list is compressed.
+ *
+ * @note This struct is NOT intended for RTL Synthesis.
+ */
+struct ConductanceTriplet
+{
+	unsigned int row; ///< zero-based row of the entry
+	unsigned int col; ///< zero-based column of the entry
+	NumType value; ///< conductance added to the entry
+
+	ConductanceTriplet(unsigned int row, unsigned int col, NumType value) :
+		row(row), col(col), value(value)
+	{}
+};
+
+/**
+ * stamps a conductance between two nodes as triplets
+ *
+ * Same stamp as the dense stampConductance() of two-terminal components: +g on the diagonal of both
+ * nodes and -g between them, or only the diagonal entry if one node is ground.
+ *
+ * @note This function is NOT intended to be synthesizable to RTL.
+ *
+ * @param triplets list of conductance triplets to append to
+ * @param npos index of positive node; zero is ground
+ * @param nneg index of negative node; zero is ground
+ * @param conductance conductance between the nodes
+ */
+inline void stampBranchConductance(std::vector<ConductanceTriplet>& triplets,
+	unsigned int npos, unsigned int nneg, NumType conductance)
+{
+	if( npos == nneg ) return; //branch is shorted out
+
+	if( npos != 0 ) triplets.push_back(ConductanceTriplet(npos-1, npos-1, conductance));
+	if( nneg != 0 ) triplets.push_back(ConductanceTriplet(nneg-1, nneg-1, conductance));
+
+	if( npos != 0 && nneg != 0 )
+	{
+		triplets.push_back(ConductanceTriplet(npos-1, nneg-1, -conductance));
+		triplets.push_back(ConductanceTriplet(nneg-1, npos-1, -conductance));
+	}
+}
+
+} //namespace LBLMC
+
+#endif //CONDUCTANCETRIPLET_HPP
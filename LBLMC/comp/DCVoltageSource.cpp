@@ -37,6 +37,11 @@ void DCVoltageSource::update(NumType* bout)
 	*bout = bs;
 }
 
+NumType DCVoltageSource::getSourceCurrent() const
+{
+	return bs;
+}
+
 int DCVoltageSource::stampConductance(NumType* conduct_mat, unsigned int dim, unsigned int npos, unsigned int nneg)
 {
 	if( (dim < npos) || (dim < nneg) || (conduct_mat == 0) ) return -1;
@@ -57,6 +62,15 @@ int DCVoltageSource::stampConductance(NumType* conduct_mat, unsigned int dim, un
 	return 0;
 }
 
+int DCVoltageSource::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos, unsigned int nneg)
+{
+	if( (dim < npos) || (dim < nneg) ) return -1;
+
+	stampBranchConductance(triplets, npos, nneg, gs);
+
+	return 0;
+}
+
 void DCVoltageSource::stampSources(std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg)
 {
     sources.push_back(npos);
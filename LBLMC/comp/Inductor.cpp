@@ -31,6 +31,16 @@ Inductor::Inductor(NumType dt, NumType ind)
 , current(0.0),current_eq(0.0),current_past(0.0),current_eq_past(0.0)
 {}
 
+#ifdef LMC_RUNTIME_TIMESTEP
+void Inductor::setTimestep(NumType dt)
+{
+	this->dt = dt;
+	hol2 = dt/NumType(2.0)/ind;
+
+	current_eq = -current - hol2*delta_v;
+}
+#endif
+
 void Inductor::update(NumType epos, NumType eneg, NumType* bout)
 {
 	//#pragma HLS inline
@@ -85,6 +95,15 @@ int Inductor::stampConductance(NumType* conduct_mat, unsigned int dim, unsigned
 	return 0;
 }
 
+int Inductor::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos, unsigned int nneg)
+{
+	if( (dim < npos) || (dim < nneg) ) return -1;
+
+	stampBranchConductance(triplets, npos, nneg, hol2);
+
+	return 0;
+}
+
 void Inductor::stampSources(std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg)
 {
     sources.push_back(npos);
@@ -26,6 +26,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #include <vector>
 
 #include "LBLMC/DataTypes.hpp"
+#include "LBLMC/comp/ConductanceTriplet.hpp"
 
 namespace LBLMC
 {
@@ -40,10 +41,10 @@ namespace LBLMC
 class Inductor
 {
 private:
-	const NumType dt;
+	LMC_TIMESTEP_CONST NumType dt;
 	const NumType ind;
 
-	const NumType hol2;
+	LMC_TIMESTEP_CONST NumType hol2;
 
 	NumType
 		epos_past,
@@ -59,6 +60,19 @@ public:
 
 	Inductor(NumType dt, NumType ind);
 
+#ifdef LMC_RUNTIME_TIMESTEP
+	/**
+	 * changes the simulation time step of the component at runtime
+	 *
+	 * Recomputes the internal constant and the history current of the next update() for the new time
+	 * step, so the component continues from its present state.  The conductance matrix of the system
+	 * must be switched to one stamped with the same time step.
+	 *
+	 * @param dt new simulation time step
+	 */
+	void setTimestep(NumType dt);
+#endif
+
 	void update(NumType epos, NumType eneg, NumType* bout);
 
 	/**
@@ -91,6 +105,22 @@ public:
 	 */
 	int stampConductance(NumType* conduct_mat, unsigned int dim, unsigned int npos, unsigned int nneg);
 
+	/**
+	 * stamps conductance of component as triplets of a sparse conductance matrix (Non-Synthesis ONLY)
+	 *
+	 * Same stamp as the dense stampConductance(), for systems too large to store as dense matrices.
+	 *
+	 * @note This method is NOT intended to be synthesizable to RTL.
+	 *
+	 * @param triplets list of conductance triplets to append to
+	 * @param dim dimension of square conductance matrix (width or height)
+	 * @param npos index of positive terminal of component; zero is ground
+	 * @param nneg index of negative terminal of component; zero is ground
+	 *
+	 * @return 0 if successful, -1 if cannot stamp conductance to matrix due to matrix dimension size
+	 */
+	int stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos, unsigned int nneg);
+
 	/**
         @brief stamps the nodes of source(s) of this component into a vector that can be used to
         construct equations for the system source vector b (out of Gx=b).
@@ -36,6 +36,13 @@ MutualInductance2::MutualInductance2(NumType dt, NumType L1, NumType L2, NumType
     assert( ( (L1*L2 - M*M) != 0 )&&"MutualInductance2 inductance matrix parameters must be invertible; L1*L2-M^2 != 0" );
 }
 
+#ifdef LMC_RUNTIME_TIMESTEP
+void MutualInductance2::setTimestep(NumType dt)
+{
+    this->dt = dt;
+}
+#endif
+
 void MutualInductance2::update(NumType epos1, NumType eneg1, NumType epos2, NumType eneg2, NumType* bout1, NumType* bout2)
 {
     voltage1 = epos1 - eneg1;
@@ -55,4 +62,11 @@ int MutualInductance2::stampConductance(NumType* conduct_mat, unsigned int dim,
     return 0;
 }
 
+int MutualInductance2::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos1, unsigned int nneg1, unsigned int npos2, unsigned int nneg2)
+{
+    //do nothing as there is no conductance to stamp (Euler Forward)
+
+    return 0;
+}
+
 } //namespace LBLMC
@@ -25,6 +25,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 
  #include "LBLMC/Params.hpp"
  #include "LBLMC/DataTypes.hpp"
+ #include "LBLMC/comp/ConductanceTriplet.hpp"
 
  namespace LBLMC
  {
@@ -54,7 +55,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
  class MutualInductance2
  {
  private:
-	const NumType dt;        ///< simulation time step
+	LMC_TIMESTEP_CONST NumType dt;        ///< simulation time step
     const NumType L1;        ///< inductance of 1st inductor
     const NumType L2;        ///< inductance of 2nd inductor
     const NumType M;         ///< mutual inductance between inductors, M = k*sqrt(L1*L2), k coupling coefficient 0.0-1.0
@@ -79,6 +80,18 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 	**/
 	MutualInductance2(NumType dt, NumType L1, NumType L2, NumType M);
 
+#ifdef LMC_RUNTIME_TIMESTEP
+	/**
+	 * changes the simulation time step of the component at runtime
+	 *
+	 * The component is discretized with Euler Forward and stamps no conductance, so only its internal
+	 * constants change; it continues from its present state.
+	 *
+	 * @param dt new simulation time step
+	 */
+	void setTimestep(NumType dt);
+#endif
+
 	/**
         @brief updates state of component and the b-vector currents from it
         @param epos1 input voltage at terminal 1 of 1st coil
@@ -104,6 +117,13 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 
 	**/
 	int stampConductance(NumType* conduct_mat, unsigned int dim, unsigned int npos1, unsigned int nneg1, unsigned int npos2, unsigned int nneg2);
+
+	/**
+        @brief stamps conductance of component as triplets of a sparse conductance matrix
+
+        This component has no conductance (using EF for integration) so, has no effect
+	**/
+	int stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos1, unsigned int nneg1, unsigned int npos2, unsigned int nneg2);
  };
 
  }
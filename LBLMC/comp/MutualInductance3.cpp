@@ -45,6 +45,14 @@ MutualInductance3::MutualInductance3(NumType dt, NumType L1, NumType L2, NumType
     //do nothing else
 }
 
+#ifdef LMC_RUNTIME_TIMESTEP
+void MutualInductance3::setTimestep(NumType dt)
+{
+    this->dt = dt;
+    d = dt / (L3*M12*M12 - NumType(2)*M12*M23*M31 + L1*M23*M23 + L2*M31*M31 - L1*L2*L3 );
+}
+#endif
+
 //	MutualInductance3::MutualInductance3(NumType dt, NumType L[9])
 //	{
 //
@@ -74,6 +82,14 @@ int MutualInductance3::stampConductance(NumType* conduct_mat, unsigned int dim,
     return 0;
 }
 
+int MutualInductance3::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim,
+	unsigned int npos1, unsigned int nneg1, unsigned int npos2, unsigned int nneg2, unsigned int npos3, unsigned int nneg3)
+{
+    //do nothing as there is no conductance to stamp (Euler Forward)
+
+    return 0;
+}
+
 void MutualInductance3::stampSources(std::vector<unsigned int>& sources,
         unsigned int npos1, unsigned int nneg1, unsigned int npos2, unsigned int nneg2, unsigned int npos3, unsigned int nneg3)
 {
@@ -27,6 +27,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 
  #include "LBLMC/Params.hpp"
  #include "LBLMC/DataTypes.hpp"
+ #include "LBLMC/comp/ConductanceTriplet.hpp"
 
  namespace LBLMC
  {
@@ -58,14 +59,14 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
  class MutualInductance3
  {
  private:
-	const NumType dt;   ///< simulation time step
+	LMC_TIMESTEP_CONST NumType dt;   ///< simulation time step
 	const NumType L1;   ///< inductance of 1st inductor
 	const NumType L2;   ///< inductance of 2nd inductor
 	const NumType L3;   ///< inductance of 3rd inductor
 	const NumType M12;  ///< mutual inductance between 1st and 2nd inductors
 	const NumType M23;  ///< mutual inductance between 2nd and 3rd inductors
 	const NumType M31;  ///< mutual inductance between 3rd and 1st inductors
-	const NumType d;    ///< internal constant
+	LMC_TIMESTEP_CONST NumType d;    ///< internal constant
 	const NumType k1;   ///< internal constant
 	const NumType k2;   ///< internal constant
 	const NumType k3;   ///< internal constant
@@ -92,12 +93,27 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 		NumType M12,NumType M23,NumType M31);
 	//MutualInductance3(NumType dt, NumType L[9]);
 
+#ifdef LMC_RUNTIME_TIMESTEP
+	/**
+	 * changes the simulation time step of the component at runtime
+	 *
+	 * The component is discretized with Euler Forward and stamps no conductance, so only its internal
+	 * constants change; it continues from its present state.
+	 *
+	 * @param dt new simulation time step
+	 */
+	void setTimestep(NumType dt);
+#endif
+
 	void update(NumType epos1, NumType eneg1, NumType epos2, NumType eneg2, NumType epos3, NumType eneg3,
 		NumType* bout1, NumType* bout2, NumType* bout3);
 
 	int stampConductance(NumType* conduct_mat, unsigned int dim,
 		unsigned int npos1, unsigned int nneg1, unsigned int npos2, unsigned int nneg2, unsigned int npos3, unsigned int nneg3);
 
+	int stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim,
+		unsigned int npos1, unsigned int nneg1, unsigned int npos2, unsigned int nneg2, unsigned int npos3, unsigned int nneg3);
+
 
     void stampSources(std::vector<unsigned int>& sources,
         unsigned int npos1, unsigned int nneg1, unsigned int npos2, unsigned int nneg2, unsigned int npos3, unsigned int nneg3);
@@ -35,6 +35,13 @@ RLSwitch::RLSwitch(NumType dt, NumType l, NumType r) :
 	sw_past(false)
 {}
 
+#ifdef LMC_RUNTIME_TIMESTEP
+void RLSwitch::setTimestep(NumType dt)
+{
+	DT = dt;
+	HOL = dt/L;
+}
+#endif
 
 void RLSwitch::update(NumType epos, NumType eneg, bool sw, NumType* bout)
 {
@@ -70,6 +77,13 @@ int RLSwitch::stampConductance(NumType* conduct_mat, unsigned int dim, unsigned
 	return 0;
 }
 
+int RLSwitch::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos, unsigned int nneg)
+{
+	//do nothing since component has no conductance with Euler Forward
+
+	return 0;
+}
+
 void RLSwitch::stampSources(std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg)
 {
 	sources.push_back(npos);
@@ -25,6 +25,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #define LBLMC_COMPONENT_RLSWITCH_HPP
 
 #include "LBLMC/DataTypes.hpp"
+#include "LBLMC/comp/ConductanceTriplet.hpp"
 #include <vector>
 
 namespace LBLMC
@@ -51,10 +52,10 @@ namespace LBLMC
 class RLSwitch
 {
 private:
-	const NumType DT;
+	LMC_TIMESTEP_CONST NumType DT;
 	const NumType L;
 	const NumType R;
-	const NumType HOL;
+	LMC_TIMESTEP_CONST NumType HOL;
 
 	NumType current_past;
 	NumType sw_past;
@@ -63,12 +64,26 @@ public:
 
 	RLSwitch(NumType dt, NumType l, NumType r);
 
+#ifdef LMC_RUNTIME_TIMESTEP
+	/**
+	 * changes the simulation time step of the component at runtime
+	 *
+	 * The component is discretized with Euler Forward and stamps no conductance, so only its internal
+	 * constants change; it continues from its present state.
+	 *
+	 * @param dt new simulation time step
+	 */
+	void setTimestep(NumType dt);
+#endif
+
 	void update(NumType epos, NumType eneg, bool sw, NumType* bout);
 
 	NumType measureThroughCurrent(NumType* current);
 
 	int stampConductance(NumType* conduct_mat, unsigned int dim, unsigned int npos, unsigned int nneg);
 
+	int stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos, unsigned int nneg);
+
 	void stampSources(std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg);
 
 	int stampSystem(NumType* conduct_mat, unsigned int dim, std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg);
@@ -0,0 +1,95 @@
+/*
+
+Copyright (C) 2017-2019 Matthew Milton
+Copyright (C) 2017-2019 Andrea Benigni
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#include "ResistiveSwitch.hpp"
+
+namespace LBLMC
+{
+
+ResistiveSwitch::ResistiveSwitch(NumType r_on, NumType r_off, bool closed) :
+	g_on(NumType(1.0)/r_on),
+	g_off( (r_off == NumType(0.0)) ? NumType(0.0) : NumType(NumType(1.0)/r_off) ),
+	closed(closed)
+{}
+
+void ResistiveSwitch::update(bool sw)
+{
+	closed = sw;
+}
+
+bool ResistiveSwitch::isClosed() const
+{
+	return closed;
+}
+
+NumType ResistiveSwitch::getConductance(bool closed) const
+{
+	return closed ? g_on : g_off;
+}
+
+NumType ResistiveSwitch::measureThroughCurrent(NumType epos, NumType eneg) const
+{
+	return getConductance(closed)*(epos - eneg);
+}
+
+int ResistiveSwitch::stampConductance(NumType* conduct_mat, unsigned int dim, unsigned int npos, unsigned int nneg)
+{
+	if( (dim < npos) || (dim < nneg) || (conduct_mat == 0) ) return -1;
+	if( npos == nneg ) return 0; //component is shorted out
+
+	const NumType conductance = getConductance(closed);
+
+	if( npos != 0 && nneg != 0)
+	{
+		conduct_mat[dim*(npos-1) + (npos-1)] += conductance;
+		conduct_mat[dim*(npos-1) + (nneg-1)] += -conductance;
+		conduct_mat[dim*(nneg-1) + (npos-1)] += -conductance;
+		conduct_mat[dim*(nneg-1) + (nneg-1)] += conductance;
+	}
+	else if (npos != 0)
+		conduct_mat[dim*(npos-1)+ (npos-1)] += conductance;
+	else if (nneg != 0)
+		conduct_mat[dim*(nneg-1)+ (nneg-1)] += conductance;
+
+	return 0;
+}
+
+int ResistiveSwitch::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos, unsigned int nneg)
+{
+	if( (dim < npos) || (dim < nneg) ) return -1;
+
+	stampBranchConductance(triplets, npos, nneg, getConductance(closed));
+
+	return 0;
+}
+
+void ResistiveSwitch::stampSources(std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg)
+{
+	//does nothing
+}
+
+int ResistiveSwitch::stampSystem(NumType* conduct_mat, unsigned int dim, std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg)
+{
+	return stampConductance(conduct_mat,dim,npos,nneg);
+}
+
+} //namespace LBLMC
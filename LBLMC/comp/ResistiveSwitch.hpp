@@ -0,0 +1,148 @@
+/*
+
+Copyright (C) 2017-2019 Matthew Milton
+Copyright (C) 2017-2019 Andrea Benigni
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef RESISTIVESWITCH_HPP
+#define RESISTIVESWITCH_HPP
+
+#include <vector>
+
+#include "LBLMC/DataTypes.hpp"
+#include "LBLMC/comp/ConductanceTriplet.hpp"
+
+namespace LBLMC
+{
+
+/**
+ * @brief Resistive Switch Model
+ *
+ * switch that stamps its conductance into the system: g_on = 1/r_on when closed, g_off = 1/r_off
+ * when open.  Unlike the RLSwitch and the half-bridge converters, which are latency elements with
+ * no conductance, this switch is exact at any time step, but the conductance matrix, and so its
+ * inverse, depends on the switch state.  The system solver must use the inverse of the present
+ * states of all switches, e.g. selected from a SwitchedSystemSolverBank.
+ *
+ * An ideal switch is modeled with a small r_on.  An r_off of zero stamps no conductance when open;
+ * then nodes only connected through the switch are floating when it is open.
+ *
+ * contains no latency, so has no states other than the switch state, and no sources.
+ *
+ * @note This class is NOT intended for RTL Synthesis
+ */
+class ResistiveSwitch
+{
+private:
+	const NumType g_on; ///< conductance when closed (1/r_on)
+	const NumType g_off; ///< conductance when open (1/r_off), or 0
+	bool closed; ///< present switch state
+
+public:
+
+	/**
+	 * parameter constructor
+	 *
+	 * @param r_on resistance of the switch when closed
+	 * @param r_off resistance of the switch when open; zero for no conductance
+	 * @param closed initial switch state
+	 */
+	ResistiveSwitch(NumType r_on, NumType r_off, bool closed = false);
+
+	/**
+	 * sets the switch state
+	 *
+	 * The conductance matrix of the system changes with the state, so the system solver must switch to
+	 * the inverse of the new states before the next solve.
+	 *
+	 * @param sw switch is closed if true, switch is open if false
+	 */
+	void update(bool sw);
+
+	/**
+	 * @return true if the switch is closed
+	 */
+	bool isClosed() const;
+
+	/**
+	 * @param closed switch state
+	 * @return conductance of the switch in the given state
+	 */
+	NumType getConductance(bool closed) const;
+
+	/**
+	 * measures the current through the switch, from positive to negative terminal
+	 * @param epos positive terminal voltage
+	 * @param eneg negative terminal voltage
+	 * @return current through the switch in its present state
+	 */
+	NumType measureThroughCurrent(NumType epos, NumType eneg) const;
+
+	/**
+	 * stamps conductance of component in its present state into given conductance matrix (Non-Synthesis ONLY)
+	 *
+	 * This method expects the conductance matrix to be correct size and it to be a square matrix
+	 *
+	 * @note This method is NOT intended to be synthesizable to RTL.
+	 *
+	 * @param conduct_mat conductance matrix to stamp
+	 * @param dim dimension of square conductance matrix (width or height)
+	 * @param npos index of positive terminal of component; zero is ground
+	 * @param nneg index of negative terminal of component; zero is ground
+	 *
+	 * @return 0 if successful, -1 if cannot stamp conductance to matrix due to matrix dimension size
+	 */
+	int stampConductance(NumType* conduct_mat, unsigned int dim, unsigned int npos, unsigned int nneg);
+
+	/**
+	 * stamps conductance of component in its present state as triplets of a sparse conductance matrix (Non-Synthesis ONLY)
+	 *
+	 * Same stamp as the dense stampConductance(), for systems too large to store as dense matrices.
+	 *
+	 * @note This method is NOT intended to be synthesizable to RTL.
+	 *
+	 * @param triplets list of conductance triplets to append to
+	 * @param dim dimension of square conductance matrix (width or height)
+	 * @param npos index of positive terminal of component; zero is ground
+	 * @param nneg index of negative terminal of component; zero is ground
+	 *
+	 * @return 0 if successful, -1 if cannot stamp conductance to matrix due to matrix dimension size
+	 */
+	int stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos, unsigned int nneg);
+
+	/**
+	 * does nothing, as the component has no sources
+	 *
+	 * @note This method is NOT intended to be synthesizable to RTL.
+	 */
+	void stampSources(std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg);
+
+	/**
+	 * stamps the conductances of this component into the system (Gx=b)
+	 *
+	 * @note This method is NOT intended to be synthesizable to RTL.
+	 *
+	 * @return 0 if successful, -1 if cannot stamp conductance to matrix due to matrix dimension size
+	 */
+	int stampSystem(NumType* conduct_mat, unsigned int dim, std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg);
+};
+
+} //namespace LBLMC
+
+#endif //RESISTIVESWITCH_HPP
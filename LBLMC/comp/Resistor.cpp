@@ -49,6 +49,15 @@ int Resistor::stampConductance(NumType* conduct_mat, unsigned int dim, unsigned
 	return 0;
 }
 
+int Resistor::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int npos, unsigned int nneg)
+{
+	if( (dim < npos) || (dim < nneg) ) return -1;
+
+	stampBranchConductance(triplets, npos, nneg, conductance);
+
+	return 0;
+}
+
 void Resistor::stampSources(std::vector<unsigned int>& sources, unsigned int npos, unsigned int nneg)
 {
         //does nothing
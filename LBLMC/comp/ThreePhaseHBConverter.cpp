@@ -26,15 +26,24 @@ namespace LBLMC
 {
 
 ThreePhaseHBConverter::ThreePhaseHBConverter(NumType dt, NumType cap, NumType ind, NumType res)
-: dt(dt), cap(cap), ind(ind), res(res), hoc(dt/cap), hol(dt/ind), cap_conduct(10000.0)
+: dt(dt), cap(cap), ind(ind), res(res), hoc(dt/cap), hol(dt/ind), cap_conduct(LMC_HB_CAP_CONDUCT)
   ,vc1(0.0),vc2(0.0),il1(0.0),il2(0.0),il3(0.0),ipos(0.0),ineg(0.0)
   ,epos_past(0.0),eneg_past(0.0),eout1_past(0.0),eout2_past(0.0),eout3_past(0.0)
   ,il1_past(0.0),il2_past(0.0),il3_past(0.0),vc1_past(0.0),vc2_past(0.0)
-  ,sw1(false),sw2(false),sw3(false)
+  ,sw1(false),sw2(false),sw3(false),sw_enabled(true)
 {
 
 }
 
+#ifdef LMC_RUNTIME_TIMESTEP
+void ThreePhaseHBConverter::setTimestep(NumType dt)
+{
+	this->dt = dt;
+	hoc = dt/cap;
+	hol = dt/ind;
+}
+#endif
+
 void ThreePhaseHBConverter::update(NumType epos, NumType eneg, NumType eout1, NumType eout2, NumType eout3,
 		NumType* bpos, NumType* bneg, NumType* bout1, NumType* bout2, NumType* bout3,
 		bool sw_ctrl1, bool sw_ctrl2, bool sw_ctrl3, bool sw_en)
@@ -57,6 +66,7 @@ void ThreePhaseHBConverter::update(NumType epos, NumType eneg, NumType eout1, Nu
 	sw1 = sw_ctrl1;
 	sw2 = sw_ctrl2;
 	sw3 = sw_ctrl3;
+	sw_enabled = sw_en;
 
 		//a, b, c are for inductors, a#, b# are for caps
 	NumType a1, a2, a3, b1, b2, b3, a, b, c;
@@ -175,6 +185,198 @@ void ThreePhaseHBConverter::update(NumType epos, NumType eneg, NumType eout1, Nu
 
 };
 
+void ThreePhaseHBConverter::update(NumType epos, NumType eneg, NumType eout1, NumType eout2, NumType eout3,
+		NumType* bpos, NumType* bneg, NumType* bout1, NumType* bout2, NumType* bout3,
+		bool sw_ctrl1, bool sw_ctrl2, bool sw_ctrl3, bool sw_en,
+		NumType t_sw1, NumType t_sw2, NumType t_sw3)
+{
+	#pragma HLS latency min=0 max=0
+
+	if(!sw_en) //switches are off for the whole step, so there are no switching instants
+	{
+		update(epos, eneg, eout1, eout2, eout3, bpos, bneg, bout1, bout2, bout3,
+				sw_ctrl1, sw_ctrl2, sw_ctrl3, sw_en);
+		return;
+	}
+
+	const bool sw1_prev = sw1;
+	const bool sw2_prev = sw2;
+	const bool sw3_prev = sw3;
+	const bool sw_en_prev = sw_enabled; //if false, the phases conduct through their diodes until they switch
+
+	epos_past = epos;
+	eneg_past = eneg;
+	eout1_past = eout1;
+	eout2_past = eout2;
+	eout3_past = eout3;
+	il1_past = il1;
+	il2_past = il2;
+	il3_past = il3;
+	vc1_past = vc1;
+	vc2_past = vc2;
+	sw1 = sw_ctrl1;
+	sw2 = sw_ctrl2;
+	sw3 = sw_ctrl3;
+	sw_enabled = sw_en;
+
+	ipos = cap_conduct*(NumType(epos_past) - NumType(vc1_past));
+	ineg = cap_conduct*(NumType(eneg_past) - NumType(vc2_past));
+
+		//switching instants clamped to the step, and the sub-interval bounds sorted ascending
+
+	if(t_sw1 < NumType(0.0)) t_sw1 = 0.0;
+	if(t_sw1 > NumType(1.0)) t_sw1 = 1.0;
+	if(t_sw2 < NumType(0.0)) t_sw2 = 0.0;
+	if(t_sw2 > NumType(1.0)) t_sw2 = 1.0;
+	if(t_sw3 < NumType(0.0)) t_sw3 = 0.0;
+	if(t_sw3 > NumType(1.0)) t_sw3 = 1.0;
+
+	NumType bounds[5];
+	bounds[0] = 0.0;
+	bounds[1] = t_sw1;
+	bounds[2] = t_sw2;
+	bounds[3] = t_sw3;
+	bounds[4] = 1.0;
+
+	NumType tmp;
+	if(bounds[1] > bounds[2]) { tmp = bounds[1]; bounds[1] = bounds[2]; bounds[2] = tmp; }
+	if(bounds[2] > bounds[3]) { tmp = bounds[2]; bounds[2] = bounds[3]; bounds[3] = tmp; }
+	if(bounds[1] > bounds[2]) { tmp = bounds[1]; bounds[1] = bounds[2]; bounds[2] = tmp; }
+
+		//a phase has its new state in the sub-intervals starting at or after its switching instant
+
+	for(unsigned int j = 0; j < 4; j++)
+	{
+		#pragma HLS UNROLL
+		const NumType start = bounds[j];
+
+		integrateSegment((t_sw1 <= start) ? sw1 : sw1_prev, (t_sw2 <= start) ? sw2 : sw2_prev,
+				(t_sw3 <= start) ? sw3 : sw3_prev, (t_sw1 <= start) || sw_en_prev,
+				(t_sw2 <= start) || sw_en_prev, (t_sw3 <= start) || sw_en_prev, bounds[j+1] - start);
+	}
+
+	*bpos = (vc1)*cap_conduct;
+	*bneg = (vc2)*cap_conduct;
+	*bout1 = il1;
+	*bout2 = il2;
+	*bout3 = il3;
+}
+
+void ThreePhaseHBConverter::integrateSegment(bool sw_ctrl1, bool sw_ctrl2, bool sw_ctrl3,
+		bool sw_en1, bool sw_en2, bool sw_en3, NumType fraction)
+{
+	#pragma HLS INLINE
+
+	const NumType hoc_seg = hoc*fraction;
+	const NumType hol_seg = hol*fraction;
+
+		//a, b, c are for inductors, a#, b# are for caps; all from the states at the start of the segment
+	NumType a1, a2, a3, b1, b2, b3, a, b, c;
+
+	if(!sw_en1) //switches are off; assume there are anti-parallel diodes on switches
+	{
+		if(il1 > NumType(0.0))
+		{
+			a = vc2;
+			a1 = 0.0;
+			b1 = -il1;
+		}
+		else
+		{
+			if(il1 < NumType(0.0))
+				a = vc1;
+			else
+				a = eout1_past;
+			a1 = il1;
+			b1 = 0.0;
+		}
+	}
+	else if(sw_ctrl1)
+	{
+		a1 = il1;
+		b1 = 0.0;
+		a = vc1;
+	}
+	else
+	{
+		a1 = 0.0;
+		b1 = il1;
+		a = vc2;
+	}
+
+	if(!sw_en2) //switches are off; assume there are anti-parallel diodes on switches
+	{
+		if(il2 > NumType(0.0))
+		{
+			b = vc2;
+			a2 = 0.0;
+			b2 = -il2;
+		}
+		else
+		{
+			if(il2 < NumType(0.0))
+				b = vc1;
+			else
+				b = eout2_past;
+			a2 = il2;
+			b2 = 0.0;
+		}
+	}
+	else if(sw_ctrl2)
+	{
+		a2 = il2;
+		b2 = 0.0;
+		b = vc1;
+	}
+	else
+	{
+		a2 = 0.0;
+		b2 = il2;
+		b = vc2;
+	}
+
+	if(!sw_en3) //switches are off; assume there are anti-parallel diodes on switches
+	{
+		if(il3 > NumType(0.0))
+		{
+			c = vc2;
+			a3 = 0.0;
+			b3 = -il3;
+		}
+		else
+		{
+			if(il3 < NumType(0.0))
+				c = vc1;
+			else
+				c = eout3_past;
+			a3 = il3;
+			b3 = 0.0;
+		}
+	}
+	else if(sw_ctrl3)
+	{
+		a3 = il3;
+		b3 = 0.0;
+		c = vc1;
+	}
+	else
+	{
+		a3 = 0.0;
+		b3 = il3;
+		c = vc2;
+	}
+
+	const NumType vc1_next = hoc_seg*(NumType(ipos) - a1 - a2 - a3) + NumType(vc1);
+	const NumType vc2_next = hoc_seg*(NumType(ineg) - b1 - b2 - b3) + NumType(vc2);
+
+	il1 = NumType(il1) + hol_seg*( a - NumType(eout1_past) - res*(il1));
+	il2 = NumType(il2) + hol_seg*( b - NumType(eout2_past) - res*(il2));
+	il3 = NumType(il3) + hol_seg*( c - NumType(eout3_past) - res*(il3));
+
+	vc1 = vc1_next;
+	vc2 = vc2_next;
+}
+
 void ThreePhaseHBConverter::measureInductorCurrents(NumType* current1, NumType* current2, NumType* current3)
 {
 	*current1 = il1;
@@ -202,6 +404,20 @@ int ThreePhaseHBConverter::stampConductance(NumType* conduct_mat, unsigned int d
 	return 0;
 }
 
+int ThreePhaseHBConverter::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim,
+		unsigned int np, unsigned int nn, unsigned int na, unsigned int nb, unsigned int nc)
+{
+	if( (dim < np) || (dim < nn) || (dim < na) || (dim < nb) || (dim < nc)) return -1;
+	if( (np==nn)&&(np==na)&&(np==nb)&&(np==nc) ) return 0; //component is shorted out on all terminals
+
+	if(np != 0) triplets.push_back(ConductanceTriplet(np-1, np-1, cap_conduct));
+	if(nn != 0) triplets.push_back(ConductanceTriplet(nn-1, nn-1, cap_conduct));
+
+	// no conductances for na,nb,nc, so nothing to do for them!
+
+	return 0;
+}
+
 void ThreePhaseHBConverter::stampSources(std::vector<unsigned int>& sources,
                                          unsigned int np, unsigned int nn, unsigned int na,
                                          unsigned int nb, unsigned int nc)
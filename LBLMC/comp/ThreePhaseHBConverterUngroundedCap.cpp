@@ -26,7 +26,7 @@ namespace LBLMC
 {
 
 ThreePhaseHBConverterUngroundedCap::ThreePhaseHBConverterUngroundedCap(NumType dt, NumType cap, NumType ind, NumType res)
-: dt(dt), cap(cap), ind(ind), res(res), hoc(dt/cap), hol(dt/ind), cap_conduct(10000.0)
+: dt(dt), cap(cap), ind(ind), res(res), hoc(dt/cap), hol(dt/ind), cap_conduct(LMC_HB_CAP_CONDUCT)
   ,vc1(0.0),vc2(0.0),il1(0.0),il2(0.0),il3(0.0),ipos(0.0),ineg(0.0)
   ,epos_past(0.0),eneu_past(0.0),eneg_past(0.0),eout1_past(0.0),eout2_past(0.0),eout3_past(0.0)
   ,il1_past(0.0),il2_past(0.0),il3_past(0.0),vc1_past(0.0),vc2_past(0.0)
@@ -35,6 +35,15 @@ ThreePhaseHBConverterUngroundedCap::ThreePhaseHBConverterUngroundedCap(NumType d
 
 }
 
+#ifdef LMC_RUNTIME_TIMESTEP
+void ThreePhaseHBConverterUngroundedCap::setTimestep(NumType dt)
+{
+	this->dt = dt;
+	hoc = dt/cap;
+	hol = dt/ind;
+}
+#endif
+
 void ThreePhaseHBConverterUngroundedCap::update(NumType epos, NumType eneu, NumType eneg, NumType eout1, NumType eout2, NumType eout3,
 			NumType* bpos, NumType* bneu, NumType* bneg, NumType* bout1, NumType* bout2, NumType* bout3,
 			bool sw_ctrl1, bool sw_ctrl2, bool sw_ctrl3, bool sw_en)
@@ -243,6 +252,19 @@ int ThreePhaseHBConverterUngroundedCap::stampConductance(NumType* conduct_mat, u
 	return 0;
 }
 
+int ThreePhaseHBConverterUngroundedCap::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim,
+		unsigned int np, unsigned int nu, unsigned int nn, unsigned int na, unsigned int nb, unsigned int nc)
+{
+	if( (dim < np) || (dim < nu) || (dim < nn) || (dim < na) || (dim < nb) || (dim < nc)) return -1;
+
+	stampBranchConductance(triplets, np, nu, cap_conduct);
+	stampBranchConductance(triplets, nn, nu, cap_conduct);
+
+	// no conductances for na,nb,nc, so nothing to do for them!
+
+	return 0;
+}
+
 void ThreePhaseHBConverterUngroundedCap::stampSources(std::vector<unsigned int>& sources,
                                          unsigned int np, unsigned int nu, unsigned int nn,
                                          unsigned int na, unsigned int nb, unsigned int nc)
@@ -27,6 +27,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #include <vector>
 
 #include "LBLMC/DataTypes.hpp"
+#include "LBLMC/comp/ConductanceTriplet.hpp"
 
 namespace LBLMC
 {
@@ -42,13 +43,13 @@ class ThreePhaseHBConverterUngroundedCap
 {
 private:
 
-	 const NumType dt;
+	 LMC_TIMESTEP_CONST NumType dt;
 	 const NumType cap;
 	 const NumType ind;
 	 const NumType res;
 
-	const NumType hoc;
-	const NumType hol;
+	LMC_TIMESTEP_CONST NumType hoc;
+	LMC_TIMESTEP_CONST NumType hol;
 	const NumType cap_conduct;
 
 
@@ -82,6 +83,19 @@ public:
 
 	ThreePhaseHBConverterUngroundedCap(NumType dt, NumType cap, NumType ind, NumType res);
 
+#ifdef LMC_RUNTIME_TIMESTEP
+	/**
+	 * changes the simulation time step of the component at runtime
+	 *
+	 * The capacitor and inductor states are integrated with Euler Forward and the stamped conductance
+	 * does not depend on the time step, so only the internal constants change; the converter continues
+	 * from its present state.
+	 *
+	 * @param dt new simulation time step
+	 */
+	void setTimestep(NumType dt);
+#endif
+
 	/**
 	 * \brief top-level function for this model
 	 *
@@ -156,6 +170,27 @@ public:
 			unsigned int nc
 			);
 
+	/**
+	 * stamps conductance of component as triplets of a sparse conductance matrix (Non-Synthesis ONLY)
+	 *
+	 * Same stamp as the dense stampConductance(), for systems too large to store as dense matrices.
+	 *
+	 * @note This method is NOT intended to be synthesizable to RTL.
+	 *
+	 * @param triplets list of conductance triplets to append to
+	 * @param dim dimension of square conductance matrix (width or height)
+	 * \param np index of positive DC side terminal of component; zero is ground
+	 * \param nu index of neutral DC side terminal of component; zero is ground/common
+	 * \param nn index of negative DC side terminal of component; zero is ground
+	 * \param na index of phase a (out1) terminal of component; zero is ground
+	 * \param nb index of phase b (out2) terminal of component; zero is ground
+	 * \param nc index of phase c (out3) terminal of component; zero is ground
+	 *
+	 * @return 0 if successful, -1 if cannot stamp conductance to matrix due to matrix dimension size
+	 */
+	int stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim,
+			unsigned int np, unsigned int nu, unsigned int nn, unsigned int na, unsigned int nb, unsigned int nc);
+
     /**
         @brief stamps the nodes of source(s) of this component into a vector that can be used to
         construct equations for the system source vector b (out of Gx=b).
@@ -26,13 +26,22 @@ namespace LBLMC
 {
 
 TwoPhaseHBConverter::TwoPhaseHBConverter(NumType dt, NumType cap, NumType ind, NumType res)
-: dt(dt), cap(cap), ind(ind), res(res), hoc(dt/cap), hol(dt/ind), cap_conduct(10000.0)
+: dt(dt), cap(cap), ind(ind), res(res), hoc(dt/cap), hol(dt/ind), cap_conduct(LMC_HB_CAP_CONDUCT)
   ,vc1(0.0),vc2(0.0),il1(0.0),il2(0.0),ipos(0.0),ineg(0.0)
   ,epos_past(0.0),eneg_past(0.0),eout1_past(0.0),eout2_past(0.0)
   ,il1_past(0.0),il2_past(0.0),vc1_past(0.0),vc2_past(0.0)
   ,sw1(false),sw2(false)
 {}
 
+#ifdef LMC_RUNTIME_TIMESTEP
+void TwoPhaseHBConverter::setTimestep(NumType dt)
+{
+	this->dt = dt;
+	hoc = dt/cap;
+	hol = dt/ind;
+}
+#endif
+
 void TwoPhaseHBConverter::update(NumType epos, NumType eneg, NumType eout1, NumType eout2,
 		NumType* bpos, NumType* bneg, NumType* bout1, NumType* bout2,
 		bool sw_ctrl1, bool sw_ctrl2)
@@ -57,6 +66,54 @@ void TwoPhaseHBConverter::update(NumType epos, NumType eneg, NumType eout1, NumT
 	updateBElements(bpos, bneg, bout1, bout2);
 };
 
+void TwoPhaseHBConverter::update(NumType epos, NumType eneg, NumType eout1, NumType eout2,
+		NumType* bpos, NumType* bneg, NumType* bout1, NumType* bout2,
+		bool sw_ctrl1, bool sw_ctrl2, NumType t_sw1, NumType t_sw2)
+{
+	#pragma HLS latency min=0 max=0
+
+	const bool sw1_prev = sw1;
+	const bool sw2_prev = sw2;
+
+	epos_past = epos;
+	eneg_past = eneg;
+	eout1_past = eout1;
+	eout2_past = eout2;
+	il1_past = il1;
+	il2_past = il2;
+	vc1_past = vc1;
+	vc2_past = vc2;
+	sw1 = sw_ctrl1;
+	sw2 = sw_ctrl2;
+
+	updateIPosNeg(epos, eneg);
+
+		//switching instants clamped to the step, and the sub-interval bounds in ascending order
+
+	if(t_sw1 < NumType(0.0)) t_sw1 = 0.0;
+	if(t_sw1 > NumType(1.0)) t_sw1 = 1.0;
+	if(t_sw2 < NumType(0.0)) t_sw2 = 0.0;
+	if(t_sw2 > NumType(1.0)) t_sw2 = 1.0;
+
+	NumType bounds[4];
+	bounds[0] = 0.0;
+	bounds[1] = (t_sw1 < t_sw2) ? t_sw1 : t_sw2;
+	bounds[2] = (t_sw1 < t_sw2) ? t_sw2 : t_sw1;
+	bounds[3] = 1.0;
+
+		//a phase has its new state in the sub-intervals starting at or after its switching instant
+
+	for(unsigned int j = 0; j < 3; j++)
+	{
+		#pragma HLS UNROLL
+		const NumType start = bounds[j];
+
+		integrateSegment((t_sw1 <= start) ? sw1 : sw1_prev, (t_sw2 <= start) ? sw2 : sw2_prev, bounds[j+1] - start);
+	}
+
+	updateBElements(bpos, bneg, bout1, bout2);
+}
+
 int TwoPhaseHBConverter::stampConductance(NumType* conduct_mat, unsigned int dim,
 		unsigned int np, unsigned int nn, unsigned int na, unsigned int nb)
 {
@@ -71,6 +128,20 @@ int TwoPhaseHBConverter::stampConductance(NumType* conduct_mat, unsigned int dim
 	return 0;
 }
 
+int TwoPhaseHBConverter::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim,
+		unsigned int np, unsigned int nn, unsigned int na, unsigned int nb)
+{
+	if( (dim < np) || (dim < nn) || (dim < na) || (dim < nb)) return -1;
+	if( (np==nn)&&(np==na)&&(np==nb) ) return 0; //component is shorted out on all terminals
+
+	if(np != 0) triplets.push_back(ConductanceTriplet(np-1, np-1, cap_conduct));
+	if(nn != 0) triplets.push_back(ConductanceTriplet(nn-1, nn-1, cap_conduct));
+
+	// no conductances for na,nb, so nothing to do for them!
+
+	return 0;
+}
+
 void TwoPhaseHBConverter::updateVC(bool sw_ctrl1, bool sw_ctrl2)
 {
 	#pragma HLS INLINE
@@ -158,4 +229,50 @@ void TwoPhaseHBConverter::updateBElements(NumType* bpos, NumType* bneg, NumType*
 	*bout2 = il2;
 }
 
+void TwoPhaseHBConverter::integrateSegment(bool sw_ctrl1, bool sw_ctrl2, NumType fraction)
+{
+	#pragma HLS INLINE
+
+	const NumType hoc_seg = hoc*fraction;
+	const NumType hol_seg = hol*fraction;
+
+		//a#, b# are for caps, a, b are for inductors; all from the states at the start of the segment
+	AddSubType a1, a2, b1, b2, a, b;
+
+	if(sw_ctrl1)
+	{
+		a1 = il1;
+		b1 = 0.0;
+		a = vc1;
+	}
+	else
+	{
+		a1 = 0.0;
+		b1 = il1;
+		a = vc2;
+	}
+
+	if(sw_ctrl2)
+	{
+		a2 = il2;
+		b2 = 0.0;
+		b = vc1;
+	}
+	else
+	{
+		a2 = 0.0;
+		b2 = il2;
+		b = vc2;
+	}
+
+	const AddSubType vc1_next = hoc_seg*(AddSubType(ipos) - a1 - a2) + AddSubType(vc1);
+	const AddSubType vc2_next = hoc_seg*(AddSubType(ineg) - b1 - b2) + AddSubType(vc2);
+
+	il1 = AddSubType(il1) + hol_seg*( a - AddSubType(eout1_past) - res*(il1));
+	il2 = AddSubType(il2) + hol_seg*( b - AddSubType(eout2_past) - res*(il2));
+
+	vc1 = vc1_next;
+	vc2 = vc2_next;
+}
+
 } //namespace LBLMC
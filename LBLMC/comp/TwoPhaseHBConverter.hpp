@@ -25,6 +25,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 
 #include "LBLMC/Params.hpp"
 #include "LBLMC/DataTypes.hpp"
+#include "LBLMC/comp/ConductanceTriplet.hpp"
 
 namespace LBLMC
 {
@@ -41,13 +42,13 @@ class TwoPhaseHBConverter
 {
 private:
 
-	 const NumType dt;
+	 LMC_TIMESTEP_CONST NumType dt;
 	 const NumType cap;
 	 const NumType ind;
 	 const NumType res;
 
-	const NumType hoc;
-	const NumType hol;
+	LMC_TIMESTEP_CONST NumType hoc;
+	LMC_TIMESTEP_CONST NumType hol;
 	const NumType cap_conduct;
 
 
@@ -76,6 +77,19 @@ public:
 
 	TwoPhaseHBConverter(NumType dt, NumType cap, NumType ind, NumType res);
 
+#ifdef LMC_RUNTIME_TIMESTEP
+	/**
+	 * changes the simulation time step of the component at runtime
+	 *
+	 * The capacitor and inductor states are integrated with Euler Forward and the stamped conductance
+	 * does not depend on the time step, so only the internal constants change; the converter continues
+	 * from its present state.
+	 *
+	 * @param dt new simulation time step
+	 */
+	void setTimestep(NumType dt);
+#endif
+
 	/**
 	 * @brief top-level function for this model
 	 *
@@ -94,6 +108,36 @@ public:
 			NumType* bpos, NumType* bneg, NumType* bout1, NumType* bout2,
 			bool sw_ctrl1, bool sw_ctrl2);
 
+	/**
+	 * @brief top-level function for this model, with switching instants within the time step
+	 *
+	 * Each phase switches from its state of the last update to its new control signal at a fractional
+	 * instant of the step, from 0 (start of the step) to 1 (end of the step).  The step is split at
+	 * the switching instants, and the capacitor and inductor states are integrated piecewise over the
+	 * sub-intervals with the switch states of each, so PWM edges between step boundaries are resolved
+	 * without shortening the time step.  The instants can come from an event time, or from a carrier
+	 * comparison: with d0 and d1 the reference minus carrier at the start and end of the step, the
+	 * crossing is at d0/(d0-d1).
+	 *
+	 * With both instants 0, this is the same as update() without switching instants.
+	 *
+	 * @param epos in : DC positive voltage input
+	 * @param eneg in : DC negative voltage input
+	 * @param eout1 in : AC phase 1 voltage output
+	 * @param eout2 in : AC phase 2 voltage output
+	 * @param bpos out : DC positive b source current
+	 * @param bneg out : DC negative b source current
+	 * @param bout1 out : AC phase 1 b source current
+	 * @param bout2 out : AC phase 2 b source current
+	 * @param sw_ctrl1 in : phase 1 Switch Control signal
+	 * @param sw_ctrl2 in : phase 2 Switch Control signal
+	 * @param t_sw1 in : phase 1 switching instant as a fraction of the time step; clamped to 0 to 1
+	 * @param t_sw2 in : phase 2 switching instant as a fraction of the time step; clamped to 0 to 1
+	 */
+	void update(NumType epos, NumType eneg, NumType eout1, NumType eout2,
+			NumType* bpos, NumType* bneg, NumType* bout1, NumType* bout2,
+			bool sw_ctrl1, bool sw_ctrl2, NumType t_sw1, NumType t_sw2);
+
 	/**
 	 * stamps conductance of component into given conductance matrix (Non-Synthesis ONLY)
 	 *
@@ -113,6 +157,25 @@ public:
 	int stampConductance(NumType* conduct_mat, unsigned int dim,
 			unsigned int np, unsigned int nn, unsigned int na, unsigned int nb);
 
+	/**
+	 * stamps conductance of component as triplets of a sparse conductance matrix (Non-Synthesis ONLY)
+	 *
+	 * Same stamp as the dense stampConductance(), for systems too large to store as dense matrices.
+	 *
+	 * @note This method is NOT intended to be synthesizable to RTL.
+	 *
+	 * @param triplets list of conductance triplets to append to
+	 * @param dim dimension of square conductance matrix (width or height)
+	 * @param np index of positive DC side terminal of component; zero is ground
+	 * @param nn index of negative DC side terminal of component; zero is ground
+	 * @param na index of phase a (out1) terminal of component; zero is ground
+	 * @param nb index of phase b (out2) terminal of component; zero is ground
+	 *
+	 * @return 0 if successful, -1 if cannot stamp conductance to matrix due to matrix dimension size
+	 */
+	int stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim,
+			unsigned int np, unsigned int nn, unsigned int na, unsigned int nb);
+
 private:
 
 	void updateVC(bool sw_ctrl1, bool sw_ctrl2);
@@ -123,6 +186,9 @@ private:
 
 	void updateBElements(NumType* bpos, NumType* bneg, NumType* bout1, NumType* bout2);
 
+		/// integrates the capacitor and inductor states over a fraction of the time step with fixed switch states
+	void integrateSegment(bool sw_ctrl1, bool sw_ctrl2, NumType fraction);
+
 };
 
 } //namespace LBLMC
@@ -64,4 +64,37 @@ int TwoPortTransconductor::stampConductance(NumType* conduct_mat, unsigned int d
 	return 0;
 }
 
+int TwoPortTransconductor::stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int m, unsigned int n,
+			unsigned int p, unsigned int q)
+{
+	if( (dim < m) || (dim < n) || (dim < p) || (dim < q) ) return -1;
+	if( (m == n) && (m == p) && (m == q) ) return 0; //component ports are shorted out, so do nothing
+
+	if( (m != 0) && (p != 0) )
+	{
+		triplets.push_back(ConductanceTriplet(m-1, p-1, transconductance12));
+		triplets.push_back(ConductanceTriplet(p-1, m-1, transconductance21));
+	}
+
+	if( (m != 0) && (q != 0) )
+	{
+		triplets.push_back(ConductanceTriplet(m-1, q-1, -transconductance12));
+		triplets.push_back(ConductanceTriplet(q-1, m-1, -transconductance21));
+	}
+
+	if( (n != 0) && (p != 0) )
+	{
+		triplets.push_back(ConductanceTriplet(n-1, p-1, -transconductance12));
+		triplets.push_back(ConductanceTriplet(p-1, n-1, -transconductance21));
+	}
+
+	if( (n != 0) && (q != 0) )
+	{
+		triplets.push_back(ConductanceTriplet(n-1, q-1, transconductance12));
+		triplets.push_back(ConductanceTriplet(q-1, n-1, transconductance21));
+	}
+
+	return 0;
+}
+
 } //namespace LBLMC
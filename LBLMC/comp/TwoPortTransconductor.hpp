@@ -24,6 +24,7 @@ along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses
 #define TWOPORTTRANSCONDUCTOR_HPP
 
 #include "LBLMC/DataTypes.hpp"
+#include "LBLMC/comp/ConductanceTriplet.hpp"
 
 namespace LBLMC
 {
@@ -82,6 +83,25 @@ public:
 	 */
 	int stampConductance(NumType* conduct_mat, unsigned int dim, unsigned int port1a, unsigned int port1b,
 			unsigned int port2a, unsigned int port2b);
+
+	/**
+	 * stamps conductance of component as triplets of a sparse conductance matrix (Non-Synthesis ONLY)
+	 *
+	 * Same stamp as the dense stampConductance(), for systems too large to store as dense matrices.
+	 *
+	 * @note This method is NOT intended to be synthesizable to RTL.
+	 *
+	 * @param triplets list of conductance triplets to append to
+	 * @param dim dimension of square conductance matrix (width or height)
+	 * @param port1a index of (a) positive terminal of port 1 of component; zero is ground
+	 * @param port1b index of (b) negative terminal of port 1 of component; zero is ground
+	 * @param port2a index of (a) positive terminal of port 2 of component; zero is ground
+	 * @param port2b index of (b) negative terminal of port 2 of component; zero is ground
+	 *
+	 * @return 0 if successful, -1 if cannot stamp conductance to matrix due to matrix dimension size
+	 */
+	int stampConductance(std::vector<ConductanceTriplet>& triplets, unsigned int dim, unsigned int port1a, unsigned int port1b,
+			unsigned int port2a, unsigned int port2b);
 };
 
 } //namespace LBLMC
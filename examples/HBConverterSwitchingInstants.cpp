@@ -0,0 +1,218 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+
+/*
+ * Half-bridge converter switching instant accuracy check
+ *
+ * Drives a ThreePhaseHBConverter with 10 kHz sine-triangle PWM into shorted outputs and compares the
+ * phase 1 inductor current against a 5 ns reference run, for time steps of 100 ns to 1 us, with the
+ * switches taking their new state at step boundaries (update()) and at the carrier crossings within
+ * the step (update() with switching instants).  The relative RMS error is taken over the second half
+ * of the 20 ms run.
+ *
+ * Also checks that the switching instant update is identical to update() when all instants are 0,
+ * including around steps with the switches disabled, and that after a disabled step the phases
+ * conduct through their diodes until their switching instants.
+ */
+
+// Build from the repository root:
+//
+// 	g++ -O2 -I. examples/HBConverterSwitchingInstants.cpp LBLMC/comp/*.cpp
+
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include "LBLMC/comp/ThreePhaseHBConverter.hpp"
+
+using namespace LBLMC;
+
+static const double pi = 3.14159265358979323846;
+static const double carrier_freq = 10e3;
+static const double run_time = 20e-3;
+
+	/// triangle carrier from 0 to 1
+static double carrier(double t)
+{
+	double x = t*carrier_freq;
+	x -= std::floor(x);
+	return (x < 0.5) ? 2.0*x : 2.0 - 2.0*x;
+}
+
+	/// 50 Hz modulation reference of phase k
+static double reference(unsigned int k, double t)
+{
+	return 0.5 + 0.4*std::sin(2.0*pi*50.0*t - k*2.0*pi/3.0);
+}
+
+	/// runs the converter for run_time with time step dt and stores the phase 1 current of each step
+static void run(double dt, bool use_instants, std::vector<double>& current)
+{
+	ThreePhaseHBConverter converter(dt, 5e-2, 1e-3, 1.0);
+	NumType b[5];
+
+	const unsigned int steps = (unsigned int)(run_time/dt + 0.5);
+	current.resize(steps);
+
+	for(unsigned int i = 0; i < steps; i++)
+	{
+		const double t0 = i*dt;
+		const double t1 = (i+1)*dt;
+
+		bool sw[3];
+		NumType t_sw[3];
+
+		for(unsigned int k = 0; k < 3; k++)
+		{
+			const double d0 = reference(k, t0) - carrier(t0);
+			const double d1 = reference(k, t1) - carrier(t1);
+
+			sw[k] = (d1 > 0.0);
+			t_sw[k] = ((d0 > 0.0) != (d1 > 0.0)) ? d0/(d0 - d1) : 0.0;
+		}
+
+		if(use_instants)
+		{
+			converter.update(400.0, -400.0, 0.0, 0.0, 0.0, &b[0], &b[1], &b[2], &b[3], &b[4],
+					sw[0], sw[1], sw[2], true, t_sw[0], t_sw[1], t_sw[2]);
+		}
+		else
+		{
+			converter.update(400.0, -400.0, 0.0, 0.0, 0.0, &b[0], &b[1], &b[2], &b[3], &b[4],
+					sw[0], sw[1], sw[2], true);
+		}
+
+		NumType i1, i2, i3;
+		converter.measureInductorCurrents(&i1, &i2, &i3);
+		current[i] = i1;
+	}
+}
+
+	/// relative RMS error of a run against the reference over the second half of the run
+static double error(const std::vector<double>& current, const std::vector<double>& reference_current, double dt, double reference_dt)
+{
+	const unsigned int stride = (unsigned int)(dt/reference_dt + 0.5);
+
+	double error_sum = 0.0;
+	double reference_sum = 0.0;
+
+	for(unsigned int i = current.size()/2; i < current.size(); i++)
+	{
+		const double r = reference_current[(i+1)*stride - 1];
+		error_sum += (current[i] - r)*(current[i] - r);
+		reference_sum += r*r;
+	}
+
+	return std::sqrt(error_sum/reference_sum);
+}
+
+int main()
+{
+	bool passed = true;
+
+		//switching instants of 0 are the same as update(), also with dead band steps
+
+	{
+		ThreePhaseHBConverter plain(1e-6, 5e-2, 1e-3, 1.0);
+		ThreePhaseHBConverter instants(plain);
+		NumType b[5], c[5];
+		bool same = true;
+
+		for(unsigned int i = 0; i < 5000; i++)
+		{
+			const bool sw1 = (i/7)%2, sw2 = (i/11)%2, sw3 = (i/13)%2;
+			const bool sw_en = (i%17) > 2;
+
+			plain.update(400.0, -400.0, 10.0, -5.0, 3.0, &b[0], &b[1], &b[2], &b[3], &b[4], sw1, sw2, sw3, sw_en);
+			instants.update(400.0, -400.0, 10.0, -5.0, 3.0, &c[0], &c[1], &c[2], &c[3], &c[4], sw1, sw2, sw3, sw_en, 0.0, 0.0, 0.0);
+
+			for(unsigned int k = 0; k < 5; k++) same = same && (b[k] == c[k]);
+		}
+
+		std::printf("zero switching instants identical to update(): %s\n", same ? "yes" : "no");
+		passed = passed && same;
+	}
+
+		//after a step with the switches disabled, a phase conducts through its diodes until its
+		//switching instant, so instants of 1 are the same as another disabled step
+
+	{
+		ThreePhaseHBConverter plain(1e-6, 5e-2, 1e-3, 1.0);
+		ThreePhaseHBConverter instants(plain);
+		NumType b[5], c[5];
+		bool same = true;
+
+		for(unsigned int i = 0; i < 5000; i++)
+		{
+			const bool sw1 = (i/7)%2, sw2 = (i/11)%2, sw3 = (i/13)%2;
+			const double v = 100.0*std::sin(2.0*pi*50.0*i*1e-6);
+
+			plain.update(400.0, -400.0, v, -v, 0.5*v, &b[0], &b[1], &b[2], &b[3], &b[4], sw1, sw2, sw3, false);
+
+			if(i%2 == 0)
+				instants.update(400.0, -400.0, v, -v, 0.5*v, &c[0], &c[1], &c[2], &c[3], &c[4], sw1, sw2, sw3, false);
+			else
+				instants.update(400.0, -400.0, v, -v, 0.5*v, &c[0], &c[1], &c[2], &c[3], &c[4], sw1, sw2, sw3, true, 1.0, 1.0, 1.0);
+
+			for(unsigned int k = 0; k < 5; k++) same = same && (b[k] == c[k]);
+		}
+
+		std::printf("diode conduction until switching instants after disabled steps: %s\n", same ? "yes" : "no");
+		passed = passed && same;
+	}
+
+		//PWM accuracy against a 5 ns reference
+
+	const double reference_dt = 5e-9;
+	std::vector<double> reference_current;
+	run(reference_dt, false, reference_current);
+
+	const double dts[] = {1e-7, 2.5e-7, 5e-7, 1e-6};
+	double plain_error_100ns = 0.0;
+	double instants_error_1us = 0.0;
+
+	for(unsigned int j = 0; j < sizeof(dts)/sizeof(dts[0]); j++)
+	{
+		std::vector<double> plain_current, instants_current;
+		run(dts[j], false, plain_current);
+		run(dts[j], true, instants_current);
+
+		const double plain_error = error(plain_current, reference_current, dts[j], reference_dt);
+		const double instants_error = error(instants_current, reference_current, dts[j], reference_dt);
+
+		std::printf("dt = %6.1f ns: relative RMS error at step boundaries %.3e, at switching instants %.3e\n",
+				dts[j]*1e9, plain_error, instants_error);
+
+		if(j == 0) plain_error_100ns = plain_error;
+		if(j == sizeof(dts)/sizeof(dts[0]) - 1) instants_error_1us = instants_error;
+
+		passed = passed && (instants_error < plain_error);
+	}
+
+		//switching instants at 1 us should be at least as accurate as step boundaries at 100 ns
+
+	passed = passed && (instants_error_1us <= plain_error_100ns);
+
+	std::printf("%s\n", passed ? "passed" : "FAILED");
+
+	return passed ? 0 : 1;
+}
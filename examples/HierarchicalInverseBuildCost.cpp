@@ -0,0 +1,94 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+
+/*
+ * HierarchicalInverse sparse build cost check
+ *
+ * Builds the hierarchical inverse of square RLC meshes of 400 to 3600 nodes from their sparse
+ * conductance matrices, and reports the sparse solves the build used, the compression and the
+ * estimated error.  Checks that the number of solves grows linearly with the number of nodes
+ * (solves <= max_solves_per_node * N), and that the estimated error is within the tolerance.
+ */
+
+// Build from the repository root:
+//
+// 	g++ -O2 -I. -I/usr/include/eigen3 examples/HierarchicalInverseBuildCost.cpp LBLMC/codegen/*.cpp LBLMC/comp/*.cpp -lpthread
+
+#include <cstdio>
+#include <ctime>
+#include "LBLMC/codegen/CodeGen.hpp"
+
+using namespace LBLMC;
+
+static const double max_solves_per_node = 3.0;
+
+int main()
+{
+	const unsigned int widths[] = {20, 40, 60};
+	const double dt = 1e-6;
+	const double tolerance = 1e-8;
+
+	bool passed = true;
+
+	std::printf("%8s %10s %10s %10s %12s %12s\n", "N", "build [s]", "solves", "solves/N", "compression", "error");
+
+	for(unsigned int w = 0; w < sizeof(widths)/sizeof(widths[0]); w++)
+	{
+		const unsigned int W = widths[w];
+		const unsigned int N = W*W;
+
+			//resistors along rows, inductors along columns, capacitors to ground
+
+		SystemNetlist netlist(N);
+		for(unsigned int y = 0; y < W; y++)
+		{
+			for(unsigned int x = 0; x < W; x++)
+			{
+				const unsigned int n = y*W + x + 1;
+				if(x+1 < W) netlist.addResistor("r", n, n+1, 1.0);
+				if(y+1 < W) netlist.addInductor("l", n, n+W, 1e-3);
+				netlist.addCapacitor("c", n, 0, 1e-6);
+			}
+		}
+
+		SparseSystemConductance conductance(N);
+		SystemSourceVector sources(N);
+		netlist.stampSystem(dt, conductance, sources);
+
+		const std::clock_t start = std::clock();
+		HierarchicalInverse inverse(conductance, tolerance);
+		const double seconds = double(std::clock() - start)/CLOCKS_PER_SEC;
+
+		const double solves_per_node = double(inverse.getNumSolves())/N;
+
+		std::printf("%8u %10.2f %10lu %10.2f %12.4f %12.3e\n", N, seconds, inverse.getNumSolves(), solves_per_node,
+				inverse.getCompressionRatio(), inverse.getEstimatedError());
+
+		passed = passed && (solves_per_node <= max_solves_per_node);
+		passed = passed && (inverse.getEstimatedError() <= tolerance);
+	}
+
+	std::printf("%s\n", passed ? "passed" : "FAILED");
+
+	return passed ? 0 : 1;
+}
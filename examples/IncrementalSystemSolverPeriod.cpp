@@ -0,0 +1,119 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+/*
+ * IncrementalSystemSolver full re-solve period check
+ *
+ * Runs an IncrementalSystemSolver against the SystemSolver it is built from for several full
+ * re-solve periods, including 1 (every step is a full solve), and checks that a full solve happens
+ * every full_solve_period steps and that the solutions agree.
+ */
+
+// Build from the repository root:
+//
+// 	g++ -O2 -I. -I/usr/include/eigen3 examples/IncrementalSystemSolverPeriod.cpp LBLMC/codegen/*.cpp LBLMC/comp/*.cpp -lpthread
+
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include "LBLMC/codegen/CodeGen.hpp"
+
+using namespace LBLMC;
+
+int main()
+{
+	const unsigned int W = 4;
+	const unsigned int N = W*W;
+	const unsigned int num_steps = 100;
+	const NumType dt = 50.0e-9;
+
+	SystemNetlist netlist(N);
+	for(unsigned int y = 0; y < W; y++)
+	{
+		for(unsigned int x = 0; x < W; x++)
+		{
+			const unsigned int n = y*W + x + 1;
+			if(x+1 < W) netlist.addResistor("r", n, n+1, 1.0);
+			if(y+1 < W) netlist.addInductor("l", n, n+W, 1.0e-3);
+			netlist.addCapacitor("c", n, 0, 1.0e-6);
+		}
+	}
+	netlist.addDCVoltageSource("vs", 1, 0, 400.0, 0.01);
+
+	SystemConductance conductance(N);
+	SystemSourceVector sources(N);
+	if(netlist.stampSystem(dt, conductance, sources))
+	{
+		std::printf("cannot stamp netlist\n");
+		return 1;
+	}
+	conductance.invertSelf();
+
+	std::vector<NumType> A(conductance.asPointer(), conductance.asPointer() + N*N);
+	SystemSolver solver(&A[0], N, sources);
+
+	const unsigned int periods[] = {1, 2, 3, 7, 1000, 0};
+	const unsigned int num_periods = sizeof(periods)/sizeof(periods[0]);
+
+	std::vector<NumType> b_components(sources.getNumSources(), NumType(0.0));
+	std::vector<NumType> x_ref(N), x_inc(N);
+
+	int failures = 0;
+
+	std::printf("period  full solves  expected  max |x - x_ref|\n");
+
+	for(unsigned int p = 0; p < num_periods; p++)
+	{
+		IncrementalSystemSolver incremental(solver, 0.0, periods[p]);
+
+		double max_error = 0.0;
+
+		for(unsigned int k = 0; k < num_steps; k++)
+		{
+			for(unsigned int j = 0; j < b_components.size(); j++)
+			{
+				b_components[j] = NumType(std::sin(0.01*double(k*(j+1))));
+			}
+
+			solver.solve(&b_components[0], &x_ref[0]);
+			incremental.solve(&b_components[0], &x_inc[0]);
+
+			for(unsigned int r = 0; r < N; r++)
+			{
+				max_error = std::max(max_error, std::fabs(double(x_inc[r]) - double(x_ref[r])));
+			}
+		}
+
+			//full solves at steps 1, 1+period, 1+2*period, ...; only the first if never re-solving
+		const unsigned long expected = (periods[p] == 0) ? 1 : (num_steps + periods[p] - 1)/periods[p];
+		const unsigned long full_solves = incremental.getNumFullSolves();
+
+		std::printf("%6u  %11lu  %8lu  %.3e\n", periods[p], full_solves, expected, max_error);
+
+		if(full_solves != expected || max_error > 1.0e-9) failures++;
+	}
+
+	std::printf("%s\n", failures ? "FAILED" : "passed");
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+/*
+
+Copyright (C) 2019 Matthew Milton
+
+This file is part of the LB-LMC Solver C++ Library.
+
+LB-LMC Solver C++ Library is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+LB-LMC Solver C++ Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with LB-LMC Solver C++ Library.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+
+
+
+/*
+ * Runtime time step selection check of SystemStepGenerator
+ *
+ * Generates the fused step function of a 100 V R/L/C and three-phase half-bridge converter netlist
+ * for the time steps 0.5, 1 and 2 us, and runs it with dt_sel changing every few steps against the
+ * runtime reference: TimestepBank::getSolver() of the selected time step with the component models,
+ * which are given each new time step with setTimestep().  The solutions must agree at every step.
+ *
+ * The check is built in two stages: the first build writes the step function to the working
+ * directory, the second build compiles it in with RUNTIME_TIMESTEP_STEP_GENERATED and runs the check.
+ */
+
+// Build from the repository root:
+//
+// 	g++ -O2 -I. -I/usr/include/eigen3 -DLMC_RUNTIME_TIMESTEP examples/SystemStepRuntimeTimestep.cpp LBLMC/codegen/*.cpp LBLMC/comp/*.cpp -lpthread && ./a.out
+// 	g++ -O2 -I. -I/usr/include/eigen3 -DLMC_RUNTIME_TIMESTEP -DRUNTIME_TIMESTEP_STEP_GENERATED examples/SystemStepRuntimeTimestep.cpp LBLMC/codegen/*.cpp LBLMC/comp/*.cpp -lpthread && ./a.out
+
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include "LBLMC/codegen/SystemStepGenerator.hpp"
+
+using namespace LBLMC;
+
+	/// netlist of the check; node 1 is the DC bus, nodes 4-6 the converter outputs
+static SystemNetlist buildNetlist()
+{
+	SystemNetlist netlist(6);
+	netlist.addDCVoltageSource("vs", 1, 0, 100.0, 0.01);
+	netlist.addResistor("r1", 1, 2, 1.0);
+	netlist.addInductor("l1", 2, 3, 1e-3);
+	netlist.addCapacitor("c1", 3, 0, 100e-6);
+	netlist.addResistor("r3", 3, 0, 10.0);
+	netlist.addThreePhaseHBConverter("hb", 1, 0, 4, 5, 6, 5e-2, 1e-3, 0.1);
+	netlist.addResistor("ra", 4, 0, 5.0);
+	netlist.addResistor("rb", 5, 0, 5.0);
+	netlist.addResistor("rc", 6, 0, 5.0);
+	return netlist;
+}
+
+	/// time steps of the check, in the ascending order of dt_sel
+static std::vector<NumType> timesteps()
+{
+	std::vector<NumType> dts;
+	dts.push_back(0.5e-6);
+	dts.push_back(1e-6);
+	dts.push_back(2e-6);
+	return dts;
+}
+
+#ifndef RUNTIME_TIMESTEP_STEP_GENERATED
+
+int main()
+{
+	SystemStepGenerator generator(buildNetlist(), timesteps());
+
+	if(generator.generateStepAndExportC("./", "RuntimeTimestepStep", "RuntimeTimestepStep"))
+	{
+		std::printf("cannot write RuntimeTimestepStep.hpp/.cpp\n");
+		return 1;
+	}
+
+	std::printf("generated RuntimeTimestepStep.hpp/.cpp; build again with -DRUNTIME_TIMESTEP_STEP_GENERATED to run the check\n");
+	return 0;
+}
+
+#else
+
+#ifndef LMC_RUNTIME_TIMESTEP
+#error "the check needs setTimestep() of the components; build with -DLMC_RUNTIME_TIMESTEP"
+#endif
+
+#include "RuntimeTimestepStep.cpp"
+#include "LBLMC/codegen/TimestepBank.hpp"
+#include "LBLMC/codegen/SystemConductance.hpp"
+#include "LBLMC/codegen/SystemSourceVector.hpp"
+#include "LBLMC/comp/Inductor.hpp"
+#include "LBLMC/comp/Capacitor.hpp"
+#include "LBLMC/comp/ThreePhaseHBConverter.hpp"
+
+static const unsigned int num_steps = 20000;
+
+	/// source contribution of output k of element i; outputs without a source go to the unused b[0]
+static NumType* output(std::vector<NumType>& b, const SystemNetlist& netlist, unsigned int i, unsigned int k)
+{
+	return &b[netlist.getElement(i).sources[k]];
+}
+
+int main()
+{
+	SystemNetlist netlist = buildNetlist();
+	TimestepBank bank(netlist, timesteps());
+
+		//stamp once to number the sources of the elements
+
+	SystemConductance conductance(netlist.getDimension());
+	SystemSourceVector sources(netlist.getDimension());
+	netlist.stampSystem(bank.getTimestep(0), conductance, sources);
+
+	Inductor l1(bank.getTimestep(0), 1e-3);
+	Capacitor c1(bank.getTimestep(0), 100e-6);
+	ThreePhaseHBConverter hb(bank.getTimestep(0), 5e-2, 1e-3, 0.1);
+
+	RuntimeTimestepStepState state;
+	RuntimeTimestepStepInit(state);
+
+	NumType x_ref[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	NumType x_gen[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+	std::vector<NumType> b(sources.getNumSources()+1, 0.0);
+
+	const unsigned int pattern[6] = {0, 2, 1, 2, 0, 1};
+	unsigned int selected = 0;
+	double t = 0.0;
+	double max_error = 0.0;
+	double max_voltage = 0.0;
+
+	for(unsigned int step = 0; step < num_steps; step++)
+	{
+		const unsigned int dt_sel = pattern[(step/37)%6];
+		if(dt_sel != selected)
+		{
+			l1.setTimestep(bank.getTimestep(dt_sel));
+			c1.setTimestep(bank.getTimestep(dt_sel));
+			hb.setTimestep(bank.getTimestep(dt_sel));
+			selected = dt_sel;
+		}
+
+			//10 kHz switching of the phases, with the switches disabled for 1 ms
+
+		bool sw[4];
+		for(unsigned int k = 0; k < 3; k++)
+		{
+			const double phase = t*10e3 + k/3.0;
+			sw[k] = (phase - std::floor(phase)) < 0.4 + 0.1*k;
+		}
+		sw[3] = !(t > 5e-3 && t < 6e-3);
+
+		l1.update(x_ref[1], x_ref[2], output(b, netlist, 2, 0));
+		c1.update(x_ref[2], 0.0, output(b, netlist, 3, 0));
+		hb.update(x_ref[0], 0.0, x_ref[3], x_ref[4], x_ref[5],
+				output(b, netlist, 5, 0), output(b, netlist, 5, 1), output(b, netlist, 5, 2),
+				output(b, netlist, 5, 3), output(b, netlist, 5, 4), sw[0], sw[1], sw[2], sw[3]);
+		bank.getSolver(dt_sel).solve(&b[1], x_ref);
+
+		RuntimeTimestepStep(state, x_gen, sw, dt_sel);
+
+		for(unsigned int n = 0; n < 6; n++)
+		{
+			const double error = std::fabs(double(x_gen[n] - x_ref[n]));
+			if(error > max_error) max_error = error;
+			if(std::fabs(double(x_ref[n])) > max_voltage) max_voltage = std::fabs(double(x_ref[n]));
+		}
+
+		t += double(bank.getTimestep(dt_sel));
+	}
+
+	std::printf("steps: %u, max |x|: %.3f V, max |x_gen - x_ref|: %.3g V\n", num_steps, max_voltage, max_error);
+
+	const bool passed = (max_error <= 1e-9*max_voltage);
+
+	std::printf("%s\n", passed ? "passed" : "FAILED");
+
+	return passed ? 0 : 1;
+}
+
+#endif